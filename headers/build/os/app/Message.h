@@ -278,6 +278,7 @@ class BMessage {
 		status_t		_InitCommon(bool initHeader);
 		status_t		_InitHeader();
 		status_t		_Clear();
+		status_t		_Reset();
 
 		status_t		_ValidateMessage();
 
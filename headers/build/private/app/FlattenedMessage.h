@@ -0,0 +1 @@
+#include <../private/app/FlattenedMessage.h>
@@ -152,6 +152,12 @@ class BMessage::Private {
 			return fMessage->_InitHeader();
 		}
 
+		status_t
+		Reset()
+		{
+			return fMessage->_Reset();
+		}
+
 		BMessage::message_header*
 		GetMessageHeader()
 		{
@@ -170,6 +176,23 @@ class BMessage::Private {
 			return fMessage->fData;
 		}
 
+		// static methods
+
+		static uint32
+		HashName(const char* name)
+		{
+			char ch;
+			uint32 result = 0;
+
+			while ((ch = *name++) != 0) {
+				result = (result << 7) ^ (result >> 24);
+				result ^= ch;
+			}
+
+			result ^= result << 12;
+			return result;
+		}
+
 	private:
 		BMessage* fMessage;
 };
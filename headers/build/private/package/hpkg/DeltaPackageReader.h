@@ -0,0 +1 @@
+#include <../private/package/hpkg/DeltaPackageReader.h>
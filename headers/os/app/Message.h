@@ -536,6 +536,7 @@ private:
 			status_t			_InitCommon(bool initHeader);
 			status_t			_InitHeader();
 			status_t			_Clear();
+			status_t			_Reset();
 
 			status_t			_FlattenToArea(message_header** _header) const;
 			status_t			_CopyForWrite();
@@ -95,6 +95,7 @@ const uint32 B_SCROLL_VIEW_AWARE		= 0x00200000UL;	/* 21 */
 const uint32 B_SUPPORTS_LAYOUT			= 0x00100000UL;	/* 20 */
 const uint32 B_INVALIDATE_AFTER_LAYOUT	= 0x00080000UL;	/* 19 */
 const uint32 B_TRANSPARENT_BACKGROUND	= 0x00040000UL;	/* 18 */
+const uint32 B_RETAIN_DRAWING			= 0x00020000UL;	/* 17 */
 
 #define _RESIZE_MASK_ (0xffff)
 
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _FLATTENED_MESSAGE_H
+#define _FLATTENED_MESSAGE_H
+
+
+#include <Message.h>
+
+
+namespace BPrivate {
+
+/*!	Read-only access to a message flattened in the native format, without
+	unflattening it into a BMessage first. The data returned by FindData()
+	and FindString() points into the buffer, which must stay valid as long
+	as it is used.
+*/
+class BFlattenedMessage {
+	public:
+		BFlattenedMessage();
+		BFlattenedMessage(const void* buffer, size_t size);
+
+		status_t SetTo(const void* buffer, size_t size);
+		void Unset();
+		status_t InitCheck() const { return fInitStatus; }
+
+		uint32 What() const;
+		int32 CountFields() const;
+
+		status_t GetInfo(const char* name, type_code* _type,
+			int32* _count = NULL, bool* _fixedSize = NULL) const;
+		bool HasData(const char* name, type_code type = B_ANY_TYPE,
+			int32 index = 0) const;
+
+		status_t FindData(const char* name, type_code type, int32 index,
+			const void** _data, ssize_t* _numBytes) const;
+		status_t FindString(const char* name, int32 index,
+			const char** _string) const;
+
+		status_t FindBool(const char* name, int32 index, bool* _value) const;
+		status_t FindInt8(const char* name, int32 index, int8* _value) const;
+		status_t FindInt16(const char* name, int32 index, int16* _value) const;
+		status_t FindInt32(const char* name, int32 index, int32* _value) const;
+		status_t FindInt64(const char* name, int32 index, int64* _value) const;
+		status_t FindFloat(const char* name, int32 index, float* _value) const;
+		status_t FindDouble(const char* name, int32 index,
+			double* _value) const;
+		status_t FindPoint(const char* name, int32 index,
+			BPoint* _value) const;
+		status_t FindRect(const char* name, int32 index, BRect* _value) const;
+		status_t FindPointer(const char* name, int32 index,
+			void** _value) const;
+
+	private:
+		typedef BMessage::message_header message_header;
+		typedef BMessage::field_header field_header;
+
+		status_t _FindField(const char* name, type_code type,
+			const field_header** _field) const;
+		status_t _FindValue(const char* name, type_code type, int32 index,
+			void* value, size_t size) const;
+
+	private:
+		const message_header*	fHeader;
+		const field_header*		fFields;
+		const uint8*			fData;
+		status_t				fInitStatus;
+};
+
+}	// namespace BPrivate
+
+#endif	// _FLATTENED_MESSAGE_H
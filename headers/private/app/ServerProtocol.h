@@ -369,6 +369,9 @@ enum {
 	AS_VIEW_CLIP_TO_RECT,
 	AS_VIEW_CLIP_TO_SHAPE,
 
+	// debugging helper
+	AS_DUMP_DAMAGE_STATISTICS,
+
 	AS_LAST_CODE
 };
 
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SHARED_EVENT_RING_H
+#define SHARED_EVENT_RING_H
+
+
+#include <Errors.h>
+#include <SupportDefs.h>
+
+
+/*!	A single producer, single consumer ring buffer through which the
+	input_server passes events to the app_server without a port message per
+	event.
+
+	Each entry consists of the uint32 size of a flattened BMessage, followed
+	by the message itself, padded to a multiple of 8 bytes. Entries never
+	wrap; if an entry doesn't fit at the end of the buffer, a size of 0
+	tells the reader to continue at the start.
+
+	The offsets keep increasing, and are only taken modulo the buffer size
+	when accessing the data. Only the input_server changes write_offset,
+	and only the app_server changes read_offset. Before waiting on its port,
+	the app_server sets reader_waiting; the input_server then writes a
+	kEventRingCode message to that port once it has added new events.
+*/
+struct shared_event_ring {
+	uint32	write_offset;
+	uint32	read_offset;
+	int32	reader_waiting;
+	uint32	size;
+	uint8	data[0];
+};
+
+
+#define SHARED_EVENT_RING_SIZE		(64 * 1024)
+	// must be a power of two
+
+static const int32 kEventRingCode = 'evrg';
+
+
+static inline uint32
+shared_event_ring_entry_size(size_t messageSize)
+{
+	return (sizeof(uint32) + messageSize + 7) & ~(uint32)7;
+}
+
+
+/*!	Reserves room for a message of \a messageSize bytes at the end of the
+	ring, and returns where it has to be written to, or \c NULL if there
+	currently isn't enough room left. The entry is only visible to the reader
+	after shared_event_ring_end_write() has been called with the offset
+	returned in \a _nextWriteOffset.
+*/
+static inline uint8*
+shared_event_ring_begin_write(shared_event_ring* ring, size_t messageSize,
+	uint32* _nextWriteOffset)
+{
+	uint32 entrySize = shared_event_ring_entry_size(messageSize);
+	uint32 writeOffset = ring->write_offset;
+	uint32 used = writeOffset - (uint32)atomic_get((int32*)&ring->read_offset);
+	uint32 position = writeOffset & (SHARED_EVENT_RING_SIZE - 1);
+
+	// entries don't wrap, skip the rest of the buffer if necessary
+	uint32 padding = 0;
+	if (SHARED_EVENT_RING_SIZE - position < entrySize)
+		padding = SHARED_EVENT_RING_SIZE - position;
+
+	if (used > SHARED_EVENT_RING_SIZE
+		|| used + padding + entrySize > SHARED_EVENT_RING_SIZE)
+		return NULL;
+
+	if (padding != 0) {
+		*(uint32*)(ring->data + position) = 0;
+		position = 0;
+	}
+
+	*(uint32*)(ring->data + position) = messageSize;
+	*_nextWriteOffset = writeOffset + padding + entrySize;
+	return ring->data + position + sizeof(uint32);
+}
+
+
+static inline void
+shared_event_ring_end_write(shared_event_ring* ring, uint32 nextWriteOffset)
+{
+	atomic_set((int32*)&ring->write_offset, nextWriteOffset);
+}
+
+
+/*!	Returns the next message in the ring after \a readOffset, and advances
+	\a readOffset past it. \a writeOffset must have been read from the ring
+	before. Returns \c B_ENTRY_NOT_FOUND if there are no more messages, and
+	\c B_BAD_DATA if the ring doesn't contain valid entries.
+	The space is only given back to the writer once the reader sets
+	read_offset itself.
+*/
+static inline status_t
+shared_event_ring_next_message(const shared_event_ring* ring,
+	uint32* readOffset, uint32 writeOffset, const uint8** _data,
+	uint32* _size)
+{
+	while (*readOffset != writeOffset) {
+		uint32 available = writeOffset - *readOffset;
+		uint32 position = *readOffset & (SHARED_EVENT_RING_SIZE - 1);
+		uint32 messageSize = *(const uint32*)(ring->data + position);
+
+		uint32 entrySize = messageSize == 0
+			? SHARED_EVENT_RING_SIZE - position
+			: shared_event_ring_entry_size(messageSize);
+		if (available > SHARED_EVENT_RING_SIZE || entrySize > available
+			|| entrySize > SHARED_EVENT_RING_SIZE - position)
+			return B_BAD_DATA;
+
+		*readOffset += entrySize;
+		if (messageSize == 0) {
+			// the next entry didn't fit at the end, continue at the start
+			continue;
+		}
+
+		*_data = ring->data + position + sizeof(uint32);
+		*_size = messageSize;
+		return B_OK;
+	}
+
+	return B_ENTRY_NOT_FOUND;
+}
+
+
+#endif	/* SHARED_EVENT_RING_H */
@@ -51,6 +51,20 @@ SOFTWARE.
 
 #include <Region.h>
 
+
+/*!	The region operations of BRegion::Support, for the unit tests, which
+	cannot name the private class itself.
+*/
+struct region_support_ops {
+	int		(*union_region)(const BRegion* reg1, const BRegion* reg2,
+				BRegion* newReg);
+	int		(*intersect_region)(const BRegion* reg1, const BRegion* reg2,
+				BRegion* newReg);
+	int		(*subtract_region)(const BRegion* regM, const BRegion* regS,
+				BRegion* regD);
+};
+
+
 class BRegion::Support {
  public:
 	static	int					XUnionRegion(const BRegion* reg1,
@@ -77,6 +91,15 @@ class BRegion::Support {
 	static	int					XRectInRegion(const BRegion* region,
 									const clipping_rect& rect);
 
+	friend	region_support_ops	get_region_support_ops()
+								{
+									region_support_ops ops = {
+										&XUnionRegion, &XIntersectRegion,
+										&XSubtractRegion
+									};
+									return ops;
+								}
+
  private:
 	static	BRegion*			CreateRegion();
 	static	void				DestroyRegion(BRegion* r);
@@ -149,4 +172,8 @@ class BRegion::Support {
 
 };
 
+
+region_support_ops get_region_support_ops();
+
+
 #endif // __REGION_SUPPORT_H
@@ -16,7 +16,7 @@ namespace BPrivate {
 
 class SHA256 {
 public:
-								SHA256();
+								SHA256(bool allowAcceleration = true);
 								~SHA256();
 
 			void				Init();
@@ -35,6 +35,7 @@ private:
 			size_t				fBytesInBuffer;
 			size_t				fMessageSize;
 			bool				fDigested;
+			bool				fAccelerated;
 };
 
 
@@ -55,6 +55,9 @@ public:
 			bool				FirstBootProcessing() const;
 			void				SetFirstBootProcessing(bool processingIsOn);
 
+			bool				SkipUnchangedPackages() const;
+			void				SetSkipUnchangedPackages(bool skip);
+
 	virtual	status_t			Archive(BMessage* archive,
 									bool deep = true) const;
 	static	BArchivable*		Instantiate(BMessage* archive);
@@ -70,6 +73,7 @@ private:
 			BStringList			fPackagesToActivate;
 			BStringList			fPackagesToDeactivate;
 			bool				fFirstBootProcessing;
+			bool				fSkipUnchangedPackages;
 };
 
 
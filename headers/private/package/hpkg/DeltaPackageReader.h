@@ -0,0 +1,65 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _PACKAGE__HPKG__PRIVATE__DELTA_PACKAGE_READER_H_
+#define _PACKAGE__HPKG__PRIVATE__DELTA_PACKAGE_READER_H_
+
+
+#include <DataIO.h>
+
+#include <package/hpkg/HPKGDefsPrivate.h>
+
+
+namespace BPackageKit {
+
+namespace BHPKG {
+
+
+class BErrorOutput;
+
+
+namespace BPrivate {
+
+
+class DeltaPackageReader {
+public:
+								DeltaPackageReader(BErrorOutput* errorOutput);
+								~DeltaPackageReader();
+
+			status_t			Init(BPositionIO* delta);
+
+			uint64				OldPackageSize() const
+									{ return fHeader.old_package_size; }
+			const uint8*		OldPackageChecksum() const
+									{ return fHeader.old_package_checksum; }
+			uint64				NewPackageSize() const
+									{ return fHeader.new_package_size; }
+			const uint8*		NewPackageChecksum() const
+									{ return fHeader.new_package_checksum; }
+
+			status_t			Apply(BPositionIO* oldPackage,
+									BPositionIO* newPackage);
+
+private:
+			status_t			_Read(void* buffer, size_t size);
+
+private:
+			BErrorOutput*		fErrorOutput;
+			BPositionIO*		fDelta;
+			hpkg_delta_header	fHeader;
+			uint8*				fInputBuffer;
+			size_t				fInputSize;
+			size_t				fInputPosition;
+			off_t				fInputOffset;
+};
+
+
+}	// namespace BPrivate
+
+}	// namespace BHPKG
+
+}	// namespace BPackageKit
+
+
+#endif	// _PACKAGE__HPKG__PRIVATE__DELTA_PACKAGE_READER_H_
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _PACKAGE__HPKG__PRIVATE__DELTA_PACKAGE_WRITER_H_
+#define _PACKAGE__HPKG__PRIVATE__DELTA_PACKAGE_WRITER_H_
+
+
+#include <vector>
+
+#include <DataIO.h>
+
+
+namespace BPackageKit {
+
+namespace BHPKG {
+
+
+class BErrorOutput;
+
+
+namespace BPrivate {
+
+
+class DeltaPackageWriter {
+public:
+								DeltaPackageWriter(BErrorOutput* errorOutput);
+								~DeltaPackageWriter();
+
+			status_t			Create(BPositionIO* oldPackage,
+									BPositionIO* newPackage,
+									BPositionIO* delta);
+
+			uint64				CopiedSize() const
+									{ return fCopiedSize; }
+			uint64				InsertedSize() const
+									{ return fInsertedSize; }
+
+private:
+			struct Block;
+
+			typedef std::vector<Block> BlockList;
+
+private:
+			status_t			_IndexOldPackage(uint8* checksum);
+			bool				_FindMatch(const uint8* data, uint32 weakSum,
+									off_t& _oldOffset);
+			bool				_MatchesOldData(off_t oldOffset,
+									const uint8* data);
+
+			status_t			_AddCopy(off_t oldOffset);
+			status_t			_AddLiteral(uint8 byte);
+			status_t			_AddLiterals(const uint8* data, size_t size);
+			status_t			_FlushCopy();
+			status_t			_FlushLiterals();
+
+			status_t			_Write(const void* buffer, size_t size);
+			status_t			_FlushOutput();
+
+private:
+			BErrorOutput*		fErrorOutput;
+			BPositionIO*		fOldPackage;
+			BPositionIO*		fDelta;
+			off_t				fOldSize;
+			BlockList			fBlocks;
+			uint8*				fOldBlockBuffer;
+			off_t				fCopyOffset;
+			uint64				fCopyLength;
+			uint8*				fLiteralBuffer;
+			size_t				fLiteralSize;
+			uint8*				fOutputBuffer;
+			size_t				fOutputSize;
+			off_t				fOutputOffset;
+			uint64				fCopiedSize;
+			uint64				fInsertedSize;
+};
+
+
+}	// namespace BPrivate
+
+}	// namespace BHPKG
+
+}	// namespace BPackageKit
+
+
+#endif	// _PACKAGE__HPKG__PRIVATE__DELTA_PACKAGE_WRITER_H_
@@ -70,6 +70,38 @@ struct hpkg_repo_header {
 };
 
 
+// delta package file header
+struct hpkg_delta_header {
+	uint32	magic;							// "hpkd"
+	uint16	header_size;
+	uint16	version;
+	uint32	block_size;
+	uint32	reserved1;
+
+	// the package the delta applies to and the package it yields
+	uint64	old_package_size;
+	uint64	new_package_size;
+	uint8	old_package_checksum[32];		// SHA-256 of the package file
+	uint8	new_package_checksum[32];		// SHA-256 of the package file
+};
+
+
+enum {
+	B_HPKG_DELTA_MAGIC			= 'hpkd',
+	B_HPKG_DELTA_VERSION		= 1
+};
+
+
+// delta package instructions (following the header)
+enum {
+	B_HPKG_DELTA_END			= 0,
+	B_HPKG_DELTA_COPY			= 1,
+		// uint64 offset, uint64 length: copy data from the old package
+	B_HPKG_DELTA_DATA			= 2
+		// uint64 length, data: insert the given data
+};
+
+
 // attribute tag arithmetics
 // (using 7 bits for id, 3 for type, 1 for hasChildren and 2 for encoding)
 static inline uint16
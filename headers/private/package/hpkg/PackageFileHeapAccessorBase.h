@@ -93,6 +93,8 @@ public:
 									{ fFile = file; }
 
 	// BAbstractBufferedDataReader
+	virtual	status_t			ReadData(off_t offset, void* buffer,
+									size_t size);
 	virtual	status_t			ReadDataToOutput(off_t offset,
 									size_t size, BDataIO* output);
 
@@ -120,6 +122,10 @@ protected:
 			status_t			ReadFileData(uint64 offset, void* buffer,
 									size_t size);
 
+private:
+			status_t			_ReadData(off_t offset, size_t size,
+									BDataIO* output, uint8* buffer);
+
 protected:
 			BErrorOutput*		fErrorOutput;
 			BPositionIO*		fFile;
@@ -64,8 +64,10 @@ private:
 			struct Chunk;
 			struct ChunkSegment;
 			struct ChunkBuffer;
+			struct ParallelCompressor;
 
 			friend struct ChunkBuffer;
+			friend struct ParallelCompressor;
 
 private:
 			void				_Uninit();
@@ -73,6 +75,12 @@ private:
 			status_t			_FlushPendingData();
 			status_t			_WriteChunk(const void* data, size_t size,
 									bool mayCompress);
+			status_t			_QueueChunk(const void* data, size_t size);
+			status_t			_WriteOldestQueuedChunk();
+			status_t			_WriteQueuedChunks();
+			status_t			_CompressChunkData(const void* data,
+									size_t size, void* compressedDataBuffer,
+									size_t& _compressedSize);
 			status_t			_WriteDataCompressed(const void* data,
 									size_t size);
 			status_t			_WriteDataUncompressed(const void* data,
@@ -88,6 +96,7 @@ private:
 			size_t				fPendingDataSize;
 			Array<uint64>		fOffsets;
 			CompressionAlgorithmOwner* fCompressionAlgorithm;
+			ParallelCompressor*	fParallelCompressor;
 };
 
 
@@ -127,10 +127,12 @@ private:
 			void				_AnalyzeResult();
 			void				_ConfirmChanges(bool fromMostSpecific = false);
 			void				_ApplyPackageChanges(
-									bool fromMostSpecific = false);
+									bool fromMostSpecific = false,
+									bool skipUnchangedPackages = false);
 			void				_PreparePackageChanges(
 									InstalledRepository&
-										installationRepository);
+										installationRepository,
+									bool skipUnchangedPackages);
 			void				_CommitPackageChanges(Transaction& transaction);
 
 			void				_ClonePackageFile(
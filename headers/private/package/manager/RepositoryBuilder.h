@@ -59,6 +59,11 @@ public:
 			BRepositoryBuilder&	AddToSolver(BSolver* solver,
 									bool isInstalled = false);
 
+			BRepositoryBuilder&	CreatePackageDelta(
+									const char* oldPackagePath,
+									const char* newPackagePath,
+									const char* deltaPath);
+
 private:
 			BSolverRepository&	fRepository;
 			BString				fErrorName;
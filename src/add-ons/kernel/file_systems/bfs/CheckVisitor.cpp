@@ -479,6 +479,15 @@ CheckVisitor::_CheckInodeBlocks(Inode* inode, const char* name)
 		return B_OK;
 	}
 
+	if (inode->HasInlineData()) {
+		// inline data doesn't have a data stream either
+		if (!GetVolume()->HasInlineData() || !inode->IsFile()
+			|| inode->Size() > (off_t)INODE_INLINE_DATA_LENGTH)
+			return B_BAD_DATA;
+
+		return B_OK;
+	}
+
 	data_stream* data = &inode->Node().data;
 
 	// check the direct range
@@ -66,6 +66,7 @@ dump_super_block(const disk_super_block* superBlock)
 	kprintf("  num_ags        = %u\n", (unsigned)superBlock->AllocationGroups());
 	kprintf("  flags          = %#08x (%s)\n", (int)superBlock->Flags(),
 		get_tupel(superBlock->Flags()));
+	kprintf("  features       = %#08x\n", (int)superBlock->Features());
 	dump_block_run("  log_blocks     = ", superBlock->log_blocks);
 	kprintf("  log_start      = %" B_PRIdOFF "\n", superBlock->LogStart());
 	kprintf("  log_end        = %" B_PRIdOFF "\n", superBlock->LogEnd());
@@ -135,7 +136,11 @@ dump_inode(const bfs_inode* inode)
 	kprintf("  short_symlink      = %s\n",
 		S_ISLNK(inode->Mode()) && (inode->Flags() & INODE_LONG_SYMLINK) == 0
 			? inode->short_symlink : "-");
-	dump_data_stream(&(inode->data));
+	if ((inode->Flags() & INODE_INLINE_DATA) != 0) {
+		kprintf("  inline data size   = %" B_PRIdOFF "\n",
+			inode->data.Size());
+	} else
+		dump_data_stream(&(inode->data));
 	kprintf("  --\n  pad[0]             = %08x\n", (int)inode->pad[0]);
 	kprintf("  pad[1]             = %08x\n", (int)inode->pad[1]);
 }
@@ -0,0 +1,257 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * This file may be used under the terms of the MIT License.
+ */
+
+
+//! Online relocation of fragmented file data
+
+
+#include "DefragmentVisitor.h"
+
+#include "BlockAllocator.h"
+#include "Debug.h"
+#include "Inode.h"
+#include "Volume.h"
+
+
+static const size_t kMaxCopyBufferSize = 65536;
+
+
+DefragmentVisitor::DefragmentVisitor(Volume* volume)
+	:
+	FileSystemVisitor(volume),
+	fControl(NULL),
+	fBuffer(NULL),
+	fBufferSize(0)
+{
+}
+
+
+DefragmentVisitor::~DefragmentVisitor()
+{
+	free(fBuffer);
+}
+
+
+/*!	Walks over all regular nodes of the volume, and moves the data of every
+	file whose stream consists of more than one block run into a single
+	contiguous run. Each file is relocated in its own transaction, so the
+	volume stays usable (and consistent) during the whole operation.
+	Only streams that fit into the direct range are relocated; neither
+	streams using the indirect ranges, nor B+trees (directories, indices,
+	and attribute directories) are compacted.
+*/
+status_t
+DefragmentVisitor::Defragment(defragment_control& control)
+{
+	if (control.magic != BFS_IOCTL_DEFRAGMENT_MAGIC)
+		return B_BAD_VALUE;
+
+	memset(&control.stats, 0, sizeof(control.stats));
+
+	if (GetVolume()->IsReadOnly())
+		return B_READ_ONLY_DEVICE;
+
+	fBufferSize = min_c(kMaxCopyBufferSize, (size_t)GetVolume()->BlockSize()
+		* MAX_BLOCK_RUN_LENGTH);
+	fBuffer = (uint8*)malloc(fBufferSize);
+	if (fBuffer == NULL)
+		return B_NO_MEMORY;
+
+	fControl = &control;
+
+	Start(VISIT_REGULAR);
+
+	status_t status;
+	while ((status = Next()) == B_OK)
+		;
+
+	Stop();
+	fControl = NULL;
+
+	if (status == B_ENTRY_NOT_FOUND)
+		status = B_OK;
+
+	control.status = status;
+	return status;
+}
+
+
+status_t
+DefragmentVisitor::VisitInode(Inode* inode, const char* treeName)
+{
+	fControl->stats.inodes++;
+
+	// Only file data is accessed through the file cache; everything else
+	// lives in the block cache, and cannot simply be moved on disk.
+	if (!inode->IsFile() || inode->IsDeleted() || inode->HasInlineData())
+		return B_OK;
+
+	off_t blocks;
+	if (!_IsFragmented(inode->Node().data, blocks))
+		return B_OK;
+
+	fControl->stats.fragmented++;
+
+	bool relocated;
+	status_t status = _Relocate(inode, relocated);
+	if (status == B_OK && relocated) {
+		fControl->stats.relocated++;
+		fControl->stats.blocks_moved += blocks;
+
+		if (fControl->delay > 0)
+			snooze(fControl->delay);
+	} else if (status == B_DEVICE_FULL) {
+		// there is no free range large enough for this file - that's okay
+		status = B_OK;
+	}
+
+	return status;
+}
+
+
+status_t
+DefragmentVisitor::OpenInodeFailed(status_t reason, ino_t id, Inode* parent,
+	char* treeName, TreeIterator* iterator)
+{
+	// just ignore nodes we cannot open, that's a job for checkfs
+	return B_OK;
+}
+
+
+status_t
+DefragmentVisitor::OpenBPlusTreeFailed(Inode* inode)
+{
+	return B_OK;
+}
+
+
+status_t
+DefragmentVisitor::TreeIterationFailed(status_t reason, Inode* parent)
+{
+	return B_OK;
+}
+
+
+/*!	Returns whether or not the stream consists of more than one block run
+	that could be merged into a single one. Only streams that use the direct
+	range are considered.
+*/
+bool
+DefragmentVisitor::_IsFragmented(const data_stream& data, off_t& _blocks) const
+{
+	if (data.MaxIndirectRange() != 0 || data.MaxDoubleIndirectRange() != 0)
+		return false;
+
+	off_t blocks = 0;
+	int32 count = 0;
+	for (; count < NUM_DIRECT_BLOCKS; count++) {
+		if (data.direct[count].IsZero())
+			break;
+		blocks += data.direct[count].Length();
+	}
+
+	// the new run must fit into a single allocation group
+	_blocks = blocks;
+	return count > 1 && blocks <= MAX_BLOCK_RUN_LENGTH
+		&& blocks <= (off_t)1 << GetVolume()->AllocationGroupShift();
+}
+
+
+status_t
+DefragmentVisitor::_Relocate(Inode* inode, bool& _relocated)
+{
+	Volume* volume = GetVolume();
+	_relocated = false;
+
+	Transaction transaction(volume, inode->BlockNumber());
+	inode->WriteLockInTransaction(transaction);
+
+	// The stream might have changed since we looked at it
+	data_stream& data = inode->Node().data;
+	off_t blocks;
+	if (inode->IsDeleted() || inode->HasInlineData()
+		|| !_IsFragmented(data, blocks))
+		return B_OK;
+
+	// The allocator only guarantees a minimum length for powers of two, so
+	// we check the outcome ourselves; aborting the transaction will undo the
+	// allocation in case it was too short.
+	block_run run;
+	status_t status = volume->Allocate(transaction, inode, blocks, run);
+	if (status != B_OK)
+		return status;
+	if (run.Length() != blocks)
+		return B_DEVICE_FULL;
+
+	// Copy the data to its new location; since we hold the write lock, no
+	// pages can be written back in the mean time. Pages that are still dirty
+	// will end up in the new location, as we invalidate the file map below.
+
+	off_t target = volume->ToBlock(run);
+	for (int32 i = 0; i < NUM_DIRECT_BLOCKS && !data.direct[i].IsZero();
+			i++) {
+		status = _CopyBlocks(data.direct[i], target);
+		if (status != B_OK)
+			return status;
+
+		target += data.direct[i].Length();
+	}
+
+	// The data was written to the device directly, but it has to be on disk
+	// before the log entry pointing the stream to it can be.
+	// If that call fails, we can't do anything about it anyway
+	ioctl(volume->Device(), B_FLUSH_DRIVE_CACHE);
+
+	for (int32 i = 0; i < NUM_DIRECT_BLOCKS && !data.direct[i].IsZero();
+			i++) {
+		status = volume->Free(transaction, data.direct[i]);
+		if (status != B_OK)
+			return status;
+
+		data.direct[i].SetTo(0, 0, 0);
+	}
+	data.direct[0] = run;
+
+	status = inode->WriteBack(transaction);
+	if (status != B_OK)
+		return status;
+
+	file_map_invalidate(inode->Map(), 0, data.MaxDirectRange());
+
+	status = transaction.Done();
+	if (status == B_OK)
+		_relocated = true;
+
+	return status;
+}
+
+
+status_t
+DefragmentVisitor::_CopyBlocks(block_run from, off_t to)
+{
+	Volume* volume = GetVolume();
+	off_t source = volume->ToOffset(from);
+	off_t target = to << volume->BlockShift();
+	off_t bytesLeft = (off_t)from.Length() << volume->BlockShift();
+
+	while (bytesLeft > 0) {
+		size_t bytes = min_c((off_t)fBufferSize, bytesLeft);
+
+		ssize_t bytesRead = read_pos(volume->Device(), source, fBuffer, bytes);
+		if (bytesRead != (ssize_t)bytes)
+			RETURN_ERROR(bytesRead < 0 ? bytesRead : B_IO_ERROR);
+
+		ssize_t bytesWritten = write_pos(volume->Device(), target, fBuffer,
+			bytes);
+		if (bytesWritten != (ssize_t)bytes)
+			RETURN_ERROR(bytesWritten < 0 ? bytesWritten : B_IO_ERROR);
+
+		source += bytes;
+		target += bytes;
+		bytesLeft -= bytes;
+	}
+
+	return B_OK;
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * This file may be used under the terms of the MIT License.
+ */
+#ifndef DEFRAGMENT_VISITOR_H
+#define DEFRAGMENT_VISITOR_H
+
+
+#include "system_dependencies.h"
+
+#include "bfs_control.h"
+#include "FileSystemVisitor.h"
+
+
+class DefragmentVisitor : public FileSystemVisitor {
+public:
+								DefragmentVisitor(Volume* volume);
+	virtual						~DefragmentVisitor();
+
+			status_t			Defragment(defragment_control& control);
+
+	virtual status_t			VisitInode(Inode* inode, const char* treeName);
+
+	virtual status_t			OpenInodeFailed(status_t reason, ino_t id,
+									Inode* parent, char* treeName,
+									TreeIterator* iterator);
+	virtual status_t			OpenBPlusTreeFailed(Inode* inode);
+	virtual status_t			TreeIterationFailed(status_t reason,
+									Inode* parent);
+
+private:
+			bool				_IsFragmented(const data_stream& data,
+									off_t& _blocks) const;
+			status_t			_Relocate(Inode* inode, bool& _relocated);
+			status_t			_CopyBlocks(block_run from, off_t to);
+
+private:
+			defragment_control*	fControl;
+			uint8*				fBuffer;
+			size_t				fBufferSize;
+};
+
+
+#endif	// DEFRAGMENT_VISITOR_H
@@ -327,6 +327,10 @@ bfs_inode::InitCheck(Volume* volume) const
 	if (Flags() & INODE_DELETED)
 		return B_NOT_ALLOWED;
 
+	if ((Flags() & INODE_INLINE_DATA) != 0
+		&& data.Size() > (off_t)INODE_INLINE_DATA_LENGTH)
+		RETURN_ERROR(B_BAD_DATA);
+
 	// TODO: Add some tests to check the integrity of the other stuff here,
 	// especially for the data_stream!
 
@@ -499,6 +503,7 @@ Inode::WriteBack(Transaction& transaction)
 	if (status != B_OK)
 		return status;
 
+	Node().flags &= ~HOST_ENDIAN_TO_BFS_INT32(INODE_INLINE_DATA_CHANGED);
 	memcpy(node.WritableNode(), &Node(), sizeof(bfs_inode));
 	return B_OK;
 }
@@ -1428,8 +1433,9 @@ Inode::ContainerContentsChanged(Transaction& transaction)
 off_t
 Inode::AllocatedSize() const
 {
-	if (IsSymLink() && (Flags() & INODE_LONG_SYMLINK) == 0) {
-		// This symlink does not have a data stream
+	if ((IsSymLink() && (Flags() & INODE_LONG_SYMLINK) == 0)
+		|| HasInlineData()) {
+		// This node does not have a data stream
 		return Node().InodeSize();
 	}
 
@@ -1471,6 +1477,9 @@ Inode::AllocatedSize() const
 status_t
 Inode::FindBlockRun(off_t pos, block_run& run, off_t& offset)
 {
+	if (HasInlineData())
+		return B_BAD_VALUE;
+
 	data_stream* data = &Node().data;
 
 	// find matching block run
@@ -1599,10 +1608,13 @@ Inode::WriteAt(Transaction& transaction, off_t pos, const uint8* buffer,
 	if (pos < 0)
 		return B_BAD_VALUE;
 
+	// inline data is written as part of the inode
+	bool needsTransaction = changeSize || HasInlineData();
+
 	locker.Unlock();
 
 	// the transaction doesn't have to be started already
-	if (changeSize && !transaction.IsStarted())
+	if (needsTransaction && !transaction.IsStarted())
 		transaction.Start(fVolume, BlockNumber());
 
 	WriteLocker writeLocker(fLock);
@@ -1610,7 +1622,8 @@ Inode::WriteAt(Transaction& transaction, off_t pos, const uint8* buffer,
 	// Work around possible race condition: Someone might have shrunken the file
 	// while we had no lock.
 	if (!transaction.IsStarted()
-		&& (uint64)pos + (uint64)length > (uint64)Size()) {
+		&& ((uint64)pos + (uint64)length > (uint64)Size()
+			|| HasInlineData())) {
 		writeLocker.Unlock();
 		transaction.Start(fVolume, BlockNumber());
 		writeLocker.Lock();
@@ -1640,6 +1653,20 @@ Inode::WriteAt(Transaction& transaction, off_t pos, const uint8* buffer,
 		}
 	}
 
+	if (HasInlineData() && length > 0) {
+		// the file cache only reads the data back from the inode, so it has
+		// to be written there, too
+		status_t status = user_memcpy(Node().inline_data + pos, buffer,
+			length);
+		if (status == B_OK)
+			status = WriteBack(transaction);
+		if (status != B_OK) {
+			*_length = 0;
+			WriteLockInTransaction(transaction);
+			RETURN_ERROR(status);
+		}
+	}
+
 	writeLocker.Unlock();
 
 	if (oldSize < pos)
@@ -1686,6 +1713,43 @@ Inode::FillGapWithZeros(off_t pos, off_t newSize)
 }
 
 
+/*!	Copies \a length bytes of the inline data at \a pos to \a buffer. Anything
+	beyond the end of the file reads as zeros, as the file cache expects it.
+	The inode must be at least read locked.
+*/
+void
+Inode::ReadInlineData(off_t pos, uint8* buffer, size_t length) const
+{
+	size_t bytes = 0;
+	if (pos < Size())
+		bytes = min_c(length, (size_t)(Size() - pos));
+
+	memcpy(buffer, Node().inline_data + pos, bytes);
+	memset(buffer + bytes, 0, length - bytes);
+}
+
+
+/*!	Takes over what the file cache writes back to the inline data. Changes
+	made through WriteAt() are already there; anything else, like a write to
+	a mapping of the file, is only written to disk with the next Sync(), or
+	when the inode is put away.
+	The inode must be write locked.
+*/
+void
+Inode::WriteInlineData(off_t pos, const uint8* buffer, size_t length)
+{
+	if (pos >= Size())
+		return;
+
+	length = min_c(length, (size_t)(Size() - pos));
+	if (memcmp(Node().inline_data + pos, buffer, length) == 0)
+		return;
+
+	memcpy(Node().inline_data + pos, buffer, length);
+	Node().flags |= HOST_ENDIAN_TO_BFS_INT32(INODE_INLINE_DATA_CHANGED);
+}
+
+
 /*!	Allocates \a length blocks, and clears their contents. Growing
 	the indirect and double indirect range uses this method.
 	The allocated block_run is saved in "run"
@@ -2328,6 +2392,24 @@ Inode::SetFileSize(Transaction& transaction, off_t size)
 
 	T(Resize(this, oldSize, size, false));
 
+	if (HasInlineData()) {
+		if (size <= (off_t)INODE_INLINE_DATA_LENGTH) {
+			// keep everything past the end of the file cleared
+			if (size < oldSize)
+				memset(Node().inline_data + size, 0, oldSize - size);
+
+			Node().data.size = HOST_ENDIAN_TO_BFS_INT64(size);
+
+			file_cache_set_size(FileCache(), size);
+			file_map_set_size(Map(), size);
+			return WriteBack(transaction);
+		}
+
+		status_t status = _MoveInlineDataToStream(transaction);
+		if (status != B_OK)
+			return status;
+	}
+
 	// should the data stream grow or shrink?
 	status_t status;
 	if (size > oldSize) {
@@ -2343,6 +2425,13 @@ Inode::SetFileSize(Transaction& transaction, off_t size)
 	if (status < B_OK)
 		return status;
 
+	if (size == 0 && IsFile() && fVolume->HasInlineData()) {
+		// the stream is gone, so the file can start over inline
+		memset(&Node().data, 0, sizeof(data_stream));
+		Node().flags |= HOST_ENDIAN_TO_BFS_INT32(INODE_INLINE_DATA);
+		file_map_invalidate(Map(), 0, oldSize);
+	}
+
 	file_cache_set_size(FileCache(), size);
 	file_map_set_size(Map(), size);
 
@@ -2350,6 +2439,64 @@ Inode::SetFileSize(Transaction& transaction, off_t size)
 }
 
 
+/*!	Gives the file a data stream of its current size, and moves the inline
+	data into its first block. The data is written to the device directly, as
+	the file cache only writes back what changed.
+*/
+status_t
+Inode::_MoveInlineDataToStream(Transaction& transaction)
+{
+	off_t size = Size();
+	uint8 inlineData[INODE_INLINE_DATA_LENGTH];
+	memcpy(inlineData, Node().inline_data, size);
+
+	memset(&Node().data, 0, sizeof(data_stream));
+	Node().flags &= ~HOST_ENDIAN_TO_BFS_INT32(INODE_INLINE_DATA
+		| INODE_INLINE_DATA_CHANGED);
+
+	status_t status = B_OK;
+	if (size > 0) {
+		status = _GrowStream(transaction, size);
+
+		block_run run;
+		off_t offset;
+		if (status == B_OK)
+			status = FindBlockRun(0, run, offset);
+
+		uint8* block = NULL;
+		if (status == B_OK) {
+			block = (uint8*)calloc(1, fVolume->BlockSize());
+			if (block == NULL)
+				status = B_NO_MEMORY;
+		}
+		if (status == B_OK) {
+			memcpy(block, inlineData, size);
+			if (write_pos(fVolume->Device(), fVolume->ToOffset(run), block,
+					fVolume->BlockSize()) != (ssize_t)fVolume->BlockSize())
+				status = B_IO_ERROR;
+		}
+		free(block);
+
+		if (status != B_OK) {
+			_ShrinkStream(transaction, 0);
+			memset(&Node().data, 0, sizeof(data_stream));
+			memcpy(Node().inline_data, inlineData, size);
+			Node().data.size = HOST_ENDIAN_TO_BFS_INT64(size);
+			Node().flags |= HOST_ENDIAN_TO_BFS_INT32(INODE_INLINE_DATA);
+			return status;
+		}
+
+		// The block has to be on disk before the log entry pointing the
+		// stream to it can be.
+		// If that call fails, we can't do anything about it anyway
+		ioctl(fVolume->Device(), B_FLUSH_DRIVE_CACHE);
+	}
+
+	file_map_invalidate(Map(), 0, size);
+	return B_OK;
+}
+
+
 status_t
 Inode::Append(Transaction& transaction, off_t bytes)
 {
@@ -2368,7 +2515,7 @@ Inode::NeedsTrimming() const
 	// possible. There are only few indices anyway, so this doesn't hurt.
 	// Also, if an inode is already in deleted state, we don't bother trimming
 	// it.
-	if (IsIndex() || IsDeleted()
+	if (IsIndex() || IsDeleted() || HasInlineData()
 		|| (IsSymLink() && (Flags() & INODE_LONG_SYMLINK) == 0))
 		return false;
 
@@ -2435,8 +2582,19 @@ Inode::Free(Transaction& transaction)
 status_t
 Inode::Sync()
 {
-	if (FileCache())
-		return file_cache_sync(FileCache());
+	if (FileCache()) {
+		status_t status = file_cache_sync(FileCache());
+		if (status == B_OK && (Flags() & INODE_INLINE_DATA_CHANGED) != 0) {
+			// the inline data was changed through the file cache only
+			Transaction transaction(fVolume, BlockNumber());
+			WriteLockInTransaction(transaction);
+
+			status = WriteBack(transaction);
+			if (status == B_OK)
+				status = transaction.Done();
+		}
+		return status;
+	}
 
 	// We may also want to flush the attribute's data stream to
 	// disk here... (do we?)
@@ -2790,6 +2948,9 @@ Inode::Create(Transaction& transaction, Inode* parent, const char* name,
 
 	node->type = HOST_ENDIAN_TO_BFS_INT32(type);
 
+	if (inode->IsFile() && volume->HasInlineData())
+		node->flags |= HOST_ENDIAN_TO_BFS_INT32(INODE_INLINE_DATA);
+
 	inode->WriteBack(transaction);
 		// make sure the initialized node is available to others
 
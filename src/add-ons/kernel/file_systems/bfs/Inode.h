@@ -75,6 +75,9 @@ public:
 			bool				IsLongSymLink() const
 									{ return (Flags() & INODE_LONG_SYMLINK)
 										!= 0; }
+			bool				HasInlineData() const
+									{ return (Flags() & INODE_INLINE_DATA)
+										!= 0; }
 
 			bool				HasUserAccessableStream() const
 									{ return IsFile(); }
@@ -150,6 +153,12 @@ public:
 									const uint8* buffer, size_t* length);
 			status_t			FillGapWithZeros(off_t oldSize, off_t newSize);
 
+			// inline data, for the file system hooks
+			void				ReadInlineData(off_t pos, uint8* buffer,
+									size_t length) const;
+			void				WriteInlineData(off_t pos, const uint8* buffer,
+									size_t length);
+
 			status_t			SetFileSize(Transaction& transaction,
 									off_t size);
 			status_t			Append(Transaction& transaction, off_t bytes);
@@ -256,6 +265,8 @@ private:
 									off_t size);
 			status_t			_ShrinkStream(Transaction& transaction,
 									off_t size);
+			status_t			_MoveInlineDataToStream(
+									Transaction& transaction);
 			status_t			_AddBlockRun(Transaction& transaction,
 									data_stream* data, block_run run,
 									off_t targetSize, int32* rest = NULL,
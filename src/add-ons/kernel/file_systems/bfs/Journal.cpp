@@ -402,15 +402,20 @@ Journal::Journal(Volume* volume)
 	:
 	fVolume(volume),
 	fOwner(NULL),
+	fWaitingOwners(0),
 	fLogSize(volume->Log().Length()),
 	fMaxTransactionSize(fLogSize / 2 - 5),
+	fMaxGroupSize(fLogSize * 3 / 4 - 5),
 	fUsed(0),
 	fUnwrittenTransactions(0),
 	fHasSubtransaction(false),
-	fSeparateSubTransactions(false)
+	fSeparateSubTransactions(false),
+	fFlushesStarted(0),
+	fLastFlushStatus(B_OK)
 {
 	recursive_lock_init(&fLock, "bfs journal");
 	mutex_init(&fEntriesLock, "bfs journal entries");
+	mutex_init(&fFlushLock, "bfs journal flush");
 
 	fLogFlusherSem = create_sem(0, "bfs log flusher");
 	fLogFlusher = spawn_kernel_thread(&Journal::_LogFlusher, "bfs log flusher",
@@ -426,6 +431,7 @@ Journal::~Journal()
 
 	recursive_lock_destroy(&fLock);
 	mutex_destroy(&fEntriesLock);
+	mutex_destroy(&fFlushLock);
 
 	sem_id logFlusher = fLogFlusherSem;
 	fLogFlusherSem = -1;
@@ -960,11 +966,34 @@ Journal::_FlushLog(bool canWait, bool flushBlocks, bool alreadyLocked)
 
 /*!	Flushes the current log entry to disk, and also writes back all dirty
 	blocks for this volume (completing all open transactions).
+
+	Concurrent callers are committed as a group: if another flush has been
+	started after we were called, and has completed while we were waiting
+	for it, everything we wanted to see on disk is already there, and we
+	just share its result instead of flushing the device once more.
 */
 status_t
 Journal::FlushLogAndBlocks()
 {
-	return _FlushLog(true, true);
+	if (recursive_lock_get_recursion(&fLock) > 0) {
+		// We're inside a transaction, and must not wait for another flush
+		// that might need the journal lock to complete.
+		return _FlushLog(true, true);
+	}
+
+	int32 flushesStarted = atomic_get(&fFlushesStarted);
+
+	MutexLocker locker(fFlushLock);
+
+	if (fFlushesStarted != flushesStarted) {
+		// a flush that started after us has completed already
+		return fLastFlushStatus;
+	}
+
+	atomic_add(&fFlushesStarted, 1);
+	fLastFlushStatus = _FlushLog(true, true);
+
+	return fLastFlushStatus;
 }
 
 
@@ -991,7 +1020,17 @@ Journal::FlushLogAndLockJournal()
 status_t
 Journal::Lock(Transaction* owner, bool separateSubTransactions)
 {
+	// Keep track of the transactions waiting for the journal, so that they
+	// can be committed together with the current one (see
+	// _TransactionDone()).
+	bool waiting = owner != NULL && recursive_lock_get_recursion(&fLock) < 0;
+	if (waiting)
+		atomic_add(&fWaitingOwners, 1);
+
 	status_t status = recursive_lock_lock(&fLock);
+
+	if (waiting)
+		atomic_add(&fWaitingOwners, -1);
 	if (status != B_OK)
 		return status;
 
@@ -1103,9 +1142,15 @@ Journal::_TransactionDone(bool success)
 	}
 
 	// Up to a maximum size, we will just batch several
-	// transactions together to improve speed
+	// transactions together to improve speed.
+	// If other transactions are already waiting for the journal, we let the
+	// batch grow a bit larger, so that they end up in the same log entry,
+	// instead of each group of them paying for writing the log and flushing
+	// the drive cache on its own (group commit).
 	uint32 size = _TransactionSize();
-	if (size < fMaxTransactionSize) {
+	uint32 maxSize = atomic_get(&fWaitingOwners) > 0
+		? fMaxGroupSize : fMaxTransactionSize;
+	if (size < maxSize) {
 		// Flush the log from time to time, so that we have enough space
 		// for this transaction
 		if (size > FreeLogBlocks())
@@ -1198,6 +1243,7 @@ Journal::MoveLog(block_run newLog)
 
 	fLogSize = newLog.Length();
 	fMaxTransactionSize = fLogSize / 2 - 5;
+	fMaxGroupSize = fLogSize * 3 / 4 - 5;
 
 	Unlock(NULL, true);
 	volumeLock.Unlock();
@@ -1239,12 +1285,15 @@ Journal::Dump()
 	kprintf("  owner:                %p\n", fOwner);
 	kprintf("  log size:             %" B_PRIu32 "\n", fLogSize);
 	kprintf("  max transaction size: %" B_PRIu32 "\n", fMaxTransactionSize);
+	kprintf("  max group size:       %" B_PRIu32 "\n", fMaxGroupSize);
+	kprintf("  waiting owners:       %" B_PRId32 "\n", fWaitingOwners);
 	kprintf("  used:                 %" B_PRIu32 "\n", fUsed);
 	kprintf("  unwritten:            %" B_PRId32 "\n", fUnwrittenTransactions);
 	kprintf("  timestamp:            %" B_PRId64 "\n", fTimestamp);
 	kprintf("  transaction ID:       %" B_PRId32 "\n", fTransactionID);
 	kprintf("  has subtransaction:   %d\n", fHasSubtransaction);
 	kprintf("  separate sub-trans.:  %d\n", fSeparateSubTransactions);
+	kprintf("  flushes started:      %" B_PRId32 "\n", fFlushesStarted);
 	kprintf("entries:\n");
 	kprintf("  address        id  start length\n");
 
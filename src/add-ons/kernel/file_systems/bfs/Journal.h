@@ -71,8 +71,10 @@ private:
 			Volume*			fVolume;
 			recursive_lock	fLock;
 			Transaction*	fOwner;
+			int32			fWaitingOwners;
 			uint32			fLogSize;
 			uint32			fMaxTransactionSize;
+			uint32			fMaxGroupSize;
 			uint32			fUsed;
 			int32			fUnwrittenTransactions;
 			mutex			fEntriesLock;
@@ -84,6 +86,10 @@ private:
 
 			thread_id		fLogFlusher;
 			sem_id			fLogFlusherSem;
+
+			mutex			fFlushLock;
+			int32			fFlushesStarted;
+			status_t		fLastFlushStatus;
 };
 
 
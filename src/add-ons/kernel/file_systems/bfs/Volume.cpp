@@ -134,7 +134,8 @@ Volume::Volume(fs_volume* volume)
 	fDirtyCachedBlocks(0),
 	fFlags(0),
 	fCheckingThread(-1),
-	fCheckVisitor(NULL)
+	fCheckVisitor(NULL),
+	fMaintenanceRunning(0)
 {
 	mutex_init(&fLock, "bfs volume");
 	mutex_init(&fQueryLock, "bfs queries");
@@ -200,6 +201,13 @@ Volume::Mount(const char* deviceName, uint32 flags)
 		return B_BAD_VALUE;
 	}
 
+	if ((fSuperBlock.Features() & ~SUPER_BLOCK_KNOWN_FEATURES) != 0) {
+		// we would not keep the parts of the format intact that we don't know
+		INFORM(("bfs: volume uses unknown features (%#" B_PRIx32 "), mounting "
+			"read-only.\n", fSuperBlock.Features()));
+		fFlags |= VOLUME_READ_ONLY;
+	}
+
 	// initialize short hands to the superblock (to save byte swapping)
 	fBlockSize = fSuperBlock.BlockSize();
 	fBlockShift = fSuperBlock.BlockShift();
@@ -481,12 +489,15 @@ Volume::RemoveQuery(Query* query)
 status_t
 Volume::CreateCheckVisitor()
 {
-	if (fCheckVisitor != NULL)
-		return B_BUSY;
+	status_t status = StartMaintenance();
+	if (status != B_OK)
+		return status;
 
 	fCheckVisitor = new(std::nothrow) ::CheckVisitor(this);
-	if (fCheckVisitor == NULL)
+	if (fCheckVisitor == NULL) {
+		EndMaintenance();
 		return B_NO_MEMORY;
+	}
 
 	return B_OK;
 }
@@ -495,8 +506,33 @@ Volume::CreateCheckVisitor()
 void
 Volume::DeleteCheckVisitor()
 {
+	if (fCheckVisitor == NULL)
+		return;
+
 	delete fCheckVisitor;
 	fCheckVisitor = NULL;
+	EndMaintenance();
+}
+
+
+/*!	Reserves the volume for one of the operations that walk over the whole
+	file system and change its layout (checking, resizing, defragmenting).
+	Returns \c B_BUSY if another one of them is already running.
+*/
+status_t
+Volume::StartMaintenance()
+{
+	if (atomic_test_and_set(&fMaintenanceRunning, 1, 0) != 0)
+		return B_BUSY;
+
+	return B_OK;
+}
+
+
+void
+Volume::EndMaintenance()
+{
+	atomic_set(&fMaintenanceRunning, 0);
 }
 
 
@@ -580,6 +616,10 @@ Volume::Initialize(int fd, const char* name, uint32 blockSize,
 	// create valid superblock
 
 	fSuperBlock.Initialize(name, numBlocks, blockSize);
+	if ((flags & VOLUME_INLINE_DATA) != 0) {
+		fSuperBlock.features
+			|= HOST_ENDIAN_TO_BFS_INT32(SUPER_BLOCK_FEATURE_INLINE_DATA);
+	}
 
 	// initialize short hands to the superblock (to save byte swapping)
 	fBlockSize = fSuperBlock.BlockSize();
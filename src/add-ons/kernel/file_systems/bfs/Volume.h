@@ -24,6 +24,7 @@ enum volume_flags {
 
 enum volume_initialize_flags {
 	VOLUME_NO_INDICES	= 0x0001,
+	VOLUME_INLINE_DATA	= 0x0002,
 };
 
 typedef DoublyLinkedList<Inode> InodeList;
@@ -79,6 +80,9 @@ public:
 								{ return fSuperBlock.AllocationGroups(); }
 			uint32			AllocationGroupShift() const
 								{ return fAllocationGroupShift; }
+			bool			HasInlineData() const
+								{ return (fSuperBlock.Features()
+									& SUPER_BLOCK_FEATURE_INLINE_DATA) != 0; }
 			disk_super_block& SuperBlock() { return fSuperBlock; }
 
 			off_t			ToOffset(block_run run) const
@@ -122,6 +126,10 @@ public:
 			void			DeleteCheckVisitor();
 			::CheckVisitor*	CheckVisitor() { return fCheckVisitor; }
 
+			// checking, resizing, and defragmenting exclude each other
+			status_t		StartMaintenance();
+			void			EndMaintenance();
+
 			// cache access
 			status_t		WriteSuperBlock();
 			status_t		FlushDevice();
@@ -180,6 +188,7 @@ protected:
 			void*			fBlockCache;
 			thread_id		fCheckingThread;
 			::CheckVisitor*	fCheckVisitor;
+			int32			fMaintenanceRunning;
 
 			InodeList		fRemovedInodes;
 };
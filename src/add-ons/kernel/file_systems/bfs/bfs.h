@@ -76,7 +76,8 @@ struct disk_super_block {
 	int32		magic3;
 	inode_addr	root_dir;
 	inode_addr	indices;
-	int32		_reserved[8];
+	uint32		features;
+	int32		_reserved[7];
 	int32		pad_to_block[87];
 		// this also contains parts of the boot block
 
@@ -95,6 +96,7 @@ struct disk_super_block {
 	int32 AllocationGroupShift() const
 		{ return BFS_ENDIAN_TO_HOST_INT32(ag_shift); }
 	int32 Flags() const { return BFS_ENDIAN_TO_HOST_INT32(flags); }
+	uint32 Features() const { return BFS_ENDIAN_TO_HOST_INT32(features); }
 	off_t LogStart() const { return BFS_ENDIAN_TO_HOST_INT64(log_start); }
 	off_t LogEnd() const { return BFS_ENDIAN_TO_HOST_INT64(log_end); }
 
@@ -113,6 +115,11 @@ struct disk_super_block {
 #define SUPER_BLOCK_DISK_CLEAN		'CLEN'		/* CLEN */
 #define SUPER_BLOCK_DISK_DIRTY		'DIRT'		/* DIRT */
 
+// Features that extend the on-disk format; a volume that uses a feature the
+// implementation doesn't know about is only mounted read-only.
+#define SUPER_BLOCK_FEATURE_INLINE_DATA	0x00000001	// see INODE_INLINE_DATA
+#define SUPER_BLOCK_KNOWN_FEATURES		SUPER_BLOCK_FEATURE_INLINE_DATA
+
 //**************************************
 
 #define NUM_DIRECT_BLOCKS			12
@@ -136,6 +143,10 @@ struct data_stream {
 		{ return BFS_ENDIAN_TO_HOST_INT64(size); }
 } _PACKED;
 
+// Files with INODE_INLINE_DATA keep up to this many bytes in the place of
+// their data_stream; only the size remains valid.
+#define INODE_INLINE_DATA_LENGTH	(sizeof(data_stream) - sizeof(int64))
+
 // This defines the size of the indirect and double indirect
 // blocks.
 #define NUM_ARRAY_BLOCKS			4
@@ -211,6 +222,7 @@ struct bfs_inode {
 	union {
 		data_stream		data;
 		char 			short_symlink[SHORT_SYMLINK_NAME_LENGTH];
+		uint8			inline_data[INODE_INLINE_DATA_LENGTH];
 	};
 	bigtime_t	status_change_time;
 	int32		pad[2];
@@ -266,9 +278,11 @@ enum inode_flags {
 	INODE_DELETED			= 0x00000010,
 	INODE_NOT_READY			= 0x00000020,	// used during Inode construction
 	INODE_LONG_SYMLINK		= 0x00000040,	// symlink in data stream
+	INODE_INLINE_DATA		= 0x00000080,	// file data in the inode
 
 	INODE_PERMANENT_FLAGS	= 0x0000ffff,
 
+	INODE_INLINE_DATA_CHANGED = 0x00010000,	// not yet written back
 	INODE_WAS_WRITTEN		= 0x00020000,
 	INODE_IN_TRANSACTION	= 0x00040000,
 
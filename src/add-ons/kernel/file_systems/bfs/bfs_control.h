@@ -104,4 +104,27 @@ struct check_control {
 #define BFS_IOCTL_RESIZE		14205
 
 
+/* Relocates the data of fragmented files into contiguous free space while
+ * the volume is mounted. The parameter is a struct defragment_control; all
+ * fields except "delay" must be set to zero, and magic must be set.
+ */
+#define BFS_IOCTL_DEFRAGMENT	14206
+
+struct defragment_control {
+	uint32		magic;
+	bigtime_t	delay;
+		/* time to wait after each relocated file, to throttle the I/O */
+	struct {
+		uint64	inodes;
+		uint64	fragmented;
+		uint64	relocated;
+		uint64	blocks_moved;
+	} stats;
+	status_t	status;
+};
+
+/* defragment control magic value */
+#define BFS_IOCTL_DEFRAGMENT_MAGIC	'BDfr'
+
+
 #endif	/* BFS_CONTROL_H */
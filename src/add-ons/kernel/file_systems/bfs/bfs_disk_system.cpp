@@ -22,6 +22,8 @@ parse_initialize_parameters(const char* parameterString,
 
 	if (get_driver_boolean_parameter(handle, "noindex", false, true))
 		parameters.flags |= VOLUME_NO_INDICES;
+	if (get_driver_boolean_parameter(handle, "inline_data", false, true))
+		parameters.flags |= VOLUME_INLINE_DATA;
 	if (get_driver_boolean_parameter(handle, "verbose", false, true))
 		parameters.verbose = true;
 
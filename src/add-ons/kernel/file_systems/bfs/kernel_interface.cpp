@@ -10,6 +10,7 @@
 #include "Attribute.h"
 #include "CheckVisitor.h"
 #include "Debug.h"
+#include "DefragmentVisitor.h"
 #include "Volume.h"
 #include "Inode.h"
 #include "Index.h"
@@ -354,6 +355,19 @@ bfs_put_vnode(fs_volume* _volume, fs_vnode* _node, bool reenter)
 		}
 	}
 
+	// a mapped write to inline data might not have been synced yet
+	if (!volume->IsReadOnly()
+		&& (inode->Flags() & INODE_INLINE_DATA_CHANGED) != 0) {
+		Transaction transaction(volume, inode->BlockNumber());
+
+		if (inode->WriteBack(transaction) == B_OK)
+			transaction.Done();
+		else if (transaction.HasParent()) {
+			// TODO: for now, we don't let sub-transactions fail
+			transaction.Done();
+		}
+	}
+
 	delete inode;
 	return B_OK;
 }
@@ -420,6 +434,18 @@ bfs_read_pages(fs_volume* _volume, fs_vnode* _node, void* _cookie,
 
 	InodeReadLocker _(inode);
 
+	if (inode->HasInlineData()) {
+		size_t bytesLeft = *_numBytes;
+		for (size_t i = 0; i < count && bytesLeft > 0; i++) {
+			size_t bytes = min_c(vecs[i].iov_len, bytesLeft);
+			inode->ReadInlineData(pos, (uint8*)vecs[i].iov_base, bytes);
+			pos += bytes;
+			bytesLeft -= bytes;
+		}
+		*_numBytes -= bytesLeft;
+		return B_OK;
+	}
+
 	uint32 vecIndex = 0;
 	size_t vecOffset = 0;
 	size_t bytesLeft = *_numBytes;
@@ -463,6 +489,24 @@ bfs_write_pages(fs_volume* _volume, fs_vnode* _node, void* _cookie,
 	if (inode->FileCache() == NULL)
 		RETURN_ERROR(B_BAD_VALUE);
 
+	if (inode->HasInlineData()) {
+		WriteLocker locker(inode->Lock());
+
+		// the file might have been moved to a stream in the mean time
+		if (inode->HasInlineData()) {
+			size_t bytesLeft = *_numBytes;
+			for (size_t i = 0; i < count && bytesLeft > 0; i++) {
+				size_t bytes = min_c(vecs[i].iov_len, bytesLeft);
+				inode->WriteInlineData(pos, (const uint8*)vecs[i].iov_base,
+					bytes);
+				pos += bytes;
+				bytesLeft -= bytes;
+			}
+			*_numBytes -= bytesLeft;
+			return B_OK;
+		}
+	}
+
 	InodeReadLocker _(inode);
 
 	uint32 vecIndex = 0;
@@ -520,6 +564,51 @@ bfs_io(fs_volume* _volume, fs_vnode* _node, void* _cookie, io_request* request)
 		RETURN_ERROR(B_BAD_VALUE);
 	}
 
+#ifndef FS_SHELL
+	if (inode->HasInlineData()) {
+		bool isWrite = io_request_is_write(request);
+		if (isWrite)
+			rw_lock_write_lock(&inode->Lock());
+		else
+			rw_lock_read_lock(&inode->Lock());
+
+		// the file might have been moved to a stream in the mean time
+		if (inode->HasInlineData()) {
+			off_t offset = io_request_offset(request);
+			off_t length = io_request_length(request);
+			uint8 buffer[INODE_INLINE_DATA_LENGTH];
+			status_t status = B_OK;
+
+			while (length > 0 && status == B_OK) {
+				size_t bytes = min_c(length, (off_t)sizeof(buffer));
+				if (isWrite) {
+					status = read_from_io_request(request, buffer, bytes);
+					if (status == B_OK)
+						inode->WriteInlineData(offset, buffer, bytes);
+				} else {
+					inode->ReadInlineData(offset, buffer, bytes);
+					status = write_to_io_request(request, buffer, bytes);
+				}
+				offset += bytes;
+				length -= bytes;
+			}
+
+			if (isWrite)
+				rw_lock_write_unlock(&inode->Lock());
+			else
+				rw_lock_read_unlock(&inode->Lock());
+
+			notify_io_request(request, status);
+			return status;
+		}
+
+		if (isWrite)
+			rw_lock_write_unlock(&inode->Lock());
+		else
+			rw_lock_read_unlock(&inode->Lock());
+	}
+#endif
+
 	// We lock the node here and will unlock it in the "finished" hook.
 	rw_lock_read_lock(&inode->Lock());
 
@@ -541,6 +630,10 @@ bfs_get_file_map(fs_volume* _volume, fs_vnode* _node, off_t offset, size_t size,
 	Volume* volume = (Volume*)_volume->private_volume;
 	Inode* inode = (Inode*)_node->private_node;
 
+	// inline data has no place on the device to map
+	if (inode->HasInlineData())
+		return B_BAD_VALUE;
+
 	int32 blockShift = volume->BlockShift();
 	uint32 index = 0, max = *_count;
 	block_run run;
@@ -790,8 +883,46 @@ bfs_ioctl(fs_volume* _volume, fs_vnode* _node, void* _cookie, uint32 cmd,
 			if (user_memcpy((uint8*)&size, buffer, sizeof(uint64)) != B_OK)
 				return B_BAD_ADDRESS;
 
+			status_t status = volume->StartMaintenance();
+			if (status != B_OK)
+				return status;
+
 			ResizeVisitor resizer(volume);
-			return resizer.Resize(size, -1);
+			status = resizer.Resize(size, -1);
+
+			volume->EndMaintenance();
+			return status;
+		}
+		case BFS_IOCTL_DEFRAGMENT:
+		{
+			// only root users are allowed to move the data of all files
+			if (geteuid() != 0)
+				return B_NOT_ALLOWED;
+			if (bufferLength != sizeof(defragment_control))
+				return B_BAD_VALUE;
+
+			defragment_control control;
+			if (user_memcpy(&control, buffer, sizeof(defragment_control))
+					!= B_OK) {
+				return B_BAD_ADDRESS;
+			}
+
+			status_t status = volume->StartMaintenance();
+			if (status != B_OK)
+				return status;
+
+			DefragmentVisitor defragmenter(volume);
+			status = defragmenter.Defragment(control);
+
+			volume->EndMaintenance();
+
+			// the statistics are also of interest if we had to stop early
+			if (user_memcpy(buffer, &control, sizeof(defragment_control))
+					!= B_OK && status == B_OK) {
+				status = B_BAD_ADDRESS;
+			}
+
+			return status;
 		}
 
 #ifdef DEBUG_FRAGMENTER
@@ -23,6 +23,7 @@
 
 #include "AttributeCookie.h"
 #include "AttributeDirectoryCookie.h"
+#include "CachedDataReader.h"
 #include "DebugSupport.h"
 #include "Directory.h"
 #include "Query.h"
@@ -1160,9 +1161,19 @@ packagefs_std_ops(int32 op, ...)
 				create_object_cache("pkgfs TKAVLTreeNodes",
 					sizeof(TwoKeyAVLTreeNode<void*>), CACHE_NO_DEPOT);
 
+			error = CachedDataReader::GlobalInit();
+			if (error != B_OK) {
+				ERROR("Failed to init CachedDataReader\n");
+				StringConstants::Cleanup();
+				StringPool::Cleanup();
+				exit_debugging();
+				return error;
+			}
+
 			error = PackageFSRoot::GlobalInit();
 			if (error != B_OK) {
 				ERROR("Failed to init PackageFSRoot\n");
+				CachedDataReader::GlobalUninit();
 				StringConstants::Cleanup();
 				StringPool::Cleanup();
 				exit_debugging();
@@ -1176,6 +1187,7 @@ packagefs_std_ops(int32 op, ...)
 		{
 			PRINT("package_std_ops(): B_MODULE_UNINIT\n");
 			PackageFSRoot::GlobalUninit();
+			CachedDataReader::GlobalUninit();
 			delete_object_cache(TwoKeyAVLTreeNode<void*>::sNodeCache);
 			object_cache_free((object_cache*)
 				PackageFileHeapAccessorBase::sQuadChunkCache,
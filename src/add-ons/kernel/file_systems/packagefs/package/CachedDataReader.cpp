@@ -7,9 +7,12 @@
 #include "CachedDataReader.h"
 
 #include <algorithm>
+#include <new>
 
 #include <DataIO.h>
 
+#include <debug.h>
+#include <low_resource_manager.h>
 #include <util/AutoLock.h>
 #include <vm/VMCache.h>
 #include <vm/vm_page.h>
@@ -20,6 +23,21 @@
 using BPackageKit::BHPKG::BBufferDataReader;
 
 
+// minimum number of pages all readers together may keep cached
+static const size_t kMinCachedPages = 1024;
+
+
+mutex CachedDataReader::sCachedLinesLock;
+CachedDataReader::CachedLineList* CachedDataReader::sProbationaryLines;
+CachedDataReader::CachedLineList* CachedDataReader::sProtectedLines;
+size_t CachedDataReader::sCachedPages;
+size_t CachedDataReader::sProtectedPages;
+size_t CachedDataReader::sMaxCachedPages;
+int64 CachedDataReader::sHits;
+int64 CachedDataReader::sMisses;
+int64 CachedDataReader::sEvictions;
+
+
 static inline bool
 page_physical_number_less(const vm_page* a, const vm_page* b)
 {
@@ -82,7 +100,8 @@ CachedDataReader::CachedDataReader()
 	:
 	fReader(NULL),
 	fCache(NULL),
-	fCacheLineLockers()
+	fCacheLineLockers(),
+	fCachedLines()
 {
 	mutex_init(&fLock, "packagefs cached reader");
 }
@@ -90,6 +109,21 @@ CachedDataReader::CachedDataReader()
 
 CachedDataReader::~CachedDataReader()
 {
+	MutexLocker linesLocker(sCachedLinesLock);
+	CachedLine* line = fCachedLines.Clear(true);
+	while (line != NULL) {
+		CachedLine* next = line->hashNext;
+		if (line->isProtected) {
+			sProtectedLines->Remove(line);
+			sProtectedPages -= line->pageCount;
+		} else
+			sProbationaryLines->Remove(line);
+		sCachedPages -= line->pageCount;
+		delete line;
+		line = next;
+	}
+	linesLocker.Unlock();
+
 	if (fCache != NULL) {
 		fCache->Lock();
 		fCache->ReleaseRefAndUnlock();
@@ -108,6 +142,10 @@ CachedDataReader::Init(BAbstractBufferedDataReader* reader, off_t size)
 	if (error != B_OK)
 		RETURN_ERROR(error);
 
+	error = fCachedLines.Init();
+	if (error != B_OK)
+		RETURN_ERROR(error);
+
 	error = VMCacheFactory::CreateNullCache(VM_PRIORITY_SYSTEM,
 		fCache);
 	if (error != B_OK)
@@ -154,6 +192,55 @@ CachedDataReader::ReadDataToOutput(off_t offset, size_t size,
 }
 
 
+/*static*/ status_t
+CachedDataReader::GlobalInit()
+{
+	sProbationaryLines = new(std::nothrow) CachedLineList;
+	sProtectedLines = new(std::nothrow) CachedLineList;
+	if (sProbationaryLines == NULL || sProtectedLines == NULL) {
+		delete sProbationaryLines;
+		delete sProtectedLines;
+		return B_NO_MEMORY;
+	}
+
+	mutex_init(&sCachedLinesLock, "packagefs cached lines");
+
+	sCachedPages = 0;
+	sProtectedPages = 0;
+	sMaxCachedPages = std::max((size_t)vm_page_num_pages() / 8,
+		kMinCachedPages);
+	sHits = 0;
+	sMisses = 0;
+	sEvictions = 0;
+
+	register_low_resource_handler(&_LowMemoryHandler, NULL,
+		B_KERNEL_RESOURCE_PAGES | B_KERNEL_RESOURCE_MEMORY, 0);
+
+	add_debugger_command_etc("packagefs_cache", &_DumpStatistics,
+		"Print statistics of the packagefs data cache",
+		"\n"
+		"Prints the number of pages cached by packagefs and the hit, miss,\n"
+		"and eviction counts of its data cache.\n", 0);
+
+	return B_OK;
+}
+
+
+/*static*/ void
+CachedDataReader::GlobalUninit()
+{
+	remove_debugger_command("packagefs_cache", &_DumpStatistics);
+	unregister_low_resource_handler(&_LowMemoryHandler, NULL);
+
+	mutex_destroy(&sCachedLinesLock);
+
+	delete sProbationaryLines;
+	delete sProtectedLines;
+	sProbationaryLines = NULL;
+	sProtectedLines = NULL;
+}
+
+
 status_t
 CachedDataReader::_ReadCacheLine(off_t lineOffset, size_t lineSize,
 	off_t requestOffset, size_t requestLength, BDataIO* output)
@@ -209,6 +296,11 @@ CachedDataReader::_ReadCacheLine(off_t lineOffset, size_t lineSize,
 
 	cacheLocker.Unlock();
 
+	if (missingPages == 0)
+		atomic_add64(&sHits, 1);
+	else
+		atomic_add64(&sMisses, 1);
+
 	if (missingPages > 0) {
 // TODO: If the missing pages range doesn't intersect with the request, just
 // satisfy the request and don't read anything at all.
@@ -279,6 +371,7 @@ CachedDataReader::_ReadCacheLine(off_t lineOffset, size_t lineSize,
 	status_t error = _WritePages(pages, requestOffset - lineOffset,
 		requestLength, output);
 	_CachePages(pages, 0, linePageCount);
+	_TouchCachedLine(lineOffset, linePageCount);
 	return error;
 }
 
@@ -441,3 +534,172 @@ CachedDataReader::_UnlockCacheLine(CacheLineLocker* lineLocker)
 		nextLineLocker->WakeUp();
 	}
 }
+
+
+/*!	Records an access to the cache line at \a lineOffset, whose pages have
+	just been marked cached. A line that is not yet known enters the
+	probationary list, a known line is moved to the end of the protected list.
+	If that makes the cache exceed its budget, the least recently used lines
+	are evicted.
+	\c fCache must not be locked.
+*/
+void
+CachedDataReader::_TouchCachedLine(off_t lineOffset, uint32 pageCount)
+{
+	MutexLocker locker(sCachedLinesLock);
+
+	CachedLine* line = fCachedLines.Lookup(lineOffset);
+	if (line != NULL) {
+		if (line->isProtected) {
+			sProtectedLines->Remove(line);
+		} else {
+			sProbationaryLines->Remove(line);
+			line->isProtected = true;
+			sProtectedPages += line->pageCount;
+		}
+		sProtectedLines->Add(line);
+
+		// Don't let the protected lines take up more than three quarters of
+		// the budget. The excess goes back to the probationary list.
+		while (sProtectedPages > sMaxCachedPages / 4 * 3) {
+			CachedLine* oldest = sProtectedLines->RemoveHead();
+			oldest->isProtected = false;
+			sProtectedPages -= oldest->pageCount;
+			sProbationaryLines->Add(oldest);
+		}
+		return;
+	}
+
+	// If we fail to allocate the line, the pages simply stay cached until the
+	// page daemon reclaims them.
+	line = new(std::nothrow) CachedLine;
+	if (line == NULL)
+		return;
+
+	line->reader = this;
+	line->offset = lineOffset;
+	line->pageCount = pageCount;
+	line->isProtected = false;
+
+	if (fCachedLines.Insert(line) != B_OK) {
+		delete line;
+		return;
+	}
+
+	sProbationaryLines->Add(line);
+	sCachedPages += pageCount;
+
+	if (sCachedPages > sMaxCachedPages)
+		_EvictCachedLines(sCachedPages - sMaxCachedPages);
+}
+
+
+/*!	Removes \a line from its reader and the LRU lists, without freeing its
+	pages.
+	\c sCachedLinesLock must be held.
+*/
+/*static*/ void
+CachedDataReader::_RemoveCachedLine(CachedLine* line)
+{
+	if (line->isProtected) {
+		sProtectedLines->Remove(line);
+		sProtectedPages -= line->pageCount;
+	} else
+		sProbationaryLines->Remove(line);
+
+	sCachedPages -= line->pageCount;
+	line->reader->fCachedLines.RemoveUnchecked(line);
+}
+
+
+/*!	Removes \a line and frees those of its pages that are still cached.
+	Pages currently in use by a read of the line are left alone; the read will
+	add the line again when it is done.
+	\c sCachedLinesLock must be held.
+*/
+/*static*/ void
+CachedDataReader::_EvictCachedLine(CachedLine* line)
+{
+	_RemoveCachedLine(line);
+
+	VMCache* cache = line->reader->fCache;
+	AutoLocker<VMCache> cacheLocker(cache);
+
+	for (uint32 i = 0; i < line->pageCount; i++) {
+		vm_page* page = cache->LookupPage(
+			line->offset + (off_t)i * B_PAGE_SIZE);
+		if (page == NULL || page->busy
+			|| page->State() != PAGE_STATE_CACHED) {
+			continue;
+		}
+
+		DEBUG_PAGE_ACCESS_START(page);
+		cache->RemovePage(page);
+		vm_page_free(NULL, page);
+	}
+
+	cacheLocker.Unlock();
+
+	sEvictions++;
+	delete line;
+}
+
+
+/*!	Evicts least recently used lines until at least \a pageCount pages have
+	been released or no lines are left. Probationary lines go first.
+	\c sCachedLinesLock must be held.
+*/
+/*static*/ void
+CachedDataReader::_EvictCachedLines(size_t pageCount)
+{
+	size_t evicted = 0;
+	while (evicted < pageCount) {
+		CachedLine* line = sProbationaryLines->Head();
+		if (line == NULL)
+			line = sProtectedLines->Head();
+		if (line == NULL)
+			break;
+
+		evicted += line->pageCount;
+		_EvictCachedLine(line);
+	}
+}
+
+
+/*static*/ void
+CachedDataReader::_LowMemoryHandler(void* data, uint32 resources,
+	int32 level)
+{
+	MutexLocker locker(sCachedLinesLock);
+
+	size_t pageCount;
+	switch (level) {
+		case B_NO_LOW_RESOURCE:
+			return;
+		case B_LOW_RESOURCE_NOTE:
+			pageCount = sCachedPages / 4;
+			break;
+		case B_LOW_RESOURCE_WARNING:
+			pageCount = sCachedPages / 2;
+			break;
+		case B_LOW_RESOURCE_CRITICAL:
+		default:
+			pageCount = sCachedPages;
+			break;
+	}
+
+	_EvictCachedLines(pageCount);
+}
+
+
+/*static*/ int
+CachedDataReader::_DumpStatistics(int argc, char** argv)
+{
+	kprintf("cached pages:    %" B_PRIuSIZE " (max %" B_PRIuSIZE ")\n",
+		sCachedPages, sMaxCachedPages);
+	kprintf("protected pages: %" B_PRIuSIZE "\n", sProtectedPages);
+	kprintf("hits:            %" B_PRId64 "\n", sHits);
+	kprintf("misses:          %" B_PRId64 "\n", sMisses);
+	kprintf("evictions:       %" B_PRId64 "\n", sEvictions);
+	return 0;
+}
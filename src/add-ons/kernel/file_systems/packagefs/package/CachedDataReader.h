@@ -29,6 +29,9 @@ public:
 	virtual	status_t			ReadDataToOutput(off_t offset, size_t size,
 									BDataIO* output);
 
+	static	status_t			GlobalInit();
+	static	void				GlobalUninit();
+
 private:
 			class CacheLineLocker
 				: public DoublyLinkedListLinkImpl<CacheLineLocker> {
@@ -113,6 +116,47 @@ private:
 
 			typedef BOpenHashTable<LockerHashDefinition> LockerTable;
 
+			// A cache line whose pages are in the cache. All cached lines of
+			// all readers share a global page budget and a segmented LRU:
+			// lines enter the probationary list and are only moved to the
+			// protected list when they are hit again, so that a single pass
+			// over a large file cannot push out the frequently used lines.
+			struct CachedLine : DoublyLinkedListLinkImpl<CachedLine> {
+				CachedDataReader*	reader;
+				off_t				offset;
+				CachedLine*			hashNext;
+				uint32				pageCount;
+				bool				isProtected;
+			};
+
+			struct CachedLineHashDefinition {
+				typedef off_t		KeyType;
+				typedef	CachedLine	ValueType;
+
+				size_t HashKey(off_t key) const
+				{
+					return size_t(key / kCacheLineSize);
+				}
+
+				size_t Hash(const CachedLine* value) const
+				{
+					return HashKey(value->offset);
+				}
+
+				bool Compare(off_t key, const CachedLine* value) const
+				{
+					return value->offset == key;
+				}
+
+				CachedLine*& GetLink(CachedLine* value) const
+				{
+					return value->hashNext;
+				}
+			};
+
+			typedef BOpenHashTable<CachedLineHashDefinition> CachedLineTable;
+			typedef DoublyLinkedList<CachedLine> CachedLineList;
+
 			struct PagesDataOutput;
 
 private:
@@ -133,6 +177,16 @@ private:
 			void				_LockCacheLine(CacheLineLocker* lineLocker);
 			void				_UnlockCacheLine(CacheLineLocker* lineLocker);
 
+			void				_TouchCachedLine(off_t lineOffset,
+									uint32 pageCount);
+
+	static	void				_RemoveCachedLine(CachedLine* line);
+	static	void				_EvictCachedLine(CachedLine* line);
+	static	void				_EvictCachedLines(size_t pageCount);
+	static	void				_LowMemoryHandler(void* data,
+									uint32 resources, int32 level);
+	static	int					_DumpStatistics(int argc, char** argv);
+
 private:
 			static const size_t kCacheLineSize = 64 * 1024;
 			static const size_t kPagesPerCacheLine
@@ -143,6 +197,17 @@ private:
 			BAbstractBufferedDataReader* fReader;
 			VMCache*			fCache;
 			LockerTable			fCacheLineLockers;
+			CachedLineTable		fCachedLines;
+
+	static	mutex				sCachedLinesLock;
+	static	CachedLineList*		sProbationaryLines;
+	static	CachedLineList*		sProtectedLines;
+	static	size_t				sCachedPages;
+	static	size_t				sProtectedPages;
+	static	size_t				sMaxCachedPages;
+	static	int64				sHits;
+	static	int64				sMisses;
+	static	int64				sEvictions;
 };
 
 
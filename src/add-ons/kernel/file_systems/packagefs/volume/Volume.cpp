@@ -26,6 +26,7 @@
 #include <AutoDeleterDrivers.h>
 #include <PackagesDirectoryDefs.h>
 
+#include <smp.h>
 #include <vfs.h>
 
 #include "AttributeIndex.h"
@@ -63,6 +64,9 @@ const size_t kMaxActivationRequestSize = 10 * 1024 * 1024;
 // sanity limit for activation file size
 const size_t kMaxActivationFileSize = 10 * 1024 * 1024;
 
+// maximum number of threads loading packages concurrently
+static const int32 kMaxPackageLoaderThreads = 8;
+
 static const char* const kAdministrativeDirectoryName
 	= PACKAGES_DIRECTORY_ADMIN_DIRECTORY;
 static const char* const kActivationFileName
@@ -161,6 +165,48 @@ private:
 };
 
 
+// #pragma mark - PackageLoader
+
+
+struct Volume::PackageLoader {
+	PackageLoader(Volume* volume, PackagesDirectory* packagesDirectory,
+		const char* const* names, int32 count, Package** packages,
+		status_t* errors)
+		:
+		fVolume(volume),
+		fPackagesDirectory(packagesDirectory),
+		fNames(names),
+		fPackages(packages),
+		fErrors(errors),
+		fCount(count),
+		fNextIndex(0)
+	{
+	}
+
+	void Run()
+	{
+		while (true) {
+			int32 index = atomic_add(&fNextIndex, 1);
+			if (index >= fCount)
+				break;
+
+			fPackages[index] = NULL;
+			fErrors[index] = fVolume->_LoadPackage(fPackagesDirectory,
+				fNames[index], fPackages[index]);
+		}
+	}
+
+private:
+	Volume*				fVolume;
+	PackagesDirectory*	fPackagesDirectory;
+	const char* const*	fNames;
+	Package**			fPackages;
+	status_t*			fErrors;
+	int32				fCount;
+	int32				fNextIndex;
+};
+
+
 // #pragma mark - Volume
 
 
@@ -865,7 +911,20 @@ Volume::_AddInitialPackagesFromActivationFile(
 	// null-terminate to simplify parsing
 	fileContent[st.st_size] = '\0';
 
-	// parse the file and add the respective packages
+	// every line contains at most one package name
+	int32 maxPackageCount = 1;
+	for (off_t i = 0; i < st.st_size; i++) {
+		if (fileContent[i] == '\n')
+			maxPackageCount++;
+	}
+
+	const char** packageNames = new(std::nothrow) const char*[maxPackageCount];
+	if (packageNames == NULL)
+		RETURN_ERROR(B_NO_MEMORY);
+	ArrayDeleter<const char*> packageNamesDeleter(packageNames);
+
+	// parse the file and collect the package names
+	int32 packageCount = 0;
 	const char* packageName = fileContent;
 	char* const fileContentEnd = fileContent + st.st_size;
 	while (packageName < fileContentEnd) {
@@ -885,15 +944,12 @@ Volume::_AddInitialPackagesFromActivationFile(
 			RETURN_ERROR(B_BAD_DATA);
 		}
 
-		status_t error = _LoadAndAddInitialPackage(packagesDirectory,
-			packageName);
-		if (error != B_OK)
-			RETURN_ERROR(error);
-
+		packageNames[packageCount++] = packageName;
 		packageName = packageNameEnd + 1;
 	}
 
-	return B_OK;
+	return _LoadAndAddInitialPackages(packagesDirectory, packageNames,
+		packageCount, false);
 }
 
 
@@ -914,6 +970,13 @@ Volume::_AddInitialPackagesFromDirectory()
 		RETURN_ERROR(errno);
 	}
 
+	// collect the names of all packages, so that we can load them in parallel
+	char* names = NULL;
+	size_t namesSize = 0;
+	size_t namesCapacity = 0;
+	int32 packageCount = 0;
+	MemoryDeleter namesDeleter;
+
 	while (dirent* entry = readdir(dir.Get())) {
 		// skip "." and ".."
 		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
@@ -926,28 +989,82 @@ Volume::_AddInitialPackagesFromDirectory()
 			continue;
 		}
 
-		_LoadAndAddInitialPackage(fPackagesDirectory, entry->d_name);
+		if (namesSize + nameLength + 1 > namesCapacity) {
+			size_t capacity = max_c(namesCapacity * 2, 4096);
+			char* newNames = (char*)realloc(names, capacity);
+			if (newNames == NULL)
+				RETURN_ERROR(B_NO_MEMORY);
+
+			namesDeleter.Detach();
+			namesDeleter.SetTo(newNames);
+			names = newNames;
+			namesCapacity = capacity;
+		}
+
+		memcpy(names + namesSize, entry->d_name, nameLength + 1);
+		namesSize += nameLength + 1;
+		packageCount++;
 	}
 
-	return B_OK;
+	const char** packageNames = new(std::nothrow) const char*[packageCount];
+	if (packageNames == NULL)
+		RETURN_ERROR(B_NO_MEMORY);
+	ArrayDeleter<const char*> packageNamesDeleter(packageNames);
+
+	const char* name = names;
+	for (int32 i = 0; i < packageCount; i++) {
+		packageNames[i] = name;
+		name += strlen(name) + 1;
+	}
+
+	return _LoadAndAddInitialPackages(fPackagesDirectory, packageNames,
+		packageCount, true);
 }
 
 
+/*!	Loads the given packages, and adds them to the volume. If \a ignoreErrors
+	is \c false, the first package that fails to load will stop adding any
+	further packages, and its error is returned.
+*/
 status_t
-Volume::_LoadAndAddInitialPackage(PackagesDirectory* packagesDirectory,
-	const char* name)
+Volume::_LoadAndAddInitialPackages(PackagesDirectory* packagesDirectory,
+	const char* const* names, int32 count, bool ignoreErrors)
 {
-	Package* package;
-	status_t error = _LoadPackage(packagesDirectory, name, package);
-	if (error != B_OK) {
-		ERROR("Failed to load package \"%s\": %s\n", name, strerror(error));
-		RETURN_ERROR(error);
-	}
-	BReference<Package> packageReference(package, true);
+	if (count == 0)
+		return B_OK;
+
+	Package** packages = new(std::nothrow) Package*[count];
+	if (packages == NULL)
+		RETURN_ERROR(B_NO_MEMORY);
+	ArrayDeleter<Package*> packagesDeleter(packages);
+
+	status_t* errors = new(std::nothrow) status_t[count];
+	if (errors == NULL)
+		RETURN_ERROR(B_NO_MEMORY);
+	ArrayDeleter<status_t> errorsDeleter(errors);
+
+	_LoadPackages(packagesDirectory, names, count, packages, errors);
 
 	VolumeWriteLocker systemVolumeLocker(_SystemVolumeIfNotSelf());
 	VolumeWriteLocker volumeLocker(this);
-	_AddPackage(package);
+
+	status_t error = B_OK;
+	for (int32 i = 0; i < count; i++) {
+		if (errors[i] != B_OK) {
+			ERROR("Failed to load package \"%s\": %s\n", names[i],
+				strerror(errors[i]));
+			if (!ignoreErrors && error == B_OK)
+				error = errors[i];
+			continue;
+		}
+
+		BReference<Package> packageReference(packages[i], true);
+		if (error == B_OK)
+			_AddPackage(packages[i]);
+	}
+
+	if (error != B_OK)
+		RETURN_ERROR(error);
 
 	return B_OK;
 }
@@ -1547,6 +1664,51 @@ Volume::_LoadPackage(PackagesDirectory* packagesDirectory, const char* name,
 }
 
 
+/*!	Loads the given packages using a number of worker threads, as parsing the
+	package file TOCs is independent of each other, and of the volume state.
+	For each package, either a reference to the loaded package is returned in
+	\a packages, or the error in \a errors.
+*/
+void
+Volume::_LoadPackages(PackagesDirectory* packagesDirectory,
+	const char* const* names, int32 count, Package** packages,
+	status_t* errors)
+{
+	PackageLoader loader(this, packagesDirectory, names, count, packages,
+		errors);
+
+	// the calling thread works on the packages, too
+	int32 threadCount = min_c(min_c(smp_get_num_cpus(),
+		kMaxPackageLoaderThreads), count) - 1;
+
+	thread_id threads[kMaxPackageLoaderThreads];
+	int32 startedThreads = 0;
+	for (int32 i = 0; i < threadCount; i++) {
+		thread_id thread = spawn_kernel_thread(&_PackageLoaderThread,
+			"packagefs package loader", B_NORMAL_PRIORITY, &loader);
+		if (thread < 0)
+			break;
+
+		threads[startedThreads++] = thread;
+		resume_thread(thread);
+	}
+
+	loader.Run();
+
+	for (int32 i = 0; i < startedThreads; i++)
+		wait_for_thread(threads[i], NULL);
+}
+
+
+/*static*/ status_t
+Volume::_PackageLoaderThread(void* data)
+{
+	PackageLoader* loader = (PackageLoader*)data;
+	loader->Run();
+	return B_OK;
+}
+
+
 status_t
 Volume::_ChangeActivation(ActivationChangeRequest& request)
 {
@@ -1618,26 +1780,47 @@ Volume::_ChangeActivation(ActivationChangeRequest& request)
 			oldPackageReferences);
 
 	// load all new packages
+	const char** newPackageNames = new(std::nothrow) const char*[
+		newPackageCount];
+	Package** newPackages = new(std::nothrow) Package*[newPackageCount];
+	status_t* newPackageErrors = new(std::nothrow) status_t[newPackageCount];
+	ArrayDeleter<const char*> newPackageNamesDeleter(newPackageNames);
+	ArrayDeleter<Package*> newPackagesDeleter(newPackages);
+	ArrayDeleter<status_t> newPackageErrorsDeleter(newPackageErrors);
+	if (newPackageNames == NULL || newPackages == NULL
+		|| newPackageErrors == NULL) {
+		RETURN_ERROR(B_NO_MEMORY);
+	}
+
 	int32 newPackageIndex = 0;
 	for (uint32 i = 0; i < itemCount; i++) {
 		PackageFSActivationChangeItem* item = request.ItemAt(i);
 
-		if (item->type != PACKAGE_FS_ACTIVATE_PACKAGE
-			&& item->type != PACKAGE_FS_REACTIVATE_PACKAGE) {
-			continue;
+		if (item->type == PACKAGE_FS_ACTIVATE_PACKAGE
+			|| item->type == PACKAGE_FS_REACTIVATE_PACKAGE) {
+			newPackageNames[newPackageIndex++] = item->name;
 		}
+	}
 
-		Package* package;
-		status_t error = _LoadPackage(fPackagesDirectory, item->name, package);
-		if (error != B_OK) {
+	_LoadPackages(fPackagesDirectory, newPackageNames, newPackageCount,
+		newPackages, newPackageErrors);
+
+	status_t loadError = B_OK;
+	for (int32 i = 0; i < newPackageCount; i++) {
+		if (newPackageErrors[i] != B_OK) {
 			ERROR("Volume::_ChangeActivation(): failed to load package "
-				"\"%s\"\n", item->name);
-			RETURN_ERROR(error);
+				"\"%s\"\n", newPackageNames[i]);
+			if (loadError == B_OK)
+				loadError = newPackageErrors[i];
+			continue;
 		}
 
-		newPackageReferences[newPackageIndex++].SetTo(package, true);
+		newPackageReferences[i].SetTo(newPackages[i], true);
 	}
 
+	if (loadError != B_OK)
+		RETURN_ERROR(loadError);
+
 	// apply the changes
 	VolumeWriteLocker systemVolumeLocker(_SystemVolumeIfNotSelf());
 	VolumeWriteLocker volumeLocker(this);
@@ -109,6 +109,7 @@ private:
 private:
 			struct ShineThroughDirectory;
 			struct ActivationChangeRequest;
+			struct PackageLoader;
 
 private:
 			status_t			_LoadOldPackagesStates(
@@ -118,9 +119,10 @@ private:
 			status_t			_AddInitialPackagesFromActivationFile(
 									PackagesDirectory* packagesDirectory);
 			status_t			_AddInitialPackagesFromDirectory();
-			status_t			_LoadAndAddInitialPackage(
+			status_t			_LoadAndAddInitialPackages(
 									PackagesDirectory* packagesDirectory,
-									const char* name);
+									const char* const* names, int32 count,
+									bool ignoreErrors);
 
 	inline	void				_AddPackage(Package* package);
 	inline	void				_RemovePackage(Package* package);
@@ -156,6 +158,11 @@ private:
 			status_t			_LoadPackage(
 									PackagesDirectory* packagesDirectory,
 									const char* name, Package*& _package);
+			void				_LoadPackages(
+									PackagesDirectory* packagesDirectory,
+									const char* const* names, int32 count,
+									Package** packages, status_t* errors);
+	static	status_t			_PackageLoaderThread(void* data);
 
 			status_t			_ChangeActivation(
 									ActivationChangeRequest& request);
@@ -15,5 +15,7 @@ uint16 calculate_crc(uint16 crc, uint8 *data, uint16 length);
 
 uint32 calculate_crc32c(uint32 crc32c, const unsigned char *buffer,
 	unsigned int length);
+uint32 calculate_crc32c_generic(uint32 crc32c, const unsigned char *buffer,
+	unsigned int length);
 
 
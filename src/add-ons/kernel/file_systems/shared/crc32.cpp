@@ -53,6 +53,8 @@
 #include <stdint.h>
 uint32 calculate_crc32c(uint32 crc32c, const unsigned char *buffer,
 	unsigned int length);
+uint32 calculate_crc32c_generic(uint32 crc32c, const unsigned char *buffer,
+	unsigned int length);
 #endif
 
 #else
@@ -60,12 +62,17 @@ uint32 calculate_crc32c(uint32 crc32c, const unsigned char *buffer,
 #include "fssh_api_wrapper.h"
 #include "fssh_auto_deleter.h"
 #include "fssh_kernel_priv.h"
-#include "Debug.h"
 uint32 calculate_crc32c(uint32 crc32c, const unsigned char *buffer,
 	unsigned int length);
+uint32 calculate_crc32c_generic(uint32 crc32c, const unsigned char *buffer,
+	unsigned int length);
 
 #endif
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
 
 const uint32 crc32_tab[] = {
 	0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419, 0x706af48f,
@@ -762,7 +769,7 @@ multitable_crc32c(uint32 crc32c,
 }
 
 uint32
-calculate_crc32c(uint32 crc32c,
+calculate_crc32c_generic(uint32 crc32c,
     const unsigned char *buffer,
     unsigned int length)
 {
@@ -773,3 +780,76 @@ calculate_crc32c(uint32 crc32c,
 	}
 }
 
+
+#if (defined(__x86_64__) || defined(__i386__)) \
+	&& (__GNUC__ >= 5 || defined(__clang__))
+#	define HAVE_HARDWARE_CRC32C
+
+
+/*!	Uses the SSE4.2 crc32 instruction, which implements CRC32C. It only
+	operates on general purpose registers, so it is safe to use in the kernel
+	without saving any FPU state.
+*/
+__attribute__((target("sse4.2")))
+static uint32
+hardware_crc32c(uint32 crc, const unsigned char *buffer, unsigned int length)
+{
+	while (length > 0 && ((uintptr_t)buffer & 7) != 0) {
+		crc = __builtin_ia32_crc32qi(crc, *buffer++);
+		length--;
+	}
+
+#ifdef __x86_64__
+	uint64 crc64 = crc;
+	while (length >= 8) {
+		crc64 = __builtin_ia32_crc32di(crc64, *(const uint64 *)buffer);
+		buffer += 8;
+		length -= 8;
+	}
+	crc = (uint32)crc64;
+#endif
+
+	while (length >= 4) {
+		crc = __builtin_ia32_crc32si(crc, *(const uint32 *)buffer);
+		buffer += 4;
+		length -= 4;
+	}
+
+	while (length > 0) {
+		crc = __builtin_ia32_crc32qi(crc, *buffer++);
+		length--;
+	}
+
+	return crc;
+}
+
+
+static bool
+has_hardware_crc32c()
+{
+	static int sHasHardwareCRC32C = -1;
+	if (sHasHardwareCRC32C < 0) {
+		unsigned int eax, ebx, ecx, edx;
+		sHasHardwareCRC32C = __get_cpuid(1, &eax, &ebx, &ecx, &edx) != 0
+			&& (ecx & bit_SSE4_2) != 0;
+	}
+
+	return sHasHardwareCRC32C != 0;
+}
+
+#endif
+
+
+uint32
+calculate_crc32c(uint32 crc32c,
+    const unsigned char *buffer,
+    unsigned int length)
+{
+#ifdef HAVE_HARDWARE_CRC32C
+	if (has_hardware_crc32c())
+		return hardware_crc32c(crc32c, buffer, length);
+#endif
+
+	return calculate_crc32c_generic(crc32c, buffer, length);
+}
+
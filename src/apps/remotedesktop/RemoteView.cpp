@@ -6,6 +6,7 @@
  *		Michael Lotz <mmlr@mlotz.ch>
  */
 
+#include "BitmapTileCache.h"
 #include "NetReceiver.h"
 #include "NetSender.h"
 #include "RemoteMessage.h"
@@ -61,6 +62,7 @@ RemoteView::RemoteView(BRect frame, const char *remoteHost, uint16 remotePort)
 	fIsConnected(false),
 	fReceiveBuffer(NULL),
 	fSendBuffer(NULL),
+	fTileCache(NULL),
 	fEndpoint(NULL),
 	fReceiver(NULL),
 	fSender(NULL),
@@ -93,6 +95,17 @@ RemoteView::RemoteView(BRect frame, const char *remoteHost, uint16 remotePort)
 	if (fInitStatus != B_OK)
 		return;
 
+	fTileCache = new(std::nothrow) BitmapTileCache();
+	if (fTileCache == NULL) {
+		fInitStatus = B_NO_MEMORY;
+		TRACE_ERROR("no memory available\n");
+		return;
+	}
+
+	fInitStatus = fTileCache->InitCheck();
+	if (fInitStatus != B_OK)
+		return;
+
 	fEndpoint = new(std::nothrow) BNetEndpoint();
 	fEndpoint->SetReuseAddr();
 	if (fEndpoint == NULL) {
@@ -174,6 +187,8 @@ RemoteView::~RemoteView()
 
 	int32 result;
 	wait_for_thread(fDrawThread, &result);
+
+	delete fTileCache;
 }
 
 
@@ -426,6 +441,50 @@ RemoteView::_FindState(uint32 token)
 }
 
 
+/*!	Reads past the bitmaps of a drawing message that is not drawn, so that
+	the tiles sent along with them still end up in the tile cache. The
+	server assumes that the client has them from now on.
+*/
+void
+RemoteView::_DiscardBitmaps(uint16 code, RemoteMessage& message)
+{
+	switch (code) {
+		case RP_DRAW_BITMAP:
+		{
+			BRect bitmapRect, viewRect;
+			uint32 options;
+
+			message.Read(bitmapRect);
+			message.Read(viewRect);
+			message.Read(options);
+			message.ReadBitmap(NULL, false, B_RGB32, 0, fTileCache);
+			break;
+		}
+
+		case RP_DRAW_BITMAP_RECTS:
+		{
+			color_space colorSpace;
+			int32 rectCount;
+			uint32 flags, options;
+
+			message.Read(options);
+			message.Read(colorSpace);
+			message.Read(flags);
+			message.Read(rectCount);
+			for (int32 i = 0; i < rectCount; i++) {
+				BRect viewRect;
+				message.Read(viewRect);
+				if (message.ReadBitmap(NULL, true, colorSpace, flags,
+						fTileCache) != B_OK) {
+					break;
+				}
+			}
+			break;
+		}
+	}
+}
+
+
 int32
 RemoteView::_DrawEntry(void *data)
 {
@@ -611,6 +670,7 @@ RemoteView::_DrawThread()
 			state = _CreateState(token);
 			if (state == NULL) {
 				TRACE_ERROR("failed to create state for unknown token\n");
+				_DiscardBitmaps(code, message);
 				continue;
 			}
 		}
@@ -766,8 +826,10 @@ RemoteView::_DrawThread()
 				message.Read(bitmapRect);
 				message.Read(viewRect);
 				message.Read(options);
-				if (message.ReadBitmap(&bitmap) != B_OK || bitmap == NULL)
+				if (message.ReadBitmap(&bitmap, false, B_RGB32, 0,
+						fTileCache) != B_OK || bitmap == NULL) {
 					continue;
+				}
 
 				offscreen->DrawBitmap(bitmap, bitmapRect, viewRect, options);
 				invalidRegion.Include(viewRect);
@@ -791,7 +853,7 @@ RemoteView::_DrawThread()
 
 					message.Read(viewRect);
 					if (message.ReadBitmap(&bitmap, true, colorSpace,
-							flags) != B_OK || bitmap == NULL) {
+							flags, fTileCache) != B_OK || bitmap == NULL) {
 						continue;
 					}
 
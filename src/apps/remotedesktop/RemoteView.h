@@ -14,8 +14,10 @@
 #include <View.h>
 
 class BBitmap;
+class BitmapTileCache;
 class NetReceiver;
 class NetSender;
+class RemoteMessage;
 class StreamingRingBuffer;
 
 struct engine_state;
@@ -55,6 +57,9 @@ static	int							_StateCompareByKey(const uint32 *key,
 		void						_DeleteState(uint32 token);
 		engine_state *				_FindState(uint32 token);
 
+		void						_DiscardBitmaps(uint16 code,
+										RemoteMessage& message);
+
 static	int32						_DrawEntry(void *data);
 		void						_DrawThread();
 
@@ -66,6 +71,7 @@ static	int32						_DrawEntry(void *data);
 
 		StreamingRingBuffer *		fReceiveBuffer;
 		StreamingRingBuffer *		fSendBuffer;
+		BitmapTileCache *			fTileCache;
 		BNetEndpoint *				fEndpoint;
 		NetReceiver *				fReceiver;
 		NetSender *					fSender;
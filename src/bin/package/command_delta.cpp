@@ -0,0 +1,124 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <File.h>
+
+#include <package/hpkg/StandardErrorOutput.h>
+
+#include <package/hpkg/DeltaPackageWriter.h>
+
+#include "package.h"
+
+
+using BPackageKit::BHPKG::BStandardErrorOutput;
+using BPackageKit::BHPKG::BPrivate::DeltaPackageWriter;
+
+
+int
+command_delta(int argc, const char* const* argv)
+{
+	bool quiet = false;
+	bool verbose = false;
+
+	while (true) {
+		static struct option sLongOptions[] = {
+			{ "help", no_argument, 0, 'h' },
+			{ "quiet", no_argument, 0, 'q' },
+			{ "verbose", no_argument, 0, 'v' },
+			{ 0, 0, 0, 0 }
+		};
+
+		opterr = 0; // don't print errors
+		int c = getopt_long(argc, (char**)argv, "+hqv", sLongOptions, NULL);
+		if (c == -1)
+			break;
+
+		switch (c) {
+			case 'h':
+				print_usage_and_exit(false);
+				break;
+
+			case 'q':
+				quiet = true;
+				break;
+
+			case 'v':
+				verbose = true;
+				break;
+
+			default:
+				print_usage_and_exit(true);
+				break;
+		}
+	}
+
+	// The remaining arguments are the old and new package files and the
+	// delta file, i.e. three more arguments.
+	if (argc - optind != 3)
+		print_usage_and_exit(true);
+
+	const char* oldPackageFileName = argv[optind++];
+	const char* newPackageFileName = argv[optind++];
+	const char* deltaFileName = argv[optind++];
+
+	// open the files
+	BFile oldPackageFile;
+	status_t error = oldPackageFile.SetTo(oldPackageFileName, B_READ_ONLY);
+	if (error != B_OK) {
+		fprintf(stderr, "Error: Failed to open old package file \"%s\": %s\n",
+			oldPackageFileName, strerror(error));
+		return 1;
+	}
+
+	BFile newPackageFile;
+	error = newPackageFile.SetTo(newPackageFileName, B_READ_ONLY);
+	if (error != B_OK) {
+		fprintf(stderr, "Error: Failed to open new package file \"%s\": %s\n",
+			newPackageFileName, strerror(error));
+		return 1;
+	}
+
+	BFile deltaFile;
+	error = deltaFile.SetTo(deltaFileName,
+		B_READ_WRITE | B_CREATE_FILE | B_ERASE_FILE);
+	if (error != B_OK) {
+		fprintf(stderr, "Error: Failed to create delta file \"%s\": %s\n",
+			deltaFileName, strerror(error));
+		return 1;
+	}
+
+	// write the delta
+	BStandardErrorOutput errorOutput;
+	DeltaPackageWriter deltaWriter(&errorOutput);
+	error = deltaWriter.Create(&oldPackageFile, &newPackageFile, &deltaFile);
+	if (error != B_OK) {
+		deltaFile.Unset();
+		unlink(deltaFileName);
+		return 1;
+	}
+
+	if (verbose) {
+		off_t deltaSize = 0;
+		deltaFile.GetSize(&deltaSize);
+		printf("reused:   %10" B_PRIu64 " bytes\n", deltaWriter.CopiedSize());
+		printf("inserted: %10" B_PRIu64 " bytes\n",
+			deltaWriter.InsertedSize());
+		printf("delta:    %10" B_PRIdOFF " bytes\n", deltaSize);
+	}
+
+	if (!quiet)
+		printf("Delta file \"%s\" created.\n", deltaFileName);
+
+	return 0;
+}
@@ -8,6 +8,7 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <getopt.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -23,6 +24,7 @@
 #include <AutoDeleter.h>
 #include <HashString.h>
 
+#include <util/DoublyLinkedList.h>
 #include <util/OpenHashTable.h>
 
 #include <package/hpkg/BlockBufferPoolNoLock.h>
@@ -30,6 +32,7 @@
 #include <package/hpkg/PackageDataReader.h>
 #include <package/hpkg/PackageEntry.h>
 #include <package/hpkg/PackageEntryAttribute.h>
+#include <package/hpkg/PackageFileHeapReader.h>
 #include <package/hpkg/PackageReader.h>
 #include <package/hpkg/StandardErrorOutput.h>
 #include <package/hpkg/v1/PackageContentHandler.h>
@@ -50,6 +53,7 @@ using BPackageKit::BHPKG::BErrorOutput;
 using BPackageKit::BHPKG::BFDDataReader;
 using BPackageKit::BHPKG::BPackageInfoAttributeValue;
 using BPackageKit::BHPKG::BStandardErrorOutput;
+using BPackageKit::BHPKG::BPrivate::PackageFileHeapReader;
 
 
 struct VersionPolicyV1 {
@@ -67,6 +71,12 @@ struct VersionPolicyV1 {
 		return BPackageKit::BHPKG::V1::B_HPKG_DEFAULT_DATA_CHUNK_SIZE_ZLIB;
 	}
 
+	static inline bool SupportsParallelExtraction()
+	{
+		// the data readers share the (unlocked) buffer pool
+		return false;
+	}
+
 	static inline const char* PackageInfoFileName()
 	{
 		return BPackageKit::BHPKG::V1::B_HPKG_PACKAGE_INFO_FILE_NAME;
@@ -97,6 +107,12 @@ struct VersionPolicyV1 {
 		return _heapReader != NULL ? B_OK : B_NO_MEMORY;
 	}
 
+	static inline status_t CloneHeapReader(HeapReaderBase* heapReader,
+		HeapReaderBase*& _clone)
+	{
+		return B_NOT_SUPPORTED;
+	}
+
 	static status_t CreatePackageDataReader(BBufferPool* bufferPool,
 		HeapReaderBase* heapReader, const PackageData& data,
 		BAbstractBufferedDataReader*& _reader)
@@ -119,6 +135,11 @@ struct VersionPolicyV2 {
 		return 64 * 1024;
 	}
 
+	static inline bool SupportsParallelExtraction()
+	{
+		return true;
+	}
+
 	static inline const char* PackageInfoFileName()
 	{
 		return BPackageKit::BHPKG::B_HPKG_PACKAGE_INFO_FILE_NAME;
@@ -150,6 +171,20 @@ struct VersionPolicyV2 {
 		return B_OK;
 	}
 
+	static status_t CloneHeapReader(HeapReaderBase* heapReader,
+		HeapReaderBase*& _clone)
+	{
+		// A clone shares the package file and the chunk offsets with the
+		// original, so the package doesn't need to be parsed again.
+		PackageFileHeapReader* fileHeapReader
+			= dynamic_cast<PackageFileHeapReader*>(heapReader);
+		if (fileHeapReader == NULL)
+			return B_NOT_SUPPORTED;
+
+		_clone = fileHeapReader->Clone();
+		return _clone != NULL ? B_OK : B_NO_MEMORY;
+	}
+
 	static status_t CreatePackageDataReader(BBufferPool* bufferPool,
 		HeapReaderBase* heapReader, const PackageData& data,
 		BAbstractBufferedDataReader*& _reader)
@@ -304,6 +339,405 @@ private:
 };
 
 
+// maximum number of threads writing file data in parallel
+static const int32 kMaxExtractThreads = 8;
+
+// File data are written in pieces of this size, so that the data of large
+// files are decompressed by several threads at once.
+static const off_t kExtractPieceSize = 1024 * 1024;
+
+// number of pieces per thread that may be queued at any time
+static const int32 kQueuedPiecesPerThread = 4;
+
+
+template<typename VersionPolicy>
+static status_t
+extract_file_data(BBufferPool* bufferPool,
+	typename VersionPolicy::HeapReaderBase* heapReader,
+	const typename VersionPolicy::PackageData& data, off_t offset, off_t size,
+	int fd, void* buffer, size_t bufferSize)
+{
+	// create a PackageDataReader
+	BAbstractBufferedDataReader* reader;
+	status_t error = VersionPolicy::CreatePackageDataReader(bufferPool,
+		heapReader, data, reader);
+	if (error != B_OK)
+		return error;
+	ObjectDeleter<BAbstractBufferedDataReader> readerDeleter(reader);
+
+	// write the data
+	off_t bytesRemaining = size;
+	while (bytesRemaining > 0) {
+		// read
+		size_t toCopy = std::min((off_t)bufferSize, bytesRemaining);
+		error = reader->ReadData(offset, buffer, toCopy);
+		if (error != B_OK) {
+			fprintf(stderr, "Error: Failed to read data: %s\n",
+				strerror(error));
+			return error;
+		}
+
+		// write
+		ssize_t bytesWritten = write_pos(fd, offset, buffer, toCopy);
+		if (bytesWritten < 0) {
+			fprintf(stderr, "Error: Failed to write data: %s\n",
+				strerror(errno));
+			return errno;
+		}
+		if ((size_t)bytesWritten != toCopy) {
+			fprintf(stderr, "Error: Failed to write all data (%zd of "
+				"%zu)\n", bytesWritten, toCopy);
+			return B_ERROR;
+		}
+
+		offset += toCopy;
+		bytesRemaining -= toCopy;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Writes the data of regular files on a set of worker threads. Each thread
+	has its own clone of the package's heap reader, so the heap chunks are
+	read and decompressed in parallel, too. The data of large files are split
+	into pieces which are processed independently. Threads are only started
+	while there are more queued pieces than idle threads, so small extracts
+	don't pay for more threads than they can use. Once all pieces of a file are written and
+	the caller is done with the file (i.e. has written its attributes), the
+	file's times and permissions are set and it is closed.
+	The number of queued pieces is limited, QueueFile() blocks while the
+	queue is full.
+*/
+template<typename VersionPolicy>
+struct ParallelDataWriter {
+	ParallelDataWriter()
+		:
+		fHeapReader(NULL),
+		fWorkers(NULL),
+		fWorkerCount(0),
+		fMaxWorkerCount(0),
+		fPieces(),
+		fQueuedPieces(0),
+		fActivePieces(0),
+		fMaxQueuedPieces(0),
+		fError(B_OK),
+		fTerminating(false)
+	{
+		pthread_mutex_init(&fLock, NULL);
+		pthread_cond_init(&fPieceQueuedCondition, NULL);
+		pthread_cond_init(&fPieceDoneCondition, NULL);
+	}
+
+	~ParallelDataWriter()
+	{
+		Finish();
+
+		delete[] fWorkers;
+
+		pthread_cond_destroy(&fPieceDoneCondition);
+		pthread_cond_destroy(&fPieceQueuedCondition);
+		pthread_mutex_destroy(&fLock);
+	}
+
+	/*!	\a heapReader must remain valid until Finish() has been called. At
+		most \a maxThreadCount threads are used.
+	*/
+	status_t Init(typename VersionPolicy::HeapReaderBase* heapReader,
+		int32 maxThreadCount)
+	{
+		fWorkers = new(std::nothrow) Worker[maxThreadCount];
+		if (fWorkers == NULL)
+			return B_NO_MEMORY;
+
+		fHeapReader = heapReader;
+		fMaxWorkerCount = maxThreadCount;
+		fMaxQueuedPieces = maxThreadCount * kQueuedPiecesPerThread;
+
+		// start the first thread right away, so we know the heap reader can
+		// be cloned at all
+		return _StartWorker();
+	}
+
+	/*!	Takes over ownership of \a fd in any case. \a times may be \c NULL.
+		On success FileDone() must be called with the returned \a _cookie,
+		on error the file is released already.
+	*/
+	status_t QueueFile(const typename VersionPolicy::PackageData& data,
+		int fd, const timespec* times, mode_t mode, const BString& path,
+		void*& _cookie)
+	{
+		File* file = new(std::nothrow) File;
+		if (file == NULL) {
+			close(fd);
+			return B_NO_MEMORY;
+		}
+
+		off_t size = VersionPolicy::PackageDataUncompressedSize(data);
+
+		file->data = data;
+		file->fd = fd;
+		file->setTimes = times != NULL;
+		if (times != NULL) {
+			file->times[0] = times[0];
+			file->times[1] = times[1];
+		}
+		file->mode = mode;
+		file->path = path;
+		file->error = B_OK;
+		int32 pieceCount = std::max((size + kExtractPieceSize - 1)
+			/ kExtractPieceSize, (off_t)1);
+		file->references = pieceCount + 1;
+			// one reference for each piece and one for the caller
+
+		pthread_mutex_lock(&fLock);
+
+		off_t offset = 0;
+		for (int32 i = 0; i < pieceCount; i++) {
+			Piece* piece = new(std::nothrow) Piece;
+			if (piece == NULL) {
+				// Let the pieces queued so far and the caller finish the
+				// file.
+				if (fError == B_OK)
+					fError = B_NO_MEMORY;
+				file->error = B_NO_MEMORY;
+				file->references -= pieceCount - i;
+				break;
+			}
+
+			piece->file = file;
+			piece->offset = offset;
+			piece->size = std::min(size - offset, kExtractPieceSize);
+			offset += piece->size;
+
+			while (fQueuedPieces >= fMaxQueuedPieces)
+				pthread_cond_wait(&fPieceDoneCondition, &fLock);
+
+			fPieces.Add(piece);
+			fQueuedPieces++;
+			pthread_cond_signal(&fPieceQueuedCondition);
+
+			// Start another thread, if the running ones can't take all
+			// queued pieces. If that fails, the running ones do the work.
+			if (fWorkerCount < fMaxWorkerCount
+				&& fQueuedPieces > fWorkerCount - fActivePieces
+				&& _StartWorker() != B_OK) {
+				fMaxWorkerCount = fWorkerCount;
+			}
+		}
+
+		status_t error = fError;
+
+		pthread_mutex_unlock(&fLock);
+
+		if (error != B_OK) {
+			// the caller won't call FileDone()
+			_ReleaseFile(file);
+			_cookie = NULL;
+			return error;
+		}
+
+		_cookie = file;
+		return B_OK;
+	}
+
+	void FileDone(void* cookie)
+	{
+		_ReleaseFile((File*)cookie);
+	}
+
+	/*!	Waits until all queued files have been written and stops the worker
+		threads. Returns the first error that occurred.
+	*/
+	status_t Finish()
+	{
+		pthread_mutex_lock(&fLock);
+
+		while (fQueuedPieces > 0 || fActivePieces > 0)
+			pthread_cond_wait(&fPieceDoneCondition, &fLock);
+
+		fTerminating = true;
+		pthread_cond_broadcast(&fPieceQueuedCondition);
+		status_t error = fError;
+
+		pthread_mutex_unlock(&fLock);
+
+		for (int32 i = 0; i < fWorkerCount; i++)
+			pthread_join(fWorkers[i].thread, NULL);
+		fWorkerCount = 0;
+
+		return error;
+	}
+
+private:
+	struct File {
+		typename VersionPolicy::PackageData	data;
+		int									fd;
+		timespec							times[2];
+		bool								setTimes;
+		mode_t								mode;
+		BString								path;
+		status_t							error;
+		int32								references;
+	};
+
+	struct Piece : DoublyLinkedListLinkImpl<Piece> {
+		File*	file;
+		off_t	offset;
+		off_t	size;
+	};
+
+	struct Worker {
+		Worker()
+			:
+			heapReader(NULL),
+			buffer(NULL)
+		{
+		}
+
+		~Worker()
+		{
+			delete heapReader;
+			free(buffer);
+		}
+
+		status_t Init(ParallelDataWriter* writer,
+			typename VersionPolicy::HeapReaderBase* heapReader)
+		{
+			this->writer = writer;
+
+			status_t error = VersionPolicy::CloneHeapReader(heapReader,
+				this->heapReader);
+			if (error != B_OK)
+				return error;
+
+			buffer = malloc(VersionPolicy::BufferSize());
+			if (buffer == NULL)
+				return B_NO_MEMORY;
+
+			return B_OK;
+		}
+
+		ParallelDataWriter*						writer;
+		typename VersionPolicy::HeapReaderBase*	heapReader;
+		void*									buffer;
+		pthread_t								thread;
+	};
+
+	typedef DoublyLinkedList<Piece> PieceList;
+
+private:
+	/*!	Called with fLock held, or before any thread has been started.
+	*/
+	status_t _StartWorker()
+	{
+		Worker& worker = fWorkers[fWorkerCount];
+		status_t error = worker.Init(this, fHeapReader);
+		if (error != B_OK)
+			return error;
+
+		if (pthread_create(&worker.thread, NULL, &_WorkerEntry, &worker) != 0)
+			return B_NO_MORE_THREADS;
+
+		fWorkerCount++;
+		return B_OK;
+	}
+
+	static void* _WorkerEntry(void* data)
+	{
+		Worker* worker = (Worker*)data;
+		worker->writer->_Work(worker);
+		return NULL;
+	}
+
+	void _Work(Worker* worker)
+	{
+		pthread_mutex_lock(&fLock);
+
+		while (true) {
+			while (!fTerminating && fPieces.IsEmpty())
+				pthread_cond_wait(&fPieceQueuedCondition, &fLock);
+
+			Piece* piece = fPieces.RemoveHead();
+			if (piece == NULL)
+				break;
+
+			fQueuedPieces--;
+			fActivePieces++;
+			File* file = piece->file;
+			bool skip = file->error != B_OK;
+
+			pthread_mutex_unlock(&fLock);
+
+			status_t error = B_OK;
+			if (!skip) {
+				error = extract_file_data<VersionPolicy>(NULL,
+					worker->heapReader, file->data, piece->offset, piece->size,
+					file->fd, worker->buffer, VersionPolicy::BufferSize());
+			}
+			delete piece;
+
+			pthread_mutex_lock(&fLock);
+
+			if (error != B_OK) {
+				if (file->error == B_OK)
+					file->error = error;
+				if (fError == B_OK)
+					fError = error;
+			}
+
+			fActivePieces--;
+
+			pthread_mutex_unlock(&fLock);
+			_ReleaseFile(file);
+			pthread_mutex_lock(&fLock);
+
+			pthread_cond_broadcast(&fPieceDoneCondition);
+		}
+
+		pthread_mutex_unlock(&fLock);
+	}
+
+	void _ReleaseFile(File* file)
+	{
+		pthread_mutex_lock(&fLock);
+		bool lastReference = --file->references == 0;
+		pthread_mutex_unlock(&fLock);
+
+		if (!lastReference)
+			return;
+
+		if (file->error == B_OK) {
+			if (file->setTimes)
+				futimens(file->fd, file->times);
+
+			if (fchmod(file->fd, file->mode & ALLPERMS) != 0) {
+				fprintf(stderr, "Warning: Failed to set permissions of file "
+					"\"%s\": %s\n", file->path.String(), strerror(errno));
+			}
+		}
+
+		close(file->fd);
+		delete file;
+	}
+
+private:
+	typename VersionPolicy::HeapReaderBase* fHeapReader;
+	Worker*				fWorkers;
+	int32				fWorkerCount;
+	int32				fMaxWorkerCount;
+	pthread_mutex_t		fLock;
+	pthread_cond_t		fPieceQueuedCondition;
+	pthread_cond_t		fPieceDoneCondition;
+	PieceList			fPieces;
+	int32				fQueuedPieces;
+	int32				fActivePieces;
+	int32				fMaxQueuedPieces;
+	status_t			fError;
+	bool				fTerminating;
+};
+
+
 template<typename VersionPolicy>
 struct PackageContentExtractHandler : VersionPolicy::PackageContentHandler {
 	PackageContentExtractHandler(BBufferPool* bufferPool,
@@ -311,6 +745,7 @@ struct PackageContentExtractHandler : VersionPolicy::PackageContentHandler {
 		:
 		fBufferPool(bufferPool),
 		fPackageFileReader(heapReader),
+		fDataWriter(NULL),
 		fDataBuffer(NULL),
 		fDataBufferSize(0),
 		fRootFilterEntry(NULL, NULL, true),
@@ -339,6 +774,11 @@ struct PackageContentExtractHandler : VersionPolicy::PackageContentHandler {
 		return B_OK;
 	}
 
+	void SetDataWriter(ParallelDataWriter<VersionPolicy>* dataWriter)
+	{
+		fDataWriter = dataWriter;
+	}
+
 	void SetBaseDirectory(int fd)
 	{
 		fBaseDirectory = fd;
@@ -510,10 +950,33 @@ struct PackageContentExtractHandler : VersionPolicy::PackageContentHandler {
 			}
 
 			// write data
-			status_t error = _ExtractFileData(fPackageFileReader, entry->Data(),
-				fd);
-			if (error != B_OK)
-				return error;
+			if (fDataWriter != NULL) {
+				// The data writer sets times and permissions when it is done
+				// with the file, since writing the data would change them.
+				int dataFD = dup(fd);
+				if (dataFD < 0) {
+					fprintf(stderr, "Error: Failed to duplicate FD of file "
+						"\"%s\": %s\n", _EntryPath(entry).String(),
+						strerror(errno));
+					close(fd);
+					return errno;
+				}
+
+				timespec times[2] = {entry->AccessTime(),
+					entry->ModifiedTime()};
+				status_t error = fDataWriter->QueueFile(entry->Data(), dataFD,
+					times, entry->Mode(), _EntryPath(entry),
+					token->dataCookie);
+				if (error != B_OK) {
+					close(fd);
+					return error;
+				}
+			} else {
+				status_t error = _ExtractFileData(fPackageFileReader,
+					entry->Data(), fd);
+				if (error != B_OK)
+					return error;
+			}
 		} else if (S_ISLNK(entry->Mode())) {
 			if (implicit) {
 				fprintf(stderr, "Error: Symlink \"%s\" was specified as a "
@@ -559,7 +1022,7 @@ struct PackageContentExtractHandler : VersionPolicy::PackageContentHandler {
 		token->fd = fd;
 
 		// set the file times
-		if (!entryExists && !implicit) {
+		if (!entryExists && !implicit && token->dataCookie == NULL) {
 			timespec times[2] = {entry->AccessTime(), entry->ModifiedTime()};
 			futimens(fd, times);
 
@@ -611,7 +1074,10 @@ struct PackageContentExtractHandler : VersionPolicy::PackageContentHandler {
 		Token* token = (Token*)entry->UserToken();
 
 		// set the node permissions for non-symlinks
-		if (token != NULL && !S_ISLNK(entry->Mode())) {
+		if (token != NULL && token->dataCookie != NULL) {
+			// the data writer sets the permissions
+			fDataWriter->FileDone(token->dataCookie);
+		} else if (token != NULL && !S_ISLNK(entry->Mode())) {
 			// get parent FD and entry name
 			int parentFD;
 			const char* entryName;
@@ -649,12 +1115,14 @@ private:
 		Entry*	filterEntry;
 		int		fd;
 		bool	implicit;
+		void*	dataCookie;
 
 		Token()
 			:
 			filterEntry(NULL),
 			fd(-1),
-			implicit(true)
+			implicit(true),
+			dataCookie(NULL)
 		{
 		}
 
@@ -709,50 +1177,15 @@ private:
 		typename VersionPolicy::HeapReaderBase* dataReader,
 		const typename VersionPolicy::PackageData& data, int fd)
 	{
-		// create a PackageDataReader
-		BAbstractBufferedDataReader* reader;
-		status_t error = VersionPolicy::CreatePackageDataReader(fBufferPool,
-			dataReader, data, reader);
-		if (error != B_OK)
-			return error;
-		ObjectDeleter<BAbstractBufferedDataReader> readerDeleter(reader);
-
-		// write the data
-		off_t bytesRemaining = VersionPolicy::PackageDataUncompressedSize(data);
-		off_t offset = 0;
-		while (bytesRemaining > 0) {
-			// read
-			size_t toCopy = std::min((off_t)fDataBufferSize, bytesRemaining);
-			error = reader->ReadData(offset, fDataBuffer, toCopy);
-			if (error != B_OK) {
-				fprintf(stderr, "Error: Failed to read data: %s\n",
-					strerror(error));
-				return error;
-			}
-
-			// write
-			ssize_t bytesWritten = write_pos(fd, offset, fDataBuffer, toCopy);
-			if (bytesWritten < 0) {
-				fprintf(stderr, "Error: Failed to write data: %s\n",
-					strerror(errno));
-				return errno;
-			}
-			if ((size_t)bytesWritten != toCopy) {
-				fprintf(stderr, "Error: Failed to write all data (%zd of "
-					"%zu)\n", bytesWritten, toCopy);
-				return B_ERROR;
-			}
-
-			offset += toCopy;
-			bytesRemaining -= toCopy;
-		}
-
-		return B_OK;
+		return extract_file_data<VersionPolicy>(fBufferPool, dataReader, data,
+			0, VersionPolicy::PackageDataUncompressedSize(data), fd,
+			fDataBuffer, fDataBufferSize);
 	}
 
 private:
 	BBufferPool*							fBufferPool;
 	typename VersionPolicy::HeapReaderBase*	fPackageFileReader;
+	ParallelDataWriter<VersionPolicy>*		fDataWriter;
 	void*									fDataBuffer;
 	size_t									fDataBufferSize;
 	Entry									fRootFilterEntry;
@@ -835,8 +1268,30 @@ do_extract(const char* packageFileName, const char* changeToDirectory,
 	if (packageInfoFileName != NULL)
 		handler.SetPackageInfoFile(packageInfoFileName);
 
+	// If we have more than one CPU, write the file data in parallel. The
+	// writer starts threads as the amount of queued data requires.
+	ParallelDataWriter<VersionPolicy>* dataWriter = NULL;
+	int32 threadCount = std::min((int32)sysconf(_SC_NPROCESSORS_ONLN),
+		kMaxExtractThreads);
+	if (VersionPolicy::SupportsParallelExtraction() && threadCount > 1) {
+		dataWriter = new(std::nothrow) ParallelDataWriter<VersionPolicy>;
+		if (dataWriter == NULL
+			|| dataWriter->Init(heapReader, threadCount) != B_OK) {
+			delete dataWriter;
+			dataWriter = NULL;
+		}
+	}
+	ObjectDeleter<ParallelDataWriter<VersionPolicy> > dataWriterDeleter(
+		dataWriter);
+	handler.SetDataWriter(dataWriter);
+
 	// extract
 	error = packageReader.ParseContent(&handler);
+	if (dataWriter != NULL) {
+		status_t writerError = dataWriter->Finish();
+		if (error == B_OK)
+			error = writerError;
+	}
 	if (error != B_OK)
 		exit(1);
 
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <File.h>
+
+#include <package/hpkg/StandardErrorOutput.h>
+
+#include <package/hpkg/DeltaPackageReader.h>
+
+#include "package.h"
+
+
+using BPackageKit::BHPKG::BStandardErrorOutput;
+using BPackageKit::BHPKG::BPrivate::DeltaPackageReader;
+
+
+int
+command_patch(int argc, const char* const* argv)
+{
+	bool quiet = false;
+
+	while (true) {
+		static struct option sLongOptions[] = {
+			{ "help", no_argument, 0, 'h' },
+			{ "quiet", no_argument, 0, 'q' },
+			{ 0, 0, 0, 0 }
+		};
+
+		opterr = 0; // don't print errors
+		int c = getopt_long(argc, (char**)argv, "+hq", sLongOptions, NULL);
+		if (c == -1)
+			break;
+
+		switch (c) {
+			case 'h':
+				print_usage_and_exit(false);
+				break;
+
+			case 'q':
+				quiet = true;
+				break;
+
+			default:
+				print_usage_and_exit(true);
+				break;
+		}
+	}
+
+	// The remaining arguments are the old package file, the delta file, and
+	// the new package file, i.e. three more arguments.
+	if (argc - optind != 3)
+		print_usage_and_exit(true);
+
+	const char* oldPackageFileName = argv[optind++];
+	const char* deltaFileName = argv[optind++];
+	const char* newPackageFileName = argv[optind++];
+
+	// open the files
+	BFile oldPackageFile;
+	status_t error = oldPackageFile.SetTo(oldPackageFileName, B_READ_ONLY);
+	if (error != B_OK) {
+		fprintf(stderr, "Error: Failed to open old package file \"%s\": %s\n",
+			oldPackageFileName, strerror(error));
+		return 1;
+	}
+
+	BFile deltaFile;
+	error = deltaFile.SetTo(deltaFileName, B_READ_ONLY);
+	if (error != B_OK) {
+		fprintf(stderr, "Error: Failed to open delta file \"%s\": %s\n",
+			deltaFileName, strerror(error));
+		return 1;
+	}
+
+	BStandardErrorOutput errorOutput;
+	DeltaPackageReader deltaReader(&errorOutput);
+	error = deltaReader.Init(&deltaFile);
+	if (error != B_OK)
+		return 1;
+
+	BFile newPackageFile;
+	error = newPackageFile.SetTo(newPackageFileName,
+		B_READ_WRITE | B_CREATE_FILE | B_ERASE_FILE);
+	if (error != B_OK) {
+		fprintf(stderr, "Error: Failed to create new package file \"%s\": "
+			"%s\n", newPackageFileName, strerror(error));
+		return 1;
+	}
+
+	// apply the delta
+	error = deltaReader.Apply(&oldPackageFile, &newPackageFile);
+	if (error != B_OK) {
+		newPackageFile.Unset();
+		unlink(newPackageFileName);
+		return 1;
+	}
+
+	if (!quiet)
+		printf("Package file \"%s\" created.\n", newPackageFileName);
+
+	return 0;
+}
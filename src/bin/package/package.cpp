@@ -67,6 +67,14 @@ static const char* kUsage =
 	"        -q         - Be quiet (don't show any output except for errors).\n"
 	"        -v         - Be verbose (show more info about created package).\n"
 	"\n"
+	"    delta [ <options> ] <old package> <new package> <delta>\n"
+	"        Creates delta file <delta>, which turns package file <old package>\n"
+	"        into package file <new package>. Data of the new package that are\n"
+	"        also found in the old package are only referenced.\n"
+	"\n"
+	"        -q         - Be quiet (don't show any output except for errors).\n"
+	"        -v         - Be verbose (show how much data are reused).\n"
+	"\n"
 	"    dump [ <options> ] <package>\n"
 	"        Dumps the TOC section of package file <package>. For debugging only.\n"
 	"\n"
@@ -98,6 +106,14 @@ static const char* kUsage =
 	"        -i         - Only print the meta information, not the files.\n"
 	"        -p         - Only print a list of file paths.\n"
 	"\n"
+	"    patch [ <options> ] <old package> <delta> <new package>\n"
+	"        Applies delta file <delta> to package file <old package> and writes\n"
+	"        the resulting package file <new package>. Fails, if the delta has\n"
+	"        been created for a different package or the result doesn't match\n"
+	"        the checksum recorded in the delta.\n"
+	"\n"
+	"        -q         - Be quiet (don't show any output except for errors).\n"
+	"\n"
 	"    recompress [ <options> ] <input package> <output package>\n"
 	"        Reads the package file <input package> and writes it to new package\n"
 	"        <output package> using the specified compression options. If the\n"
@@ -165,6 +181,9 @@ main(int argc, const char* const* argv)
 	if (strcmp(command, "create") == 0)
 		return command_create(argc - 1, argv + 1);
 
+	if (strcmp(command, "delta") == 0)
+		return command_delta(argc - 1, argv + 1);
+
 	if (strcmp(command, "dump") == 0)
 		return command_dump(argc - 1, argv + 1);
 
@@ -177,6 +196,9 @@ main(int argc, const char* const* argv)
 	if (strcmp(command, "info") == 0)
 		return command_info(argc - 1, argv + 1);
 
+	if (strcmp(command, "patch") == 0)
+		return command_patch(argc - 1, argv + 1);
+
 	if (strcmp(command, "recompress") == 0)
 		return command_recompress(argc - 1, argv + 1);
 
@@ -321,8 +321,14 @@ PackageManager::ProgressTransactionCommitted(InstalledRepository& repository,
 		}
 	}
 
-	printf("[%s] Changes applied. Old activation state backed up in \"%s\"\n",
-		repositoryName, result.OldStateDirectory().String());
+	if (result.OldStateDirectory().IsEmpty()) {
+		// all packages were unchanged, the daemon didn't touch anything
+		printf("[%s] Changes applied. No packages needed to be replaced\n",
+			repositoryName);
+	} else {
+		printf("[%s] Changes applied. Old activation state backed up in "
+			"\"%s\"\n", repositoryName, result.OldStateDirectory().String());
+	}
 	printf("[%s] Cleaning up ...\n", repositoryName);
 }
 
@@ -91,6 +91,46 @@ print_type(const char *format, uint8 *pointer)
 }
 
 
+/*!	Checks that the items of \a field lie within the message data, so that
+	accessing them later doesn't need any further checks.
+*/
+static bool
+is_valid_field(const BMessage::field_header *field, const uint8 *data,
+	uint32 dataSize)
+{
+	if (field->name_length == 0
+		|| (uint64)field->offset + field->name_length + field->data_size
+			> dataSize
+		|| data[field->offset + field->name_length - 1] != '\0') {
+		return false;
+	}
+
+	if ((field->flags & FIELD_FLAG_FIXED_SIZE) != 0) {
+		if (field->count == 0)
+			return field->data_size == 0;
+		return field->data_size >= field->count
+			&& field->data_size % field->count == 0;
+	}
+
+	// every variable sized item is prefixed with its size
+	const uint8 *pointer = data + field->offset + field->name_length;
+	uint32 left = field->data_size;
+	for (uint32 i = 0; i < field->count; i++) {
+		if (left < sizeof(uint32))
+			return false;
+
+		uint32 size = *(uint32 *)pointer;
+		if (size > left - sizeof(uint32))
+			return false;
+
+		pointer += size + sizeof(uint32);
+		left -= size + sizeof(uint32);
+	}
+
+	return left == 0;
+}
+
+
 //	#pragma mark -
 
 
@@ -348,6 +388,34 @@ BMessage::_Clear()
 }
 
 
+status_t
+BMessage::_Reset()
+{
+	DEBUG_FUNCTION_ENTER;
+	if (fHeader == NULL)
+		return _InitHeader();
+
+	fFieldsAvailable += fHeader->field_count;
+	fDataAvailable += fHeader->data_size;
+
+	if (fFieldsAvailable * sizeof(field_header) > MAX_DATA_PREALLOCATION) {
+		free(fFields);
+		fFields = NULL;
+		fFieldsAvailable = 0;
+	}
+	if (fDataAvailable > MAX_DATA_PREALLOCATION) {
+		free(fData);
+		fData = NULL;
+		fDataAvailable = 0;
+	}
+
+	delete fOriginal;
+	fOriginal = NULL;
+
+	return _InitHeader();
+}
+
+
 status_t
 BMessage::GetInfo(type_code typeRequested, int32 index, char **nameFound,
 	type_code *typeFound, int32 *countFound) const
@@ -835,24 +903,41 @@ BMessage::Flatten(BDataIO *stream, ssize_t *size) const
 status_t
 BMessage::_ValidateMessage()
 {
-	if (fHeader->field_count == 0)
-		return B_OK;
+	if (fHeader == NULL)
+		return B_NO_INIT;
 
-	if (fFields == NULL)
+	if (fHeader->field_count > 0 && fFields == NULL)
 		return B_NO_INIT;
 
-	for (uint32 i = 0; i < fHeader->field_count; i++) {
+	bool valid = fHeader->hash_table_size > 0
+		&& fHeader->hash_table_size <= MESSAGE_BODY_HASH_TABLE_SIZE;
+
+	for (uint32 i = 0; valid && i < fHeader->field_count; i++) {
 		field_header *field = &fFields[i];
-		if ((field->next_field >= 0
-				&& (uint32)field->next_field > fHeader->field_count)
-			|| (field->offset + field->name_length + field->data_size
-				> fHeader->data_size)) {
-			// the message is corrupt
-			MakeEmpty();
-			return B_BAD_VALUE;
+		valid = (field->next_field < 0
+				|| (uint32)field->next_field < fHeader->field_count)
+			&& is_valid_field(field, fData, fHeader->data_size);
+	}
+
+	// every field can only be in one hash chain, so a longer walk means
+	// that the chains loop
+	uint32 chainedFields = 0;
+	for (uint32 i = 0; valid && i < fHeader->hash_table_size; i++) {
+		int32 index = fHeader->hash_table[i];
+		while (valid && index >= 0) {
+			valid = (uint32)index < fHeader->field_count
+				&& ++chainedFields <= fHeader->field_count;
+			if (valid)
+				index = fFields[index].next_field;
 		}
 	}
 
+	if (!valid) {
+		// the message is corrupt
+		MakeEmpty();
+		return B_BAD_VALUE;
+	}
+
 	return B_OK;
 }
 
@@ -1222,16 +1307,7 @@ BMessage::_ResizeData(uint32 offset, int32 change)
 uint32
 BMessage::_HashName(const char *name) const
 {
-	char ch;
-	uint32 result = 0;
-
-	while ((ch = *name++) != 0) {
-		result = (result << 7) ^ (result >> 24);
-		result ^= ch;
-	}
-
-	result ^= result << 12;
-	return result;
+	return Private::HashName(name);
 }
 
 
@@ -0,0 +1,374 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <FlattenedMessage.h>
+
+#include <string.h>
+
+#include <MessageAdapter.h>
+#include <MessagePrivate.h>
+#include <Point.h>
+#include <Rect.h>
+
+
+namespace BPrivate {
+
+
+BFlattenedMessage::BFlattenedMessage()
+	:
+	fHeader(NULL),
+	fFields(NULL),
+	fData(NULL),
+	fInitStatus(B_NO_INIT)
+{
+}
+
+
+BFlattenedMessage::BFlattenedMessage(const void* buffer, size_t size)
+	:
+	fHeader(NULL),
+	fFields(NULL),
+	fData(NULL),
+	fInitStatus(B_NO_INIT)
+{
+	SetTo(buffer, size);
+}
+
+
+/*!	Validates the flattened message in \a buffer, so that the lookups don't
+	need to check the structure again. Returns \c B_NOT_SUPPORTED for
+	messages that have to go through BMessage::Unflatten(), i.e. foreign
+	formats and messages passed by area.
+*/
+status_t
+BFlattenedMessage::SetTo(const void* buffer, size_t size)
+{
+	Unset();
+
+	if (buffer == NULL)
+		return fInitStatus = B_BAD_VALUE;
+	if (size < sizeof(message_header))
+		return fInitStatus = B_BAD_DATA;
+
+	const message_header* header = (const message_header*)buffer;
+	if (header->format != MESSAGE_FORMAT_HAIKU)
+		return fInitStatus = B_NOT_SUPPORTED;
+	if ((header->flags & MESSAGE_FLAG_VALID) == 0)
+		return fInitStatus = B_BAD_DATA;
+	if ((header->flags & MESSAGE_FLAG_PASS_BY_AREA) != 0
+		&& header->message_area >= 0) {
+		return fInitStatus = B_NOT_SUPPORTED;
+	}
+
+	uint64 fieldsSize = (uint64)header->field_count * sizeof(field_header);
+	if (sizeof(message_header) + fieldsSize + header->data_size > size)
+		return fInitStatus = B_BAD_DATA;
+
+	if (header->hash_table_size == 0
+		|| header->hash_table_size > MESSAGE_BODY_HASH_TABLE_SIZE) {
+		return fInitStatus = B_BAD_DATA;
+	}
+	for (uint32 i = 0; i < header->hash_table_size; i++) {
+		if (header->hash_table[i] >= (int32)header->field_count)
+			return fInitStatus = B_BAD_DATA;
+	}
+
+	const field_header* fields = (const field_header*)(header + 1);
+	const uint8* data = (const uint8*)fields + fieldsSize;
+
+	for (uint32 i = 0; i < header->field_count; i++) {
+		const field_header* field = &fields[i];
+		if (field->next_field >= (int32)header->field_count
+			|| field->name_length == 0
+			|| (uint64)field->offset + field->name_length + field->data_size
+				> header->data_size
+			|| data[field->offset + field->name_length - 1] != '\0') {
+			return fInitStatus = B_BAD_DATA;
+		}
+
+		// every item takes up at least one byte, or its size prefix
+		if ((field->flags & FIELD_FLAG_FIXED_SIZE) != 0) {
+			if (field->data_size < field->count
+				|| (field->count > 0
+					&& field->data_size % field->count != 0)) {
+				return fInitStatus = B_BAD_DATA;
+			}
+		} else if ((uint64)field->count * sizeof(uint32) > field->data_size)
+			return fInitStatus = B_BAD_DATA;
+	}
+
+	fHeader = header;
+	fFields = fields;
+	fData = data;
+	return fInitStatus = B_OK;
+}
+
+
+void
+BFlattenedMessage::Unset()
+{
+	fHeader = NULL;
+	fFields = NULL;
+	fData = NULL;
+	fInitStatus = B_NO_INIT;
+}
+
+
+uint32
+BFlattenedMessage::What() const
+{
+	return fHeader != NULL ? fHeader->what : 0;
+}
+
+
+int32
+BFlattenedMessage::CountFields() const
+{
+	return fHeader != NULL ? fHeader->field_count : 0;
+}
+
+
+status_t
+BFlattenedMessage::GetInfo(const char* name, type_code* _type, int32* _count,
+	bool* _fixedSize) const
+{
+	const field_header* field;
+	status_t result = _FindField(name, B_ANY_TYPE, &field);
+	if (result != B_OK)
+		return result;
+
+	if (_type != NULL)
+		*_type = field->type;
+	if (_count != NULL)
+		*_count = field->count;
+	if (_fixedSize != NULL)
+		*_fixedSize = (field->flags & FIELD_FLAG_FIXED_SIZE) != 0;
+
+	return B_OK;
+}
+
+
+bool
+BFlattenedMessage::HasData(const char* name, type_code type, int32 index) const
+{
+	const field_header* field;
+	if (_FindField(name, type, &field) != B_OK)
+		return false;
+
+	return index >= 0 && (uint32)index < field->count;
+}
+
+
+status_t
+BFlattenedMessage::FindData(const char* name, type_code type, int32 index,
+	const void** _data, ssize_t* _numBytes) const
+{
+	if (_data == NULL)
+		return B_BAD_VALUE;
+
+	*_data = NULL;
+	const field_header* field;
+	status_t result = _FindField(name, type, &field);
+	if (result != B_OK)
+		return result;
+
+	if (index < 0 || (uint32)index >= field->count)
+		return B_BAD_INDEX;
+
+	const uint8* pointer = fData + field->offset + field->name_length;
+
+	if ((field->flags & FIELD_FLAG_FIXED_SIZE) != 0) {
+		size_t bytes = field->data_size / field->count;
+		*_data = pointer + index * bytes;
+		if (_numBytes != NULL)
+			*_numBytes = bytes;
+		return B_OK;
+	}
+
+	// Variable sized items are prefixed with their size; since SetTo() only
+	// checked the field as a whole, each item has to be checked here.
+	const uint8* end = pointer + field->data_size;
+	for (int32 i = 0;; i++) {
+		if ((size_t)(end - pointer) < sizeof(uint32))
+			return B_BAD_DATA;
+
+		uint32 bytes;
+		memcpy(&bytes, pointer, sizeof(uint32));
+		pointer += sizeof(uint32);
+		if (bytes > (size_t)(end - pointer))
+			return B_BAD_DATA;
+
+		if (i == index) {
+			*_data = pointer;
+			if (_numBytes != NULL)
+				*_numBytes = bytes;
+			return B_OK;
+		}
+
+		pointer += bytes;
+	}
+}
+
+
+status_t
+BFlattenedMessage::FindString(const char* name, int32 index,
+	const char** _string) const
+{
+	if (_string == NULL)
+		return B_BAD_VALUE;
+
+	const void* data;
+	ssize_t bytes;
+	status_t result = FindData(name, B_STRING_TYPE, index, &data, &bytes);
+	if (result != B_OK)
+		return result;
+
+	const char* string = (const char*)data;
+	if (bytes == 0 || string[bytes - 1] != '\0')
+		return B_BAD_DATA;
+
+	*_string = string;
+	return B_OK;
+}
+
+
+status_t
+BFlattenedMessage::FindBool(const char* name, int32 index, bool* _value) const
+{
+	return _FindValue(name, B_BOOL_TYPE, index, _value, sizeof(bool));
+}
+
+
+status_t
+BFlattenedMessage::FindInt8(const char* name, int32 index, int8* _value) const
+{
+	return _FindValue(name, B_INT8_TYPE, index, _value, sizeof(int8));
+}
+
+
+status_t
+BFlattenedMessage::FindInt16(const char* name, int32 index,
+	int16* _value) const
+{
+	return _FindValue(name, B_INT16_TYPE, index, _value, sizeof(int16));
+}
+
+
+status_t
+BFlattenedMessage::FindInt32(const char* name, int32 index,
+	int32* _value) const
+{
+	return _FindValue(name, B_INT32_TYPE, index, _value, sizeof(int32));
+}
+
+
+status_t
+BFlattenedMessage::FindInt64(const char* name, int32 index,
+	int64* _value) const
+{
+	return _FindValue(name, B_INT64_TYPE, index, _value, sizeof(int64));
+}
+
+
+status_t
+BFlattenedMessage::FindFloat(const char* name, int32 index,
+	float* _value) const
+{
+	return _FindValue(name, B_FLOAT_TYPE, index, _value, sizeof(float));
+}
+
+
+status_t
+BFlattenedMessage::FindDouble(const char* name, int32 index,
+	double* _value) const
+{
+	return _FindValue(name, B_DOUBLE_TYPE, index, _value, sizeof(double));
+}
+
+
+status_t
+BFlattenedMessage::FindPoint(const char* name, int32 index,
+	BPoint* _value) const
+{
+	return _FindValue(name, B_POINT_TYPE, index, _value, sizeof(BPoint));
+}
+
+
+status_t
+BFlattenedMessage::FindRect(const char* name, int32 index, BRect* _value) const
+{
+	return _FindValue(name, B_RECT_TYPE, index, _value, sizeof(BRect));
+}
+
+
+status_t
+BFlattenedMessage::FindPointer(const char* name, int32 index,
+	void** _value) const
+{
+	return _FindValue(name, B_POINTER_TYPE, index, _value, sizeof(void*));
+}
+
+
+status_t
+BFlattenedMessage::_FindField(const char* name, type_code type,
+	const field_header** _field) const
+{
+	if (name == NULL)
+		return B_BAD_VALUE;
+
+	if (fHeader == NULL)
+		return B_NO_INIT;
+
+	if (fHeader->field_count == 0)
+		return B_NAME_NOT_FOUND;
+
+	uint32 hash = BMessage::Private::HashName(name) % fHeader->hash_table_size;
+	int32 nextField = fHeader->hash_table[hash];
+
+	// the chain length is bounded, in case the buffer contains a loop
+	for (uint32 i = 0; nextField >= 0 && i < fHeader->field_count; i++) {
+		const field_header* field = &fFields[nextField];
+		if ((field->flags & FIELD_FLAG_VALID) == 0)
+			break;
+
+		if (strcmp((const char*)(fData + field->offset), name) == 0) {
+			if (type != B_ANY_TYPE && field->type != type)
+				return B_BAD_TYPE;
+
+			*_field = field;
+			return B_OK;
+		}
+
+		nextField = field->next_field;
+	}
+
+	return B_NAME_NOT_FOUND;
+}
+
+
+status_t
+BFlattenedMessage::_FindValue(const char* name, type_code type, int32 index,
+	void* value, size_t size) const
+{
+	if (value == NULL)
+		return B_BAD_VALUE;
+
+	const void* data;
+	ssize_t bytes;
+	status_t result = FindData(name, type, index, &data, &bytes);
+	if (result != B_OK)
+		return result;
+
+	if ((size_t)bytes != size)
+		return B_BAD_DATA;
+
+	// the data in the buffer isn't necessarily aligned
+	memcpy(value, data, size);
+	return B_OK;
+}
+
+
+}	// namespace BPrivate
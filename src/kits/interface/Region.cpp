@@ -22,6 +22,24 @@
 const static int32 kDataBlockSize = 8;
 
 
+// These work on the internal format, where right and bottom are exclusive.
+
+static inline bool
+internal_rects_overlap(const clipping_rect& a, const clipping_rect& b)
+{
+	return a.left < b.right && b.left < a.right && a.top < b.bottom
+		&& b.top < a.bottom;
+}
+
+
+static inline bool
+internal_rect_covers(const clipping_rect& outer, const clipping_rect& inner)
+{
+	return outer.left <= inner.left && outer.top <= inner.top
+		&& outer.right >= inner.right && outer.bottom >= inner.bottom;
+}
+
+
 BRegion::BRegion()
 	:
 	fCount(0),
@@ -368,11 +386,18 @@ BRegion::Include(clipping_rect clipping)
 {
 	if (!valid_rect(clipping))
 		return;
+	if (fCount == 0) {
+		Set(clipping);
+		return;
+	}
 
 	// convert to internal clipping format
 	clipping.right++;
 	clipping.bottom++;
 
+	if (fCount == 1 && internal_rect_covers(fBounds, clipping))
+		return;
+
 	// use private clipping_rect constructor which avoids malloc()
 	BRegion temp(clipping);
 
@@ -386,6 +411,15 @@ BRegion::Include(clipping_rect clipping)
 void
 BRegion::Include(const BRegion* region)
 {
+	if (region->fCount == 0
+		|| (fCount == 1 && internal_rect_covers(fBounds, region->fBounds)))
+		return;
+	if (fCount == 0 || (region->fCount == 1
+			&& internal_rect_covers(region->fBounds, fBounds))) {
+		*this = *region;
+		return;
+	}
+
 	BRegion result;
 	Support::XUnionRegion(this, region, &result);
 
@@ -410,6 +444,13 @@ BRegion::Exclude(clipping_rect clipping)
 	clipping.right++;
 	clipping.bottom++;
 
+	if (fCount == 0 || !internal_rects_overlap(fBounds, clipping))
+		return;
+	if (internal_rect_covers(clipping, fBounds)) {
+		MakeEmpty();
+		return;
+	}
+
 	// use private clipping_rect constructor which avoids malloc()
 	BRegion temp(clipping);
 
@@ -423,6 +464,14 @@ BRegion::Exclude(clipping_rect clipping)
 void
 BRegion::Exclude(const BRegion* region)
 {
+	if (fCount == 0 || region->fCount == 0
+		|| !internal_rects_overlap(fBounds, region->fBounds))
+		return;
+	if (region->fCount == 1 && internal_rect_covers(region->fBounds, fBounds)) {
+		MakeEmpty();
+		return;
+	}
+
 	BRegion result;
 	Support::XSubtractRegion(this, region, &result);
 
@@ -433,6 +482,26 @@ BRegion::Exclude(const BRegion* region)
 void
 BRegion::IntersectWith(const BRegion* region)
 {
+	// Clipping against a single rectangle is by far the most common case,
+	// so handle it without allocating a temporary region.
+	if (fCount == 0)
+		return;
+	if (region->fCount == 0
+		|| !internal_rects_overlap(fBounds, region->fBounds)) {
+		MakeEmpty();
+		return;
+	}
+	if (region->fCount == 1 && internal_rect_covers(region->fBounds, fBounds))
+		return;
+	if (fCount == 1 && region->fCount == 1) {
+		fBounds.left = max_c(fBounds.left, region->fBounds.left);
+		fBounds.top = max_c(fBounds.top, region->fBounds.top);
+		fBounds.right = min_c(fBounds.right, region->fBounds.right);
+		fBounds.bottom = min_c(fBounds.bottom, region->fBounds.bottom);
+		fData[0] = fBounds;
+		return;
+	}
+
 	BRegion result;
 	Support::XIntersectRegion(this, region, &result);
 
@@ -101,6 +101,15 @@ using std::nothrow;
 	 (r1)->bottom > (r2)->top && \
 	 (r1)->top < (r2)->bottom)
 
+/*  1 if region r1 is a single clipping_rect that completely covers r2.
+ */
+#define SUBSUMES(r1, r2) \
+	((r1)->fCount == 1 && \
+	 (r1)->fBounds.left <= (r2)->fBounds.left && \
+	 (r1)->fBounds.top <= (r2)->fBounds.top && \
+	 (r1)->fBounds.right >= (r2)->fBounds.right && \
+	 (r1)->fBounds.bottom >= (r2)->fBounds.bottom)
+
 /*
  *  update region fBounds
  */
@@ -473,6 +482,38 @@ BRegion::Support::XIntersectRegion(
     if ( (!(reg1->fCount)) || (!(reg2->fCount))  ||
 	(!EXTENTCHECK(&reg1->fBounds, &reg2->fBounds)))
         newReg->fCount = 0;
+    /*
+     * One region is a single rectangle covering the other one; this is the
+     * common case of clipping against a window or view frame, and does not
+     * need to walk the bands at all.
+     */
+    else if (SUBSUMES(reg2, reg1))
+    {
+        if (newReg != reg1)
+            miRegionCopy(newReg, reg1);
+        return 1;
+    }
+    else if (SUBSUMES(reg1, reg2))
+    {
+        if (newReg != reg2)
+            miRegionCopy(newReg, reg2);
+        return 1;
+    }
+    else if ((reg1->fCount == 1) && (reg2->fCount == 1))
+    {
+        clipping_rect rect;
+        rect.left = max_c(reg1->fBounds.left, reg2->fBounds.left);
+        rect.top = max_c(reg1->fBounds.top, reg2->fBounds.top);
+        rect.right = min_c(reg1->fBounds.right, reg2->fBounds.right);
+        rect.bottom = min_c(reg1->fBounds.bottom, reg2->fBounds.bottom);
+
+        if (!newReg->_SetSize(1))
+            return 0;
+        newReg->fData[0] = rect;
+        newReg->fBounds = rect;
+        newReg->fCount = 1;
+        return 1;
+    }
     else
 	miRegionOp (newReg, reg1, reg2,
     		miIntersectO, NULL, NULL);
@@ -856,6 +897,24 @@ BRegion::Support::miRegionOp(
      * the two source regions, then mark the "new" region empty, allocating
      * another array of rectangles for it to use.
      */
+    /*
+     * The destination is emptied below, so if it is one of the source
+     * regions, work on a temporary region instead. Its bounds are left
+     * alone, as the callers compute the bounds of the result from those
+     * of the source regions afterwards.
+     */
+    if (newReg == reg1 || newReg == reg2)
+    {
+	BRegion result;
+	miRegionOp(&result, reg1, reg2, overlapFunc, nonOverlap1Func,
+		nonOverlap2Func);
+
+	clipping_rect bounds = newReg->fBounds;
+	newReg->_AdoptRegionData(result);
+	newReg->fBounds = bounds;
+	return;
+    }
+
     r1 = reg1->fData;
     r2 = reg2->fData;
     r1End = r1 + reg1->fCount;
@@ -1506,6 +1565,16 @@ BRegion::Support::XSubtractRegion(
         return 1;
     }
 
+    /*
+     * regS is a single rectangle that covers all of regM
+     */
+    if (SUBSUMES(regS, regM))
+    {
+        regD->fCount = 0;
+        miSetExtents(regD);
+        return 1;
+    }
+
     miRegionOp (regD, regM, regS, miSubtractO,
     		miSubtractNonO1, NULL);
 
@@ -25,7 +25,8 @@ BActivationTransaction::BActivationTransaction()
 	fTransactionDirectoryName(),
 	fPackagesToActivate(),
 	fPackagesToDeactivate(),
-	fFirstBootProcessing(false)
+	fFirstBootProcessing(false),
+	fSkipUnchangedPackages(false)
 {
 }
 
@@ -38,7 +39,8 @@ BActivationTransaction::BActivationTransaction(BMessage* archive,
 	fTransactionDirectoryName(),
 	fPackagesToActivate(),
 	fPackagesToDeactivate(),
-	fFirstBootProcessing(false)
+	fFirstBootProcessing(false),
+	fSkipUnchangedPackages(false)
 {
 	status_t error;
 	int32 location;
@@ -47,6 +49,10 @@ BActivationTransaction::BActivationTransaction(BMessage* archive,
 			!= B_OK)
 		fFirstBootProcessing = false; // Field is optional for compatibility.
 
+	if (archive->FindBool("skip unchanged packages", &fSkipUnchangedPackages)
+			!= B_OK)
+		fSkipUnchangedPackages = false; // Field is optional as well.
+
 	if ((error = archive->FindInt32("location", &location)) == B_OK
 		&& (error = archive->FindInt64("change count", &fChangeCount)) == B_OK
 		&& (error = archive->FindString("transaction",
@@ -99,6 +105,7 @@ BActivationTransaction::SetTo(BPackageInstallationLocation location,
 	fPackagesToActivate.MakeEmpty();
 	fPackagesToDeactivate.MakeEmpty();
 	fFirstBootProcessing = false;
+	fSkipUnchangedPackages = false;
 
 	return B_OK;
 }
@@ -205,6 +212,20 @@ BActivationTransaction::SetFirstBootProcessing(bool processingIsOn)
 }
 
 
+bool
+BActivationTransaction::SkipUnchangedPackages() const
+{
+	return fSkipUnchangedPackages;
+}
+
+
+void
+BActivationTransaction::SetSkipUnchangedPackages(bool skip)
+{
+	fSkipUnchangedPackages = skip;
+}
+
+
 status_t
 BActivationTransaction::Archive(BMessage* archive, bool deep) const
 {
@@ -221,7 +242,9 @@ BActivationTransaction::Archive(BMessage* archive, bool deep) const
 		|| (error = archive->AddStrings("deactivate", fPackagesToDeactivate))
 			!= B_OK
 		|| (error = archive->AddBool("first boot processing",
-			fFirstBootProcessing)) != B_OK) {
+			fFirstBootProcessing)) != B_OK
+		|| (error = archive->AddBool("skip unchanged packages",
+			fSkipUnchangedPackages)) != B_OK) {
 		return error;
 	}
 
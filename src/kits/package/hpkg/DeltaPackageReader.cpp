@@ -0,0 +1,290 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <package/hpkg/DeltaPackageReader.h>
+
+#include <string.h>
+
+#include <algorithm>
+#include <new>
+
+#include <ByteOrder.h>
+
+#include <package/hpkg/ErrorOutput.h>
+
+#include <AutoDeleter.h>
+#include <SHA256.h>
+
+
+namespace BPackageKit {
+
+namespace BHPKG {
+
+namespace BPrivate {
+
+
+static const size_t kInputBufferSize = 64 * 1024;
+static const size_t kCopyBufferSize = 1024 * 1024;
+
+
+DeltaPackageReader::DeltaPackageReader(BErrorOutput* errorOutput)
+	:
+	fErrorOutput(errorOutput),
+	fDelta(NULL),
+	fInputBuffer(NULL),
+	fInputSize(0),
+	fInputPosition(0),
+	fInputOffset(0)
+{
+	memset(&fHeader, 0, sizeof(fHeader));
+}
+
+
+DeltaPackageReader::~DeltaPackageReader()
+{
+	delete[] fInputBuffer;
+}
+
+
+status_t
+DeltaPackageReader::Init(BPositionIO* delta)
+{
+	fDelta = delta;
+
+	ssize_t bytesRead = fDelta->ReadAt(0, &fHeader, sizeof(fHeader));
+	if (bytesRead != (ssize_t)sizeof(fHeader)) {
+		if (bytesRead < 0) {
+			fErrorOutput->PrintError("Error: Failed to read delta header: "
+				"%s\n", strerror(bytesRead));
+			return bytesRead;
+		}
+		fErrorOutput->PrintError("Error: Delta file too short\n");
+		return B_BAD_DATA;
+	}
+
+	fHeader.magic = B_BENDIAN_TO_HOST_INT32(fHeader.magic);
+	fHeader.header_size = B_BENDIAN_TO_HOST_INT16(fHeader.header_size);
+	fHeader.version = B_BENDIAN_TO_HOST_INT16(fHeader.version);
+	fHeader.block_size = B_BENDIAN_TO_HOST_INT32(fHeader.block_size);
+	fHeader.old_package_size = B_BENDIAN_TO_HOST_INT64(
+		fHeader.old_package_size);
+	fHeader.new_package_size = B_BENDIAN_TO_HOST_INT64(
+		fHeader.new_package_size);
+
+	if (fHeader.magic != B_HPKG_DELTA_MAGIC) {
+		fErrorOutput->PrintError("Error: Invalid delta file: Invalid "
+			"magic\n");
+		return B_BAD_DATA;
+	}
+
+	if (fHeader.version != B_HPKG_DELTA_VERSION) {
+		fErrorOutput->PrintError("Error: Invalid/unsupported delta file "
+			"version (%d)\n", fHeader.version);
+		return B_MISMATCHED_VALUES;
+	}
+
+	if (fHeader.header_size < sizeof(fHeader)) {
+		fErrorOutput->PrintError("Error: Invalid delta file: Invalid header "
+			"size (%u)\n", fHeader.header_size);
+		return B_BAD_DATA;
+	}
+
+	if (fInputBuffer == NULL) {
+		fInputBuffer = new(std::nothrow) uint8[kInputBufferSize];
+		if (fInputBuffer == NULL) {
+			fErrorOutput->PrintError("Error: Out of memory!\n");
+			return B_NO_MEMORY;
+		}
+	}
+
+	fInputSize = 0;
+	fInputPosition = 0;
+	fInputOffset = fHeader.header_size;
+	return B_OK;
+}
+
+
+/*!	Writes the package resulting from applying the delta to \a oldPackage to
+	\a newPackage. Fails, if \a oldPackage isn't the package the delta was
+	created for, or if the result doesn't match the checksum recorded in the
+	delta.
+*/
+status_t
+DeltaPackageReader::Apply(BPositionIO* oldPackage, BPositionIO* newPackage)
+{
+	if (fDelta == NULL)
+		return B_NO_INIT;
+
+	uint8* buffer = new(std::nothrow) uint8[kCopyBufferSize];
+	if (buffer == NULL) {
+		fErrorOutput->PrintError("Error: Out of memory!\n");
+		return B_NO_MEMORY;
+	}
+	ArrayDeleter<uint8> bufferDeleter(buffer);
+
+	// check the old package
+	off_t oldSize;
+	status_t error = oldPackage->GetSize(&oldSize);
+	if (error != B_OK) {
+		fErrorOutput->PrintError("Error: Failed to get size of old package: "
+			"%s\n", strerror(error));
+		return error;
+	}
+
+	if ((uint64)oldSize != fHeader.old_package_size) {
+		fErrorOutput->PrintError("Error: The delta doesn't apply to the "
+			"package (size mismatch)\n");
+		return B_MISMATCHED_VALUES;
+	}
+
+	SHA256 checksummer;
+	for (off_t offset = 0; offset < oldSize;) {
+		size_t toRead = (size_t)std::min((off_t)kCopyBufferSize,
+			oldSize - offset);
+		ssize_t bytesRead = oldPackage->ReadAt(offset, buffer, toRead);
+		if (bytesRead != (ssize_t)toRead) {
+			error = bytesRead < 0 ? bytesRead : B_ERROR;
+			fErrorOutput->PrintError("Error: Failed to read old package: %s\n",
+				strerror(error));
+			return error;
+		}
+
+		checksummer.Update(buffer, toRead);
+		offset += toRead;
+	}
+
+	if (memcmp(checksummer.Digest(), fHeader.old_package_checksum,
+			SHA_DIGEST_LENGTH) != 0) {
+		fErrorOutput->PrintError("Error: The delta doesn't apply to the "
+			"package (checksum mismatch)\n");
+		return B_MISMATCHED_VALUES;
+	}
+
+	// execute the instructions
+	checksummer.Init();
+	uint64 newSize = 0;
+
+	while (true) {
+		uint8 opcode;
+		error = _Read(&opcode, 1);
+		if (error != B_OK)
+			return error;
+
+		if (opcode == B_HPKG_DELTA_END)
+			break;
+
+		uint64 offset = 0;
+		uint64 length;
+		if (opcode == B_HPKG_DELTA_COPY) {
+			error = _Read(&offset, sizeof(offset));
+			if (error != B_OK)
+				return error;
+			offset = B_BENDIAN_TO_HOST_INT64(offset);
+		} else if (opcode != B_HPKG_DELTA_DATA) {
+			fErrorOutput->PrintError("Error: Invalid delta file: Unknown "
+				"instruction %u\n", opcode);
+			return B_BAD_DATA;
+		}
+
+		error = _Read(&length, sizeof(length));
+		if (error != B_OK)
+			return error;
+		length = B_BENDIAN_TO_HOST_INT64(length);
+
+		if (length > fHeader.new_package_size - newSize
+			|| (opcode == B_HPKG_DELTA_COPY
+				&& (offset > (uint64)oldSize
+					|| length > (uint64)oldSize - offset))) {
+			fErrorOutput->PrintError("Error: Invalid delta file: Instruction "
+				"out of bounds\n");
+			return B_BAD_DATA;
+		}
+
+		while (length > 0) {
+			size_t toCopy = (size_t)std::min((uint64)kCopyBufferSize, length);
+			if (opcode == B_HPKG_DELTA_COPY) {
+				ssize_t bytesRead = oldPackage->ReadAt(offset, buffer, toCopy);
+				if (bytesRead != (ssize_t)toCopy) {
+					error = bytesRead < 0 ? bytesRead : B_ERROR;
+					fErrorOutput->PrintError("Error: Failed to read old "
+						"package: %s\n", strerror(error));
+					return error;
+				}
+				offset += toCopy;
+			} else {
+				error = _Read(buffer, toCopy);
+				if (error != B_OK)
+					return error;
+			}
+
+			ssize_t bytesWritten = newPackage->WriteAt(newSize, buffer,
+				toCopy);
+			if (bytesWritten != (ssize_t)toCopy) {
+				error = bytesWritten < 0 ? bytesWritten : B_ERROR;
+				fErrorOutput->PrintError("Error: Failed to write new package: "
+					"%s\n", strerror(error));
+				return error;
+			}
+
+			checksummer.Update(buffer, toCopy);
+			newSize += toCopy;
+			length -= toCopy;
+		}
+	}
+
+	if (newSize != fHeader.new_package_size
+		|| memcmp(checksummer.Digest(), fHeader.new_package_checksum,
+			SHA_DIGEST_LENGTH) != 0) {
+		fErrorOutput->PrintError("Error: The resulting package doesn't match "
+			"the checksum recorded in the delta\n");
+		return B_BAD_DATA;
+	}
+
+	return B_OK;
+}
+
+
+status_t
+DeltaPackageReader::_Read(void* _buffer, size_t size)
+{
+	uint8* buffer = (uint8*)_buffer;
+
+	while (size > 0) {
+		if (fInputPosition == fInputSize) {
+			ssize_t bytesRead = fDelta->ReadAt(fInputOffset, fInputBuffer,
+				kInputBufferSize);
+			if (bytesRead < 0) {
+				fErrorOutput->PrintError("Error: Failed to read delta: %s\n",
+					strerror(bytesRead));
+				return bytesRead;
+			}
+			if (bytesRead == 0) {
+				fErrorOutput->PrintError("Error: Invalid delta file: "
+					"Premature end of file\n");
+				return B_BAD_DATA;
+			}
+
+			fInputOffset += bytesRead;
+			fInputSize = bytesRead;
+			fInputPosition = 0;
+		}
+
+		size_t toCopy = std::min(size, fInputSize - fInputPosition);
+		memcpy(buffer, fInputBuffer + fInputPosition, toCopy);
+		fInputPosition += toCopy;
+		buffer += toCopy;
+		size -= toCopy;
+	}
+
+	return B_OK;
+}
+
+
+}	// namespace BPrivate
+
+}	// namespace BHPKG
+
+}	// namespace BPackageKit
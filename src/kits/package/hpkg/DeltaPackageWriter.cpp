@@ -0,0 +1,534 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <package/hpkg/DeltaPackageWriter.h>
+
+#include <string.h>
+
+#include <algorithm>
+#include <new>
+
+#include <ByteOrder.h>
+
+#include <package/hpkg/ErrorOutput.h>
+#include <package/hpkg/HPKGDefsPrivate.h>
+
+#include <AutoDeleter.h>
+#include <SHA256.h>
+
+
+namespace BPackageKit {
+
+namespace BHPKG {
+
+namespace BPrivate {
+
+
+// The new package is compared against the old one in blocks of this size. A
+// block of the new package that is found anywhere in the old package -- at
+// any offset, not only at block boundaries -- is encoded as a reference to the
+// old package. Everything else is inserted literally. Unchanged heap chunks
+// are thus reused, even if they moved, and for uncompressed packages so is
+// unchanged file data.
+static const uint32 kBlockSize = 4096;
+static const size_t kScanBufferSize = 1024 * 1024;
+static const size_t kMaxLiteralSize = 64 * 1024;
+static const size_t kOutputBufferSize = 64 * 1024;
+static const int32 kMaxMatchCandidates = 16;
+
+
+struct DeltaPackageWriter::Block {
+	uint32	weakSum;
+	uint32	index;
+
+	Block()
+	{
+	}
+
+	Block(uint32 weakSum, uint32 index)
+		:
+		weakSum(weakSum),
+		index(index)
+	{
+	}
+
+	bool operator<(const Block& other) const
+	{
+		if (weakSum != other.weakSum)
+			return weakSum < other.weakSum;
+		return index < other.index;
+	}
+};
+
+
+/*!	Computes the rsync style rolling checksum of the given data. The two
+	16 bit halves can be updated cheaply when the window moves by one byte.
+*/
+static inline void
+compute_weak_sum(const uint8* data, size_t size, uint32& _a, uint32& _b)
+{
+	uint32 a = 0;
+	uint32 b = 0;
+	for (size_t i = 0; i < size; i++) {
+		a += data[i];
+		b += (uint32)(size - i) * data[i];
+	}
+
+	_a = a & 0xffff;
+	_b = b & 0xffff;
+}
+
+
+static status_t
+check_package_magic(BPositionIO* package, const char* which,
+	BErrorOutput* errorOutput)
+{
+	uint32 magic;
+	ssize_t bytesRead = package->ReadAt(0, &magic, sizeof(magic));
+	if (bytesRead != (ssize_t)sizeof(magic)
+		|| B_BENDIAN_TO_HOST_INT32(magic) != B_HPKG_MAGIC) {
+		errorOutput->PrintError("Error: The %s package is not a valid package "
+			"file\n", which);
+		return B_BAD_DATA;
+	}
+
+	return B_OK;
+}
+
+
+DeltaPackageWriter::DeltaPackageWriter(BErrorOutput* errorOutput)
+	:
+	fErrorOutput(errorOutput),
+	fOldPackage(NULL),
+	fDelta(NULL),
+	fOldSize(0),
+	fBlocks(),
+	fOldBlockBuffer(NULL),
+	fCopyOffset(0),
+	fCopyLength(0),
+	fLiteralBuffer(NULL),
+	fLiteralSize(0),
+	fOutputBuffer(NULL),
+	fOutputSize(0),
+	fOutputOffset(0),
+	fCopiedSize(0),
+	fInsertedSize(0)
+{
+}
+
+
+DeltaPackageWriter::~DeltaPackageWriter()
+{
+	delete[] fOldBlockBuffer;
+	delete[] fLiteralBuffer;
+	delete[] fOutputBuffer;
+}
+
+
+/*!	Writes a delta to \a delta, that turns \a oldPackage into \a newPackage.
+	Both packages are only read; \a delta must be seekable, since the header
+	is written last.
+*/
+status_t
+DeltaPackageWriter::Create(BPositionIO* oldPackage, BPositionIO* newPackage,
+	BPositionIO* delta)
+{
+	fOldPackage = oldPackage;
+	fDelta = delta;
+	fCopyLength = 0;
+	fLiteralSize = 0;
+	fOutputSize = 0;
+	fCopiedSize = 0;
+	fInsertedSize = 0;
+
+	if (fOldBlockBuffer == NULL) {
+		fOldBlockBuffer = new(std::nothrow) uint8[kBlockSize];
+		fLiteralBuffer = new(std::nothrow) uint8[kMaxLiteralSize];
+		fOutputBuffer = new(std::nothrow) uint8[kOutputBufferSize];
+	}
+	uint8* scanBuffer = new(std::nothrow) uint8[kScanBufferSize];
+	ArrayDeleter<uint8> scanBufferDeleter(scanBuffer);
+	if (fOldBlockBuffer == NULL || fLiteralBuffer == NULL
+		|| fOutputBuffer == NULL || scanBuffer == NULL) {
+		fErrorOutput->PrintError("Error: Out of memory!\n");
+		return B_NO_MEMORY;
+	}
+
+	status_t error = check_package_magic(oldPackage, "old", fErrorOutput);
+	if (error == B_OK)
+		error = check_package_magic(newPackage, "new", fErrorOutput);
+	if (error != B_OK)
+		return error;
+
+	hpkg_delta_header header;
+	memset(&header, 0, sizeof(header));
+
+	error = _IndexOldPackage(header.old_package_checksum);
+	if (error != B_OK)
+		return error;
+
+	// The instructions follow the header, which we write when done.
+	fOutputOffset = sizeof(header);
+
+	SHA256 newChecksummer;
+	off_t newOffset = 0;
+	size_t bufferSize = 0;
+	size_t position = 0;
+	bool endOfFile = false;
+	bool haveSum = false;
+	uint32 a = 0;
+	uint32 b = 0;
+
+	while (true) {
+		// Make sure we have a full block plus the byte following it, so we can
+		// roll the checksum.
+		if (bufferSize - position <= kBlockSize && !endOfFile) {
+			memmove(scanBuffer, scanBuffer + position, bufferSize - position);
+			bufferSize -= position;
+			position = 0;
+
+			while (bufferSize < kScanBufferSize) {
+				ssize_t bytesRead = newPackage->ReadAt(newOffset,
+					scanBuffer + bufferSize, kScanBufferSize - bufferSize);
+				if (bytesRead < 0) {
+					fErrorOutput->PrintError("Error: Failed to read new "
+						"package: %s\n", strerror(bytesRead));
+					return bytesRead;
+				}
+				if (bytesRead == 0) {
+					endOfFile = true;
+					break;
+				}
+
+				newChecksummer.Update(scanBuffer + bufferSize, bytesRead);
+				newOffset += bytesRead;
+				bufferSize += bytesRead;
+			}
+		}
+
+		size_t available = bufferSize - position;
+		if (available < kBlockSize)
+			break;
+
+		const uint8* window = scanBuffer + position;
+		if (!haveSum) {
+			compute_weak_sum(window, kBlockSize, a, b);
+			haveSum = true;
+		}
+
+		// Preferably continue the current copy, since that doesn't need a new
+		// instruction.
+		off_t oldOffset;
+		bool found;
+		if (fCopyLength > 0
+			&& _MatchesOldData(fCopyOffset + fCopyLength, window)) {
+			oldOffset = fCopyOffset + fCopyLength;
+			found = true;
+		} else
+			found = _FindMatch(window, a | (b << 16), oldOffset);
+
+		if (found) {
+			error = _AddCopy(oldOffset);
+			if (error != B_OK)
+				return error;
+
+			position += kBlockSize;
+			haveSum = false;
+			continue;
+		}
+
+		if (available == kBlockSize) {
+			// end of file -- the rest is added literally
+			break;
+		}
+
+		// no match -- add the first byte literally and roll the window
+		uint8 outByte = window[0];
+		uint8 inByte = window[kBlockSize];
+		error = _AddLiteral(outByte);
+		if (error != B_OK)
+			return error;
+
+		a = (a - outByte + inByte) & 0xffff;
+		b = (b - kBlockSize * outByte + a) & 0xffff;
+		position++;
+	}
+
+	error = _AddLiterals(scanBuffer + position, bufferSize - position);
+	if (error == B_OK)
+		error = _FlushCopy();
+	if (error == B_OK)
+		error = _FlushLiterals();
+	if (error == B_OK) {
+		uint8 opcode = B_HPKG_DELTA_END;
+		error = _Write(&opcode, 1);
+	}
+	if (error == B_OK)
+		error = _FlushOutput();
+	if (error != B_OK)
+		return error;
+
+	// write the header
+	header.magic = B_HOST_TO_BENDIAN_INT32(B_HPKG_DELTA_MAGIC);
+	header.header_size = B_HOST_TO_BENDIAN_INT16((uint16)sizeof(header));
+	header.version = B_HOST_TO_BENDIAN_INT16(B_HPKG_DELTA_VERSION);
+	header.block_size = B_HOST_TO_BENDIAN_INT32(kBlockSize);
+	header.old_package_size = B_HOST_TO_BENDIAN_INT64((uint64)fOldSize);
+	header.new_package_size = B_HOST_TO_BENDIAN_INT64((uint64)newOffset);
+	memcpy(header.new_package_checksum, newChecksummer.Digest(),
+		sizeof(header.new_package_checksum));
+
+	ssize_t bytesWritten = fDelta->WriteAt(0, &header, sizeof(header));
+	if (bytesWritten != (ssize_t)sizeof(header)) {
+		error = bytesWritten < 0 ? bytesWritten : B_ERROR;
+		fErrorOutput->PrintError("Error: Failed to write delta header: %s\n",
+			strerror(error));
+		return error;
+	}
+
+	return B_OK;
+}
+
+
+status_t
+DeltaPackageWriter::_IndexOldPackage(uint8* checksum)
+{
+	status_t error = fOldPackage->GetSize(&fOldSize);
+	if (error != B_OK) {
+		fErrorOutput->PrintError("Error: Failed to get size of old package: "
+			"%s\n", strerror(error));
+		return error;
+	}
+
+	uint8* buffer = new(std::nothrow) uint8[kScanBufferSize];
+	if (buffer == NULL) {
+		fErrorOutput->PrintError("Error: Out of memory!\n");
+		return B_NO_MEMORY;
+	}
+	ArrayDeleter<uint8> bufferDeleter(buffer);
+
+	try {
+		fBlocks.clear();
+		fBlocks.reserve(fOldSize / kBlockSize);
+	} catch (std::bad_alloc&) {
+		fErrorOutput->PrintError("Error: Out of memory!\n");
+		return B_NO_MEMORY;
+	}
+
+	// Compute the checksum of the whole package and the weak checksums of
+	// all of its full blocks. The buffer size is a multiple of the block size.
+	SHA256 checksummer;
+	uint32 blockIndex = 0;
+	for (off_t offset = 0; offset < fOldSize;) {
+		size_t toRead = (size_t)std::min((off_t)kScanBufferSize,
+			fOldSize - offset);
+		ssize_t bytesRead = fOldPackage->ReadAt(offset, buffer, toRead);
+		if (bytesRead != (ssize_t)toRead) {
+			error = bytesRead < 0 ? bytesRead : B_ERROR;
+			fErrorOutput->PrintError("Error: Failed to read old package: %s\n",
+				strerror(error));
+			return error;
+		}
+
+		checksummer.Update(buffer, toRead);
+
+		for (size_t i = 0; i + kBlockSize <= toRead; i += kBlockSize) {
+			uint32 a;
+			uint32 b;
+			compute_weak_sum(buffer + i, kBlockSize, a, b);
+			fBlocks.push_back(Block(a | (b << 16), blockIndex++));
+		}
+
+		offset += toRead;
+	}
+
+	memcpy(checksum, checksummer.Digest(), SHA_DIGEST_LENGTH);
+
+	std::sort(fBlocks.begin(), fBlocks.end());
+	return B_OK;
+}
+
+
+bool
+DeltaPackageWriter::_FindMatch(const uint8* data, uint32 weakSum,
+	off_t& _oldOffset)
+{
+	BlockList::iterator it = std::lower_bound(fBlocks.begin(), fBlocks.end(),
+		Block(weakSum, 0));
+	for (int32 i = 0; it != fBlocks.end() && it->weakSum == weakSum
+			&& i < kMaxMatchCandidates; ++it, i++) {
+		off_t oldOffset = (off_t)it->index * kBlockSize;
+		if (_MatchesOldData(oldOffset, data)) {
+			_oldOffset = oldOffset;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+bool
+DeltaPackageWriter::_MatchesOldData(off_t oldOffset, const uint8* data)
+{
+	if (oldOffset + (off_t)kBlockSize > fOldSize)
+		return false;
+
+	return fOldPackage->ReadAt(oldOffset, fOldBlockBuffer, kBlockSize)
+			== (ssize_t)kBlockSize
+		&& memcmp(fOldBlockBuffer, data, kBlockSize) == 0;
+}
+
+
+status_t
+DeltaPackageWriter::_AddCopy(off_t oldOffset)
+{
+	status_t error = _FlushLiterals();
+	if (error != B_OK)
+		return error;
+
+	fCopiedSize += kBlockSize;
+
+	if (fCopyLength > 0 && fCopyOffset + (off_t)fCopyLength == oldOffset) {
+		fCopyLength += kBlockSize;
+		return B_OK;
+	}
+
+	error = _FlushCopy();
+	if (error != B_OK)
+		return error;
+
+	fCopyOffset = oldOffset;
+	fCopyLength = kBlockSize;
+	return B_OK;
+}
+
+
+status_t
+DeltaPackageWriter::_AddLiteral(uint8 byte)
+{
+	if (fCopyLength > 0 || fLiteralSize == kMaxLiteralSize) {
+		status_t error = _FlushCopy();
+		if (error == B_OK)
+			error = _FlushLiterals();
+		if (error != B_OK)
+			return error;
+	}
+
+	fLiteralBuffer[fLiteralSize++] = byte;
+	fInsertedSize++;
+	return B_OK;
+}
+
+
+status_t
+DeltaPackageWriter::_AddLiterals(const uint8* data, size_t size)
+{
+	for (size_t i = 0; i < size; i++) {
+		status_t error = _AddLiteral(data[i]);
+		if (error != B_OK)
+			return error;
+	}
+
+	return B_OK;
+}
+
+
+status_t
+DeltaPackageWriter::_FlushCopy()
+{
+	if (fCopyLength == 0)
+		return B_OK;
+
+	uint8 opcode = B_HPKG_DELTA_COPY;
+	uint64 offset = B_HOST_TO_BENDIAN_INT64((uint64)fCopyOffset);
+	uint64 length = B_HOST_TO_BENDIAN_INT64(fCopyLength);
+	fCopyLength = 0;
+
+	status_t error = _Write(&opcode, 1);
+	if (error == B_OK)
+		error = _Write(&offset, sizeof(offset));
+	if (error == B_OK)
+		error = _Write(&length, sizeof(length));
+	return error;
+}
+
+
+status_t
+DeltaPackageWriter::_FlushLiterals()
+{
+	if (fLiteralSize == 0)
+		return B_OK;
+
+	uint8 opcode = B_HPKG_DELTA_DATA;
+	uint64 length = B_HOST_TO_BENDIAN_INT64((uint64)fLiteralSize);
+
+	status_t error = _Write(&opcode, 1);
+	if (error == B_OK)
+		error = _Write(&length, sizeof(length));
+	if (error == B_OK)
+		error = _Write(fLiteralBuffer, fLiteralSize);
+
+	fLiteralSize = 0;
+	return error;
+}
+
+
+status_t
+DeltaPackageWriter::_Write(const void* buffer, size_t size)
+{
+	if (fOutputSize + size > kOutputBufferSize) {
+		status_t error = _FlushOutput();
+		if (error != B_OK)
+			return error;
+
+		if (size >= kOutputBufferSize) {
+			ssize_t bytesWritten = fDelta->WriteAt(fOutputOffset, buffer,
+				size);
+			if (bytesWritten != (ssize_t)size) {
+				error = bytesWritten < 0 ? bytesWritten : B_ERROR;
+				fErrorOutput->PrintError("Error: Failed to write delta: %s\n",
+					strerror(error));
+				return error;
+			}
+
+			fOutputOffset += size;
+			return B_OK;
+		}
+	}
+
+	memcpy(fOutputBuffer + fOutputSize, buffer, size);
+	fOutputSize += size;
+	return B_OK;
+}
+
+
+status_t
+DeltaPackageWriter::_FlushOutput()
+{
+	if (fOutputSize == 0)
+		return B_OK;
+
+	ssize_t bytesWritten = fDelta->WriteAt(fOutputOffset, fOutputBuffer,
+		fOutputSize);
+	if (bytesWritten != (ssize_t)fOutputSize) {
+		status_t error = bytesWritten < 0 ? bytesWritten : B_ERROR;
+		fErrorOutput->PrintError("Error: Failed to write delta: %s\n",
+			strerror(error));
+		return error;
+	}
+
+	fOutputOffset += fOutputSize;
+	fOutputSize = 0;
+	return B_OK;
+}
+
+
+}	// namespace BPrivate
+
+}	// namespace BHPKG
+
+}	// namespace BPackageKit
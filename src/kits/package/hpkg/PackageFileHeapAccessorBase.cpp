@@ -207,9 +207,31 @@ PackageFileHeapAccessorBase::~PackageFileHeapAccessorBase()
 }
 
 
+status_t
+PackageFileHeapAccessorBase::ReadData(off_t offset, void* buffer, size_t size)
+{
+	return _ReadData(offset, size, NULL, (uint8*)buffer);
+}
+
+
 status_t
 PackageFileHeapAccessorBase::ReadDataToOutput(off_t offset, size_t size,
 	BDataIO* output)
+{
+	return _ReadData(offset, size, output, NULL);
+}
+
+
+/*!	Reads the given heap range either into \a buffer or, if that is \c NULL,
+	writes it to \a output.
+	When reading into a buffer, chunks that are completely covered by the
+	range are decompressed directly into it rather than going through the
+	chunk buffer, so that e.g. the TOC of a package ends up in its section
+	buffer without another copy.
+*/
+status_t
+PackageFileHeapAccessorBase::_ReadData(off_t offset, size_t size,
+	BDataIO* output, uint8* buffer)
 {
 	if (size == 0)
 		return B_OK;
@@ -276,6 +298,20 @@ PackageFileHeapAccessorBase::ReadDataToOutput(off_t offset, size_t size,
 	size_t remainingBytes = size;
 
 	while (remainingBytes > 0) {
+		if (buffer != NULL && inChunkOffset == 0
+			&& remainingBytes >= kChunkSize) {
+			// the whole chunk is wanted -- decompress it in place
+			status_t error = ReadAndDecompressChunk(chunkIndex,
+				compressedDataBuffer, buffer, scratch);
+			if (error != B_OK)
+				return error;
+
+			buffer += kChunkSize;
+			remainingBytes -= kChunkSize;
+			chunkIndex++;
+			continue;
+		}
+
 		status_t error = ReadAndDecompressChunk(chunkIndex,
 			compressedDataBuffer, uncompressedDataBuffer, scratch);
 		if (error != B_OK)
@@ -286,10 +322,16 @@ PackageFileHeapAccessorBase::ReadDataToOutput(off_t offset, size_t size,
 			// The last chunk may be shorter than kChunkSize, but since
 			// size (and thus remainingSize) had been clamped, that doesn't
 			// harm.
-		error = output->WriteExactly(
-			(char*)uncompressedDataBuffer + inChunkOffset, toWrite);
-		if (error != B_OK)
-			return error;
+		if (buffer != NULL) {
+			memcpy(buffer, (char*)uncompressedDataBuffer + inChunkOffset,
+				toWrite);
+			buffer += toWrite;
+		} else {
+			error = output->WriteExactly(
+				(char*)uncompressedDataBuffer + inChunkOffset, toWrite);
+			if (error != B_OK)
+				return error;
+		}
 
 		remainingBytes -= toWrite;
 		chunkIndex++;
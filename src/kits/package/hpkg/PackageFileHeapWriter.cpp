@@ -9,6 +9,9 @@
 #include <algorithm>
 #include <new>
 
+#include <pthread.h>
+#include <unistd.h>
+
 #include <ByteOrder.h>
 #include <List.h>
 #include <package/hpkg/ErrorOutput.h>
@@ -24,6 +27,9 @@
 // minimum length of data we require before trying to compress them
 static const size_t kCompressionSizeThreshold = 64;
 
+// maximum number of threads compressing chunks in parallel
+static const int32 kMaxCompressionThreads = 16;
+
 
 namespace BPackageKit {
 
@@ -194,6 +200,179 @@ private:
 };
 
 
+/*!	Compresses chunks on a set of worker threads. The chunks are queued in a
+	ring of job slots and are written by the writer thread in the order they
+	were queued, so the resulting heap is identical to one written without
+	the parallel compressor.
+*/
+struct PackageFileHeapWriter::ParallelCompressor {
+	struct Job {
+		void*		data;
+		void*		compressedData;
+		size_t		size;
+		size_t		compressedSize;
+		status_t	status;
+		bool		done;
+	};
+
+	ParallelCompressor(PackageFileHeapWriter* writer)
+		:
+		fWriter(writer),
+		fJobs(NULL),
+		fJobCount(0),
+		fThreads(NULL),
+		fThreadCount(0),
+		fQueuedJobs(0),
+		fStartedJobs(0),
+		fWrittenJobs(0),
+		fTerminating(false)
+	{
+		pthread_mutex_init(&fLock, NULL);
+		pthread_cond_init(&fJobQueuedCondition, NULL);
+		pthread_cond_init(&fJobDoneCondition, NULL);
+	}
+
+	~ParallelCompressor()
+	{
+		pthread_mutex_lock(&fLock);
+		fTerminating = true;
+		pthread_cond_broadcast(&fJobQueuedCondition);
+		pthread_mutex_unlock(&fLock);
+
+		for (int32 i = 0; i < fThreadCount; i++)
+			pthread_join(fThreads[i], NULL);
+		delete[] fThreads;
+
+		if (fJobs != NULL) {
+			for (int32 i = 0; i < fJobCount; i++) {
+				free(fJobs[i].data);
+				free(fJobs[i].compressedData);
+			}
+			delete[] fJobs;
+		}
+
+		pthread_cond_destroy(&fJobDoneCondition);
+		pthread_cond_destroy(&fJobQueuedCondition);
+		pthread_mutex_destroy(&fLock);
+	}
+
+	status_t Init(int32 threadCount)
+	{
+		// Two jobs per thread, so that the threads have work queued while the
+		// writer thread is busy writing.
+		fJobCount = threadCount * 2;
+		fJobs = new(std::nothrow) Job[fJobCount]();
+		if (fJobs == NULL)
+			return B_NO_MEMORY;
+
+		for (int32 i = 0; i < fJobCount; i++) {
+			fJobs[i].data = malloc(kChunkSize);
+			fJobs[i].compressedData = malloc(kChunkSize);
+			if (fJobs[i].data == NULL || fJobs[i].compressedData == NULL)
+				return B_NO_MEMORY;
+		}
+
+		fThreads = new(std::nothrow) pthread_t[threadCount];
+		if (fThreads == NULL)
+			return B_NO_MEMORY;
+
+		for (; fThreadCount < threadCount; fThreadCount++) {
+			if (pthread_create(&fThreads[fThreadCount], NULL, &_ThreadEntry,
+					this) != 0) {
+				return B_NO_MORE_THREADS;
+			}
+		}
+
+		return B_OK;
+	}
+
+	bool IsFull() const
+	{
+		return fQueuedJobs - fWrittenJobs == fJobCount;
+	}
+
+	bool IsEmpty() const
+	{
+		return fQueuedJobs == fWrittenJobs;
+	}
+
+	void Queue(const void* data, size_t size)
+	{
+		Job& job = fJobs[fQueuedJobs % fJobCount];
+		memcpy(job.data, data, size);
+		job.size = size;
+		job.done = false;
+
+		pthread_mutex_lock(&fLock);
+		fQueuedJobs++;
+		pthread_cond_signal(&fJobQueuedCondition);
+		pthread_mutex_unlock(&fLock);
+	}
+
+	Job& WaitForOldestJob()
+	{
+		Job& job = fJobs[fWrittenJobs % fJobCount];
+
+		pthread_mutex_lock(&fLock);
+		while (!job.done)
+			pthread_cond_wait(&fJobDoneCondition, &fLock);
+		pthread_mutex_unlock(&fLock);
+
+		return job;
+	}
+
+	void OldestJobWritten()
+	{
+		fWrittenJobs++;
+	}
+
+private:
+	static void* _ThreadEntry(void* data)
+	{
+		((ParallelCompressor*)data)->_Run();
+		return NULL;
+	}
+
+	void _Run()
+	{
+		pthread_mutex_lock(&fLock);
+
+		while (true) {
+			while (!fTerminating && fStartedJobs == fQueuedJobs)
+				pthread_cond_wait(&fJobQueuedCondition, &fLock);
+			if (fTerminating)
+				break;
+
+			Job& job = fJobs[fStartedJobs++ % fJobCount];
+			pthread_mutex_unlock(&fLock);
+
+			job.status = fWriter->_CompressChunkData(job.data, job.size,
+				job.compressedData, job.compressedSize);
+
+			pthread_mutex_lock(&fLock);
+			job.done = true;
+			pthread_cond_broadcast(&fJobDoneCondition);
+		}
+
+		pthread_mutex_unlock(&fLock);
+	}
+
+private:
+	PackageFileHeapWriter*	fWriter;
+	Job*					fJobs;
+	int32					fJobCount;
+	pthread_t*				fThreads;
+	int32					fThreadCount;
+	int64					fQueuedJobs;
+	int64					fStartedJobs;
+	int64					fWrittenJobs;
+	bool					fTerminating;
+	pthread_mutex_t			fLock;
+	pthread_cond_t			fJobQueuedCondition;
+	pthread_cond_t			fJobDoneCondition;
+};
+
+
 PackageFileHeapWriter::PackageFileHeapWriter(BErrorOutput* errorOutput,
 	BPositionIO* file, off_t heapOffset,
 	CompressionAlgorithmOwner* compressionAlgorithm,
@@ -205,7 +384,8 @@ PackageFileHeapWriter::PackageFileHeapWriter(BErrorOutput* errorOutput,
 	fCompressedDataBuffer(NULL),
 	fPendingDataSize(0),
 	fOffsets(),
-	fCompressionAlgorithm(compressionAlgorithm)
+	fCompressionAlgorithm(compressionAlgorithm),
+	fParallelCompressor(NULL)
 {
 	if (fCompressionAlgorithm != NULL)
 		fCompressionAlgorithm->AcquireReference();
@@ -229,6 +409,25 @@ PackageFileHeapWriter::Init()
 	fCompressedDataBuffer = malloc(kChunkSize);
 	if (fPendingDataBuffer == NULL || fCompressedDataBuffer == NULL)
 		throw std::bad_alloc();
+
+	// If we compress, do that on as many threads as we have CPUs. Failing to
+	// set them up isn't fatal, we just compress on the calling thread then.
+	if (fCompressionAlgorithm == NULL)
+		return;
+
+	int32 threadCount = std::min((int32)sysconf(_SC_NPROCESSORS_ONLN),
+		kMaxCompressionThreads);
+	if (threadCount < 2)
+		return;
+
+	fParallelCompressor = new(std::nothrow) ParallelCompressor(this);
+	if (fParallelCompressor == NULL)
+		return;
+
+	if (fParallelCompressor->Init(threadCount) != B_OK) {
+		delete fParallelCompressor;
+		fParallelCompressor = NULL;
+	}
 }
 
 
@@ -318,6 +517,8 @@ PackageFileHeapWriter::RemoveDataRanges(
 	// Before we begin flush any pending data, so we don't need any special
 	// handling and also can use the pending data buffer.
 	status_t status = _FlushPendingData();
+	if (status == B_OK)
+		status = _WriteQueuedChunks();
 	if (status != B_OK)
 		throw status_t(status);
 
@@ -423,6 +624,12 @@ PackageFileHeapWriter::RemoveDataRanges(
 		AddDataThrows((uint8*)uncompressedData + segment.toKeepOffset,
 			segment.toKeepSize);
 
+		// The read-ahead above relies on the heap size being current, so the
+		// chunk must not remain queued for compression.
+		status_t error = _WriteQueuedChunks();
+		if (error != B_OK)
+			throw error;
+
 		chunkBuffer.CurrentSegmentDone();
 	}
 
@@ -440,6 +647,8 @@ PackageFileHeapWriter::Finish()
 {
 	// flush pending data, if any
 	status_t error = _FlushPendingData();
+	if (error == B_OK)
+		error = _WriteQueuedChunks();
 	if (error != B_OK)
 		return error;
 
@@ -482,6 +691,10 @@ PackageFileHeapWriter::ReadAndDecompressChunk(size_t chunkIndex,
 	void* compressedDataBuffer, void* uncompressedDataBuffer,
 	iovec* scratchBuffer)
 {
+	status_t error = _WriteQueuedChunks();
+	if (error != B_OK)
+		return error;
+
 	if (uint64(chunkIndex + 1) * kChunkSize > fUncompressedHeapSize) {
 		// The chunk has not been written to disk yet. Its data are still in the
 		// pending data buffer.
@@ -504,6 +717,9 @@ PackageFileHeapWriter::ReadAndDecompressChunk(size_t chunkIndex,
 void
 PackageFileHeapWriter::_Uninit()
 {
+	delete fParallelCompressor;
+	fParallelCompressor = NULL;
+
 	free(fPendingDataBuffer);
 	free(fCompressedDataBuffer);
 	fPendingDataBuffer = NULL;
@@ -529,16 +745,24 @@ status_t
 PackageFileHeapWriter::_WriteChunk(const void* data, size_t size,
 	bool mayCompress)
 {
+	// Try to use compression only for data large enough.
+	bool compress = mayCompress && size >= (off_t)kCompressionSizeThreshold;
+	if (compress && fParallelCompressor != NULL)
+		return _QueueChunk(data, size);
+
+	// Chunks queued for compression go first.
+	status_t error = _WriteQueuedChunks();
+	if (error != B_OK)
+		return error;
+
 	// add offset
 	if (!fOffsets.Add(fCompressedHeapSize)) {
 		fErrorOutput->PrintError("Out of memory!\n");
 		return B_NO_MEMORY;
 	}
 
-	// Try to use compression only for data large enough.
-	bool compress = mayCompress && size >= (off_t)kCompressionSizeThreshold;
 	if (compress) {
-		status_t error = _WriteDataCompressed(data, size);
+		error = _WriteDataCompressed(data, size);
 		if (error != B_OK) {
 			if (error != B_BUFFER_OVERFLOW)
 				return error;
@@ -548,7 +772,7 @@ PackageFileHeapWriter::_WriteChunk(const void* data, size_t size,
 
 	// Write uncompressed, if necessary.
 	if (!compress) {
-		status_t error = _WriteDataUncompressed(data, size);
+		error = _WriteDataUncompressed(data, size);
 		if (error != B_OK)
 			return error;
 	}
@@ -558,13 +782,68 @@ PackageFileHeapWriter::_WriteChunk(const void* data, size_t size,
 
 
 status_t
-PackageFileHeapWriter::_WriteDataCompressed(const void* data, size_t size)
+PackageFileHeapWriter::_QueueChunk(const void* data, size_t size)
+{
+	if (fParallelCompressor->IsFull()) {
+		status_t error = _WriteOldestQueuedChunk();
+		if (error != B_OK)
+			return error;
+	}
+
+	fParallelCompressor->Queue(data, size);
+	return B_OK;
+}
+
+
+status_t
+PackageFileHeapWriter::_WriteOldestQueuedChunk()
+{
+	ParallelCompressor::Job& job = fParallelCompressor->WaitForOldestJob();
+	fParallelCompressor->OldestJobWritten();
+
+	if (job.status != B_OK && job.status != B_BUFFER_OVERFLOW)
+		return job.status;
+
+	if (!fOffsets.Add(fCompressedHeapSize)) {
+		fErrorOutput->PrintError("Out of memory!\n");
+		return B_NO_MEMORY;
+	}
+
+	if (job.status == B_OK)
+		return _WriteDataUncompressed(job.compressedData, job.compressedSize);
+	return _WriteDataUncompressed(job.data, job.size);
+}
+
+
+status_t
+PackageFileHeapWriter::_WriteQueuedChunks()
+{
+	if (fParallelCompressor == NULL)
+		return B_OK;
+
+	while (!fParallelCompressor->IsEmpty()) {
+		status_t error = _WriteOldestQueuedChunk();
+		if (error != B_OK)
+			return error;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Compresses the given chunk data into \a compressedDataBuffer.
+	Returns \c B_BUFFER_OVERFLOW, if the data should rather be stored
+	uncompressed. May be called on any thread.
+*/
+status_t
+PackageFileHeapWriter::_CompressChunkData(const void* data, size_t size,
+	void* compressedDataBuffer, size_t& _compressedSize)
 {
 	if (fCompressionAlgorithm == NULL)
 		return B_BUFFER_OVERFLOW;
 
 	const iovec uncompressed = { (void*)data, size };
-	iovec compressed = { fCompressedDataBuffer, size };
+	iovec compressed = { compressedDataBuffer, size };
 	status_t error = fCompressionAlgorithm->algorithm->CompressBuffer(
 		uncompressed, compressed,
 		fCompressionAlgorithm->parameters);
@@ -580,7 +859,21 @@ PackageFileHeapWriter::_WriteDataCompressed(const void* data, size_t size)
 	if (compressed.iov_len == size)
 		return B_BUFFER_OVERFLOW;
 
-	return _WriteDataUncompressed(fCompressedDataBuffer, compressed.iov_len);
+	_compressedSize = compressed.iov_len;
+	return B_OK;
+}
+
+
+status_t
+PackageFileHeapWriter::_WriteDataCompressed(const void* data, size_t size)
+{
+	size_t compressedSize;
+	status_t error = _CompressChunkData(data, size, fCompressedDataBuffer,
+		compressedSize);
+	if (error != B_OK)
+		return error;
+
+	return _WriteDataUncompressed(fCompressedDataBuffer, compressedSize);
 }
 
 
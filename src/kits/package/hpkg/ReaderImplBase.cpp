@@ -1409,7 +1409,10 @@ ReaderImplBase::ReadBuffer(off_t offset, void* buffer, size_t size)
 status_t
 ReaderImplBase::ReadSection(const PackageFileSection& section)
 {
-	return fHeapReader->ReadData(section.offset,
+	// The sections are read only once, so there's no point in going through
+	// the cache. The raw heap reader decompresses the chunks straight into
+	// the section buffer.
+	return fRawHeapReader->ReadData(section.offset,
 		section.data, section.uncompressedLength);
 }
 
@@ -318,7 +318,7 @@ BPackageManager::Update(const BSolverPackageSpecifierList& packages)
 	// install/uninstall packages
 	_AnalyzeResult();
 	_ConfirmChanges();
-	_ApplyPackageChanges();
+	_ApplyPackageChanges(false, true);
 }
 
 
@@ -338,7 +338,7 @@ BPackageManager::FullSync()
 	// install/uninstall packages
 	_AnalyzeResult();
 	_ConfirmChanges();
-	_ApplyPackageChanges();
+	_ApplyPackageChanges(false, true);
 }
 
 
@@ -509,15 +509,20 @@ BPackageManager::_ConfirmChanges(bool fromMostSpecific)
 
 
 void
-BPackageManager::_ApplyPackageChanges(bool fromMostSpecific)
+BPackageManager::_ApplyPackageChanges(bool fromMostSpecific,
+	bool skipUnchangedPackages)
 {
 	int32 count = fInstalledRepositories.CountItems();
 	if (fromMostSpecific) {
-		for (int32 i = count - 1; i >= 0; i--)
-			_PreparePackageChanges(*fInstalledRepositories.ItemAt(i));
+		for (int32 i = count - 1; i >= 0; i--) {
+			_PreparePackageChanges(*fInstalledRepositories.ItemAt(i),
+				skipUnchangedPackages);
+		}
 	} else {
-		for (int32 i = 0; i < count; i++)
-			_PreparePackageChanges(*fInstalledRepositories.ItemAt(i));
+		for (int32 i = 0; i < count; i++) {
+			_PreparePackageChanges(*fInstalledRepositories.ItemAt(i),
+				skipUnchangedPackages);
+		}
 	}
 
 	for (int32 i = 0; Transaction* transaction = fTransactions.ItemAt(i); i++)
@@ -529,7 +534,7 @@ BPackageManager::_ApplyPackageChanges(bool fromMostSpecific)
 
 void
 BPackageManager::_PreparePackageChanges(
-	InstalledRepository& installationRepository)
+	InstalledRepository& installationRepository, bool skipUnchangedPackages)
 {
 	if (!installationRepository.HasChanges())
 		return;
@@ -550,6 +555,9 @@ BPackageManager::_PreparePackageChanges(
 	if (error != B_OK)
 		DIE(error, "Failed to create transaction");
 
+	transaction->ActivationTransaction().SetSkipUnchangedPackages(
+		skipUnchangedPackages);
+
 	// download the new packages and prepare the transaction
 	for (int32 i = 0; BSolverPackage* package = packagesToActivate.ItemAt(i);
 		i++) {
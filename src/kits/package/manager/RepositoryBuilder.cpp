@@ -12,11 +12,16 @@
 
 #include <errno.h>
 #include <dirent.h>
+#include <unistd.h>
 
 #include <Entry.h>
+#include <File.h>
+#include <package/hpkg/ErrorOutput.h>
 #include <package/RepositoryCache.h>
 #include <Path.h>
 
+#include <package/hpkg/DeltaPackageWriter.h>
+
 #include <AutoDeleter.h>
 #include <AutoDeleterPosix.h>
 
@@ -58,6 +63,23 @@ private:
 };
 
 
+class CollectingErrorOutput : public BHPKG::BErrorOutput {
+public:
+	virtual void PrintErrorVarArgs(const char* format, va_list args)
+	{
+		fErrors << BString().SetToFormatVarArgs(format, args);
+	}
+
+	const BString& Errors() const
+	{
+		return fErrors;
+	}
+
+private:
+	BString		fErrors;
+};
+
+
 } // unnamed namespace
 
 
@@ -253,6 +275,45 @@ BRepositoryBuilder::AddToSolver(BSolver* solver, bool isInstalled)
 }
 
 
+/*!	Creates a delta file at \a deltaPath, which turns the package file at
+	\a oldPackagePath into the one at \a newPackagePath. Clients can fetch
+	the delta instead of the complete new package, if they have the old one.
+*/
+BRepositoryBuilder&
+BRepositoryBuilder::CreatePackageDelta(const char* oldPackagePath,
+	const char* newPackagePath, const char* deltaPath)
+{
+	BFile oldPackageFile;
+	status_t error = oldPackageFile.SetTo(oldPackagePath, B_READ_ONLY);
+	if (error != B_OK)
+		DIE(error, "failed to open package file \"%s\"", oldPackagePath);
+
+	BFile newPackageFile;
+	error = newPackageFile.SetTo(newPackagePath, B_READ_ONLY);
+	if (error != B_OK)
+		DIE(error, "failed to open package file \"%s\"", newPackagePath);
+
+	BFile deltaFile;
+	error = deltaFile.SetTo(deltaPath,
+		B_READ_WRITE | B_CREATE_FILE | B_ERASE_FILE);
+	if (error != B_OK)
+		DIE(error, "failed to create delta file \"%s\"", deltaPath);
+
+	CollectingErrorOutput errorOutput;
+	BHPKG::BPrivate::DeltaPackageWriter deltaWriter(&errorOutput);
+	error = deltaWriter.Create(&oldPackageFile, &newPackageFile, &deltaFile);
+	if (error != B_OK) {
+		deltaFile.Unset();
+		unlink(deltaPath);
+		DIE_DETAILS(errorOutput.Errors(), error,
+			"failed to create delta from \"%s\" to \"%s\"", oldPackagePath,
+			newPackagePath);
+	}
+
+	return *this;
+}
+
+
 }	// namespace BPrivate
 
 }	// namespace BManager
@@ -10,7 +10,10 @@
 #include "LibsolvSolver.h"
 
 #include <errno.h>
+#include <stdio.h>
+#include <sys/stat.h>
 #include <sys/utsname.h>
+#include <unistd.h>
 
 #include <new>
 
@@ -18,6 +21,8 @@
 #include <solv/poolarch.h>
 #include <solv/repo.h>
 #include <solv/repo_haiku.h>
+#include <solv/repo_solv.h>
+#include <solv/repo_write.h>
 #include <solv/selection.h>
 #include <solv/solverdebug.h>
 
@@ -30,7 +35,11 @@
 #include <package/solver/SolverRepository.h>
 #include <package/solver/SolverResult.h>
 
+#include <FindDirectory.h>
+#include <Path.h>
+
 #include <AutoDeleter.h>
+#include <AutoDeleterPosix.h>
 #include <ObjectList.h>
 
 
@@ -38,6 +47,36 @@
 // abort()s. Obviously that isn't good behavior for a library.
 
 
+// The pools built for (not installed) repositories are cached in libsolv's
+// own binary format, so that they don't have to be re-created from the
+// package infos every time. A cache file starts with a SolvCacheHeader,
+// followed by the data written by repo_write().
+static const char* const kSolvCacheDirectory = "package-solver";
+static const uint32 kSolvCacheMagic = 'HSlv';
+static const uint32 kSolvCacheVersion = 1;
+
+
+struct SolvCacheHeader {
+	uint32	magic;
+	uint32	version;
+	uint64	fingerprint;
+	uint32	packageCount;
+	uint32	reserved;
+};
+
+
+static inline uint64
+fingerprint_add(uint64 hash, const char* string)
+{
+	// FNV-1a, including the terminating null
+	do {
+		hash = (hash ^ (uint8)*string) * 0x100000001b3ULL;
+	} while (*string++ != '\0');
+
+	return hash;
+}
+
+
 BSolver*
 BPackageKit::create_solver()
 {
@@ -748,22 +787,23 @@ LibsolvSolver::_AddRepositories()
 		repo->priority = -1 - repository->Priority();
 		repo->appdata = (void*)repositoryInfo;
 
-		int32 packageCount = repository->CountPackages();
-		for (int32 k = 0; k < packageCount; k++) {
-			BSolverPackage* package = repository->PackageAt(k);
-			Id solvableId = repo_add_haiku_package_info(repo, package->Info(),
-				REPO_REUSE_REPODATA | REPO_NO_INTERNALIZE);
-
-			try {
-				fSolvablePackages[solvableId] = package;
-				fPackageSolvables[package] = solvableId;
-			} catch (std::bad_alloc&) {
-				return B_NO_MEMORY;
-			}
+		// The installed repository changes too frequently to be worth
+		// caching. Other repositories can only be cached, if their packages
+		// can be identified reliably.
+		uint64 fingerprint;
+		bool useCache = !repository->IsInstalled()
+			&& _RepositoryFingerprint(repository, fingerprint) == B_OK;
+
+		if (!useCache
+			|| _ReadCachedRepository(repositoryInfo, fingerprint) != B_OK) {
+			error = _AddRepositoryPackages(repositoryInfo);
+			if (error != B_OK)
+				return error;
+
+			if (useCache)
+				_WriteCachedRepository(repositoryInfo, fingerprint);
 		}
 
-		repo_internalize(repo);
-
 		if (repository->IsInstalled()) {
 			fInstalledRepository = repositoryInfo;
 			pool_set_installed(fPool, repo);
@@ -779,6 +819,209 @@ LibsolvSolver::_AddRepositories()
 }
 
 
+status_t
+LibsolvSolver::_AddRepositoryPackages(RepositoryInfo* repositoryInfo)
+{
+	BSolverRepository* repository = repositoryInfo->Repository();
+	Repo* repo = repositoryInfo->SolvRepo();
+
+	int32 packageCount = repository->CountPackages();
+	for (int32 i = 0; i < packageCount; i++) {
+		BSolverPackage* package = repository->PackageAt(i);
+		Id solvableId = repo_add_haiku_package_info(repo, package->Info(),
+			REPO_REUSE_REPODATA | REPO_NO_INTERNALIZE);
+
+		try {
+			fSolvablePackages[solvableId] = package;
+			fPackageSolvables[package] = solvableId;
+		} catch (std::bad_alloc&) {
+			return B_NO_MEMORY;
+		}
+	}
+
+	repo_internalize(repo);
+
+	return B_OK;
+}
+
+
+/*!	Computes a hash identifying the packages of the given repository.
+	Packages from a repository carry the SHA-256 checksum of their package
+	file, so any change of a package file changes the fingerprint as well.
+	A package rebuilt without a version bump keeps name and version, though,
+	so if any package lacks a checksum, \c B_NOT_SUPPORTED is returned and the
+	repository must not be cached.
+*/
+status_t
+LibsolvSolver::_RepositoryFingerprint(BSolverRepository* repository,
+	uint64& _fingerprint) const
+{
+	uint64 hash = 0xcbf29ce484222325ULL;
+	hash = fingerprint_add(hash, repository->Name());
+
+	int32 packageCount = repository->CountPackages();
+	for (int32 i = 0; i < packageCount; i++) {
+		const BPackageInfo& info = repository->PackageAt(i)->Info();
+		if (info.Checksum().IsEmpty())
+			return B_NOT_SUPPORTED;
+
+		hash = fingerprint_add(hash, info.Name());
+		hash = fingerprint_add(hash, info.Checksum());
+		hash = fingerprint_add(hash,
+			info.InitCheck() == B_OK ? "ok" : "invalid");
+	}
+
+	_fingerprint = hash;
+	return B_OK;
+}
+
+
+status_t
+LibsolvSolver::_GetRepositoryCachePath(BSolverRepository* repository,
+	BPath& _path) const
+{
+#ifdef HAIKU_TARGET_PLATFORM_HAIKU
+	status_t error = find_directory(B_USER_CACHE_DIRECTORY, &_path);
+	if (error != B_OK)
+		return error;
+
+	error = _path.Append(kSolvCacheDirectory);
+	if (error != B_OK)
+		return error;
+
+	BString fileName(repository->Name());
+	if (fileName.IsEmpty())
+		return B_BAD_VALUE;
+	fileName.ReplaceAll('/', '_');
+	fileName << ".solv";
+
+	return _path.Append(fileName);
+#else
+	return B_NOT_SUPPORTED;
+#endif
+}
+
+
+/*!	Tries to fill the repository's (empty) libsolv repo from the cache file.
+	The cache is only used, if its fingerprint matches and its solvables
+	correspond one-to-one to the repository's packages.
+*/
+status_t
+LibsolvSolver::_ReadCachedRepository(RepositoryInfo* repositoryInfo,
+	uint64 fingerprint)
+{
+	BSolverRepository* repository = repositoryInfo->Repository();
+	Repo* repo = repositoryInfo->SolvRepo();
+
+	BPath path;
+	status_t error = _GetRepositoryCachePath(repository, path);
+	if (error != B_OK)
+		return error;
+
+	FileCloser file(fopen(path.Path(), "r"));
+	if (!file.IsSet())
+		return errno;
+
+	int32 packageCount = repository->CountPackages();
+
+	SolvCacheHeader header;
+	if (fread(&header, sizeof(header), 1, file.Get()) != 1
+		|| header.magic != kSolvCacheMagic
+		|| header.version != kSolvCacheVersion
+		|| header.fingerprint != fingerprint
+		|| header.packageCount != (uint32)packageCount) {
+		return B_BAD_DATA;
+	}
+
+	if (repo_add_solv(repo, file.Get(), 0) != 0) {
+		repo_empty(repo, 1);
+		return B_BAD_DATA;
+	}
+
+	// Packages with invalid infos weren't added to the repo. The others must
+	// match the solvables in order.
+	Id solvableId = repo->start;
+	for (int32 i = 0; i < packageCount; i++) {
+		const BPackageInfo& info = repository->PackageAt(i)->Info();
+		if (info.InitCheck() != B_OK)
+			continue;
+
+		BString name("pkg:");
+		name << info.Name();
+		if (solvableId >= repo->end
+			|| name != pool_id2str(fPool,
+				pool_id2solvable(fPool, solvableId)->name)) {
+			repo_empty(repo, 1);
+			return B_BAD_DATA;
+		}
+		solvableId++;
+	}
+
+	if (solvableId != repo->end) {
+		repo_empty(repo, 1);
+		return B_BAD_DATA;
+	}
+
+	solvableId = repo->start;
+	for (int32 i = 0; i < packageCount; i++) {
+		BSolverPackage* package = repository->PackageAt(i);
+		Id packageSolvableId = 0;
+		if (package->Info().InitCheck() == B_OK)
+			packageSolvableId = solvableId++;
+
+		try {
+			fSolvablePackages[packageSolvableId] = package;
+			fPackageSolvables[package] = packageSolvableId;
+		} catch (std::bad_alloc&) {
+			return B_NO_MEMORY;
+		}
+	}
+
+	return B_OK;
+}
+
+
+void
+LibsolvSolver::_WriteCachedRepository(RepositoryInfo* repositoryInfo,
+	uint64 fingerprint) const
+{
+	BSolverRepository* repository = repositoryInfo->Repository();
+
+	BPath path;
+	if (_GetRepositoryCachePath(repository, path) != B_OK)
+		return;
+
+	BPath directoryPath;
+	if (path.GetParent(&directoryPath) != B_OK)
+		return;
+	mkdir(directoryPath.Path(), 0755);
+
+	// write to a temporary file first and move it into place, so that
+	// concurrent readers never see a partially written cache
+	BString tempPath(path.Path());
+	tempPath << '.' << (int32)getpid();
+
+	FileCloser file(fopen(tempPath.String(), "w"));
+	if (!file.IsSet())
+		return;
+
+	SolvCacheHeader header;
+	header.magic = kSolvCacheMagic;
+	header.version = kSolvCacheVersion;
+	header.fingerprint = fingerprint;
+	header.packageCount = repository->CountPackages();
+	header.reserved = 0;
+
+	bool success = fwrite(&header, sizeof(header), 1, file.Get()) == 1
+		&& repo_write(repositoryInfo->SolvRepo(), file.Get()) == 0;
+	if (fclose(file.Detach()) != 0)
+		success = false;
+
+	if (!success || rename(tempPath.String(), path.Path()) != 0)
+		unlink(tempPath.String());
+}
+
+
 LibsolvSolver::RepositoryInfo*
 LibsolvSolver::_InstalledRepository() const
 {
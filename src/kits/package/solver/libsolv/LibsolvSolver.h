@@ -19,6 +19,9 @@
 using namespace BPackageKit;
 
 
+class BPath;
+
+
 namespace BPackageKit {
 	class BPackageResolvableExpression;
 	class BSolverPackage;
@@ -95,6 +98,21 @@ private:
 
 			bool				_HaveRepositoriesChanged() const;
 			status_t			_AddRepositories();
+			status_t			_AddRepositoryPackages(
+									RepositoryInfo* repositoryInfo);
+
+			status_t			_RepositoryFingerprint(
+									BSolverRepository* repository,
+									uint64& _fingerprint) const;
+			status_t			_GetRepositoryCachePath(
+									BSolverRepository* repository,
+									BPath& _path) const;
+			status_t			_ReadCachedRepository(
+									RepositoryInfo* repositoryInfo,
+									uint64 fingerprint);
+			void				_WriteCachedRepository(
+									RepositoryInfo* repositoryInfo,
+									uint64 fingerprint) const;
 			RepositoryInfo*		_InstalledRepository() const;
 			RepositoryInfo*		_GetRepositoryInfo(
 									BSolverRepository* repository) const;
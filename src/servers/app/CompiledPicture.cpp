@@ -0,0 +1,1220 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "CompiledPicture.h"
+
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+
+#include <AffineTransform.h>
+#include <Gradient.h>
+#include <PicturePlayer.h>
+#include <Shape.h>
+
+
+using BPrivate::PicturePlayerCallbacks;
+
+
+enum {
+	kMovePenBy = 0,
+	kStrokeLine,
+	kStrokeLineGradient,
+	kDrawRect,
+	kDrawRectGradient,
+	kDrawRoundRect,
+	kDrawRoundRectGradient,
+	kDrawBezier,
+	kDrawBezierGradient,
+	kDrawArc,
+	kDrawArcGradient,
+	kDrawEllipse,
+	kDrawEllipseGradient,
+	kDrawPolygon,
+	kDrawPolygonGradient,
+	kDrawShape,
+	kDrawShapeGradient,
+	kDrawString,
+	kDrawStringLocations,
+	kDrawPixels,
+	kDrawPicture,
+	kSetClippingRects,
+	kClipToPicture,
+	kClipToRect,
+	kClipToShape,
+	kPushState,
+	kPopState,
+	kEnterStateChange,
+	kExitStateChange,
+	kEnterFontState,
+	kExitFontState,
+	kSetOrigin,
+	kSetPenLocation,
+	kSetDrawingMode,
+	kSetLineMode,
+	kSetPenSize,
+	kSetForeColor,
+	kSetBackColor,
+	kSetStipplePattern,
+	kSetScale,
+	kSetFontFamily,
+	kSetFontStyle,
+	kSetFontSpacing,
+	kSetFontSize,
+	kSetFontRotation,
+	kSetFontEncoding,
+	kSetFontFlags,
+	kSetFontShear,
+	kSetFontFace,
+	kSetBlendingMode,
+	kSetFillRule,
+	kSetTransform,
+	kTranslateBy,
+	kScaleBy,
+	kRotateBy,
+	kBlendLayer
+};
+
+enum {
+	kFill		= 0x01,
+	kClosed		= 0x02,
+	kInverse	= 0x04
+};
+
+
+struct line_arguments {
+	BPoint			start;
+	BPoint			end;
+};
+
+struct round_rect_arguments {
+	BRect			rect;
+	BPoint			radii;
+};
+
+struct arc_arguments {
+	BPoint			center;
+	BPoint			radii;
+	float			start_theta;
+	float			arc_theta;
+};
+
+struct string_arguments {
+	float			space_escapement;
+	float			non_space_escapement;
+	// followed by the characters
+};
+
+struct string_locations_arguments {
+	uint32			length;
+	uint32			_reserved;
+	// followed by the locations, and the characters
+};
+
+struct pixels_arguments {
+	BRect			source;
+	BRect			destination;
+	uint32			width;
+	uint32			height;
+	uint32			bytes_per_row;
+	color_space		format;
+	uint32			flags;
+	uint32			_reserved;
+	// followed by the pixel data
+};
+
+struct picture_arguments {
+	BPoint			where;
+	int32			token;
+};
+
+struct line_mode_arguments {
+	cap_mode		cap;
+	join_mode		join;
+	float			miter_limit;
+};
+
+struct blending_arguments {
+	source_alpha	source;
+	alpha_function	function;
+};
+
+struct clip_shape_arguments {
+	int32			op_count;
+	int32			point_count;
+	// followed by the ops, and the points
+};
+
+struct transform_arguments {
+	double			sx;
+	double			shy;
+	double			shx;
+	double			sy;
+	double			tx;
+	double			ty;
+};
+
+struct double_arguments {
+	double			x;
+	double			y;
+};
+
+
+static inline size_t
+align_arguments(size_t size)
+{
+	return (size + 7) & ~(size_t)7;
+}
+
+
+//	#pragma mark - Recorder
+
+
+/*!	Receives the commands of the picture from a PicturePlayer, and appends
+	them to the compiled picture.
+*/
+class CompiledPicture::Recorder : public PicturePlayerCallbacks {
+public:
+	Recorder(CompiledPicture& picture)
+		:
+		fPicture(picture)
+	{
+	}
+
+	virtual void MovePenBy(const BPoint& delta)
+	{
+		command* last = _LastCommand();
+		if (last != NULL && (last->type == kMovePenBy
+				|| last->type == kSetPenLocation)) {
+			*(BPoint*)fPicture._ArgumentsOf(*last) += delta;
+			return;
+		}
+
+		_Add(kMovePenBy, delta);
+	}
+
+	virtual void StrokeLine(const BPoint& start, const BPoint& end)
+	{
+		line_arguments arguments = { start, end };
+		_Add(kStrokeLine, arguments);
+	}
+
+	virtual void DrawRect(const BRect& rect, bool fill)
+	{
+		_Add(kDrawRect, rect, fill ? kFill : 0);
+	}
+
+	virtual void DrawRoundRect(const BRect& rect, const BPoint& radii,
+		bool fill)
+	{
+		round_rect_arguments arguments = { rect, radii };
+		_Add(kDrawRoundRect, arguments, fill ? kFill : 0);
+	}
+
+	virtual void DrawBezier(const BPoint controlPoints[4], bool fill)
+	{
+		_AddData(kDrawBezier, controlPoints, 4 * sizeof(BPoint), 4,
+			fill ? kFill : 0);
+	}
+
+	virtual void DrawArc(const BPoint& center, const BPoint& radii,
+		float startTheta, float arcTheta, bool fill)
+	{
+		arc_arguments arguments = { center, radii, startTheta, arcTheta };
+		_Add(kDrawArc, arguments, fill ? kFill : 0);
+	}
+
+	virtual void DrawEllipse(const BRect& rect, bool fill)
+	{
+		_Add(kDrawEllipse, rect, fill ? kFill : 0);
+	}
+
+	virtual void DrawPolygon(size_t numPoints, const BPoint points[],
+		bool isClosed, bool fill)
+	{
+		_AddData(kDrawPolygon, points, numPoints * sizeof(BPoint), numPoints,
+			(fill ? kFill : 0) | (isClosed ? kClosed : 0));
+	}
+
+	virtual void DrawShape(const BShape& shape, bool fill)
+	{
+		command* command = _AddShape(kDrawShape, shape);
+		if (command != NULL)
+			command->flags = fill ? kFill : 0;
+
+		// shapes are offset by the pen location, which may be inherited
+		fPicture.fHasKnownBounds = false;
+	}
+
+	virtual void DrawString(const char* string, size_t length,
+		float spaceEscapement, float nonSpaceEscapement)
+	{
+		command* command = fPicture._AddCommand(kDrawString,
+			sizeof(string_arguments) + length);
+		if (command == NULL)
+			return;
+
+		command->count = length;
+
+		uint8* data = fPicture._ArgumentsOf(*command);
+		string_arguments* arguments = (string_arguments*)data;
+		arguments->space_escapement = spaceEscapement;
+		arguments->non_space_escapement = nonSpaceEscapement;
+		memcpy(data + sizeof(string_arguments), string, length);
+
+		// the bounding box of text is not computed yet
+		fPicture.fHasKnownBounds = false;
+	}
+
+	virtual void DrawPixels(const BRect& source, const BRect& destination,
+		uint32 width, uint32 height, size_t bytesPerRow,
+		color_space pixelFormat, uint32 flags, const void* pixels,
+		size_t length)
+	{
+		command* command = fPicture._AddCommand(kDrawPixels,
+			sizeof(pixels_arguments) + length);
+		if (command == NULL)
+			return;
+
+		command->count = length;
+
+		uint8* data = fPicture._ArgumentsOf(*command);
+		pixels_arguments* arguments = (pixels_arguments*)data;
+		arguments->source = source;
+		arguments->destination = destination;
+		arguments->width = width;
+		arguments->height = height;
+		arguments->bytes_per_row = bytesPerRow;
+		arguments->format = pixelFormat;
+		arguments->flags = flags;
+		memcpy(data + sizeof(pixels_arguments), pixels, length);
+	}
+
+	virtual void DrawPicture(const BPoint& where, int32 token)
+	{
+		picture_arguments arguments = { where, token };
+		_Add(kDrawPicture, arguments);
+
+		// the bounds of the other picture are not taken into account
+		fPicture.fHasKnownBounds = false;
+	}
+
+	virtual void SetClippingRects(size_t numRects,
+		const clipping_rect rects[])
+	{
+		_AddData(kSetClippingRects, rects, numRects * sizeof(clipping_rect),
+			numRects);
+	}
+
+	virtual void ClipToPicture(int32 token, const BPoint& where,
+		bool clipToInverse)
+	{
+		picture_arguments arguments = { where, token };
+		_Add(kClipToPicture, arguments, clipToInverse ? kInverse : 0);
+	}
+
+	virtual void PushState()
+	{
+		_AddEmpty(kPushState);
+	}
+
+	virtual void PopState()
+	{
+		_AddEmpty(kPopState);
+	}
+
+	virtual void EnterStateChange()
+	{
+		_AddEmpty(kEnterStateChange);
+	}
+
+	virtual void ExitStateChange()
+	{
+		_AddEmpty(kExitStateChange);
+	}
+
+	virtual void EnterFontState()
+	{
+		_AddEmpty(kEnterFontState);
+	}
+
+	virtual void ExitFontState()
+	{
+		_AddEmpty(kExitFontState);
+	}
+
+	virtual void SetOrigin(const BPoint& origin)
+	{
+		_Add(kSetOrigin, origin);
+	}
+
+	virtual void SetPenLocation(const BPoint& location)
+	{
+		command* last = _LastCommand();
+		if (last != NULL && last->type == kMovePenBy) {
+			// the relative movement is overridden anyway
+			last->type = kSetPenLocation;
+			*(BPoint*)fPicture._ArgumentsOf(*last) = location;
+			return;
+		}
+
+		_SetState(kSetPenLocation, location);
+	}
+
+	virtual void SetDrawingMode(drawing_mode mode)
+	{
+		_SetState(kSetDrawingMode, (int32)mode);
+	}
+
+	virtual void SetLineMode(cap_mode capMode, join_mode joinMode,
+		float miterLimit)
+	{
+		line_mode_arguments arguments = { capMode, joinMode, miterLimit };
+		_SetState(kSetLineMode, arguments);
+	}
+
+	virtual void SetPenSize(float size)
+	{
+		_Add(kSetPenSize, size);
+	}
+
+	virtual void SetForeColor(const rgb_color& color)
+	{
+		_SetState(kSetForeColor, color);
+	}
+
+	virtual void SetBackColor(const rgb_color& color)
+	{
+		_SetState(kSetBackColor, color);
+	}
+
+	virtual void SetStipplePattern(const pattern& stipplePattern)
+	{
+		_SetState(kSetStipplePattern, stipplePattern);
+	}
+
+	virtual void SetScale(float scale)
+	{
+		_Add(kSetScale, scale);
+	}
+
+	virtual void SetFontFamily(const char* familyName, size_t length)
+	{
+		_AddData(kSetFontFamily, familyName, length, length);
+	}
+
+	virtual void SetFontStyle(const char* styleName, size_t length)
+	{
+		_AddData(kSetFontStyle, styleName, length, length);
+	}
+
+	virtual void SetFontSpacing(uint8 spacing)
+	{
+		_SetState(kSetFontSpacing, (uint32)spacing);
+	}
+
+	virtual void SetFontSize(float size)
+	{
+		_SetState(kSetFontSize, size);
+	}
+
+	virtual void SetFontRotation(float rotation)
+	{
+		_SetState(kSetFontRotation, rotation);
+	}
+
+	virtual void SetFontEncoding(uint8 encoding)
+	{
+		_SetState(kSetFontEncoding, (uint32)encoding);
+	}
+
+	virtual void SetFontFlags(uint32 flags)
+	{
+		_SetState(kSetFontFlags, flags);
+	}
+
+	virtual void SetFontShear(float shear)
+	{
+		_SetState(kSetFontShear, shear);
+	}
+
+	virtual void SetFontFace(uint16 face)
+	{
+		_Add(kSetFontFace, (uint32)face);
+	}
+
+	virtual void SetBlendingMode(source_alpha alphaSourceMode,
+		alpha_function alphaFunctionMode)
+	{
+		blending_arguments arguments = { alphaSourceMode, alphaFunctionMode };
+		_SetState(kSetBlendingMode, arguments);
+	}
+
+	virtual void SetFillRule(int32 fillRule)
+	{
+		_SetState(kSetFillRule, fillRule);
+	}
+
+	virtual void SetTransform(const BAffineTransform& transform)
+	{
+		// any transformation right before is overridden by this one
+		command* last = _LastCommand();
+		while (last != NULL && _IsTransform(last->type)) {
+			fPicture.fCommandCount--;
+			last = _LastCommand();
+		}
+
+		transform_arguments arguments = { transform.sx, transform.shy,
+			transform.shx, transform.sy, transform.tx, transform.ty };
+		_Add(kSetTransform, arguments);
+	}
+
+	virtual void TranslateBy(double x, double y)
+	{
+		command* last = _LastCommand();
+		if (last != NULL && last->type == kSetTransform) {
+			BAffineTransform transform = _TransformOf(*last);
+			transform.PreTranslateBy(x, y);
+			_SetTransformOf(*last, transform);
+			return;
+		}
+		if (last != NULL && last->type == kTranslateBy) {
+			double_arguments* arguments
+				= (double_arguments*)fPicture._ArgumentsOf(*last);
+			arguments->x += x;
+			arguments->y += y;
+			return;
+		}
+
+		double_arguments arguments = { x, y };
+		_Add(kTranslateBy, arguments);
+	}
+
+	virtual void ScaleBy(double x, double y)
+	{
+		command* last = _LastCommand();
+		if (last != NULL && last->type == kSetTransform) {
+			BAffineTransform transform = _TransformOf(*last);
+			transform.PreScaleBy(x, y);
+			_SetTransformOf(*last, transform);
+			return;
+		}
+		if (last != NULL && last->type == kScaleBy) {
+			double_arguments* arguments
+				= (double_arguments*)fPicture._ArgumentsOf(*last);
+			arguments->x *= x;
+			arguments->y *= y;
+			return;
+		}
+
+		double_arguments arguments = { x, y };
+		_Add(kScaleBy, arguments);
+	}
+
+	virtual void RotateBy(double angleRadians)
+	{
+		command* last = _LastCommand();
+		if (last != NULL && last->type == kSetTransform) {
+			BAffineTransform transform = _TransformOf(*last);
+			transform.PreRotateBy(angleRadians);
+			_SetTransformOf(*last, transform);
+			return;
+		}
+		if (last != NULL && last->type == kRotateBy) {
+			*(double*)fPicture._ArgumentsOf(*last) += angleRadians;
+			return;
+		}
+
+		_Add(kRotateBy, angleRadians);
+	}
+
+	virtual void BlendLayer(Layer* layer)
+	{
+		_Add(kBlendLayer, layer);
+
+		// the layer is drawn with the bounds of its own picture
+		fPicture.fHasKnownBounds = false;
+	}
+
+	virtual void ClipToRect(const BRect& rect, bool inverse)
+	{
+		_Add(kClipToRect, rect, inverse ? kInverse : 0);
+	}
+
+	virtual void ClipToShape(int32 opCount, const uint32 opList[],
+		int32 ptCount, const BPoint ptList[], bool inverse)
+	{
+		size_t opSize = opCount * sizeof(uint32);
+		size_t pointSize = ptCount * sizeof(BPoint);
+
+		command* command = fPicture._AddCommand(kClipToShape,
+			sizeof(clip_shape_arguments) + opSize + pointSize);
+		if (command == NULL)
+			return;
+
+		command->flags = inverse ? kInverse : 0;
+
+		uint8* data = fPicture._ArgumentsOf(*command);
+		clip_shape_arguments* arguments = (clip_shape_arguments*)data;
+		arguments->op_count = opCount;
+		arguments->point_count = ptCount;
+		data += sizeof(clip_shape_arguments);
+		memcpy(data, opList, opSize);
+		memcpy(data + opSize, ptList, pointSize);
+	}
+
+	virtual void DrawStringLocations(const char* string, size_t length,
+		const BPoint locations[], size_t locationCount)
+	{
+		size_t locationSize = locationCount * sizeof(BPoint);
+
+		command* command = fPicture._AddCommand(kDrawStringLocations,
+			sizeof(string_locations_arguments) + locationSize + length);
+		if (command == NULL)
+			return;
+
+		command->count = locationCount;
+
+		uint8* data = fPicture._ArgumentsOf(*command);
+		((string_locations_arguments*)data)->length = length;
+		data += sizeof(string_locations_arguments);
+		memcpy(data, locations, locationSize);
+		memcpy(data + locationSize, string, length);
+
+		fPicture.fHasKnownBounds = false;
+	}
+
+	virtual void DrawRectGradient(const BRect& rect, BGradient& gradient,
+		bool fill)
+	{
+		_AddGradient(_Add(kDrawRectGradient, rect, fill ? kFill : 0),
+			gradient);
+	}
+
+	virtual void DrawRoundRectGradient(const BRect& rect, const BPoint& radii,
+		BGradient& gradient, bool fill)
+	{
+		round_rect_arguments arguments = { rect, radii };
+		_AddGradient(_Add(kDrawRoundRectGradient, arguments, fill ? kFill : 0),
+			gradient);
+	}
+
+	virtual void DrawBezierGradient(const BPoint controlPoints[4],
+		BGradient& gradient, bool fill)
+	{
+		_AddGradient(_AddData(kDrawBezierGradient, controlPoints,
+			4 * sizeof(BPoint), 4, fill ? kFill : 0), gradient);
+	}
+
+	virtual void DrawArcGradient(const BPoint& center, const BPoint& radii,
+		float startTheta, float arcTheta, BGradient& gradient, bool fill)
+	{
+		arc_arguments arguments = { center, radii, startTheta, arcTheta };
+		_AddGradient(_Add(kDrawArcGradient, arguments, fill ? kFill : 0),
+			gradient);
+	}
+
+	virtual void DrawEllipseGradient(const BRect& rect, BGradient& gradient,
+		bool fill)
+	{
+		_AddGradient(_Add(kDrawEllipseGradient, rect, fill ? kFill : 0),
+			gradient);
+	}
+
+	virtual void DrawPolygonGradient(size_t numPoints, const BPoint points[],
+		bool isClosed, BGradient& gradient, bool fill)
+	{
+		_AddGradient(_AddData(kDrawPolygonGradient, points,
+			numPoints * sizeof(BPoint), numPoints,
+			(fill ? kFill : 0) | (isClosed ? kClosed : 0)), gradient);
+	}
+
+	virtual void DrawShapeGradient(const BShape& shape, BGradient& gradient,
+		bool fill)
+	{
+		command* command = _AddShape(kDrawShapeGradient, shape);
+		if (command != NULL)
+			command->flags = fill ? kFill : 0;
+		_AddGradient(command, gradient);
+
+		fPicture.fHasKnownBounds = false;
+	}
+
+	virtual void StrokeLineGradient(const BPoint& start, const BPoint& end,
+		BGradient& gradient)
+	{
+		line_arguments arguments = { start, end };
+		_AddGradient(_Add(kStrokeLineGradient, arguments), gradient);
+	}
+
+private:
+	command* _LastCommand() const
+	{
+		if (fPicture.fCommandCount == 0)
+			return NULL;
+
+		return &fPicture.fCommands[fPicture.fCommandCount - 1];
+	}
+
+	command* _AddEmpty(uint16 type)
+	{
+		return fPicture._AddCommand(type, 0);
+	}
+
+	template<typename Type>
+	command* _Add(uint16 type, const Type& arguments, uint16 flags = 0)
+	{
+		return _AddData(type, &arguments, sizeof(Type), 0, flags);
+	}
+
+	command* _AddData(uint16 type, const void* data, size_t size,
+		uint32 count, uint16 flags = 0)
+	{
+		command* command = fPicture._AddCommand(type, size);
+		if (command == NULL)
+			return NULL;
+
+		command->flags = flags;
+		command->count = count;
+		memcpy(fPicture._ArgumentsOf(*command), data, size);
+		return command;
+	}
+
+	command* _AddShape(uint16 type, const BShape& shape)
+	{
+		command* command = _AddEmpty(type);
+		if (command == NULL)
+			return NULL;
+
+		BShape* copy = new(std::nothrow) BShape(shape);
+		command->object = fPicture.fShapes.CountItems();
+		if (copy == NULL || !fPicture.fShapes.AddItem(copy)) {
+			delete copy;
+			fPicture.fStatus = B_NO_MEMORY;
+			return NULL;
+		}
+
+		return command;
+	}
+
+	void _AddGradient(command* command, const BGradient& gradient)
+	{
+		if (command == NULL)
+			return;
+
+		// only the base class is kept, since that is all the callbacks get
+		// to see as well
+		BGradient* copy = new(std::nothrow) BGradient(gradient);
+		command->gradient = fPicture.fGradients.CountItems();
+		if (copy == NULL || !fPicture.fGradients.AddItem(copy)) {
+			delete copy;
+			fPicture.fStatus = B_NO_MEMORY;
+		}
+	}
+
+	/*!	Replaces the value of an earlier state change of the same \a type,
+		as long as nothing happened in between that could have used it.
+		Otherwise, the state change is appended as usual.
+	*/
+	template<typename Type>
+	void _SetState(uint16 type, const Type& value)
+	{
+		for (int32 i = fPicture.fCommandCount - 1; i >= 0; i--) {
+			command& command = fPicture.fCommands[i];
+			if (command.type == type) {
+				*(Type*)fPicture._ArgumentsOf(command) = value;
+				return;
+			}
+			if (!_IsFoldableState(command.type))
+				break;
+		}
+
+		_Add(type, value);
+	}
+
+	BAffineTransform _TransformOf(const command& command) const
+	{
+		const transform_arguments* arguments
+			= (const transform_arguments*)fPicture._ArgumentsOf(command);
+		return BAffineTransform(arguments->sx, arguments->shy, arguments->shx,
+			arguments->sy, arguments->tx, arguments->ty);
+	}
+
+	void _SetTransformOf(const command& command,
+		const BAffineTransform& transform)
+	{
+		transform_arguments* arguments
+			= (transform_arguments*)fPicture._ArgumentsOf(command);
+		arguments->sx = transform.sx;
+		arguments->shy = transform.shy;
+		arguments->shx = transform.shx;
+		arguments->sy = transform.sy;
+		arguments->tx = transform.tx;
+		arguments->ty = transform.ty;
+	}
+
+	static bool _IsTransform(uint16 type)
+	{
+		return type == kSetTransform || type == kTranslateBy
+			|| type == kScaleBy || type == kRotateBy;
+	}
+
+	static bool _IsFoldableState(uint16 type)
+	{
+		switch (type) {
+			case kEnterStateChange:
+			case kExitStateChange:
+			case kEnterFontState:
+			case kExitFontState:
+			case kSetPenLocation:
+			case kSetDrawingMode:
+			case kSetLineMode:
+			case kSetForeColor:
+			case kSetBackColor:
+			case kSetStipplePattern:
+			case kSetFontSpacing:
+			case kSetFontSize:
+			case kSetFontRotation:
+			case kSetFontEncoding:
+			case kSetFontFlags:
+			case kSetFontShear:
+			case kSetBlendingMode:
+			case kSetFillRule:
+				return true;
+
+			default:
+				return false;
+		}
+	}
+
+private:
+	CompiledPicture&	fPicture;
+};
+
+
+//	#pragma mark - CompiledPicture
+
+
+CompiledPicture::CompiledPicture()
+	:
+	fCommands(NULL),
+	fCommandCount(0),
+	fCommandCapacity(0),
+	fArguments(NULL),
+	fArgumentsSize(0),
+	fArgumentsCapacity(0),
+	fShapes(8),
+	fGradients(8),
+	fSourceSize(0),
+	fHasKnownBounds(true),
+	fStatus(B_OK)
+{
+}
+
+
+CompiledPicture::~CompiledPicture()
+{
+	free(fCommands);
+	free(fArguments);
+}
+
+
+/*!	Decodes the picture \a data of the given \a size. The \a pictures are
+	the sub pictures the data refers to, as with PicturePlayer.
+	May only be called once per object.
+*/
+status_t
+CompiledPicture::Compile(const void* data, size_t size, BList* pictures)
+{
+	Recorder recorder(*this);
+	BPrivate::PicturePlayer player(data, size, pictures);
+
+	status_t status = player.Play(recorder);
+	if (status == B_OK)
+		status = fStatus;
+	if (status != B_OK)
+		return status;
+
+	fSourceSize = size;
+	return B_OK;
+}
+
+
+void
+CompiledPicture::Play(PicturePlayerCallbacks& callbacks) const
+{
+	for (int32 i = 0; i < fCommandCount; i++) {
+		const command& command = fCommands[i];
+		const uint8* data = _ArgumentsOf(command);
+		bool fill = (command.flags & kFill) != 0;
+
+		// the callbacks are allowed to change the gradient, so they only
+		// get a copy of it
+		switch (command.type) {
+			case kMovePenBy:
+				callbacks.MovePenBy(*(const BPoint*)data);
+				break;
+
+			case kStrokeLine:
+			{
+				const line_arguments* arguments = (const line_arguments*)data;
+				callbacks.StrokeLine(arguments->start, arguments->end);
+				break;
+			}
+			case kStrokeLineGradient:
+			{
+				const line_arguments* arguments = (const line_arguments*)data;
+				BGradient gradient(*fGradients.ItemAt(command.gradient));
+				callbacks.StrokeLineGradient(arguments->start, arguments->end,
+					gradient);
+				break;
+			}
+
+			case kDrawRect:
+				callbacks.DrawRect(*(const BRect*)data, fill);
+				break;
+			case kDrawRectGradient:
+			{
+				BGradient gradient(*fGradients.ItemAt(command.gradient));
+				callbacks.DrawRectGradient(*(const BRect*)data, gradient, fill);
+				break;
+			}
+
+			case kDrawRoundRect:
+			{
+				const round_rect_arguments* arguments
+					= (const round_rect_arguments*)data;
+				callbacks.DrawRoundRect(arguments->rect, arguments->radii,
+					fill);
+				break;
+			}
+			case kDrawRoundRectGradient:
+			{
+				const round_rect_arguments* arguments
+					= (const round_rect_arguments*)data;
+				BGradient gradient(*fGradients.ItemAt(command.gradient));
+				callbacks.DrawRoundRectGradient(arguments->rect,
+					arguments->radii, gradient, fill);
+				break;
+			}
+
+			case kDrawBezier:
+				callbacks.DrawBezier((const BPoint*)data, fill);
+				break;
+			case kDrawBezierGradient:
+			{
+				BGradient gradient(*fGradients.ItemAt(command.gradient));
+				callbacks.DrawBezierGradient((const BPoint*)data, gradient, fill);
+				break;
+			}
+
+			case kDrawArc:
+			{
+				const arc_arguments* arguments = (const arc_arguments*)data;
+				callbacks.DrawArc(arguments->center, arguments->radii,
+					arguments->start_theta, arguments->arc_theta, fill);
+				break;
+			}
+			case kDrawArcGradient:
+			{
+				const arc_arguments* arguments = (const arc_arguments*)data;
+				BGradient gradient(*fGradients.ItemAt(command.gradient));
+				callbacks.DrawArcGradient(arguments->center, arguments->radii,
+					arguments->start_theta, arguments->arc_theta, gradient, fill);
+				break;
+			}
+
+			case kDrawEllipse:
+				callbacks.DrawEllipse(*(const BRect*)data, fill);
+				break;
+			case kDrawEllipseGradient:
+			{
+				BGradient gradient(*fGradients.ItemAt(command.gradient));
+				callbacks.DrawEllipseGradient(*(const BRect*)data, gradient, fill);
+				break;
+			}
+
+			case kDrawPolygon:
+				callbacks.DrawPolygon(command.count, (const BPoint*)data,
+					(command.flags & kClosed) != 0, fill);
+				break;
+			case kDrawPolygonGradient:
+			{
+				BGradient gradient(*fGradients.ItemAt(command.gradient));
+				callbacks.DrawPolygonGradient(command.count,
+					(const BPoint*)data, (command.flags & kClosed) != 0, gradient,
+					fill);
+				break;
+			}
+
+			case kDrawShape:
+				callbacks.DrawShape(*fShapes.ItemAt(command.object), fill);
+				break;
+			case kDrawShapeGradient:
+			{
+				BGradient gradient(*fGradients.ItemAt(command.gradient));
+				callbacks.DrawShapeGradient(*fShapes.ItemAt(command.object),
+					gradient, fill);
+				break;
+			}
+
+			case kDrawString:
+			{
+				const string_arguments* arguments
+					= (const string_arguments*)data;
+				callbacks.DrawString(
+					(const char*)(data + sizeof(string_arguments)),
+					command.count, arguments->space_escapement,
+					arguments->non_space_escapement);
+				break;
+			}
+
+			case kDrawStringLocations:
+			{
+				const string_locations_arguments* arguments
+					= (const string_locations_arguments*)data;
+				const BPoint* locations = (const BPoint*)(data
+					+ sizeof(string_locations_arguments));
+				callbacks.DrawStringLocations(
+					(const char*)(locations + command.count),
+					arguments->length, locations, command.count);
+				break;
+			}
+
+			case kDrawPixels:
+			{
+				const pixels_arguments* arguments
+					= (const pixels_arguments*)data;
+				callbacks.DrawPixels(arguments->source, arguments->destination,
+					arguments->width, arguments->height,
+					arguments->bytes_per_row, arguments->format,
+					arguments->flags, data + sizeof(pixels_arguments),
+					command.count);
+				break;
+			}
+
+			case kDrawPicture:
+			{
+				const picture_arguments* arguments
+					= (const picture_arguments*)data;
+				callbacks.DrawPicture(arguments->where, arguments->token);
+				break;
+			}
+
+			case kSetClippingRects:
+				callbacks.SetClippingRects(command.count,
+					(const clipping_rect*)data);
+				break;
+
+			case kClipToPicture:
+			{
+				const picture_arguments* arguments
+					= (const picture_arguments*)data;
+				callbacks.ClipToPicture(arguments->token, arguments->where,
+					(command.flags & kInverse) != 0);
+				break;
+			}
+
+			case kClipToRect:
+				callbacks.ClipToRect(*(const BRect*)data,
+					(command.flags & kInverse) != 0);
+				break;
+
+			case kClipToShape:
+			{
+				const clip_shape_arguments* arguments
+					= (const clip_shape_arguments*)data;
+				const uint32* ops = (const uint32*)(data
+					+ sizeof(clip_shape_arguments));
+				callbacks.ClipToShape(arguments->op_count, ops,
+					arguments->point_count,
+					(const BPoint*)(ops + arguments->op_count),
+					(command.flags & kInverse) != 0);
+				break;
+			}
+
+			case kPushState:
+				callbacks.PushState();
+				break;
+			case kPopState:
+				callbacks.PopState();
+				break;
+			case kEnterStateChange:
+				callbacks.EnterStateChange();
+				break;
+			case kExitStateChange:
+				callbacks.ExitStateChange();
+				break;
+			case kEnterFontState:
+				callbacks.EnterFontState();
+				break;
+			case kExitFontState:
+				callbacks.ExitFontState();
+				break;
+
+			case kSetOrigin:
+				callbacks.SetOrigin(*(const BPoint*)data);
+				break;
+			case kSetPenLocation:
+				callbacks.SetPenLocation(*(const BPoint*)data);
+				break;
+			case kSetDrawingMode:
+				callbacks.SetDrawingMode((drawing_mode)*(const int32*)data);
+				break;
+
+			case kSetLineMode:
+			{
+				const line_mode_arguments* arguments
+					= (const line_mode_arguments*)data;
+				callbacks.SetLineMode(arguments->cap, arguments->join,
+					arguments->miter_limit);
+				break;
+			}
+
+			case kSetPenSize:
+				callbacks.SetPenSize(*(const float*)data);
+				break;
+			case kSetForeColor:
+				callbacks.SetForeColor(*(const rgb_color*)data);
+				break;
+			case kSetBackColor:
+				callbacks.SetBackColor(*(const rgb_color*)data);
+				break;
+			case kSetStipplePattern:
+				callbacks.SetStipplePattern(*(const pattern*)data);
+				break;
+			case kSetScale:
+				callbacks.SetScale(*(const float*)data);
+				break;
+
+			case kSetFontFamily:
+				callbacks.SetFontFamily((const char*)data, command.count);
+				break;
+			case kSetFontStyle:
+				callbacks.SetFontStyle((const char*)data, command.count);
+				break;
+			case kSetFontSpacing:
+				callbacks.SetFontSpacing(*(const uint32*)data);
+				break;
+			case kSetFontSize:
+				callbacks.SetFontSize(*(const float*)data);
+				break;
+			case kSetFontRotation:
+				callbacks.SetFontRotation(*(const float*)data);
+				break;
+			case kSetFontEncoding:
+				callbacks.SetFontEncoding(*(const uint32*)data);
+				break;
+			case kSetFontFlags:
+				callbacks.SetFontFlags(*(const uint32*)data);
+				break;
+			case kSetFontShear:
+				callbacks.SetFontShear(*(const float*)data);
+				break;
+			case kSetFontFace:
+				callbacks.SetFontFace(*(const uint32*)data);
+				break;
+
+			case kSetBlendingMode:
+			{
+				const blending_arguments* arguments
+					= (const blending_arguments*)data;
+				callbacks.SetBlendingMode(arguments->source,
+					arguments->function);
+				break;
+			}
+
+			case kSetFillRule:
+				callbacks.SetFillRule(*(const int32*)data);
+				break;
+
+			case kSetTransform:
+			{
+				const transform_arguments* arguments
+					= (const transform_arguments*)data;
+				callbacks.SetTransform(BAffineTransform(arguments->sx,
+					arguments->shy, arguments->shx, arguments->sy,
+					arguments->tx, arguments->ty));
+				break;
+			}
+
+			case kTranslateBy:
+			{
+				const double_arguments* arguments
+					= (const double_arguments*)data;
+				callbacks.TranslateBy(arguments->x, arguments->y);
+				break;
+			}
+			case kScaleBy:
+			{
+				const double_arguments* arguments
+					= (const double_arguments*)data;
+				callbacks.ScaleBy(arguments->x, arguments->y);
+				break;
+			}
+			case kRotateBy:
+				callbacks.RotateBy(*(const double*)data);
+				break;
+
+			case kBlendLayer:
+				callbacks.BlendLayer(*(Layer* const*)data);
+				break;
+		}
+	}
+}
+
+
+/*!	Appends a command with room for \a argumentSize bytes of arguments.
+	The returned command, as well as the pointer to its arguments, are only
+	valid until the next command is added.
+*/
+CompiledPicture::command*
+CompiledPicture::_AddCommand(uint16 type, size_t argumentSize)
+{
+	if (fStatus != B_OK)
+		return NULL;
+
+	if (fCommandCount == fCommandCapacity) {
+		int32 capacity = fCommandCapacity > 0 ? fCommandCapacity * 2 : 64;
+		command* commands = (command*)realloc(fCommands,
+			capacity * sizeof(command));
+		if (commands == NULL) {
+			fStatus = B_NO_MEMORY;
+			return NULL;
+		}
+
+		fCommands = commands;
+		fCommandCapacity = capacity;
+	}
+
+	size_t offset = fArgumentsSize;
+	size_t size = align_arguments(argumentSize);
+	if (offset + size > fArgumentsCapacity) {
+		size_t capacity = fArgumentsCapacity > 0 ? fArgumentsCapacity : 1024;
+		while (capacity < offset + size)
+			capacity *= 2;
+
+		uint8* arguments = (uint8*)realloc(fArguments, capacity);
+		if (arguments == NULL) {
+			fStatus = B_NO_MEMORY;
+			return NULL;
+		}
+
+		fArguments = arguments;
+		fArgumentsCapacity = capacity;
+	}
+
+	fArgumentsSize += size;
+
+	command* command = &fCommands[fCommandCount++];
+	command->type = type;
+	command->flags = 0;
+	command->count = 0;
+	command->offset = offset;
+	command->object = -1;
+	command->gradient = -1;
+	return command;
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef COMPILED_PICTURE_H
+#define COMPILED_PICTURE_H
+
+
+#include <ObjectList.h>
+#include <Referenceable.h>
+#include <SupportDefs.h>
+
+
+class BGradient;
+class BList;
+class BShape;
+class Layer;
+
+namespace BPrivate {
+	class PicturePlayerCallbacks;
+}
+
+
+/*!	The commands of a picture, decoded once into a flat list of typed
+	commands, so that they can be played back again and again without
+	parsing the picture data each time.
+	Consecutive state changes that override each other are folded into
+	one, and so are consecutive transformations of the same kind.
+*/
+class CompiledPicture : public BReferenceable {
+public:
+								CompiledPicture();
+	virtual						~CompiledPicture();
+
+			status_t			Compile(const void* data, size_t size,
+									BList* pictures);
+			void				Play(
+									BPrivate::PicturePlayerCallbacks& callbacks)
+									const;
+
+			size_t				SourceSize() const { return fSourceSize; }
+			int32				CountCommands() const { return fCommandCount; }
+
+			bool				HasKnownBounds() const
+									{ return fHasKnownBounds; }
+
+private:
+			class Recorder;
+
+			struct command {
+				uint16			type;
+				uint16			flags;
+				uint32			count;
+				uint32			offset;
+				int32			object;
+				int32			gradient;
+			};
+
+			command*			_AddCommand(uint16 type, size_t argumentSize);
+			uint8*				_ArgumentsOf(const command& command) const
+									{ return fArguments + command.offset; }
+
+private:
+			command*			fCommands;
+			int32				fCommandCount;
+			int32				fCommandCapacity;
+			uint8*				fArguments;
+			size_t				fArgumentsSize;
+			size_t				fArgumentsCapacity;
+
+			BObjectList<BShape, true> fShapes;
+			BObjectList<BGradient, true> fGradients;
+
+			size_t				fSourceSize;
+			bool				fHasKnownBounds;
+			status_t			fStatus;
+};
+
+
+#endif	// COMPILED_PICTURE_H
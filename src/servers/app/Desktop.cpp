@@ -968,9 +968,14 @@ Desktop::LockDirectScreen(team_id team)
 	// which would make this method superfluous.
 
 	status_t status = fDirectScreenLock.LockWithTimeout(1000000L);
-	if (status == B_OK)
+	if (status == B_OK) {
 		fDirectScreenTeam = team;
 
+		// the screen belongs to the client now
+		fDirectScreenRegion = fVirtualScreen.Frame();
+		HWInterface()->AddDirectAccess(fDirectScreenRegion);
+	}
+
 	return status;
 }
 
@@ -979,6 +984,9 @@ status_t
 Desktop::UnlockDirectScreen(team_id team)
 {
 	if (fDirectScreenTeam == team) {
+		HWInterface()->RemoveDirectAccess(fDirectScreenRegion);
+		fDirectScreenRegion.MakeEmpty();
+
 		fDirectScreenLock.Unlock();
 		fDirectScreenTeam = -1;
 		return B_OK;
@@ -1511,10 +1519,19 @@ Desktop::MoveWindowBy(Window* window, float x, float y, int32 workspace)
 		direct = true;
 	}
 
+	// only the clipping of the windows beneath the old and the new
+	// position of the window can change
+	BRegion changedRegion;
+	_GetStackRegion(window, changedRegion);
+
 	window->MoveBy((int32)x, (int32)y);
 
+	BRegion stackRegion;
+	_GetStackRegion(window, stackRegion);
+	changedRegion.Include(&stackRegion);
+
 	BRegion background;
-	_RebuildClippingForAllWindows(background);
+	_RebuildClippingForChangedRegion(changedRegion, background);
 
 	// construct the region that is possible to be blitted
 	// to move the contents of the window
@@ -1589,10 +1606,17 @@ Desktop::ResizeWindowBy(Window* window, float x, float y)
 		direct = true;
 	}
 
+	BRegion changedRegion;
+	_GetStackRegion(window, changedRegion);
+
 	window->ResizeBy((int32)x, (int32)y, &newDirtyRegion);
 
+	BRegion stackRegion;
+	_GetStackRegion(window, stackRegion);
+	changedRegion.Include(&stackRegion);
+
 	BRegion background;
-	_RebuildClippingForAllWindows(background);
+	_RebuildClippingForChangedRegion(changedRegion, background);
 
 	// we just care for the region outside the window
 	previouslyOccupiedRegion.Exclude(&window->VisibleRegion());
@@ -2762,6 +2786,19 @@ Desktop::_DispatchMessage(int32 code, BPrivate::LinkReceiver& link)
 			break;
 		}
 
+		case AS_DUMP_DAMAGE_STATISTICS:
+		{
+			damage_statistics statistics;
+			HWInterface()->GetDamageStatistics(statistics);
+
+			debug_printf("Front buffer updates: %" B_PRId64 " flushes, %"
+				B_PRId64 " rects damaged, %" B_PRId64 " rects copied, %"
+				B_PRId64 " pixels, %" B_PRId64 " bytes\n", statistics.flushes,
+				statistics.rects_damaged, statistics.rects_copied,
+				statistics.pixels_copied, statistics.bytes_copied);
+			break;
+		}
+
 		case AS_EVENT_STREAM_CLOSED:
 			_LaunchInputServer();
 			break;
@@ -3478,6 +3515,66 @@ Desktop::_RebuildClippingForAllWindows(BRegion& stillAvailableOnScreen)
 			stillAvailableOnScreen.Exclude(&window->VisibleRegion());
 		}
 	}
+
+	fStillAvailableOnScreen = stillAvailableOnScreen;
+}
+
+
+/*!	Rebuilds the clipping of only those windows that intersect
+	\a changedRegion. The changed region must contain every part of the
+	screen in which a window has appeared, disappeared or changed its
+	shape since the clipping was last rebuilt; everywhere else, the window
+	clipping is left alone.
+	\a stillAvailableOnScreen is set to the part of the screen not covered
+	by any window, just like _RebuildClippingForAllWindows() does.
+*/
+void
+Desktop::_RebuildClippingForChangedRegion(const BRegion& changedRegion,
+	BRegion& stillAvailableOnScreen)
+{
+	// only the part of the screen within the changed region is tracked
+	BRegion available(changedRegion);
+	available.IntersectWith(&fScreenRegion);
+
+	for (Window* window = CurrentWindows().LastWindow(); window != NULL;
+			window = window->PreviousWindow(fCurrentWorkspace)) {
+		if (window->IsHidden()
+			|| !window->UpdateClipping(&available, changedRegion))
+			continue;
+
+		window->SetScreen(_DetermineScreenFor(window->Frame()));
+
+		if (window->ServerWindow()->IsDirectlyAccessing()) {
+			window->ServerWindow()->HandleDirectConnection(
+				B_DIRECT_MODIFY | B_CLIPPING_MODIFIED);
+		}
+
+		available.Exclude(&window->VisibleRegion());
+	}
+
+	fStillAvailableOnScreen.Exclude(&changedRegion);
+	fStillAvailableOnScreen.Include(&available);
+	stillAvailableOnScreen = fStillAvailableOnScreen;
+}
+
+
+//!	Returns the combined full region of all windows in \a window's stack.
+void
+Desktop::_GetStackRegion(Window* window, BRegion& region)
+{
+	WindowStack* stack = window->GetWindowStack();
+	if (stack == NULL) {
+		window->GetFullRegion(&region);
+		return;
+	}
+
+	region.MakeEmpty();
+
+	BRegion fullRegion;
+	for (int32 i = 0; i < stack->CountWindows(); i++) {
+		stack->WindowAt(i)->GetFullRegion(&fullRegion);
+		region.Include(&fullRegion);
+	}
 }
 
 
@@ -3555,6 +3652,8 @@ Desktop::RebuildAndRedrawAfterWindowChange(Window* changedWindow,
 		}
 	}
 
+	fStillAvailableOnScreen = stillAvailableOnScreen;
+
 	_SetBackground(stillAvailableOnScreen);
 	_WindowChanged(changedWindow);
 
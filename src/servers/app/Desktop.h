@@ -313,6 +313,11 @@ private:
 			Screen*				_DetermineScreenFor(BRect frame);
 			void				_RebuildClippingForAllWindows(
 									BRegion& stillAvailableOnScreen);
+			void				_RebuildClippingForChangedRegion(
+									const BRegion& changedRegion,
+									BRegion& stillAvailableOnScreen);
+			void				_GetStackRegion(Window* window,
+									BRegion& region);
 			void				_TriggerWindowRedrawing(
 									BRegion& dirtyRegion, BRegion& exposeRegion);
 			void				_SetBackground(BRegion& background);
@@ -351,6 +356,7 @@ private:
 			MultiLocker			fScreenLock;
 			BLocker				fDirectScreenLock;
 			team_id				fDirectScreenTeam;
+			BRegion				fDirectScreenRegion;
 			int32				fCurrentWorkspace;
 			int32				fPreviousWorkspace;
 
@@ -370,6 +376,9 @@ private:
 
 			BRegion				fBackgroundRegion;
 			BRegion				fScreenRegion;
+			BRegion				fStillAvailableOnScreen;
+				// the part of the screen not covered by any window, as of
+				// the last clipping rebuild
 
 			Window*				fMouseEventWindow;
 			const Window*		fWindowUnderMouse;
@@ -123,6 +123,7 @@ class EventDispatcher : public BLocker {
 
 		void _DeliverDragMessage();
 
+		void _DispatchEvent(BMessage* event);
 		void _EventLoop();
 		void _CursorLoop();
 
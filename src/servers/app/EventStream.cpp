@@ -12,15 +12,24 @@
 #include <InputServerTypes.h>
 #include <ServerProtocol.h>
 #include <shared_cursor_area.h>
+#include <shared_event_ring.h>
 
 #include <AppMisc.h>
 #include <AutoDeleter.h>
+#include <FlattenedMessage.h>
 
 #include <new>
 #include <stdio.h>
 #include <string.h>
 
 
+using BPrivate::BFlattenedMessage;
+
+
+static const bigtime_t kMouseMovedCoalesceAge = 100000;
+	// the EventDispatcher drops mouse moved events older than this anyway
+
+
 EventStream::EventStream()
 {
 }
@@ -38,6 +47,22 @@ EventStream::SupportsCursorThread() const
 }
 
 
+/*!	Waits for the next events, and adds all of them that are currently
+	available to \a events. The default implementation only adds a single
+	event.
+*/
+bool
+EventStream::GetNextEvents(BObjectList<BMessage>& events)
+{
+	BMessage* event;
+	if (!GetNextEvent(&event))
+		return false;
+
+	events.AddItem(event);
+	return true;
+}
+
+
 status_t
 EventStream::GetNextCursorPosition(BPoint& where, bigtime_t timeout)
 {
@@ -53,6 +78,7 @@ InputServerStream::InputServerStream(BMessenger& messenger)
 	fInputServer(messenger),
 	fPort(-1),
 	fQuitting(false),
+	fEventRing(NULL),
 	fLatestMouseMoved(NULL)
 {
 	BMessage message(IS_ACQUIRE_INPUT);
@@ -63,6 +89,18 @@ InputServerStream::InputServerStream(BMessenger& messenger)
 	if (fCursorArea >= B_OK)
 		message.AddInt32("cursor area", fCursorArea);
 
+	size_t ringAreaSize = (sizeof(shared_event_ring) + SHARED_EVENT_RING_SIZE
+		+ B_PAGE_SIZE - 1) & ~(B_PAGE_SIZE - 1);
+	fEventRingArea = create_area("input event ring", (void**)&fEventRing,
+		B_ANY_ADDRESS, ringAreaSize, B_LAZY_LOCK,
+		B_READ_AREA | B_WRITE_AREA | B_CLONEABLE_AREA);
+	if (fEventRingArea >= B_OK) {
+		memset(fEventRing, 0, sizeof(shared_event_ring));
+		fEventRing->size = SHARED_EVENT_RING_SIZE;
+		message.AddInt32("event ring area", fEventRingArea);
+	} else
+		fEventRing = NULL;
+
 	BMessage reply;
 	if (messenger.SendMessage(&message, &reply) != B_OK)
 		return;
@@ -71,6 +109,13 @@ InputServerStream::InputServerStream(BMessenger& messenger)
 		fPort = -1;
 	if (reply.FindInt32("cursor semaphore", &fCursorSemaphore) != B_OK)
 		fCursorSemaphore = -1;
+
+	if (fEventRing != NULL && !reply.GetBool("event ring", false)) {
+		// the input_server only uses the port
+		delete_area(fEventRingArea);
+		fEventRingArea = -1;
+		fEventRing = NULL;
+	}
 }
 
 
@@ -79,6 +124,8 @@ InputServerStream::InputServerStream()
 	:
 	fQuitting(false),
 	fCursorSemaphore(-1),
+	fEventRingArea(-1),
+	fEventRing(NULL),
 	fLatestMouseMoved(NULL)
 {
 	fPort = find_port(SERVER_INPUT_PORT);
@@ -89,6 +136,7 @@ InputServerStream::InputServerStream()
 InputServerStream::~InputServerStream()
 {
 	delete_area(fCursorArea);
+	delete_area(fEventRingArea);
 }
 
 
@@ -125,33 +173,8 @@ InputServerStream::UpdateScreenBounds(BRect bounds)
 bool
 InputServerStream::GetNextEvent(BMessage** _event)
 {
-	while (fEvents.IsEmpty()) {
-		// wait for new events
-		BMessage* event;
-		status_t status = _MessageFromPort(&event);
-		if (status == B_OK) {
-			if (event->what == B_MOUSE_MOVED)
-				fLatestMouseMoved = event;
-
-			fEvents.AddMessage(event);
-		} else if (status == B_BAD_PORT_ID) {
-			// our port got deleted - the input_server must have died
-			fPort = -1;
-			return false;
-		}
-
-		int32 count = port_count(fPort);
-		if (count > 0) {
-			// empty port queue completely while we're at it
-			for (int32 i = 0; i < count; i++) {
-				if (_MessageFromPort(&event, 0) == B_OK) {
-					if (event->what == B_MOUSE_MOVED)
-						fLatestMouseMoved = event;
-					fEvents.AddMessage(event);
-				}
-			}
-		}
-	}
+	if (!_WaitForEvents())
+		return false;
 
 	// there are items in our list, so just work through them
 
@@ -160,6 +183,20 @@ InputServerStream::GetNextEvent(BMessage** _event)
 }
 
 
+bool
+InputServerStream::GetNextEvents(BObjectList<BMessage>& events)
+{
+	if (!_WaitForEvents())
+		return false;
+
+	BMessage* event;
+	while ((event = fEvents.NextMessage()) != NULL)
+		events.AddItem(event);
+
+	return true;
+}
+
+
 status_t
 InputServerStream::GetNextCursorPosition(BPoint &where, bigtime_t timeout)
 {
@@ -223,6 +260,153 @@ InputServerStream::PeekLatestMouseMoved()
 }
 
 
+bool
+InputServerStream::_WaitForEvents()
+{
+	while (fEvents.IsEmpty()) {
+		if (fEventRing != NULL) {
+			_ReadEventRing();
+			if (!fEvents.IsEmpty())
+				break;
+
+			// Ask the input_server to notify us about new events, and make
+			// sure none arrived in the meantime
+			atomic_set(&fEventRing->reader_waiting, 1);
+			_ReadEventRing();
+			if (!fEvents.IsEmpty())
+				break;
+		}
+
+		// wait for new events
+		BMessage* event;
+		status_t status = _MessageFromPort(&event);
+		if (status == B_OK)
+			_AddEvent(event);
+		else if (status == B_BAD_PORT_ID) {
+			// our port got deleted - the input_server must have died
+			fPort = -1;
+			return false;
+		}
+
+		int32 count = port_count(fPort);
+		if (count > 0) {
+			// empty port queue completely while we're at it
+			for (int32 i = 0; i < count; i++) {
+				if (_MessageFromPort(&event, 0) == B_OK)
+					_AddEvent(event);
+			}
+		}
+	}
+
+	return true;
+}
+
+
+void
+InputServerStream::_AddEvent(BMessage* event)
+{
+	if (fEventRing != NULL) {
+		// events that are too large for the ring are sent through the port
+		// after the ones written to the ring before them
+		_ReadEventRing();
+	}
+
+	if (event->what == B_MOUSE_MOVED)
+		fLatestMouseMoved = event;
+
+	fEvents.AddMessage(event);
+}
+
+
+/*!	Moves all events from the ring shared with the input_server into the
+	event queue.
+	A mouse moved event that is followed by another one with the same buttons
+	is dropped without unflattening it when it has become too old to be
+	delivered anyway - this happens when we're lagging behind.
+*/
+void
+InputServerStream::_ReadEventRing()
+{
+	uint32 readOffset = fEventRing->read_offset;
+	uint32 writeOffset = (uint32)atomic_get((int32*)&fEventRing->write_offset);
+	if (readOffset == writeOffset)
+		return;
+
+	const bigtime_t now = system_time();
+	const uint8* pendingMouseMoved = NULL;
+	int32 pendingButtons = 0;
+	bigtime_t pendingWhen = 0;
+
+	while (true) {
+		const uint8* data;
+		uint32 messageSize;
+		status_t status = shared_event_ring_next_message(fEventRing,
+			&readOffset, writeOffset, &data, &messageSize);
+		if (status == B_BAD_DATA) {
+			printf("app_server: invalid event ring entry, dropping events\n");
+			readOffset = writeOffset;
+			break;
+		}
+		if (status != B_OK)
+			break;
+
+		BFlattenedMessage event;
+		if (event.SetTo(data, messageSize) != B_OK)
+			continue;
+
+		int32 buttons = 0;
+		bigtime_t when = now;
+		bool mouseMoved = event.What() == B_MOUSE_MOVED;
+		if (mouseMoved) {
+			event.FindInt32("buttons", 0, &buttons);
+			event.FindInt64("when", 0, &when);
+		}
+
+		if (pendingMouseMoved != NULL) {
+			if (!mouseMoved || buttons != pendingButtons
+				|| now - pendingWhen <= kMouseMovedCoalesceAge) {
+				_AddEventFromRing(pendingMouseMoved);
+			}
+			pendingMouseMoved = NULL;
+		}
+
+		if (mouseMoved) {
+			pendingMouseMoved = data;
+			pendingButtons = buttons;
+			pendingWhen = when;
+		} else
+			_AddEventFromRing(data);
+	}
+
+	if (pendingMouseMoved != NULL)
+		_AddEventFromRing(pendingMouseMoved);
+
+	// only now the input_server may reuse the space
+	atomic_set((int32*)&fEventRing->read_offset, readOffset);
+}
+
+
+void
+InputServerStream::_AddEventFromRing(const uint8* data)
+{
+	BMessage* event = new(std::nothrow) BMessage;
+	if (event == NULL)
+		return;
+
+	status_t status = event->Unflatten((const char*)data);
+	if (status != B_OK) {
+		printf("Unflatten event failed: %s\n", strerror(status));
+		delete event;
+		return;
+	}
+
+	if (event->what == B_MOUSE_MOVED)
+		fLatestMouseMoved = event;
+
+	fEvents.AddMessage(event);
+}
+
+
 status_t
 InputServerStream::_MessageFromPort(BMessage** _message, bigtime_t timeout)
 {
@@ -256,8 +440,9 @@ InputServerStream::_MessageFromPort(BMessage** _message, bigtime_t timeout)
 		// this will cause GetNextEvent() to return false
 		return B_BAD_PORT_ID;
 	}
-	if (code == 'insm') {
-		// a message has been inserted into our queue
+	if (code == 'insm' || code == kEventRingCode) {
+		// a message has been inserted into our queue, or new events are
+		// waiting in the ring
 		return B_INTERRUPTED;
 	}
 
@@ -12,9 +12,11 @@
 #include <LinkReceiver.h>
 #include <MessageQueue.h>
 #include <Messenger.h>
+#include <ObjectList.h>
 
 
 struct shared_cursor;
+struct shared_event_ring;
 
 
 class EventStream {
@@ -30,6 +32,7 @@ class EventStream {
 		virtual void UpdateScreenBounds(BRect bounds) = 0;
 
 		virtual bool GetNextEvent(BMessage** _event) = 0;
+		virtual bool GetNextEvents(BObjectList<BMessage>& events);
 		virtual status_t GetNextCursorPosition(BPoint& where,
 				bigtime_t timeout = B_INFINITE_TIMEOUT);
 
@@ -56,6 +59,7 @@ class InputServerStream : public EventStream {
 		virtual void UpdateScreenBounds(BRect bounds);
 
 		virtual bool GetNextEvent(BMessage** _event);
+		virtual bool GetNextEvents(BObjectList<BMessage>& events);
 		virtual status_t GetNextCursorPosition(BPoint& where,
 				bigtime_t timeout = B_INFINITE_TIMEOUT);
 
@@ -64,6 +68,10 @@ class InputServerStream : public EventStream {
 		virtual BMessage* PeekLatestMouseMoved();
 
 	private:
+		bool _WaitForEvents();
+		void _AddEvent(BMessage* event);
+		void _ReadEventRing();
+		void _AddEventFromRing(const uint8* data);
 		status_t _MessageFromPort(BMessage** _message,
 			bigtime_t timeout = B_INFINITE_TIMEOUT);
 
@@ -74,6 +82,8 @@ class InputServerStream : public EventStream {
 		sem_id	fCursorSemaphore;
 		area_id	fCursorArea;
 		shared_cursor* fCursorBuffer;
+		area_id	fEventRingArea;
+		shared_event_ring* fEventRing;
 		BMessage* fLatestMouseMoved;
 };
 
@@ -11,6 +11,7 @@
 
 #include "PictureBoundingBoxPlayer.h"
 
+#include <math.h>
 #include <new>
 #include <stdio.h>
 
@@ -254,11 +255,24 @@ get_polygon_frame(const BPoint* points, int32 numPoints, BRect* frame)
 }
 
 
+/*!	Expands \a rect by as much as a stroke may reach beyond the outline.
+	Square caps reach out diagonally, and miter joins as far as the miter
+	limit allows, if the outline may have \a sharpCorners at all.
+*/
 template<class RectType>
 static void
-expand_rect_for_pen_size(BoundingBoxState* state, RectType& rect)
+expand_rect_for_pen_size(BoundingBoxState* state, RectType& rect,
+	bool sharpCorners = false)
 {
-	float penInset = -((state->GetDrawState()->PenSize() / 2.0f) + 1.0f);
+	const DrawState* drawState = state->GetDrawState();
+
+	float extent = 1.0f;
+	if (drawState->LineCapMode() == B_SQUARE_CAP)
+		extent = M_SQRT2;
+	if (sharpCorners && drawState->LineJoinMode() == B_MITER_JOIN)
+		extent = max_c(extent, drawState->MiterLimit());
+
+	float penInset = -((drawState->PenSize() / 2.0f) * extent + 1.0f);
 	rect.InsetBy(penInset, penInset);
 }
 
@@ -372,7 +386,7 @@ BoundingBoxCallbacks::DrawBezier(const BPoint viewPoints[4], bool fill)
 	BRect rect;
 	determine_bounds_bezier(fState, viewPoints, rect);
 	if (!fill)
-		expand_rect_for_pen_size(fState, rect);
+		expand_rect_for_pen_size(fState, rect, true);
 	fState->IncludeRect(rect);
 }
 
@@ -423,7 +437,7 @@ BoundingBoxCallbacks::DrawPolygon(size_t numPoints,
 	BRect rect;
 	determine_bounds_polygon(fState, numPoints, viewPoints, rect);
 	if (!fill)
-		expand_rect_for_pen_size(fState, rect);
+		expand_rect_for_pen_size(fState, rect, true);
 	fState->IncludeRect(rect);
 }
 
@@ -438,7 +452,7 @@ BoundingBoxCallbacks::DrawShape(const BShape& shape, bool fill)
 
 	fState->PenToLocalTransform().Apply(&rect);
 	if (!fill)
-		expand_rect_for_pen_size(fState, rect);
+		expand_rect_for_pen_size(fState, rect, true);
 	fState->IncludeRect(rect);
 }
 
@@ -812,7 +826,7 @@ BoundingBoxCallbacks::DrawBezierGradient(const BPoint controlPoints[4], BGradien
 	determine_bounds_bezier(fState, controlPoints, rect);
 	fState->PenToLocalTransform().Apply(&gradient);
 	if (!fill)
-		expand_rect_for_pen_size(fState, rect);
+		expand_rect_for_pen_size(fState, rect, true);
 	fState->IncludeRect(rect);
 }
 
@@ -855,7 +869,7 @@ BoundingBoxCallbacks::DrawPolygonGradient(size_t numPoints, const BPoint points[
 	determine_bounds_polygon(fState, numPoints, points, rect);
 	fState->PenToLocalTransform().Apply(&gradient);
 	if (!fill)
-		expand_rect_for_pen_size(fState, rect);
+		expand_rect_for_pen_size(fState, rect, true);
 	fState->IncludeRect(rect);
 }
 
@@ -873,7 +887,7 @@ BoundingBoxCallbacks::DrawShapeGradient(const BShape& shape, BGradient& gradient
 	transform.Apply(&rect);
 	transform.Apply(&gradient);
 	if (!fill)
-		expand_rect_for_pen_size(fState, rect);
+		expand_rect_for_pen_size(fState, rect, true);
 	fState->IncludeRect(rect);
 }
 
@@ -1104,13 +1104,15 @@ ServerFont::StringWidth(const char *string, int32 numBytes,
 BRect
 ServerFont::BoundingBox()
 {
-	FT_Face face = fStyle->FreeTypeFace();
-
 	if (fBounds.IsValid() &&
 		fBounds.IntegerWidth() > 0 &&
 		fBounds.IntegerHeight() > 0)
 		return fBounds;
 
+	FT_Face face = fStyle->FreeTypeFace();
+	if (face == NULL)
+		return fBounds;
+
 	// if font has vector outlines, get the bounding box
 	// from freetype and scale it by the font size
 	if (IsScalable()) {
@@ -12,15 +12,18 @@
 
 #include "ServerPicture.h"
 
+#include <math.h>
 #include <new>
 #include <stdio.h>
 #include <stack>
 
 #include "AlphaMask.h"
+#include "CompiledPicture.h"
 #include "DrawingEngine.h"
 #include "DrawState.h"
 #include "GlobalFontManager.h"
 #include "Layer.h"
+#include "PictureBoundingBoxPlayer.h"
 #include "ServerApp.h"
 #include "ServerBitmap.h"
 #include "ServerFont.h"
@@ -38,6 +41,7 @@
 #include <ShapePrivate.h>
 #include <StackOrHeapArray.h>
 
+#include <AutoLocker.h>
 #include <Bitmap.h>
 #include <Debug.h>
 #include <List.h>
@@ -661,7 +665,8 @@ CanvasCallbacks::DrawPicture(const BPoint& where, int32 token)
 		fCanvas->SetDrawingOrigin(where);
 
 		fCanvas->PushState();
-		picture->Play(fCanvas);
+		if (!picture->IsOutsideClipping(fCanvas))
+			picture->Play(fCanvas);
 		fCanvas->PopState();
 
 		fCanvas->PopState();
@@ -1048,7 +1053,13 @@ CanvasCallbacks::ClipToShape(int32 opCount, const uint32 opList[],
 ServerPicture::ServerPicture()
 	:
 	fFile(NULL),
-	fOwner(NULL)
+	fOwner(NULL),
+	fCompiledLock("picture compiled data"),
+	fBoundingBoxPenSize(0),
+	fBoundingBoxCapMode(B_BUTT_CAP),
+	fBoundingBoxJoinMode(B_MITER_JOIN),
+	fBoundingBoxMiterLimit(B_DEFAULT_MITER_LIMIT),
+	fBoundingBoxValid(false)
 {
 	fToken = gTokenSpace.NewToken(kPictureToken, this);
 	fData.SetTo(new(std::nothrow) BMallocIO());
@@ -1061,7 +1072,13 @@ ServerPicture::ServerPicture(const ServerPicture& picture)
 	:
 	fFile(NULL),
 	fData(NULL),
-	fOwner(NULL)
+	fOwner(NULL),
+	fCompiledLock("picture compiled data"),
+	fBoundingBoxPenSize(0),
+	fBoundingBoxCapMode(B_BUTT_CAP),
+	fBoundingBoxJoinMode(B_MITER_JOIN),
+	fBoundingBoxMiterLimit(B_DEFAULT_MITER_LIMIT),
+	fBoundingBoxValid(false)
 {
 	fToken = gTokenSpace.NewToken(kPictureToken, this);
 
@@ -1086,7 +1103,13 @@ ServerPicture::ServerPicture(const char* fileName, int32 offset)
 	:
 	fFile(NULL),
 	fData(NULL),
-	fOwner(NULL)
+	fOwner(NULL),
+	fCompiledLock("picture compiled data"),
+	fBoundingBoxPenSize(0),
+	fBoundingBoxCapMode(B_BUTT_CAP),
+	fBoundingBoxJoinMode(B_MITER_JOIN),
+	fBoundingBoxMiterLimit(B_DEFAULT_MITER_LIMIT),
+	fBoundingBoxValid(false)
 {
 	fToken = gTokenSpace.NewToken(kPictureToken, this);
 
@@ -1248,12 +1271,53 @@ ServerPicture::Play(Canvas* target)
 
 	CanvasCallbacks callbacks(target);
 
+	BReference<CompiledPicture> compiled = _Compiled();
+	if (compiled != NULL) {
+		compiled->Play(callbacks);
+		return;
+	}
+
 	BPrivate::PicturePlayer player(mallocIO->Buffer(),
 		mallocIO->BufferLength(), PictureList::Private(fPictures.Get()).AsBList());
 	player.Play(callbacks);
 }
 
 
+/*!	Returns whether playing the picture onto \a target could not change
+	anything, because all of it lies outside of the current clipping of
+	the target's drawing engine.
+	This is only a quick test, and it always returns \c false when the
+	bounds of the picture are not known, or would have to be transformed.
+*/
+bool
+ServerPicture::IsOutsideClipping(Canvas* target)
+{
+	DrawState* state = target->CurrentState();
+	if (!state->CombinedTransform().IsIdentity())
+		return false;
+
+	BRect bounds;
+	if (!_GetBoundingBox(*state, bounds))
+		return false;
+
+	if (!bounds.IsValid()) {
+		// the picture does not draw anything
+		return true;
+	}
+
+	target->PenToScreenTransform().Apply(&bounds);
+
+	// round outwards like Layer does, to be on the safe side regarding
+	// anti-aliasing
+	bounds.left = floorf(bounds.left) - 2;
+	bounds.top = floorf(bounds.top) - 2;
+	bounds.right = ceilf(bounds.right) + 2;
+	bounds.bottom = ceilf(bounds.bottom) + 2;
+
+	return !target->GetDrawingEngine()->IntersectsClipping(bounds);
+}
+
+
 /*!	Acquires a reference to the pushed picture.
 */
 void
@@ -1328,6 +1392,11 @@ ServerPicture::ImportData(BPrivate::LinkReceiver& link)
 	}
 
 	fData->Seek(oldPosition, SEEK_SET);
+
+	AutoLocker<BLocker> locker(fCompiledLock);
+	fCompiled.Unset();
+	fBoundingBoxValid = false;
+
 	return status;
 }
 
@@ -1373,3 +1442,79 @@ ServerPicture::ExportData(BPrivate::PortLink& link)
 	fData->Seek(oldPosition, SEEK_SET);
 	return status;
 }
+
+
+/*!	Returns the compiled version of the picture data, and compiles it first
+	if needed. Since pictures may still grow while they are recorded, the
+	compiled data is replaced whenever the picture data changed in size.
+	Returns \c NULL if the picture could not be compiled.
+*/
+BReference<CompiledPicture>
+ServerPicture::_Compiled()
+{
+	BMallocIO* mallocIO = dynamic_cast<BMallocIO*>(fData.Get());
+	if (mallocIO == NULL)
+		return NULL;
+
+	AutoLocker<BLocker> locker(fCompiledLock);
+
+	if (fCompiled != NULL && fCompiled->SourceSize() == mallocIO->BufferLength())
+		return fCompiled;
+
+	fCompiled.Unset();
+	fBoundingBoxValid = false;
+
+	CompiledPicture* compiled = new(std::nothrow) CompiledPicture;
+	if (compiled == NULL)
+		return NULL;
+
+	if (compiled->Compile(mallocIO->Buffer(), mallocIO->BufferLength(),
+			PictureList::Private(fPictures.Get()).AsBList()) != B_OK) {
+		delete compiled;
+		return NULL;
+	}
+
+	fCompiled.SetTo(compiled, true);
+	return fCompiled;
+}
+
+
+/*!	Returns the bounding box of the picture in its own coordinate space,
+	when played with the pen size and line mode \a inherited from the
+	target. Only pictures whose bounds do not depend on anything else are
+	supported.
+*/
+bool
+ServerPicture::_GetBoundingBox(const DrawState& inherited, BRect& bounds)
+{
+	BReference<CompiledPicture> compiled = _Compiled();
+	if (compiled == NULL || !compiled->HasKnownBounds())
+		return false;
+
+	float penSize = inherited.UnscaledPenSize();
+	cap_mode capMode = inherited.LineCapMode();
+	join_mode joinMode = inherited.LineJoinMode();
+	float miterLimit = inherited.MiterLimit();
+
+	AutoLocker<BLocker> locker(fCompiledLock);
+
+	if (!fBoundingBoxValid || fBoundingBoxPenSize != penSize
+		|| fBoundingBoxCapMode != capMode || fBoundingBoxJoinMode != joinMode
+		|| fBoundingBoxMiterLimit != miterLimit) {
+		DrawState state;
+		state.SetPenSize(penSize);
+		state.SetLineCapMode(capMode);
+		state.SetLineJoinMode(joinMode);
+		state.SetMiterLimit(miterLimit);
+		PictureBoundingBoxPlayer::Play(this, &state, &fBoundingBox);
+
+		fBoundingBoxPenSize = penSize;
+		fBoundingBoxCapMode = capMode;
+		fBoundingBoxJoinMode = joinMode;
+		fBoundingBoxMiterLimit = miterLimit;
+		fBoundingBoxValid = true;
+	}
+
+	bounds = fBoundingBox;
+	return true;
+}
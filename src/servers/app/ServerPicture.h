@@ -15,13 +15,18 @@
 #include <DataIO.h>
 
 #include <AutoDeleter.h>
+#include <Locker.h>
 #include <ObjectList.h>
 #include <PictureDataWriter.h>
+#include <Rect.h>
 #include <Referenceable.h>
 
+#include "CompiledPicture.h"
+
 
 class BFile;
 class Canvas;
+class DrawState;
 class ServerApp;
 class ServerFont;
 class View;
@@ -55,6 +60,7 @@ public:
 									uint16 mask);
 
 			void				Play(Canvas* target);
+			bool				IsOutsideClipping(Canvas* target);
 
 			void 				PushPicture(ServerPicture* picture);
 			ServerPicture*		PopPicture();
@@ -72,6 +78,10 @@ private:
 
 			typedef BObjectList<ServerPicture> PictureList;
 
+			BReference<CompiledPicture> _Compiled();
+			bool				_GetBoundingBox(const DrawState& inherited,
+									BRect& bounds);
+
 			int32				fToken;
 			ObjectDeleter<BFile>
 								fFile;
@@ -82,6 +92,16 @@ private:
 			BReference<ServerPicture>
 								fPushed;
 			ServerApp*			fOwner;
+
+			BLocker				fCompiledLock;
+			BReference<CompiledPicture>
+								fCompiled;
+			BRect				fBoundingBox;
+			float				fBoundingBoxPenSize;
+			cap_mode			fBoundingBoxCapMode;
+			join_mode			fBoundingBoxJoinMode;
+			float				fBoundingBoxMiterLimit;
+			bool				fBoundingBoxValid;
 };
 
 
@@ -177,6 +177,10 @@ ServerWindow::ServerWindow(const char* title, ServerApp* app,
 	fCurrentDrawingRegion(),
 	fCurrentDrawingRegionValid(false),
 
+	fRecordingRetainedDrawing(false),
+	fRetainedDrawState(NULL),
+	fUpdateCount(0),
+
 	fIsDirectlyAccessing(false)
 {
 	STRACE(("ServerWindow(%s)::ServerWindow()\n", title));
@@ -207,6 +211,8 @@ ServerWindow::~ServerWindow()
 	if (!fWindow->IsOffscreenWindow()) {
 		fWindowAddedToDesktop = false;
 		fDesktop->RemoveWindow(fWindow.Get());
+		if (fDirectAccessRegion.CountRects() > 0)
+			fDesktop->HWInterface()->RemoveDirectAccess(fDirectAccessRegion);
 		fDesktop = NULL;
 	}
 
@@ -1045,11 +1051,13 @@ ServerWindow::_DispatchMessage(int32 code, BPrivate::LinkReceiver& link)
 
 		case AS_BEGIN_UPDATE:
 			DTRACE(("ServerWindow %s: Message AS_BEGIN_UPDATE\n", Title()));
+			fUpdateCount++;
 			fWindow->BeginUpdate(fLink);
 			break;
 
 		case AS_END_UPDATE:
 			DTRACE(("ServerWindow %s: Message AS_END_UPDATE\n", Title()));
+			_FinishRetainedDrawing(true);
 			fWindow->EndUpdate();
 			break;
 
@@ -1206,9 +1214,29 @@ void
 ServerWindow::_DispatchViewMessage(int32 code,
 	BPrivate::LinkReceiver &link)
 {
+	if (fRecordingRetainedDrawing) {
+		switch (code) {
+			case AS_VIEW_BEGIN_PICTURE:
+			case AS_VIEW_APPEND_TO_PICTURE:
+			case AS_VIEW_END_PICTURE:
+			case AS_VIEW_BEGIN_LAYER:
+			case AS_VIEW_END_LAYER:
+				// these would interfere with the recording
+				_FinishRetainedDrawing(false);
+				break;
+		}
+	} else if (fWindow->InUpdate())
+		_StartRetainedDrawing();
+
 	if (_DispatchPictureMessage(code, link))
 		return;
 
+	if (fRecordingRetainedDrawing) {
+		// the message cannot be recorded, the client will have to redraw
+		// the view itself next time
+		_FinishRetainedDrawing(false);
+	}
+
 	switch (code) {
 		case AS_VIEW_SCROLL:
 		{
@@ -2479,6 +2507,10 @@ void
 ServerWindow::_DispatchViewDrawingMessage(int32 code,
 	BPrivate::LinkReceiver &link)
 {
+	// whatever the view retained is outdated now, even if the drawing
+	// itself ends up being clipped away
+	fCurrentView->InvalidateRetainedDrawing();
+
 	if (!fCurrentView->IsVisible() || !fWindow->IsVisible()) {
 		if (link.NeedsReply()) {
 			debug_printf("ServerWindow::DispatchViewDrawingMessage() got "
@@ -3239,7 +3271,8 @@ ServerWindow::_DispatchViewDrawingMessage(int32 code,
 					fCurrentView->SetDrawingOrigin(where);
 
 					fCurrentView->PushState();
-					picture->Play(fCurrentView);
+					if (!picture->IsOutsideClipping(fCurrentView))
+						picture->Play(fCurrentView);
 					fCurrentView->PopState();
 
 					fCurrentView->PopState();
@@ -3460,6 +3493,8 @@ ServerWindow::_DispatchPictureMessage(int32 code, BPrivate::LinkReceiver& link)
 			pattern pat;
 			link.Read(&pat, sizeof(pattern));
 			picture->WriteSetPattern(pat);
+
+			fCurrentView->CurrentState()->SetPattern(Pattern(pat));
 			break;
 		}
 
@@ -4430,6 +4465,18 @@ ServerWindow::HandleDirectConnection(int32 bufferState, int32 driverState)
 	STRACE(("HandleDirectConnection(bufferState = %" B_PRId32 ", driverState = "
 		"%" B_PRId32 ")\n", bufferState, driverState));
 
+	HWInterface* interface = fDesktop->HWInterface();
+	if ((bufferState & B_DIRECT_MODE_MASK) != B_DIRECT_STOP) {
+		// the client is going to draw into its visible content directly,
+		// updates from the back buffer must not overwrite it anymore
+		BRegion previous(fDirectAccessRegion);
+		fDirectAccessRegion = fWindow->VisibleContentRegion();
+		interface->AddDirectAccess(fDirectAccessRegion);
+
+		previous.Exclude(&fDirectAccessRegion);
+		interface->RemoveDirectAccess(previous);
+	}
+
 	status_t status = fDirectWindowInfo->SetState(
 		(direct_buffer_state)bufferState, (direct_driver_state)driverState,
 		fDesktop->HWInterface()->FrontBuffer(), fWindow->Frame(),
@@ -4450,6 +4497,12 @@ ServerWindow::HandleDirectConnection(int32 bufferState, int32 driverState)
 		fIsDirectlyAccessing = true;
 	else if ((bufferState & B_DIRECT_MODE_MASK) == B_DIRECT_STOP)
 		fIsDirectlyAccessing = false;
+
+	if (!fDirectWindowInfo.IsSet()
+		|| (bufferState & B_DIRECT_MODE_MASK) == B_DIRECT_STOP) {
+		interface->RemoveDirectAccess(fDirectAccessRegion);
+		fDirectAccessRegion.MakeEmpty();
+	}
 }
 
 
@@ -4459,6 +4512,8 @@ ServerWindow::_SetCurrentView(View* view)
 	if (fCurrentView == view)
 		return;
 
+	_FinishRetainedDrawing(true);
+
 	fCurrentView = view;
 	fCurrentDrawingRegionValid = false;
 	_UpdateDrawState(fCurrentView);
@@ -4519,6 +4574,86 @@ ServerWindow::_UpdateCurrentDrawingRegion()
 }
 
 
+/*!	Starts recording the drawing commands of the current view in a picture,
+	instead of executing them right away, if the view wants to retain its
+	drawing (B_RETAIN_DRAWING), and did not already draw during the current
+	update.
+*/
+void
+ServerWindow::_StartRetainedDrawing()
+{
+	View* view = fCurrentView;
+	if (fWindow->IsOffscreenWindow() || view->Picture() != NULL
+		|| view->RetainedDrawingUpdate() == fUpdateCount
+		|| !view->CanRetainDrawing())
+		return;
+
+	// The drawing is played back from a copy of the current state later on,
+	// which does not include the state stack, nor the clipping.
+	DrawState* state = view->CurrentState();
+	if (state->PreviousState() != NULL || state->HasClipping()
+		|| state->GetAlphaMask() != NULL)
+		return;
+
+	BReference<ServerPicture> picture(new(std::nothrow) ServerPicture(), true);
+	if (picture == NULL)
+		return;
+
+	fRetainedDrawState.SetTo(new(std::nothrow) DrawState(*state));
+	if (!fRetainedDrawState.IsSet())
+		return;
+
+	view->SetPicture(picture);
+	fRecordingRetainedDrawing = true;
+}
+
+
+/*!	Stops recording the drawing commands of the current view, and puts them
+	on screen. If \a retain is \c true, the view keeps them to restore its
+	contents on exposure; it won't be able to until its next update otherwise.
+*/
+void
+ServerWindow::_FinishRetainedDrawing(bool retain)
+{
+	if (!fRecordingRetainedDrawing)
+		return;
+
+	fRecordingRetainedDrawing = false;
+
+	BReference<ServerPicture> picture(fCurrentView->Picture());
+	fCurrentView->SetPicture(NULL);
+
+	ObjectDeleter<DrawState> state(fRetainedDrawState.Detach());
+	if (picture == NULL || picture->DataLength() == 0) {
+		// Nothing has been drawn, so what the view retained from an earlier
+		// update doesn't match its contents anymore.
+		fCurrentView->SetRetainedDrawing(NULL, NULL, BRegion(), fUpdateCount);
+		return;
+	}
+
+	if (fCurrentView->IsVisible() && fWindow->IsVisible()) {
+		DrawingEngine* drawingEngine = fWindow->GetDrawingEngine();
+
+		_UpdateCurrentDrawingRegion();
+		if (fCurrentDrawingRegion.CountRects() > 0
+			&& drawingEngine->LockParallelAccess()) {
+			fCurrentView->PlayPicture(drawingEngine, picture, *state.Get(),
+				fCurrentDrawingRegion);
+			drawingEngine->UnlockParallelAccess();
+		}
+
+		_UpdateDrawState(fCurrentView);
+	}
+
+	BRegion coverage;
+	if (retain)
+		fWindow->GetRedrawnViewRegion(fCurrentView, coverage);
+
+	fCurrentView->SetRetainedDrawing(picture, state.Detach(), coverage,
+		fUpdateCount);
+}
+
+
 bool
 ServerWindow::_MessageNeedsAllWindowsLocked(uint32 code) const
 {
@@ -36,6 +36,7 @@ class BPoint;
 class BMessage;
 
 class Desktop;
+class DrawState;
 class ServerApp;
 class Decorator;
 class Window;
@@ -145,6 +146,9 @@ private:
 			void				_UpdateDrawState(View* view);
 			void				_UpdateCurrentDrawingRegion();
 
+			void				_StartRetainedDrawing();
+			void				_FinishRetainedDrawing(bool retain);
+
 			bool				_MessageNeedsAllWindowsLocked(
 									uint32 code) const;
 
@@ -175,9 +179,16 @@ private:
 			BRegion				fCurrentDrawingRegion;
 			bool				fCurrentDrawingRegionValid;
 
+			// recording the drawing of fCurrentView during an update
+			bool				fRecordingRetainedDrawing;
+			ObjectDeleter<DrawState>
+								fRetainedDrawState;
+			uint32				fUpdateCount;
+
 			ObjectDeleter<DirectWindowInfo>
 								fDirectWindowInfo;
 			bool				fIsDirectlyAccessing;
+			BRegion				fDirectAccessRegion;
 };
 
 #endif	// SERVER_WINDOW_H
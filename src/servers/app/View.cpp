@@ -49,6 +49,11 @@
 using std::nothrow;
 
 
+// Stamps screen clipping invalidations; a view's screen clipping is only
+// current if none of its ancestors has been invalidated after it was built.
+static int64 sClippingGeneration = 0;
+
+
 void
 resize_frame(IntRect& frame, uint32 resizingMode, int32 x, int32 y)
 {
@@ -78,6 +83,89 @@ resize_frame(IntRect& frame, uint32 resizingMode, int32 x, int32 y)
 }
 
 
+/*!	Plays back the drawing of a view from a copy of its drawing state, so
+	that neither the view's own state, nor the ServerWindow's idea of it is
+	changed.
+*/
+class PlaybackCanvas : public Canvas {
+public:
+	PlaybackCanvas(View* view, DrawingEngine* drawingEngine,
+			const DrawState& state, const BRegion& clipping)
+		:
+		Canvas(state),
+		fView(view),
+		fDrawingEngine(drawingEngine),
+		fClipping(clipping)
+	{
+	}
+
+	virtual IntRect Bounds() const
+	{
+		return fView->Bounds();
+	}
+
+	virtual DrawingEngine* GetDrawingEngine() const
+	{
+		return fDrawingEngine;
+	}
+
+	virtual ServerPicture* GetPicture(int32 token) const
+	{
+		return fView->GetPicture(token);
+	}
+
+	virtual void RebuildClipping(bool deep)
+	{
+		UpdateCurrentDrawingRegion();
+	}
+
+	virtual void ResyncDrawState()
+	{
+		BPoint leftTop(0, 0);
+		if (GetAlphaMask() != NULL) {
+			LocalToScreenTransform().Apply(&leftTop);
+			GetAlphaMask()->SetCanvasGeometry(leftTop, Bounds());
+			leftTop = BPoint(0, 0);
+		}
+		PenToScreenTransform().Apply(&leftTop);
+		fDrawingEngine->SetDrawState(fDrawState.Get(), leftTop.x, leftTop.y);
+	}
+
+	virtual void UpdateCurrentDrawingRegion()
+	{
+		fCurrentDrawingRegion = fClipping;
+		if (fDrawState->HasClipping()) {
+			BRegion userClipping;
+			fDrawState->GetCombinedClippingRegion(&userClipping);
+			LocalToScreenTransform().Apply(&userClipping);
+			fCurrentDrawingRegion.IntersectWith(&userClipping);
+		}
+		fDrawingEngine->ConstrainClippingRegion(&fCurrentDrawingRegion);
+	}
+
+protected:
+	virtual void _LocalToScreenTransform(SimpleTransform& transform) const
+	{
+		BPoint offset(0, 0);
+		fView->LocalToScreenTransform().Apply(&offset);
+		transform.AddOffset(offset.x, offset.y);
+	}
+
+	virtual void _ScreenToLocalTransform(SimpleTransform& transform) const
+	{
+		BPoint offset(0, 0);
+		fView->ScreenToLocalTransform().Apply(&offset);
+		transform.AddOffset(offset.x, offset.y);
+	}
+
+private:
+	View*				fView;
+	DrawingEngine*		fDrawingEngine;
+	const BRegion&		fClipping;
+	BRegion				fCurrentDrawingRegion;
+};
+
+
 //	#pragma mark -
 
 
@@ -120,9 +208,15 @@ View::View(IntRect frame, IntPoint scrollingOffset, const char* name,
 	fCursor(NULL),
 	fPicture(NULL),
 
+	fRetainedDrawing(NULL),
+	fRetainedDrawState(NULL),
+	fRetainedDrawingUpdate(0),
+
 	fLocalClipping((BRect)Bounds()),
 	fScreenClipping(),
 	fScreenClippingValid(false),
+	fScreenClippingGeneration(0),
+	fClippingInvalidation(0),
 	fUserClipping(NULL),
 	fScreenAndUserClipping(NULL)
 {
@@ -190,6 +284,8 @@ View::AttachedToWindow(::Window* window)
 void
 View::DetachedFromWindow()
 {
+	InvalidateRetainedDrawing();
+
 	// remove view from local token space
 	if (fWindow != NULL && fWindow->ServerWindow()->App() != NULL)
 		fWindow->ServerWindow()->App()->ViewTokens().RemoveToken(fToken);
@@ -241,6 +337,8 @@ View::AddChild(View* view)
 	}
 
 	view->fParent = this;
+	view->InvalidateScreenClipping();
+		// it may still have a clipping from a previous parent
 
 	if (!fLastChild) {
 		// no children yet
@@ -486,6 +584,9 @@ View::SetFlags(uint32 flags)
 	}
 
 	fDrawState->SetSubPixelPrecise(fFlags & B_SUBPIXEL_PRECISE);
+
+	if (!CanRetainDrawing())
+		InvalidateRetainedDrawing();
 }
 
 
@@ -540,6 +641,27 @@ View::_UpdateOverlayView() const
 }
 
 
+void
+View::_InvalidateRetainedDrawing(const BRegion& screenRegion)
+{
+	IntRect screenBounds(Bounds());
+	LocalToScreenTransform().Apply(&screenBounds);
+	if (!screenRegion.Intersects((clipping_rect)screenBounds))
+		return;
+
+	if (fRetainedDrawing != NULL) {
+		BRegion localRegion(screenRegion);
+		ScreenToLocalTransform().Apply(&localRegion);
+		fRetainedCoverage.Exclude(&localRegion);
+		if (fRetainedCoverage.CountRects() == 0)
+			InvalidateRetainedDrawing();
+	}
+
+	for (View* child = FirstChild(); child; child = child->NextSibling())
+		child->_InvalidateRetainedDrawing(screenRegion);
+}
+
+
 /*!
 	This method is called whenever the window is resized or moved - would
 	be nice to have a better solution for this, though.
@@ -682,6 +804,9 @@ View::ResizeBy(int32 x, int32 y, BRegion* dirtyRegion)
 	fFrame.right += x;
 	fFrame.bottom += y;
 
+	// the client may lay out its contents differently now
+	InvalidateRetainedDrawing();
+
 	if (fVisible && dirtyRegion) {
 		IntRect oldBounds(Bounds());
 		oldBounds.right -= x;
@@ -779,6 +904,8 @@ View::ScrollBy(int32 x, int32 y, BRegion* dirtyRegion)
 	// blitting version, invalidates
 	// old contents
 
+	InvalidateRetainedDrawing();
+
 	// remember old bounds for tracking dirty region
 	IntRect oldBounds(Bounds());
 
@@ -831,6 +958,8 @@ View::CopyBits(IntRect src, IntRect dst, BRegion& windowContentClipping)
 	if (!fVisible || !fWindow)
 		return;
 
+	InvalidateRetainedDrawing();
+
 	// TODO: figure out what to do when we have a transform which is not
 	// a dilation
 	BAffineTransform transform = CurrentState()->CombinedTransform();
@@ -920,6 +1049,8 @@ View::ColorUpdated(color_which which, rgb_color color)
 {
 	float tint = B_NO_TINT;
 
+	InvalidateRetainedDrawing();
+
 	if (fWhichViewColor == which)
 		SetViewColor(tint_color(color, fWhichViewColorTint));
 
@@ -1196,6 +1327,143 @@ View::Draw(DrawingEngine* drawingEngine, const BRegion* effectiveClipping,
 }
 
 
+/*!	Returns whether or not the view can keep what it drew, and have it
+	restored from app_server on exposure. Since they either draw on top of
+	their children, or let their parent draw underneath them, the view
+	cannot retain its drawing if it or one of its parents has the
+	B_DRAW_ON_CHILDREN flag, or if it has the B_TRANSPARENT_BACKGROUND one.
+*/
+bool
+View::CanRetainDrawing() const
+{
+	if ((fFlags & B_RETAIN_DRAWING) == 0
+		|| (fFlags & (B_DRAW_ON_CHILDREN | B_TRANSPARENT_BACKGROUND)) != 0)
+		return false;
+
+	for (View* parent = fParent; parent != NULL; parent = parent->fParent) {
+		if ((parent->fFlags & B_DRAW_ON_CHILDREN) != 0)
+			return false;
+	}
+
+	return true;
+}
+
+
+/*!	Replaces the retained drawing of this view with \a picture, which
+	is valid for the \a coverage region, in local coordinates, and needs to
+	be played back starting from \a state. The view takes over the \a state.
+	\a updateCount identifies the update session the drawing was recorded
+	in; it is remembered even if nothing can be retained.
+*/
+void
+View::SetRetainedDrawing(ServerPicture* picture, DrawState* state,
+	const BRegion& coverage, uint32 updateCount)
+{
+	ObjectDeleter<DrawState> stateDeleter(state);
+
+	InvalidateRetainedDrawing();
+	fRetainedDrawingUpdate = updateCount;
+
+	if (picture == NULL || state == NULL || coverage.CountRects() == 0
+		|| fWindow == NULL)
+		return;
+
+	fRetainedDrawing.SetTo(picture);
+	fRetainedDrawState.SetTo(stateDeleter.Detach());
+	fRetainedCoverage = coverage;
+
+	fWindow->AddRetainedDrawing();
+}
+
+
+void
+View::InvalidateRetainedDrawing()
+{
+	if (fRetainedDrawing == NULL)
+		return;
+
+	fRetainedDrawing.Unset();
+	fRetainedDrawState.Unset();
+	fRetainedCoverage.MakeEmpty();
+
+	if (fWindow != NULL)
+		fWindow->RemoveRetainedDrawing();
+}
+
+
+/*!	Removes \a region, in local coordinates, from the parts of this view
+	and its children their retained drawing is valid for.
+*/
+void
+View::InvalidateRetainedDrawing(const BRegion& region)
+{
+	BRegion screenRegion(region);
+	LocalToScreenTransform().Apply(&screenRegion);
+	_InvalidateRetainedDrawing(screenRegion);
+}
+
+
+/*!	Puts the retained drawing of this view and its children back on screen,
+	within \a effectiveClipping, on top of the already drawn background.
+	The parts that have been restored this way are added to \a restored.
+*/
+void
+View::DrawRetained(DrawingEngine* drawingEngine,
+	const BRegion* effectiveClipping, const BRegion* windowContentClipping,
+	BRegion& restored)
+{
+	if (!fVisible || (fFlags & B_DRAW_ON_CHILDREN) != 0)
+		return;
+
+	IntRect screenBounds(Bounds());
+	LocalToScreenTransform().Apply(&screenBounds);
+	if (!effectiveClipping->Intersects((clipping_rect)screenBounds))
+		return;
+
+	if (fRetainedDrawing != NULL) {
+		BRegion* redraw = fWindow->GetRegion(fRetainedCoverage);
+		if (redraw == NULL)
+			return;
+
+		LocalToScreenTransform().Apply(redraw);
+		redraw->IntersectWith(&_ScreenClipping(windowContentClipping));
+		redraw->IntersectWith(effectiveClipping);
+
+		if (redraw->CountRects() > 0) {
+			PlayPicture(drawingEngine, fRetainedDrawing,
+				*fRetainedDrawState.Get(), *redraw);
+			restored.Include(redraw);
+		}
+
+		fWindow->RecycleRegion(redraw);
+	}
+
+	for (View* child = FirstChild(); child; child = child->NextSibling()) {
+		child->DrawRetained(drawingEngine, effectiveClipping,
+			windowContentClipping, restored);
+	}
+}
+
+
+/*!	Plays \a picture back onto this view, starting with \a state instead of
+	the current drawing state of the view, and clipped to \a clipping, in
+	screen coordinates. This changes the drawing state of \a drawingEngine.
+*/
+void
+View::PlayPicture(DrawingEngine* drawingEngine, ServerPicture* picture,
+	const DrawState& state, const BRegion& clipping)
+{
+	PlaybackCanvas canvas(this, drawingEngine, state, clipping);
+	if (canvas.InitCheck() != B_OK)
+		return;
+
+	canvas.UpdateCurrentDrawingRegion();
+	canvas.ResyncDrawState();
+
+	picture->Play(&canvas);
+}
+
+
 // #pragma mark -
 
 
@@ -1428,9 +1696,12 @@ View::RebuildClipping(bool deep)
 BRegion&
 View::ScreenAndUserClipping(const BRegion* windowContentClipping, bool force) const
 {
+	// this also throws away an outdated combined clipping
+	BRegion& screenClipping = _ScreenClipping(windowContentClipping, force);
+
 	// no user clipping - return screen clipping directly
 	if (!fUserClipping.IsSet())
-		return _ScreenClipping(windowContentClipping, force);
+		return screenClipping;
 
 	// combined screen and user clipping already valid
 	if (fScreenAndUserClipping.IsSet())
@@ -1442,44 +1713,56 @@ View::ScreenAndUserClipping(const BRegion* windowContentClipping, bool force) co
 		return fScreenClipping;
 
 	LocalToScreenTransform().Apply(fScreenAndUserClipping.Get());
-	fScreenAndUserClipping->IntersectWith(
-		&_ScreenClipping(windowContentClipping, force));
+	fScreenAndUserClipping->IntersectWith(&screenClipping);
 	return *fScreenAndUserClipping.Get();
 }
 
 
+/*!	Invalidates the screen clipping of this view and all of its children.
+	The children are not visited; instead, the invalidation is stamped
+	with a new generation, and they compare it to the generation their own
+	screen clipping was built with when they need it the next time.
+*/
 void
 View::InvalidateScreenClipping()
 {
-// TODO: appearantly, we are calling ScreenClipping() on
-// views who's parents don't have a valid screen clipping yet,
-// this messes up the logic that for any given view with
-// fScreenClippingValid == false, all children have
-// fScreenClippingValid == false too. If this could be made the
-// case, we could save some performance here with the commented
-// out check, since InvalidateScreenClipping() might be called
-// frequently.
-// TODO: investigate, if InvalidateScreenClipping() could be
-// called in "deep" and "non-deep" mode, ie. see if there are
-// any cases where the children would still have valid screen
-// clipping, even though the parent's screen clipping becomes
-// invalid.
-//	if (!fScreenClippingValid)
-//		return;
+	fClippingInvalidation = atomic_add64(&sClippingGeneration, 1) + 1;
 
 	fScreenAndUserClipping.SetTo(NULL);
 	fScreenClippingValid = false;
-	// invalidate the childrens screen clipping as well
-	for (View* child = FirstChild(); child; child = child->NextSibling()) {
-		child->InvalidateScreenClipping();
+}
+
+
+bool
+View::IsScreenClippingValid() const
+{
+	return _IsScreenClippingCurrent()
+		&& (!fUserClipping.IsSet() || fScreenAndUserClipping.IsSet());
+}
+
+
+bool
+View::_IsScreenClippingCurrent() const
+{
+	if (!fScreenClippingValid)
+		return false;
+
+	for (const View* view = this; view != NULL; view = view->fParent) {
+		if (view->fClippingInvalidation > fScreenClippingGeneration)
+			return false;
 	}
+
+	return true;
 }
 
 
 BRegion&
 View::_ScreenClipping(const BRegion* windowContentClipping, bool force) const
 {
-	if (!fScreenClippingValid || force) {
+	if (force || !_IsScreenClippingCurrent()) {
+		fScreenClippingGeneration = atomic_get64(&sClippingGeneration);
+		fScreenAndUserClipping.SetTo(NULL);
+
 		fScreenClipping = fLocalClipping;
 		LocalToScreenTransform().Apply(&fScreenClipping);
 
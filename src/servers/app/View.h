@@ -174,6 +174,23 @@ public:
 								const BRegion* windowContentClipping,
 								bool deep = false);
 
+			// retained drawing (B_RETAIN_DRAWING)
+			bool			CanRetainDrawing() const;
+			void			SetRetainedDrawing(ServerPicture* picture,
+								DrawState* state, const BRegion& coverage,
+								uint32 updateCount);
+			uint32			RetainedDrawingUpdate() const
+								{ return fRetainedDrawingUpdate; }
+			void			InvalidateRetainedDrawing();
+			void			InvalidateRetainedDrawing(const BRegion& region);
+			void			DrawRetained(DrawingEngine* drawingEngine,
+								const BRegion* effectiveClipping,
+								const BRegion* windowContentClipping,
+								BRegion& restored);
+			void			PlayPicture(DrawingEngine* drawingEngine,
+								ServerPicture* picture, const DrawState& state,
+								const BRegion& clipping);
+
 			virtual void	MouseDown(BMessage* message, BPoint where);
 			virtual void	MouseUp(BMessage* message, BPoint where);
 			virtual void	MouseMoved(BMessage* message, BPoint where);
@@ -207,13 +224,7 @@ public:
 								const BRegion* windowContentClipping,
 								bool force = false) const;
 			void			InvalidateScreenClipping();
-	inline	bool			IsScreenClippingValid() const
-								{
-									return fScreenClippingValid
-										&& (!fUserClipping.IsSet()
-										|| (fUserClipping.IsSet()
-										&& fScreenAndUserClipping.IsSet()));
-								}
+			bool			IsScreenClippingValid() const;
 
 			// debugging
 			void			PrintToStream() const;
@@ -228,12 +239,15 @@ protected:
 	virtual	void			_ScreenToLocalTransform(
 								SimpleTransform& transform) const;
 
+			bool			_IsScreenClippingCurrent() const;
 			BRegion&		_ScreenClipping(const BRegion* windowContentClipping,
 								bool force = false) const;
 			void			_MoveScreenClipping(int32 x, int32 y,
 								bool deep);
 			Overlay*		_Overlay() const;
 			void			_UpdateOverlayView() const;
+			void			_InvalidateRetainedDrawing(
+								const BRegion& screenRegion);
 
 			BString			fName;
 			int32			fToken;
@@ -275,11 +289,22 @@ protected:
 			BReference<ServerPicture>
 							fPicture;
 
+			// what the client drew during its last update, and the part
+			// of the view (in local coordinates) it is still valid for
+			BReference<ServerPicture>
+							fRetainedDrawing;
+			ObjectDeleter<DrawState>
+							fRetainedDrawState;
+			BRegion			fRetainedCoverage;
+			uint32			fRetainedDrawingUpdate;
+
 			// clipping
 			BRegion			fLocalClipping;
 
 	mutable	BRegion			fScreenClipping;
 	mutable	bool			fScreenClippingValid;
+	mutable	int64			fScreenClippingGeneration;
+			int64			fClippingInvalidation;
 
 			ObjectDeleter<BRegion>
 							fUserClipping;
@@ -119,7 +119,8 @@ Window::Window(const BRect& frame, const char *name,
 	fMinHeight(1),
 	fMaxHeight(32768),
 
-	fWorkspacesViewCount(0)
+	fWorkspacesViewCount(0),
+	fRetainedDrawingCount(0)
 {
 	_InitWindowStack();
 
@@ -205,6 +206,45 @@ Window::SetClipping(BRegion* stillAvailableOnScreen)
 }
 
 
+/*!	Like SetClipping(), but only recomputes the part of the visible region
+	that lies within \a changedRegion; \a stillAvailableOnScreen only needs
+	to be valid within that region, too. The rest of the visible region is
+	expected to be unaffected by the change.
+	Returns \c false if the window does not intersect the changed region,
+	in which case nothing has been changed.
+*/
+bool
+Window::UpdateClipping(BRegion* stillAvailableOnScreen,
+	const BRegion& changedRegion)
+{
+	// this function is only called from the Desktop thread
+
+	BRect fullFrame = fFrame;
+	::Decorator* decorator = Decorator();
+	if (decorator != NULL)
+		fullFrame = fullFrame | decorator->GetFootprint().Frame();
+
+	if (!changedRegion.Intersects(fullFrame))
+		return false;
+
+	fVisibleRegion.Exclude(&changedRegion);
+
+	BRegion* changedPart = GetRegion();
+	if (changedPart != NULL) {
+		GetFullRegion(changedPart);
+		changedPart->IntersectWith(&changedRegion);
+		changedPart->IntersectWith(stillAvailableOnScreen);
+
+		fVisibleRegion.Include(changedPart);
+		RecycleRegion(changedPart);
+	}
+
+	fVisibleContentRegionValid = false;
+	fEffectiveDrawingRegionValid = false;
+	return true;
+}
+
+
 void
 Window::GetFullRegion(BRegion* region)
 {
@@ -323,7 +363,7 @@ Window::MoveBy(int32 x, int32 y, bool moveStack)
 	// the desktop will take care of dirty regions
 
 	// dispatch a message to the client informing about the changed size
-	BMessage msg(B_WINDOW_MOVED);
+	BMessage& msg = _ClientNotification(B_WINDOW_MOVED);
 	msg.AddInt64("when", system_time());
 	msg.AddPoint("where", fFrame.LeftTop());
 	fWindow->SendMessageToClient(&msg);
@@ -388,7 +428,7 @@ Window::ResizeBy(int32 x, int32 y, BRegion* dirtyRegion, bool resizeStack)
 
 	// send a message to the client informing about the changed size
 	BRect frame(Frame());
-	BMessage msg(B_WINDOW_RESIZED);
+	BMessage& msg = _ClientNotification(B_WINDOW_RESIZED);
 	msg.AddInt64("when", system_time());
 	msg.AddInt32("width", frame.IntegerWidth());
 	msg.AddInt32("height", frame.IntegerHeight());
@@ -850,6 +890,12 @@ Window::MarkContentDirtyAsync(BRegion& dirtyRegion)
 void
 Window::InvalidateView(View* view, BRegion& viewRegion)
 {
+	// even if they're not visible right now, neither the view nor its
+	// children must be restored from their retained drawing when they become
+	// visible again
+	if (view != NULL && fRetainedDrawingCount > 0)
+		view->InvalidateRetainedDrawing(viewRegion);
+
 	if (view && IsVisible() && view->IsVisible()) {
 		if (!fContentRegionValid)
 			_UpdateContentRegion();
@@ -1773,20 +1819,63 @@ Window::_TriggerContentRedraw(BRegion& dirty, const BRegion& expose)
 	if (!IsVisible() || dirty.CountRects() == 0 || (fFlags & kWindowScreenFlag) != 0)
 		return;
 
-	// put this into the pending dirty region
-	// to eventually trigger a client redraw
-	_TransferToUpdateSession(&dirty);
-
 	if (expose.CountRects() > 0) {
 		// draw exposed region background right now to avoid stamping artifacts
 		if (fDrawingEngine->LockParallelAccess()) {
-			bool copyToFrontEnabled = fDrawingEngine->CopyToFrontEnabled();
-			fDrawingEngine->SetCopyToFrontEnabled(true);
-			fTopView->Draw(fDrawingEngine.Get(), &expose, &fContentRegion, true);
-			fDrawingEngine->SetCopyToFrontEnabled(copyToFrontEnabled);
+			_DrawExposed(dirty, expose);
 			fDrawingEngine->UnlockParallelAccess();
 		}
 	}
+
+	// put this into the pending dirty region
+	// to eventually trigger a client redraw
+	_TransferToUpdateSession(&dirty);
+}
+
+
+/*!	Draws the backgrounds of the views in the exposed region, and puts back
+	the drawing of those views that retained it. The parts that could be
+	restored completely are removed from \a dirty, so that the client won't
+	be asked to redraw them.
+*/
+void
+Window::_DrawExposed(BRegion& dirty, const BRegion& expose)
+{
+	bool copyToFrontEnabled = fDrawingEngine->CopyToFrontEnabled();
+
+	BRegion* restored = NULL;
+	if (fRetainedDrawingCount > 0)
+		restored = fRegionPool.GetRegion();
+
+	if (restored == NULL) {
+		fDrawingEngine->SetCopyToFrontEnabled(true);
+		fTopView->Draw(fDrawingEngine.Get(), &expose, &fContentRegion, true);
+		fDrawingEngine->SetCopyToFrontEnabled(copyToFrontEnabled);
+		return;
+	}
+
+	// only show the result when the retained drawing is on top of the
+	// background already
+	fDrawingEngine->SetCopyToFrontEnabled(false);
+	fTopView->Draw(fDrawingEngine.Get(), &expose, &fContentRegion, true);
+	fTopView->DrawRetained(fDrawingEngine.Get(), &expose, &fContentRegion,
+		*restored);
+	fDrawingEngine->SetCopyToFrontEnabled(copyToFrontEnabled);
+
+	if (restored->CountRects() > 0) {
+		// the client doesn't need to redraw what could be restored
+		dirty.Exclude(restored);
+
+		// the drawing state of the engine belongs to the current view of
+		// the ServerWindow
+		ServerWindow()->ResyncDrawState();
+	}
+
+	// CopyToFront() doesn't take a const region
+	*restored = expose;
+	fDrawingEngine->CopyToFront(*restored);
+
+	fRegionPool.Recycle(restored);
 }
 
 
@@ -2000,6 +2089,30 @@ Window::EndUpdate()
 }
 
 
+/*!	Returns the part of \a view, in its local coordinates, that the client
+	redraws in the current update session, and that has not been marked dirty
+	again in the meantime.
+*/
+void
+Window::GetRedrawnViewRegion(View* view, BRegion& region)
+{
+	region.MakeEmpty();
+	if (!fInUpdate)
+		return;
+
+	if (!fContentRegionValid)
+		_UpdateContentRegion();
+
+	region = fCurrentUpdateSession->DirtyRegion();
+	region.IntersectWith(&VisibleContentRegion());
+	if (fPendingUpdateSession->IsUsed())
+		region.Exclude(&fPendingUpdateSession->DirtyRegion());
+	region.IntersectWith(&view->ScreenAndUserClipping(&fContentRegion));
+
+	view->ScreenToLocalTransform().Apply(&region);
+}
+
+
 void
 Window::_UpdateContentRegion()
 {
@@ -2292,6 +2405,19 @@ Window::_InitWindowStack()
 }
 
 
+/*!	Returns the message used to notify the client about frame changes,
+	emptied and set to \a what. Unlike a new BMessage, it keeps its field and
+	data buffers from the previous notification.
+*/
+BMessage&
+Window::_ClientNotification(uint32 what)
+{
+	fClientNotification.what = what;
+	BMessage::Private(fClientNotification).Reset();
+	return fClientNotification;
+}
+
+
 WindowStack::WindowStack(::Decorator* decorator)
 	:
 	fDecorator(decorator)
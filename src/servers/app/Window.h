@@ -22,6 +22,7 @@
 #include "WindowList.h"
 
 #include <AutoDeleter.h>
+#include <Message.h>
 #include <ObjectList.h>
 #include <Referenceable.h>
 #include <Region.h>
@@ -114,6 +115,8 @@ public:
 			// setting and getting the "hard" clipping, you need to have
 			// WriteLock()ed the clipping!
 			void				SetClipping(BRegion* stillAvailableOnScreen);
+			bool				UpdateClipping(BRegion* stillAvailableOnScreen,
+									const BRegion& changedRegion);
 			// you need to have ReadLock()ed the clipping!
 	inline	BRegion&			VisibleRegion() { return fVisibleRegion; }
 			BRegion&			VisibleContentRegion();
@@ -167,6 +170,8 @@ public:
 			void				EndUpdate();
 			bool				InUpdate() const
 									{ return fInUpdate; }
+			void				GetRedrawnViewRegion(View* view,
+									BRegion& region);
 
 			bool				NeedsUpdate() const
 									{ return fUpdateRequested; }
@@ -299,6 +304,11 @@ public:
 			void				FindWorkspacesViews(
 									BObjectList<WorkspacesView>& list) const;
 
+			void				AddRetainedDrawing()
+									{ fRetainedDrawingCount++; }
+			void				RemoveRetainedDrawing()
+									{ fRetainedDrawingCount--; }
+
 	static	bool				IsValidLook(window_look look);
 	static	bool				IsValidFeel(window_feel feel);
 	static	bool				IsModalFeel(window_feel feel);
@@ -329,6 +339,8 @@ protected:
 			void				_TriggerContentRedraw(BRegion& dirty,
 									const BRegion& expose = BRegion());
 			void				_DrawBorder();
+			void				_DrawExposed(BRegion& dirty,
+									const BRegion& expose);
 
 			// handling update sessions
 			void				_TransferToUpdateSession(
@@ -364,7 +376,8 @@ protected:
 			// windows. To avoid glitches, it must be set to a reasonable state as fast as possible,
 			// without waiting for a roundtrip to the window's Draw() methods. So it will be filled
 			// using background color and view bitmap, which can all be done without leaving
-			// app_server.
+			// app_server. Views that retained their drawing (B_RETAIN_DRAWING) are restored
+			// completely, and don't need to be redrawn by the client at all.
 			BRegion				fExposeRegion;
 
 			// caching local regions
@@ -443,13 +456,19 @@ protected:
 			int32				fMaxHeight;
 
 			int32				fWorkspacesViewCount;
+			int32				fRetainedDrawingCount;
 
 		friend class DecorManager;
 
 private:
 			WindowStack*		_InitWindowStack();
+			BMessage&			_ClientNotification(uint32 what);
 
 			BReference<WindowStack>		fCurrentStack;
+
+			// reused for the moved/resized notifications, which are sent
+			// for every step while the window is dragged
+			BMessage			fClientNotification;
 };
 
 
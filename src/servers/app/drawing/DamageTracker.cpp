@@ -0,0 +1,214 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "DamageTracker.h"
+
+#include <string.h>
+
+#include <Autolock.h>
+
+
+// The cost of copying a rect to the front buffer, in pixels: every rect
+// has a fixed overhead (locking, cursor handling), and every row of it
+// another one on top of the pixels themselves. Merging two rects into
+// their bounding box pays off when that costs less than copying both of
+// them separately.
+static const int64 kRectCost = 512;
+static const int64 kRowCost = 16;
+
+// How many of the previously merged rects a rect is compared against.
+static const int32 kMergeCandidates = 8;
+
+
+static inline int64
+copy_cost(const clipping_rect& rect)
+{
+	int64 width = rect.right - rect.left + 1;
+	int64 height = rect.bottom - rect.top + 1;
+	return kRectCost + height * kRowCost + width * height;
+}
+
+
+static inline clipping_rect
+union_rect(const clipping_rect& a, const clipping_rect& b)
+{
+	clipping_rect rect;
+	rect.left = min_c(a.left, b.left);
+	rect.top = min_c(a.top, b.top);
+	rect.right = max_c(a.right, b.right);
+	rect.bottom = max_c(a.bottom, b.bottom);
+	return rect;
+}
+
+
+// #pragma mark -
+
+
+DamageTracker::DamageTracker()
+	:
+	fLock("damage tracker")
+{
+	memset(&fStatistics, 0, sizeof(fStatistics));
+}
+
+
+DamageTracker::~DamageTracker()
+{
+}
+
+
+/*!	Adds \a frame to the damaged area. Returns \c true when there was no
+	damage before.
+*/
+bool
+DamageTracker::Include(const BRect& frame)
+{
+	BAutolock _(fLock);
+
+	bool wasEmpty = fDamage.CountRects() == 0;
+	fDamage.Include(frame);
+	AddDamaged(1);
+	return wasEmpty;
+}
+
+
+bool
+DamageTracker::Include(const BRegion& region)
+{
+	BAutolock _(fLock);
+
+	bool wasEmpty = fDamage.CountRects() == 0;
+	fDamage.Include(&region);
+	AddDamaged(region.CountRects());
+	return wasEmpty;
+}
+
+
+/*!	Marks \a region as being accessed directly by a client, like a
+	BDirectWindow. Its pending damage is dropped, and merged rects will not
+	extend into it anymore, so that the client's output is not overwritten
+	with the contents of the back buffer.
+*/
+void
+DamageTracker::AddDirectAccess(const BRegion& region)
+{
+	BAutolock _(fLock);
+
+	fDamage.Exclude(&region);
+	fDirectAccess.Include(&region);
+}
+
+
+void
+DamageTracker::RemoveDirectAccess(const BRegion& region)
+{
+	BAutolock _(fLock);
+
+	fDirectAccess.Exclude(&region);
+}
+
+
+/*!	Moves the damaged area over to \a damage, and starts over.
+*/
+void
+DamageTracker::TakeDamage(BRegion& damage)
+{
+	BAutolock _(fLock);
+
+	damage = fDamage;
+	fDamage.MakeEmpty();
+}
+
+
+void
+DamageTracker::AddDamaged(int32 rects)
+{
+	atomic_add64(&fStatistics.rects_damaged, rects);
+}
+
+
+void
+DamageTracker::AddCopied(int64 pixels, int64 bytes)
+{
+	atomic_add64(&fStatistics.rects_copied, 1);
+	atomic_add64(&fStatistics.pixels_copied, pixels);
+	atomic_add64(&fStatistics.bytes_copied, bytes);
+}
+
+
+void
+DamageTracker::AddFlush()
+{
+	atomic_add64(&fStatistics.flushes, 1);
+}
+
+
+void
+DamageTracker::GetStatistics(damage_statistics& statistics) const
+{
+	statistics.flushes = atomic_get64((int64*)&fStatistics.flushes);
+	statistics.rects_damaged
+		= atomic_get64((int64*)&fStatistics.rects_damaged);
+	statistics.rects_copied = atomic_get64((int64*)&fStatistics.rects_copied);
+	statistics.pixels_copied
+		= atomic_get64((int64*)&fStatistics.pixels_copied);
+	statistics.bytes_copied = atomic_get64((int64*)&fStatistics.bytes_copied);
+}
+
+
+/*!	Merges the rects of \a region like the static version, without
+	extending them into an area that is accessed directly.
+*/
+int32
+DamageTracker::MergeRects(const BRegion& region, clipping_rect* rects)
+{
+	BAutolock _(fLock);
+
+	return MergeRects(region, fDirectAccess, rects);
+}
+
+
+/*!	Reduces the rects of \a region to fewer, larger ones where copying the
+	extra pixels is cheaper than copying the rects one by one. The merged
+	rects never intersect \a keepOut.
+	The result is written to \a rects, which must have room for all rects of
+	the region; the resulting rects may overlap. Returns the number of rects.
+*/
+/*static*/ int32
+DamageTracker::MergeRects(const BRegion& region, const BRegion& keepOut,
+	clipping_rect* rects)
+{
+	int32 count = 0;
+	int32 regionCount = region.CountRects();
+	bool checkKeepOut = keepOut.CountRects() > 0;
+
+	for (int32 i = 0; i < regionCount; i++) {
+		clipping_rect rect = region.RectAtInt(i);
+		int64 cost = copy_cost(rect);
+
+		// the region rects are sorted from top to bottom, so the best
+		// candidates are found among the last rects
+		int32 best = -1;
+		int64 bestSaving = 0;
+		for (int32 j = count - 1; j >= 0 && j >= count - kMergeCandidates;
+				j--) {
+			clipping_rect merged = union_rect(rects[j], rect);
+			int64 saving = copy_cost(rects[j]) + cost - copy_cost(merged);
+			if (saving > bestSaving
+				&& (!checkKeepOut || !keepOut.Intersects(merged))) {
+				best = j;
+				bestSaving = saving;
+			}
+		}
+
+		if (best >= 0)
+			rects[best] = union_rect(rects[best], rect);
+		else
+			rects[count++] = rect;
+	}
+
+	return count;
+}
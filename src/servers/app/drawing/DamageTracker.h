@@ -0,0 +1,61 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef DAMAGE_TRACKER_H
+#define DAMAGE_TRACKER_H
+
+
+#include <Locker.h>
+#include <OS.h>
+#include <Region.h>
+
+
+struct damage_statistics {
+	int64		flushes;
+	int64		rects_damaged;
+		// rects handed in to be copied to the front buffer
+	int64		rects_copied;
+		// rects actually copied, after merging
+	int64		pixels_copied;
+	int64		bytes_copied;
+};
+
+
+/*!	Collects the areas of the back buffer that need to be copied to the
+	front buffer, so that they can be copied once per frame, and keeps
+	the statistics about what was copied.
+*/
+class DamageTracker {
+public:
+								DamageTracker();
+								~DamageTracker();
+
+			bool				Include(const BRect& frame);
+			bool				Include(const BRegion& region);
+			void				TakeDamage(BRegion& damage);
+
+			void				AddDirectAccess(const BRegion& region);
+			void				RemoveDirectAccess(const BRegion& region);
+
+			void				AddDamaged(int32 rects);
+			void				AddCopied(int64 pixels, int64 bytes);
+			void				AddFlush();
+			void				GetStatistics(
+									damage_statistics& statistics) const;
+
+			int32				MergeRects(const BRegion& region,
+									clipping_rect* rects);
+	static	int32				MergeRects(const BRegion& region,
+									const BRegion& keepOut,
+									clipping_rect* rects);
+
+private:
+			BLocker				fLock;
+			BRegion				fDamage;
+			BRegion				fDirectAccess;
+			damage_statistics	fStatistics;
+};
+
+
+#endif // DAMAGE_TRACKER_H
@@ -304,6 +304,14 @@ DrawingEngine::ConstrainClippingRegion(const BRegion* region)
 }
 
 
+bool
+DrawingEngine::IntersectsClipping(const BRect& rect) const
+{
+	const BRegion* clipping = fPainter->ClippingRegion();
+	return clipping == NULL || clipping->Intersects(rect);
+}
+
+
 void
 DrawingEngine::SetDrawState(const DrawState* state, int32 xOffset,
 	int32 yOffset)
@@ -1482,6 +1490,20 @@ DrawingEngine::SetRendererOffset(int32 offsetX, int32 offsetY)
 }
 
 
+void
+DrawingEngine::SetTiledRendering(bool tiled)
+{
+	fPainter->SetTiledRendering(tiled);
+}
+
+
+bool
+DrawingEngine::TiledRendering() const
+{
+	return fPainter->TiledRendering();
+}
+
+
 void
 DrawingEngine::_CopyRect(uint8* src, uint32 width, uint32 height,
 	uint32 bytesPerRow, int32 xOffset, int32 yOffset) const
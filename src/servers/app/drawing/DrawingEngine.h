@@ -69,6 +69,8 @@ public:
 	// clipping for all drawing functions, passing a NULL region
 	// will remove any clipping (drawing allowed everywhere)
 	virtual	void			ConstrainClippingRegion(const BRegion* region);
+	// returns false if nothing drawn inside of rect could end up on screen
+	virtual	bool			IntersectsClipping(const BRect& rect) const;
 
 	virtual	void			SetDrawState(const DrawState* state,
 								int32 xOffset = 0, int32 yOffset = 0);
@@ -200,6 +202,10 @@ public:
 
 			void			SetRendererOffset(int32 offsetX, int32 offsetY);
 
+	// rendering large primitives in concurrent bands, see Painter
+			void			SetTiledRendering(bool tiled);
+			bool			TiledRendering() const;
+
 private:
 	friend class DrawTransaction;
 
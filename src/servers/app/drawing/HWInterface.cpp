@@ -14,6 +14,9 @@
 #include <string.h>
 #include <unistd.h>
 
+#include <Autolock.h>
+#include <StackOrHeapArray.h>
+
 #include <vesa/vesa_info.h>
 
 #include "drawing_support.h"
@@ -52,13 +55,19 @@ HWInterface::HWInterface()
 	fHardwareCursorEnabled(false),
 	fCursorLocation(0, 0),
 	fVGADevice(-1),
-	fListeners(20)
+	fListeners(20),
+	fFlushLock("damage flush lock"),
+	fDeferredUpdates(false),
+	fFrameInterval(1000000 / 60),
+	fDamageThread(-1),
+	fDamageSemaphore(-1)
 {
 }
 
 
 HWInterface::~HWInterface()
 {
+	_StopDeferredUpdates();
 }
 
 
@@ -290,6 +299,17 @@ HWInterface::DrawingBuffer() const
 status_t
 HWInterface::InvalidateRegion(const BRegion& region)
 {
+	if (IsDoubleBuffered()) {
+		if (fDeferredUpdates) {
+			if (fDamage.Include(region))
+				release_sem_etc(fDamageSemaphore, 1, B_DO_NOT_RESCHEDULE);
+			return B_OK;
+		}
+
+		fDamage.AddDamaged(region.CountRects());
+		return _CopyRegionToFront(region);
+	}
+
 	int32 count = region.CountRects();
 	for (int32 i = 0; i < count; i++) {
 		status_t result = Invalidate(region.RectAt(i));
@@ -306,8 +326,16 @@ HWInterface::InvalidateRegion(const BRegion& region)
 status_t
 HWInterface::Invalidate(const BRect& frame)
 {
-	if (IsDoubleBuffered())
+	if (IsDoubleBuffered()) {
+		if (fDeferredUpdates) {
+			if (fDamage.Include(frame))
+				release_sem_etc(fDamageSemaphore, 1, B_DO_NOT_RESCHEDULE);
+			return B_OK;
+		}
+
+		fDamage.AddDamaged(1);
 		return CopyBackToFront(frame);
+	}
 
 	return B_OK;
 }
@@ -343,6 +371,11 @@ HWInterface::CopyBackToFront(const BRect& frame)
 
 		_DrawCursor(area);
 
+		int64 pixels = (int64)(area.IntegerWidth() + 1)
+			* (area.IntegerHeight() + 1);
+		fDamage.AddCopied(pixels,
+			pixels * frontBuffer->BytesPerRow() / frontBuffer->Width());
+
 		if (cursorLocked)
 			fFloatingOverlaysLock.Unlock();
 
@@ -370,6 +403,182 @@ HWInterface::_CopyBackToFront(/*const*/ BRegion& region)
 }
 
 
+/*!	Turns deferred updates on or off. While they are on, Invalidate() and
+	InvalidateRegion() only collect the damaged area, and a separate thread
+	copies it to the front buffer once every \a frameInterval. The thread
+	is started on first use, and stays around until _StopDeferredUpdates()
+	is called; turning deferred updates off only makes it flush the damage
+	that is still pending.
+*/
+void
+HWInterface::SetDeferredUpdates(bool enabled, bigtime_t frameInterval)
+{
+	if (frameInterval > 0)
+		fFrameInterval = frameInterval;
+
+	if (enabled && fDamageThread < 0) {
+		fDamageSemaphore = create_sem(0, "damage flush");
+		if (fDamageSemaphore < 0)
+			return;
+
+		fDamageThread = spawn_thread(&_DamageThreadEntry, "damage flusher",
+			B_URGENT_DISPLAY_PRIORITY, this);
+		if (fDamageThread < 0) {
+			delete_sem(fDamageSemaphore);
+			fDamageSemaphore = -1;
+			return;
+		}
+
+		resume_thread(fDamageThread);
+	}
+
+	fDeferredUpdates = enabled;
+}
+
+
+/*!	Copies all pending damage to the front buffer right away.
+*/
+void
+HWInterface::FlushDamage()
+{
+	if (!LockParallelAccess())
+		return;
+
+	_FlushDamage();
+
+	UnlockParallelAccess();
+}
+
+
+/*!	Tells the interface that a client draws into \a region of the front
+	buffer directly, like a BDirectWindow or BWindowScreen does. The pending
+	damage in there is dropped, and nothing is copied there from the back
+	buffer without it being explicitly invalidated. A flush that is in
+	progress is waited for, so this must be called before the client starts
+	drawing.
+*/
+void
+HWInterface::AddDirectAccess(const BRegion& region)
+{
+	BAutolock _(fFlushLock);
+
+	fDamage.AddDirectAccess(region);
+}
+
+
+void
+HWInterface::RemoveDirectAccess(const BRegion& region)
+{
+	fDamage.RemoveDirectAccess(region);
+}
+
+
+void
+HWInterface::GetDamageStatistics(damage_statistics& statistics) const
+{
+	fDamage.GetStatistics(statistics);
+}
+
+
+/*!	Stops the thread that flushes the deferred updates. Derived classes
+	need to call this before they free their frame buffers, and must not
+	hold the lock while doing so.
+*/
+void
+HWInterface::_StopDeferredUpdates()
+{
+	fDeferredUpdates = false;
+
+	if (fDamageThread < 0)
+		return;
+
+	// any damage still pending is dropped, the screen is going away
+	delete_sem(fDamageSemaphore);
+	fDamageSemaphore = -1;
+
+	status_t result;
+	wait_for_thread(fDamageThread, &result);
+	fDamageThread = -1;
+}
+
+
+/*!	Copies \a region to the front buffer, merging its rects where that
+	is cheaper than copying them one by one, but never into an area that
+	a client accesses directly.
+	The object must already be locked!
+*/
+status_t
+HWInterface::_CopyRegionToFront(const BRegion& region)
+{
+	int32 count = region.CountRects();
+	BStackOrHeapArray<clipping_rect, 64> rects(count);
+	if (rects.IsValid())
+		count = fDamage.MergeRects(region, rects);
+
+	for (int32 i = 0; i < count; i++) {
+		clipping_rect rect = rects.IsValid() ? rects[i] : region.RectAtInt(i);
+		status_t result = CopyBackToFront(
+			BRect(rect.left, rect.top, rect.right, rect.bottom));
+		if (result != B_OK)
+			return result;
+	}
+
+	return B_OK;
+}
+
+
+/*static*/ status_t
+HWInterface::_DamageThreadEntry(void* data)
+{
+	((HWInterface*)data)->_DamageThread();
+	return B_OK;
+}
+
+
+void
+HWInterface::_DamageThread()
+{
+	sem_id semaphore = fDamageSemaphore;
+	bigtime_t lastFlush = 0;
+
+	while (true) {
+		// wait until there is something to flush
+		status_t status = acquire_sem(semaphore);
+		if (status == B_INTERRUPTED)
+			continue;
+		if (status != B_OK)
+			break;
+
+		// An update after an idle period is flushed right away, everything
+		// that comes in faster than the frame rate is collected until the
+		// next frame is due.
+		bigtime_t nextFlush = lastFlush + fFrameInterval;
+		if (system_time() < nextFlush)
+			snooze_until(nextFlush, B_SYSTEM_TIMEBASE);
+
+		lastFlush = system_time();
+		FlushDamage();
+	}
+}
+
+
+/*!	The object must already be locked!
+*/
+void
+HWInterface::_FlushDamage()
+{
+	BAutolock _(fFlushLock);
+
+	BRegion damage;
+	fDamage.TakeDamage(damage);
+	if (damage.CountRects() == 0)
+		return;
+
+	fDamage.AddFlush();
+	_CopyRegionToFront(damage);
+}
+
+
 // #pragma mark -
 
 
@@ -21,6 +21,7 @@
 
 #include <new>
 
+#include "DamageTracker.h"
 #include "IntRect.h"
 #include "MultiLocker.h"
 #include "ServerCursor.h"
@@ -149,6 +150,18 @@ public:
 	// while CopyBackToFront() actually performs the operation
 	virtual	status_t			CopyBackToFront(const BRect& frame);
 
+	// With deferred updates, invalidated areas of the back buffer are
+	// collected and copied to the front buffer at most once per frame
+			void				SetDeferredUpdates(bool enabled,
+									bigtime_t frameInterval);
+			bool				DeferredUpdates() const
+									{ return fDeferredUpdates; }
+			void				FlushDamage();
+			void				AddDirectAccess(const BRegion& region);
+			void				RemoveDirectAccess(const BRegion& region);
+			void				GetDamageStatistics(
+									damage_statistics& statistics) const;
+
 protected:
 	virtual	void				_CopyBackToFront(/*const*/ BRegion& region);
 
@@ -190,6 +203,9 @@ protected:
 			void				_NotifyFrameBufferChanged();
 			void				_NotifyScreenChanged();
 
+			void				_StopDeferredUpdates();
+			status_t			_CopyRegionToFront(const BRegion& region);
+
 	static	bool				_IsValidMode(const display_mode& mode);
 
 			// If we draw the cursor somewhere in the drawing buffer,
@@ -245,8 +261,20 @@ protected:
 
 			int					fVGADevice;
 
+private:
+	static	status_t			_DamageThreadEntry(void* data);
+			void				_DamageThread();
+			void				_FlushDamage();
+
 private:
 			BList				fListeners;
+
+			DamageTracker		fDamage;
+			BLocker				fFlushLock;
+	volatile bool				fDeferredUpdates;
+	volatile bigtime_t			fFrameInterval;
+			thread_id			fDamageThread;
+			sem_id				fDamageSemaphore;
 };
 
 #endif // HW_INTERFACE_H
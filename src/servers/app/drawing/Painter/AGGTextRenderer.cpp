@@ -40,6 +40,7 @@ AGGTextRenderer::AGGTextRenderer(renderer_subpix_type& subpixRenderer,
 	fGray8Scanline(),
 	fMonoAdaptor(),
 	fMonoScanline(),
+	fAtlasScanline(),
 
 	fCurves(fPathAdaptor),
 	fContour(fCurves),
@@ -224,14 +225,17 @@ public:
 			// "glyphBounds" is now transformed into screen coords
 			// in order to stop drawing when we are already outside
 			// of the clipping frame
+			double transformedX = x + fTransformOffset.x;
+			double transformedY = y + fTransformOffset.y;
 			if (glyph->data_type != glyph_data_outline) {
 				// we cannot use the transformation pipeline
-				double transformedX = x + fTransformOffset.x;
-				double transformedY = y + fTransformOffset.y;
-				entry->InitAdaptors(glyph, transformedX, transformedY,
-					fRenderer.fMonoAdaptor,
-					fRenderer.fGray8Adaptor,
-					fRenderer.fPathAdaptor);
+				if (glyph->coverage == NULL
+					|| fRenderer.fMaskedScanline != NULL) {
+					entry->InitAdaptors(glyph, transformedX, transformedY,
+						fRenderer.fMonoAdaptor,
+						fRenderer.fGray8Adaptor,
+						fRenderer.fPathAdaptor);
+				}
 
 				glyphBounds.OffsetBy(fTransformOffset);
 			} else {
@@ -260,6 +264,9 @@ public:
 							agg::render_scanlines(fRenderer.fGray8Adaptor,
 								*fRenderer.fMaskedScanline,
 								fRenderer.fSolidRenderer);
+						} else if (glyph->coverage != NULL) {
+							_RenderAtlasGlyph(glyph, agg::iround(transformedX),
+								agg::iround(transformedY));
 						} else {
 							agg::render_scanlines(fRenderer.fGray8Adaptor,
 								fRenderer.fGray8Scanline,
@@ -325,6 +332,41 @@ public:
 	}
 
 private:
+	void _RenderAtlasGlyph(const GlyphCache* glyph, int x, int y)
+	{
+		// Hand the glyph bitmap over row by row, leaving out the pixels
+		// it does not cover at all, just like its scanlines would.
+		const agg::rect_i& bounds = glyph->bounds;
+		agg::scanline_u8& scanline = fRenderer.fAtlasScanline;
+		scanline.reset(bounds.x1 + x, bounds.x2 + x);
+
+		int32 width = bounds.x2 - bounds.x1 + 1;
+		const uint8* row = glyph->coverage;
+		for (int32 rowY = bounds.y1; rowY <= bounds.y2;
+				rowY++, row += glyph->coverage_bytes_per_row) {
+			scanline.reset_spans();
+
+			int32 start = 0;
+			while (start < width) {
+				while (start < width && row[start] == 0)
+					start++;
+				int32 end = start;
+				while (end < width && row[end] != 0)
+					end++;
+				if (end > start) {
+					scanline.add_cells(bounds.x1 + x + start, end - start,
+						row + start);
+				}
+				start = end;
+			}
+
+			if (scanline.num_spans() > 0) {
+				scanline.finalize(rowY + y);
+				fRenderer.fSolidRenderer.render(scanline);
+			}
+		}
+	}
+
 	void _DrawHorizontalLine(float y)
 	{
 		agg::path_storage path;
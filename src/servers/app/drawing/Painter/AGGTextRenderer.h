@@ -71,6 +71,8 @@ private:
 	FontCacheEntry::GlyphGray8Scanline	fGray8Scanline;
 	FontCacheEntry::GlyphMonoAdapter	fMonoAdaptor;
 	FontCacheEntry::GlyphMonoScanline	fMonoScanline;
+	agg::scanline_u8					fAtlasScanline;
+		// for glyphs drawn from the GlyphAtlas
 
 	FontCacheEntry::CurveConverter		fCurves;
 	FontCacheEntry::ContourConverter	fContour;
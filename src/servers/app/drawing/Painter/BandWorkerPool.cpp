@@ -0,0 +1,168 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	A small set of threads that help rendering large primitives, by
+	drawing horizontal bands of them concurrently.
+*/
+
+
+#include "BandWorkerPool.h"
+
+#include <new>
+#include <pthread.h>
+
+
+static const int32 kMaxThreads = 7;
+
+static pthread_once_t sDefaultPoolInitOnce = PTHREAD_ONCE_INIT;
+static BandWorkerPool* sDefaultPool;
+
+
+BandJob::~BandJob()
+{
+}
+
+
+// #pragma mark -
+
+
+BandWorkerPool::BandWorkerPool(int32 threadCount)
+	:
+	fLock("band worker pool"),
+	fStartSemaphore(-1),
+	fDoneSemaphore(-1),
+	fThreadCount(threadCount),
+	fJob(NULL),
+	fBandCount(0),
+	fNextBand(0)
+{
+}
+
+
+BandWorkerPool::~BandWorkerPool()
+{
+	// Deleting the semaphores lets the workers quit
+	delete_sem(fStartSemaphore);
+	delete_sem(fDoneSemaphore);
+}
+
+
+/*static*/ void
+BandWorkerPool::_InitDefault()
+{
+	system_info info;
+	get_system_info(&info);
+
+	int32 threadCount = min_c((int32)info.cpu_count - 1, kMaxThreads);
+	if (threadCount <= 0)
+		return;
+
+	BandWorkerPool* pool = new(std::nothrow) BandWorkerPool(threadCount);
+	if (pool != NULL && pool->_Init() != B_OK) {
+		delete pool;
+		pool = NULL;
+	}
+	sDefaultPool = pool;
+}
+
+
+/*!	Returns the shared pool, or \c NULL if there is only a single CPU, and
+	drawing can't be sped up this way.
+*/
+/*static*/ BandWorkerPool*
+BandWorkerPool::Default()
+{
+	pthread_once(&sDefaultPoolInitOnce, &_InitDefault);
+	return sDefaultPool;
+}
+
+
+/*!	Calls BandJob::RenderBand() for all bands of the \a job, using the
+	calling thread as well as the workers, and returns once all bands have
+	been rendered.
+	If the workers are busy with another job, \c false is returned right
+	away, and the caller is expected to render the job on its own.
+*/
+bool
+BandWorkerPool::Run(BandJob& job, int32 bandCount)
+{
+	if (fLock.LockWithTimeout(0) != B_OK)
+		return false;
+
+	fJob = &job;
+	fBandCount = bandCount;
+	fNextBand = 0;
+
+	int32 workerCount = min_c(fThreadCount, bandCount - 1);
+	release_sem_etc(fStartSemaphore, workerCount, B_DO_NOT_RESCHEDULE);
+
+	_RenderBands();
+
+	status_t status;
+	do {
+		status = acquire_sem_etc(fDoneSemaphore, workerCount, 0, 0);
+	} while (status == B_INTERRUPTED);
+
+	fJob = NULL;
+	fLock.Unlock();
+	return true;
+}
+
+
+status_t
+BandWorkerPool::_Init()
+{
+	fStartSemaphore = create_sem(0, "band worker start");
+	if (fStartSemaphore < 0)
+		return fStartSemaphore;
+
+	fDoneSemaphore = create_sem(0, "band worker done");
+	if (fDoneSemaphore < 0)
+		return fDoneSemaphore;
+
+	for (int32 i = 0; i < fThreadCount; i++) {
+		thread_id thread = spawn_thread(&_WorkerThread, "band worker",
+			B_DISPLAY_PRIORITY, this);
+		if (thread < 0) {
+			// work with what we've got
+			fThreadCount = i;
+			break;
+		}
+
+		resume_thread(thread);
+	}
+
+	return fThreadCount > 0 ? B_OK : B_ERROR;
+}
+
+
+void
+BandWorkerPool::_RenderBands()
+{
+	int32 band;
+	while ((band = atomic_add(&fNextBand, 1)) < fBandCount)
+		fJob->RenderBand(band);
+}
+
+
+/*static*/ status_t
+BandWorkerPool::_WorkerThread(void* data)
+{
+	BandWorkerPool* pool = (BandWorkerPool*)data;
+
+	while (true) {
+		status_t status = acquire_sem(pool->fStartSemaphore);
+		if (status == B_INTERRUPTED)
+			continue;
+		if (status != B_OK)
+			break;
+
+		pool->_RenderBands();
+		release_sem_etc(pool->fDoneSemaphore, 1, B_DO_NOT_RESCHEDULE);
+	}
+
+	return B_OK;
+}
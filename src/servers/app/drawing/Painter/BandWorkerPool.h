@@ -0,0 +1,52 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef BAND_WORKER_POOL_H
+#define BAND_WORKER_POOL_H
+
+
+#include <Locker.h>
+#include <OS.h>
+
+
+class BandJob {
+public:
+	virtual						~BandJob();
+
+	virtual	void				RenderBand(int32 band) = 0;
+};
+
+
+class BandWorkerPool {
+public:
+	static	BandWorkerPool*		Default();
+
+			int32				CountThreads() const
+									{ return fThreadCount; }
+
+			bool				Run(BandJob& job, int32 bandCount);
+
+private:
+								BandWorkerPool(int32 threadCount);
+								~BandWorkerPool();
+
+			status_t			_Init();
+			void				_RenderBands();
+
+	static	void				_InitDefault();
+	static	status_t			_WorkerThread(void* data);
+
+private:
+			BLocker				fLock;
+			sem_id				fStartSemaphore;
+			sem_id				fDoneSemaphore;
+			int32				fThreadCount;
+
+			BandJob*			fJob;
+			int32				fBandCount;
+			int32				fNextBand;
+};
+
+
+#endif	// BAND_WORKER_POOL_H
@@ -53,6 +53,7 @@
 #include <View.h>
 
 #include "AlphaMask.h"
+#include "BandWorkerPool.h"
 #include "BitmapPainter.h"
 #include "DrawingMode.h"
 #include "GlobalSubpixelSettings.h"
@@ -106,18 +107,37 @@ using std::nothrow;
 #define fCurve					fInternal.fCurve
 
 
+// Tiled rendering is only used for primitives covering at least this many
+// pixels, and each band has at least this many rows.
+static const int64 kMinTiledRenderingArea = 512 * 512;
+static const int32 kMinBandHeight = 32;
+
+
 static uint32 detect_simd();
 
 uint32 gSIMDFlags = detect_simd();
 
 
+#if __i386__ || __x86_64__
+static inline uint64
+read_xcr0()
+{
+	uint32 low;
+	uint32 high;
+	// xgetbv, spelled out for older assemblers
+	asm volatile(".byte 0x0f, 0x01, 0xd0" : "=a" (low), "=d" (high) : "c" (0));
+	return ((uint64)high << 32) | low;
+}
+#endif
+
+
 /*!	Detect SIMD flags for use in AppServer. Checks all CPUs in the system
 	and chooses the minimum supported set of instructions.
 */
 static uint32
 detect_simd()
 {
-#if __i386__
+#if __i386__ || __x86_64__
 	// Only scan CPUs for which we are certain the SIMD flags are properly
 	// defined.
 	const char* vendorNames[] = {
@@ -156,12 +176,23 @@ detect_simd()
 		uint32 cpuSIMD = 0;
 		uint32 maxStdFunc = cpuInfo.regs.eax;
 		if (vendorFound && maxStdFunc >= 1) {
-			get_cpuid(&cpuInfo, 1, 0);
+			get_cpuid(&cpuInfo, 1, cpu);
 			uint32 edx = cpuInfo.regs.edx;
+			uint32 ecx = cpuInfo.regs.ecx;
 			if (edx & (1 << 23))
 				cpuSIMD |= APPSERVER_SIMD_MMX;
 			if (edx & (1 << 25))
 				cpuSIMD |= APPSERVER_SIMD_SSE;
+			if (edx & (1 << 26))
+				cpuSIMD |= APPSERVER_SIMD_SSE2;
+
+			// AVX2 also needs the kernel to save the YMM registers
+			if ((ecx & (1 << 27)) != 0 && (ecx & (1 << 28)) != 0
+				&& maxStdFunc >= 7 && (read_xcr0() & 0x6) == 0x6) {
+				get_cpuid(&cpuInfo, 7, cpu);
+				if (cpuInfo.regs.ebx & (1 << 5))
+					cpuSIMD |= APPSERVER_SIMD_AVX2;
+			}
 		} else {
 			// no flags can be identified
 			cpuSIMD = 0;
@@ -169,7 +200,7 @@ detect_simd()
 		systemSIMD &= cpuSIMD;
 	}
 	return systemSIMD;
-#else	// !__i386__
+#else	// !__i386__ && !__x86_64__
 	return 0;
 #endif
 }
@@ -199,6 +230,275 @@ private:
 };
 
 
+/*!	Plays back the vertices of a recorded path. Unlike with the path itself,
+	any number of them can iterate over the path at the same time.
+*/
+class PathReplay {
+public:
+	PathReplay(const agg::path_storage& path)
+		:
+		fRecordedPath(path),
+		fIndex(0)
+	{
+	}
+
+	void rewind(unsigned pathID)
+	{
+		fIndex = 0;
+	}
+
+	unsigned vertex(double* x, double* y)
+	{
+		if (fIndex >= fRecordedPath.total_vertices())
+			return agg::path_cmd_stop;
+
+		return fRecordedPath.vertex(fIndex++, x, y);
+	}
+
+private:
+	const agg::path_storage&	fRecordedPath;
+	unsigned					fIndex;
+};
+
+
+/*!	Rasterizes a recorded path for one band. Every band rasterizes the
+	complete path with the painter's settings, but only sweeps its own
+	scanlines, so the coverage values are exactly the same as when the path
+	is drawn in one go.
+*/
+class PathBandRenderer : public Painter::BandRenderer {
+public:
+	PathBandRenderer(const agg::path_storage& path, const BRect& bounds,
+			const clipping_rect& clipBox, agg::filling_rule_e fillRule)
+		:
+		fRecordedPath(path),
+		fClipBox(clipBox),
+		fFillRule(fillRule)
+	{
+		fBounds.left = (int32)floorf(bounds.left);
+		fBounds.top = (int32)floorf(bounds.top);
+		fBounds.right = (int32)ceilf(bounds.right);
+		fBounds.bottom = (int32)ceilf(bounds.bottom);
+	}
+
+	virtual void RenderBand(renderer_base& baseRenderer, int32 top,
+		int32 bottom)
+	{
+		// don't rasterize the whole path for a band it doesn't reach
+		if (!_ReachesClipping(baseRenderer))
+			return;
+
+		rasterizer_type rasterizer;
+#if ALIASED_DRAWING
+		rasterizer.gamma(agg::gamma_threshold(0.5));
+#endif
+		rasterizer.clip_box(fClipBox.left, fClipBox.top, fClipBox.right + 1,
+			fClipBox.bottom + 1);
+		rasterizer.filling_rule(fFillRule);
+
+		PathReplay path(fRecordedPath);
+		rasterizer.add_path(path);
+
+		if (!rasterizer.rewind_scanlines())
+			return;
+		if (top > rasterizer.min_y() && !rasterizer.navigate_scanline(top))
+			return;
+
+		RenderScanlines(rasterizer, baseRenderer, bottom);
+	}
+
+protected:
+	virtual void RenderScanlines(rasterizer_type& rasterizer,
+		renderer_base& baseRenderer, int32 bottom) = 0;
+
+	template<class Scanline, class Renderer>
+	static void _Sweep(rasterizer_type& rasterizer, Scanline& scanline,
+		Renderer& renderer, int32 bottom)
+	{
+		scanline.reset(rasterizer.min_x(), rasterizer.max_x());
+		renderer.prepare();
+
+		while (rasterizer.sweep_scanline(scanline) && scanline.y() <= bottom)
+			renderer.render(scanline);
+	}
+
+private:
+	bool _ReachesClipping(renderer_base& baseRenderer) const
+	{
+		baseRenderer.first_clip_box();
+		do {
+			if (baseRenderer.xmin() <= fBounds.right
+				&& baseRenderer.xmax() >= fBounds.left
+				&& baseRenderer.ymin() <= fBounds.bottom
+				&& baseRenderer.ymax() >= fBounds.top) {
+				return true;
+			}
+		} while (baseRenderer.next_clip_box());
+
+		return false;
+	}
+
+private:
+	const agg::path_storage&	fRecordedPath;
+	clipping_rect				fBounds;
+	clipping_rect				fClipBox;
+	agg::filling_rule_e			fFillRule;
+};
+
+
+class SolidPathBandRenderer : public PathBandRenderer {
+public:
+	SolidPathBandRenderer(const agg::path_storage& path, const BRect& bounds,
+			const clipping_rect& clipBox, agg::filling_rule_e fillRule,
+			const agg::rgba8& color)
+		:
+		PathBandRenderer(path, bounds, clipBox, fillRule),
+		fColor(color)
+	{
+	}
+
+protected:
+	virtual void RenderScanlines(rasterizer_type& rasterizer,
+		renderer_base& baseRenderer, int32 bottom)
+	{
+		scanline_packed_type scanline;
+		renderer_type renderer(baseRenderer);
+		renderer.color(fColor);
+
+		_Sweep(rasterizer, scanline, renderer, bottom);
+	}
+
+private:
+	agg::rgba8					fColor;
+};
+
+
+template<class GradientFunction>
+class GradientPathBandRenderer : public PathBandRenderer {
+public:
+	typedef agg::span_interpolator_linear<> interpolator_type;
+	typedef agg::pod_auto_array<agg::rgba8, 256> color_array_type;
+	typedef agg::span_allocator<agg::rgba8> span_allocator_type;
+	typedef agg::span_gradient<agg::rgba8, interpolator_type,
+				GradientFunction, color_array_type> span_gradient_type;
+	typedef agg::renderer_scanline_aa<renderer_base, span_allocator_type,
+				span_gradient_type> renderer_gradient_type;
+
+	GradientPathBandRenderer(const agg::path_storage& path,
+			const BRect& bounds, const clipping_rect& clipBox,
+			agg::filling_rule_e fillRule,
+			const agg::trans_affine& gradientTransform,
+			const GradientFunction& function, const color_array_type& colors,
+			int gradientStop)
+		:
+		PathBandRenderer(path, bounds, clipBox, fillRule),
+		fGradientTransform(gradientTransform),
+		fFunction(function),
+		fColors(colors),
+		fGradientStop(gradientStop)
+	{
+	}
+
+protected:
+	virtual void RenderScanlines(rasterizer_type& rasterizer,
+		renderer_base& baseRenderer, int32 bottom)
+	{
+		interpolator_type spanInterpolator(fGradientTransform);
+		span_allocator_type spanAllocator;
+		span_gradient_type spanGradient(spanInterpolator, fFunction, fColors,
+			0, fGradientStop);
+		renderer_gradient_type renderer(baseRenderer, spanAllocator,
+			spanGradient);
+		scanline_unpacked_type scanline;
+
+		_Sweep(rasterizer, scanline, renderer, bottom);
+	}
+
+private:
+	const agg::trans_affine&	fGradientTransform;
+	const GradientFunction&		fFunction;
+	const color_array_type&		fColors;
+	int							fGradientStop;
+};
+
+
+class Painter::TiledJob : public BandJob {
+public:
+	TiledJob(const Painter* painter, const BRect& bounds, int32 bandCount,
+			BandRenderer& renderer)
+		:
+		fPainter(painter),
+		fBounds(bounds),
+		fBandCount(bandCount),
+		fBandRenderer(renderer)
+	{
+	}
+
+	virtual void RenderBand(int32 band)
+	{
+		BRegion clipping;
+		if (!fPainter->_GetBandClipping(_BandTop(band), _BandTop(band + 1) - 1,
+				clipping)) {
+			return;
+		}
+
+		// a renderer of our own, with the same offset, but clipped to the band
+		const renderer_base& painterRenderer = fPainter->fBaseRenderer;
+		renderer_base baseRenderer(fPainter->fPixelFormat);
+		baseRenderer.set_clipping_region(&clipping);
+		baseRenderer.set_offset(painterRenderer.translate_from_base_ren_x(0),
+			painterRenderer.translate_from_base_ren_y(0));
+
+		clipping_rect frame = clipping.FrameInt();
+		fBandRenderer.RenderBand(baseRenderer, frame.top, frame.bottom);
+	}
+
+private:
+	int32 _BandTop(int32 band) const
+	{
+		int32 top = (int32)floorf(fBounds.top);
+		int32 bottom = (int32)ceilf(fBounds.bottom);
+		if (band == 0)
+			return top;
+		if (band == fBandCount)
+			return bottom + 1;
+
+		// The neighbouring band computes the same row, so there are neither
+		// gaps nor overlaps
+		int32 y = top + (int32)((int64)(bottom - top + 1) * band / fBandCount);
+		while (y <= bottom && !fBandRenderer.CanEndBandAt(y - 1))
+			y++;
+
+		return y;
+	}
+
+private:
+	const Painter*		fPainter;
+	BRect				fBounds;
+	int32				fBandCount;
+	BandRenderer&		fBandRenderer;
+};
+
+
+// #pragma mark -
+
+
+Painter::BandRenderer::~BandRenderer()
+{
+}
+
+
+/*!	Returns whether a band may end with row \a y. Since each band is clipped
+	separately, this lets renderers that treat the last row of a clipping
+	rect specially keep their output identical to untiled rendering.
+*/
+bool
+Painter::BandRenderer::CanEndBandAt(int32 y) const
+{
+	return true;
+}
+
+
 // #pragma mark -
 
 
@@ -207,6 +507,7 @@ Painter::Painter()
 	fSubpixelPrecise(false),
 	fValidClipping(false),
 	fAttached(false),
+	fTiledRendering(BandWorkerPool::Default() != NULL),
 
 	fPenSize(1.0),
 	fClippingRegion(NULL),
@@ -216,6 +517,7 @@ Painter::Painter()
 	fLineCapMode(B_BUTT_CAP),
 	fLineJoinMode(B_MITER_JOIN),
 	fMiterLimit(B_DEFAULT_MITER_LIMIT),
+	fFillRule(agg::fill_non_zero),
 
 	fPatternHandler(),
 	fTextRenderer(fSubpixRenderer, fRenderer, fRendererBin, fUnpackedScanline,
@@ -450,11 +752,11 @@ Painter::SetStrokeMode(cap_mode lineCap, join_mode joinMode, float miterLimit)
 void
 Painter::SetFillRule(int32 fillRule)
 {
-	agg::filling_rule_e aggFillRule = fillRule == B_EVEN_ODD
+	fFillRule = fillRule == B_EVEN_ODD
 		? agg::fill_even_odd : agg::fill_non_zero;
 
-	fRasterizer.filling_rule(aggFillRule);
-	fSubpixRasterizer.filling_rule(aggFillRule);
+	fRasterizer.filling_rule(fFillRule);
+	fSubpixRasterizer.filling_rule(fFillRule);
 }
 
 
@@ -1641,6 +1943,34 @@ Painter::SetRendererOffset(int32 offsetX, int32 offsetY)
 }
 
 
+/*!	Enables or disables splitting large primitives into horizontal bands
+	that are rendered concurrently. Either way, the result is the same.
+*/
+void
+Painter::SetTiledRendering(bool tiled)
+{
+	fTiledRendering = tiled && BandWorkerPool::Default() != NULL;
+}
+
+
+/*!	Lets \a renderer draw the parts of the clipping region within \a bounds
+	in several horizontal bands at the same time.
+	Returns \c false without drawing anything if tiled rendering is not
+	enabled, not worth it for \a bounds, or if the worker threads are busy;
+	the caller needs to draw the primitive itself then.
+*/
+bool
+Painter::RenderTiled(const BRect& bounds, BandRenderer& renderer) const
+{
+	int32 bandCount = _CountBands(bounds);
+	if (bandCount < 2)
+		return false;
+
+	TiledJob job(this, bounds, bandCount, renderer);
+	return BandWorkerPool::Default()->Run(job, bandCount);
+}
+
+
 // #pragma mark - private
 
 
@@ -1696,6 +2026,44 @@ Painter::_Clipped(const BRect& rect) const
 }
 
 
+int32
+Painter::_CountBands(const BRect& bounds) const
+{
+	if (!fTiledRendering || !fValidClipping || fMaskedUnpackedScanline != NULL
+		|| !bounds.IsValid()) {
+		return 1;
+	}
+
+	int64 width = bounds.IntegerWidth() + 1;
+	int32 height = bounds.IntegerHeight() + 1;
+	if (width * height < kMinTiledRenderingArea)
+		return 1;
+
+	// use a few more bands than threads to even out the load
+	int32 bandCount = (BandWorkerPool::Default()->CountThreads() + 1) * 2;
+	return min_c(bandCount, height / kMinBandHeight);
+}
+
+
+/*!	Computes the part of the clipping region between the rows \a top and
+	\a bottom. Returns \c false if there is nothing to draw in it.
+*/
+bool
+Painter::_GetBandClipping(int32 top, int32 bottom, BRegion& clipping) const
+{
+	if (top > bottom)
+		return false;
+
+	clipping_rect rect = fClippingRegion->FrameInt();
+	rect.top = top;
+	rect.bottom = bottom;
+
+	clipping.Set(rect);
+	clipping.IntersectWith(fClippingRegion);
+	return clipping.Frame().IsValid();
+}
+
+
 // _UpdateDrawingMode
 void
 Painter::_UpdateDrawingMode()
@@ -2032,6 +2400,8 @@ template<class VertexSource>
 BRect
 Painter::_RasterizePath(VertexSource& path) const
 {
+	BRect bounds = _Clipped(_BoundingBox(path));
+
 	if (fMaskedUnpackedScanline != NULL) {
 		// TODO: we can't do both alpha-masking and subpixel AA.
 		fRasterizer.reset();
@@ -2044,12 +2414,22 @@ Painter::_RasterizePath(VertexSource& path) const
 		agg::render_scanlines(fSubpixRasterizer,
 			fSubpixPackedScanline, fSubpixRenderer);
 	} else {
+		if (_CountBands(bounds) > 1) {
+			agg::path_storage recordedPath;
+			recordedPath.concat_path(path);
+
+			SolidPathBandRenderer renderer(recordedPath, bounds,
+				fClippingRegion->FrameInt(), fFillRule, fRenderer.color());
+			if (RenderTiled(bounds, renderer))
+				return bounds;
+		}
+
 		fRasterizer.reset();
 		fRasterizer.add_path(path);
 		agg::render_scanlines(fRasterizer, fPackedScanline, fRenderer);
 	}
 
-	return _Clipped(_BoundingBox(path));
+	return bounds;
 }
 
 
@@ -2299,12 +2679,26 @@ Painter::_RasterizePath(VertexSource& path, const BGradient& gradient,
 
 	SolidPatternGuard _(this);
 
-	interpolator_type spanInterpolator(gradientTransform);
-	span_allocator_type spanAllocator;
 	color_array_type colorArray;
-
 	_MakeGradient(colorArray, gradient);
 
+	if (fMaskedUnpackedScanline == NULL) {
+		BRect bounds = _Clipped(_BoundingBox(path));
+		if (_CountBands(bounds) > 1) {
+			agg::path_storage recordedPath;
+			recordedPath.concat_path(path);
+
+			GradientPathBandRenderer<GradientFunction> renderer(recordedPath,
+				bounds, fClippingRegion->FrameInt(), fFillRule,
+				gradientTransform, function, colorArray, gradientStop);
+			if (RenderTiled(bounds, renderer))
+				return;
+		}
+	}
+
+	interpolator_type spanInterpolator(gradientTransform);
+	span_allocator_type spanAllocator;
+
 	span_gradient_type spanGradient(spanInterpolator, function, colorArray,
 		0, gradientStop);
 
@@ -17,6 +17,7 @@
 #include "PainterAggInterface.h"
 #include "PatternHandler.h"
 #include "ServerFont.h"
+#include "SIMDFlags.h"
 #include "Transformable.h"
 
 #include "defines.h"
@@ -43,12 +44,17 @@ class ServerBitmap;
 class ServerFont;
 
 
-// Defines for SIMD support.
-#define APPSERVER_SIMD_MMX	(1 << 0)
-#define APPSERVER_SIMD_SSE	(1 << 1)
+class Painter {
+public:
+	class BandRenderer {
+	public:
+		virtual					~BandRenderer();
 
+		virtual	bool			CanEndBandAt(int32 y) const;
+		virtual	void			RenderBand(renderer_base& baseRenderer,
+									int32 top, int32 bottom) = 0;
+	};
 
-class Painter {
 public:
 								Painter();
 	virtual						~Painter();
@@ -262,6 +268,14 @@ public:
 			void				SetRendererOffset(int32 offsetX,
 									int32 offsetY);
 
+								// tiled rendering
+			void				SetTiledRendering(bool tiled);
+	inline	bool				TiledRendering() const
+									{ return fTiledRendering; }
+
+			bool				RenderTiled(const BRect& bounds,
+									BandRenderer& renderer) const;
+
 private:
 			float				_Align(float coord, bool round,
 									bool centerOffset) const;
@@ -273,6 +287,10 @@ private:
 									bool centerOffset = true) const;
 			BRect				_Clipped(const BRect& rect) const;
 
+			int32				_CountBands(const BRect& bounds) const;
+			bool				_GetBandClipping(int32 top, int32 bottom,
+									BRegion& clipping) const;
+
 			void				_UpdateFont() const;
 			void				_UpdateLineWidth();
 			void				_UpdateDrawingMode();
@@ -344,8 +362,10 @@ private:
 
 private:
 	class BitmapPainter;
+	class TiledJob;
 
 	friend class BitmapPainter; // needed only for gcc2
+	friend class TiledJob;
 
 private:
 	// for internal coordinate rounding/transformation
@@ -353,6 +373,7 @@ private:
 			bool				fValidClipping : 1;
 			bool				fAttached : 1;
 			bool				fIdentityTransform : 1;
+			bool				fTiledRendering : 1;
 
 			Transformable		fTransform;
 			float				fPenSize;
@@ -363,6 +384,7 @@ private:
 			cap_mode			fLineCapMode;
 			join_mode			fLineJoinMode;
 			float				fMiterLimit;
+			agg::filling_rule_e	fFillRule;
 
 			PatternHandler		fPatternHandler;
 
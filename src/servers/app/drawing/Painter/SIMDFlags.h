@@ -0,0 +1,24 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * The SIMD extensions of the CPU the Painter and its drawing modes may use.
+ *
+ */
+#ifndef SIMD_FLAGS_H
+#define SIMD_FLAGS_H
+
+
+#include <SupportDefs.h>
+
+
+#define APPSERVER_SIMD_MMX	(1 << 0)
+#define APPSERVER_SIMD_SSE	(1 << 1)
+#define APPSERVER_SIMD_SSE2	(1 << 2)
+#define APPSERVER_SIMD_AVX2	(1 << 3)
+
+
+extern uint32 gSIMDFlags;
+
+
+#endif // SIMD_FLAGS_H
@@ -20,9 +20,6 @@ extern "C" {
 }
 
 
-extern uint32 gSIMDFlags;
-
-
 namespace BitmapPainterPrivate {
 
 
@@ -44,11 +41,19 @@ template<class OptimizedVersion>
 struct DrawBitmapBilinearOptimized {
 	void Draw(PainterAggInterface& aggInterface, const BRect& destinationRect,
 		agg::rendering_buffer* bitmap, const FilterData& filterData)
+	{
+		Draw(aggInterface.fBuffer, aggInterface.fBaseRenderer, destinationRect,
+			bitmap, filterData);
+	}
+
+	void Draw(agg::rendering_buffer& buffer, renderer_base& baseRenderer,
+		const BRect& destinationRect, agg::rendering_buffer* bitmap,
+		const FilterData& filterData)
 	{
 		fSource = bitmap;
 		fSourceBytesPerRow = bitmap->stride();
 		fDestination = NULL;
-		fDestinationBytesPerRow = aggInterface.fBuffer.stride();
+		fDestinationBytesPerRow = buffer.stride();
 		fWeightsX = filterData.fWeightsX;
 		fWeightsY = filterData.fWeightsY;
 
@@ -57,8 +62,6 @@ struct DrawBitmapBilinearOptimized {
 		const int32 right = (int32)destinationRect.right;
 		const int32 bottom = (int32)destinationRect.bottom;
 
-		renderer_base& baseRenderer = aggInterface.fBaseRenderer;
-
 		// iterate over clipping boxes
 		baseRenderer.first_clip_box();
 		do {
@@ -73,7 +76,7 @@ struct DrawBitmapBilinearOptimized {
 				continue;
 
 			// buffer offset into destination
-			fDestination = aggInterface.fBuffer.row_ptr(y1) + x1 * 4;
+			fDestination = buffer.row_ptr(y1) + x1 * 4;
 
 			// x and y are needed as indices into the weight arrays, so the
 			// offset into the target buffer needs to be compensated
@@ -478,6 +481,48 @@ struct BilinearSimd : DrawBitmapBilinearOptimized<BilinearSimd> {
 #endif	// __i386__
 
 
+/*!	Draws one band of a scaled bitmap with its own instance of the
+	\a OptimizedVersion, as that keeps state while drawing.
+*/
+template<class OptimizedVersion>
+class BilinearBandRenderer : public Painter::BandRenderer {
+public:
+	BilinearBandRenderer(agg::rendering_buffer& buffer,
+			const BRect& destinationRect, agg::rendering_buffer* bitmap,
+			const FilterData& filterData)
+		:
+		fBuffer(buffer),
+		fDestinationRect(destinationRect),
+		fBitmap(bitmap),
+		fFilterData(filterData)
+	{
+	}
+
+	virtual bool CanEndBandAt(int32 y) const
+	{
+		// The last row of a clipping rect is treated differently if it maps
+		// directly to a source row.
+		int32 index = y - (int32)fDestinationRect.top
+			- fFilterData.fIndexOffsetY;
+		return fFilterData.fWeightsY[index].weight != 255;
+	}
+
+	virtual void RenderBand(renderer_base& baseRenderer, int32 top,
+		int32 bottom)
+	{
+		OptimizedVersion bilinearPainter;
+		bilinearPainter.Draw(fBuffer, baseRenderer, fDestinationRect, fBitmap,
+			fFilterData);
+	}
+
+private:
+	agg::rendering_buffer&	fBuffer;
+	BRect					fDestinationRect;
+	agg::rendering_buffer*	fBitmap;
+	const FilterData&		fFilterData;
+};
+
+
 template<class ColorType, class DrawMode>
 struct DrawBitmapBilinear {
 	void
@@ -598,42 +643,34 @@ struct DrawBitmapBilinear {
 
 		if (typeid(ColorType) == typeid(ColorTypeRgb)
 			&& typeid(DrawMode) == typeid(DrawModeCopy)) {
+#ifdef __i386__
 			uint32 neededSIMDFlags = APPSERVER_SIMD_MMX | APPSERVER_SIMD_SSE;
 			if ((gSIMDFlags & neededSIMDFlags) == neededSIMDFlags)
 				codeSelect = kUseSIMDVersion;
-			else {
-				if (scaleX == scaleY && (scaleX == 1.5 || scaleX == 2.0
-					|| scaleX == 2.5 || scaleX == 3.0)) {
-					codeSelect = kOptimizeForLowFilterRatio;
-				}
+#endif
+			if (codeSelect != kUseSIMDVersion && scaleX == scaleY
+				&& (scaleX == 1.5 || scaleX == 2.0 || scaleX == 2.5
+					|| scaleX == 3.0)) {
+				codeSelect = kOptimizeForLowFilterRatio;
 			}
 		}
 
 		switch (codeSelect) {
 			case kUseDefaultVersion:
-			{
-				BilinearDefault<ColorType, DrawMode> bilinearPainter;
-				bilinearPainter.Draw(aggInterface, destinationRect, &bitmap,
-					filterData);
+				_Draw<BilinearDefault<ColorType, DrawMode> >(painter,
+					aggInterface, destinationRect, &bitmap, filterData);
 				break;
-			}
 
 			case kOptimizeForLowFilterRatio:
-			{
-				BilinearLowFilterRatio bilinearPainter;
-				bilinearPainter.Draw(aggInterface, destinationRect,
-					&bitmap, filterData);
+				_Draw<BilinearLowFilterRatio>(painter, aggInterface,
+					destinationRect, &bitmap, filterData);
 				break;
-			}
 
 #ifdef __i386__
 			case kUseSIMDVersion:
-			{
-				BilinearSimd bilinearPainter;
-				bilinearPainter.Draw(aggInterface, destinationRect, &bitmap,
-					filterData);
+				_Draw<BilinearSimd>(painter, aggInterface, destinationRect,
+					&bitmap, filterData);
 				break;
-			}
 #endif	// __i386__
 		}
 
@@ -644,6 +681,26 @@ struct DrawBitmapBilinear {
 		//printf("draw bitmap %.5fx%.5f: %lld\n", scaleX, scaleY,
 		//	system_time() - now);
 	}
+
+private:
+	template<class OptimizedVersion>
+	static void
+	_Draw(const Painter* painter, PainterAggInterface& aggInterface,
+		const BRect& destinationRect, agg::rendering_buffer* bitmap,
+		const FilterData& filterData)
+	{
+		BilinearBandRenderer<OptimizedVersion> bandRenderer(
+			aggInterface.fBuffer, destinationRect, bitmap, filterData);
+		if (painter->RenderTiled(
+				destinationRect & painter->ClippingRegion()->Frame(),
+				bandRenderer)) {
+			return;
+		}
+
+		OptimizedVersion bilinearPainter;
+		bilinearPainter.Draw(aggInterface, destinationRect, bitmap,
+			filterData);
+	}
 };
 
 
@@ -0,0 +1,872 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * SSE2 and AVX2 versions of the most frequently used blending functions.
+ *
+ * Each of them works like the scalar version of the same name, only that it
+ * blends 4 (SSE2) or 8 (AVX2) pixels at a time. The arithmetic is the same
+ * as in the BLEND, BLEND16 macros and in blend_line32(), just carried out
+ * with 16 bit (and for BLEND16, 32 bit) intermediates, so the results are
+ * identical, down to the last bit. The remaining pixels of a span are
+ * handled by the scalar macros.
+ *
+ */
+
+#include "DrawingModeSIMD.h"
+
+#ifdef APPSERVER_SIMD_BLENDERS
+
+#include <string.h>
+
+#include <immintrin.h>
+
+
+#define SSE2_FUNCTION	__attribute__((target("sse2")))
+#define AVX2_FUNCTION	__attribute__((target("avx2")))
+
+
+static inline void
+assign_pixel(uint8* p, uint8 r, uint8 g, uint8 b)
+{
+	p[0] = b;
+	p[1] = g;
+	p[2] = r;
+	p[3] = 255;
+}
+
+
+static inline void
+assign_line(uint8* p, unsigned len, const color_type& c)
+{
+	uint32 v;
+	assign_pixel((uint8*)&v, c.r, c.g, c.b);
+
+	uint32* p32 = (uint32*)p;
+	do {
+		*p32++ = v;
+	} while (--len);
+}
+
+
+// #pragma mark - SSE2
+
+
+/*!	Returns (dst * (256 - alpha) + src * alpha) >> 8 for each of the eight
+	16 bit channels, which is what the BLEND macro computes.
+*/
+SSE2_FUNCTION
+static inline __m128i
+blend_sse2(__m128i dst, __m128i src, __m128i alpha)
+{
+	__m128i inverse = _mm_sub_epi16(_mm_set1_epi16(256), alpha);
+	return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(dst, inverse),
+		_mm_mullo_epi16(src, alpha)), 8);
+}
+
+
+/*!	Returns (dst * (65536 - alpha) + src * alpha) >> 16 for each of the eight
+	16 bit channels, which is what the BLEND16 macro computes. The products
+	don't fit into 16 bits, so their high and low words are added up as
+	32 bit values. \a alpha must not be 0.
+*/
+SSE2_FUNCTION
+static inline __m128i
+blend16_sse2(__m128i dst, __m128i src, __m128i alpha)
+{
+	__m128i inverse = _mm_sub_epi16(_mm_setzero_si128(), alpha);
+	__m128i dstLow = _mm_mullo_epi16(dst, inverse);
+	__m128i dstHigh = _mm_mulhi_epu16(dst, inverse);
+	__m128i srcLow = _mm_mullo_epi16(src, alpha);
+	__m128i srcHigh = _mm_mulhi_epu16(src, alpha);
+
+	__m128i sum0 = _mm_add_epi32(_mm_unpacklo_epi16(dstLow, dstHigh),
+		_mm_unpacklo_epi16(srcLow, srcHigh));
+	__m128i sum1 = _mm_add_epi32(_mm_unpackhi_epi16(dstLow, dstHigh),
+		_mm_unpackhi_epi16(srcLow, srcHigh));
+
+	return _mm_packs_epi32(_mm_srli_epi32(sum0, 16), _mm_srli_epi32(sum1, 16));
+}
+
+
+/*!	Returns \a mask ? \a a : \a b for each byte.
+*/
+SSE2_FUNCTION
+static inline __m128i
+select_sse2(__m128i mask, __m128i a, __m128i b)
+{
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+
+/*!	Returns the 16 bit masks \a low and \a high (each covering two pixels)
+	combined to a byte mask for four pixels.
+*/
+SSE2_FUNCTION
+static inline __m128i
+pack_mask_sse2(__m128i low, __m128i high)
+{
+	return _mm_packs_epi16(low, high);
+}
+
+
+/*!	Loads four covers, and spreads each of them over the four 16 bit
+	channels of its pixel.
+*/
+SSE2_FUNCTION
+static inline void
+load_covers_sse2(const uint8* covers, __m128i& low, __m128i& high)
+{
+	uint32 packed;
+	memcpy(&packed, covers, sizeof(packed));
+
+	__m128i expanded = _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed),
+		_mm_setzero_si128());
+	expanded = _mm_unpacklo_epi16(expanded, expanded);
+	low = _mm_unpacklo_epi32(expanded, expanded);
+	high = _mm_unpackhi_epi32(expanded, expanded);
+}
+
+
+/*!	Returns the color as 16 bit BGRA channels, twice.
+*/
+SSE2_FUNCTION
+static inline __m128i
+color_channels_sse2(const color_type& c)
+{
+	return _mm_set_epi16(255, c.r, c.g, c.b, 255, c.r, c.g, c.b);
+}
+
+
+SSE2_FUNCTION
+static void
+fill_line_sse2(uint8* p, unsigned len, const color_type& c)
+{
+	__m128i channels = color_channels_sse2(c);
+	__m128i solid = _mm_packus_epi16(channels, channels);
+
+	for (; len >= 4; len -= 4, p += 16)
+		_mm_storeu_si128((__m128i*)p, solid);
+
+	if (len > 0)
+		assign_line(p, len, c);
+}
+
+
+/*!	Blends \a len pixels with \a c and alpha values of \a alpha * covers,
+	like BLEND_ALPHA_CO and BLEND_ALPHA_PO do.
+*/
+SSE2_FUNCTION
+static void
+blend_solid_hspan_alpha_sse2(uint8* p, unsigned len, const color_type& c,
+	uint8 alpha, const uint8* covers)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i opaque = _mm_set1_epi32(0xff000000);
+	const __m128i fullAlpha = _mm_set1_epi16((int16)(255 * 255));
+	const __m128i alphaFactor = _mm_set1_epi16(alpha);
+	const __m128i color = color_channels_sse2(c);
+	const __m128i solid = _mm_packus_epi16(color, color);
+
+	for (; len >= 4; len -= 4, p += 16, covers += 4) {
+		__m128i alphaLow;
+		__m128i alphaHigh;
+		load_covers_sse2(covers, alphaLow, alphaHigh);
+		alphaLow = _mm_mullo_epi16(alphaLow, alphaFactor);
+		alphaHigh = _mm_mullo_epi16(alphaHigh, alphaFactor);
+
+		__m128i skip = pack_mask_sse2(_mm_cmpeq_epi16(alphaLow, zero),
+			_mm_cmpeq_epi16(alphaHigh, zero));
+		if (_mm_movemask_epi8(skip) == 0xffff)
+			continue;
+
+		__m128i assign = pack_mask_sse2(_mm_cmpeq_epi16(alphaLow, fullAlpha),
+			_mm_cmpeq_epi16(alphaHigh, fullAlpha));
+		if (_mm_movemask_epi8(assign) == 0xffff) {
+			_mm_storeu_si128((__m128i*)p, solid);
+			continue;
+		}
+
+		__m128i dst = _mm_loadu_si128((const __m128i*)p);
+		__m128i blended = _mm_packus_epi16(
+			blend16_sse2(_mm_unpacklo_epi8(dst, zero), color, alphaLow),
+			blend16_sse2(_mm_unpackhi_epi8(dst, zero), color, alphaHigh));
+		blended = select_sse2(assign, solid, _mm_or_si128(blended, opaque));
+		_mm_storeu_si128((__m128i*)p, select_sse2(skip, dst, blended));
+	}
+
+	for (; len > 0; len--, p += 4, covers++) {
+		uint16 pixelAlpha = alpha * *covers;
+		if (pixelAlpha == 255 * 255)
+			assign_pixel(p, c.r, c.g, c.b);
+		else if (pixelAlpha != 0)
+			BLEND16(p, c.r, c.g, c.b, pixelAlpha);
+	}
+}
+
+
+/*!	Blends \a len pixels with \a c and the constant \a alpha, like the
+	scalar blend_hline_alpha_co_solid() and blend_hline_alpha_po_solid() do,
+	including their use of blend_line32() for longer lines.
+*/
+SSE2_FUNCTION
+static void
+blend_hline_alpha_sse2(uint8* p, unsigned len, const color_type& c,
+	uint16 alpha)
+{
+	if (alpha == 255 * 255) {
+		fill_line_sse2(p, len, c);
+		return;
+	}
+
+	if (len < 4) {
+		do {
+			BLEND16(p, c.r, c.g, c.b, alpha);
+			p += 4;
+		} while (--len);
+		return;
+	}
+
+	// blend_line32()
+	uint8 a = alpha >> 8;
+	uint8 r = (c.r * a) >> 8;
+	uint8 g = (c.g * a) >> 8;
+	uint8 b = (c.b * a) >> 8;
+	a = 255 - a;
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i opaque = _mm_set1_epi32(0xff000000);
+	const __m128i inverse = _mm_set1_epi16(a);
+	const __m128i premultiplied = _mm_set_epi16(0, r, g, b, 0, r, g, b);
+
+	for (; len >= 4; len -= 4, p += 16) {
+		__m128i dst = _mm_loadu_si128((const __m128i*)p);
+		__m128i low = _mm_add_epi16(_mm_srli_epi16(
+			_mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), inverse), 8),
+			premultiplied);
+		__m128i high = _mm_add_epi16(_mm_srli_epi16(
+			_mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), inverse), 8),
+			premultiplied);
+		_mm_storeu_si128((__m128i*)p,
+			_mm_or_si128(_mm_packus_epi16(low, high), opaque));
+	}
+
+	for (; len > 0; len--, p += 4) {
+		p[0] = ((p[0] * a) >> 8) + b;
+		p[1] = ((p[1] * a) >> 8) + g;
+		p[2] = ((p[2] * a) >> 8) + r;
+		p[3] = 255;
+	}
+}
+
+
+SSE2_FUNCTION
+void
+blend_hline_over_solid_sse2(int x, int y, unsigned len, const color_type& c,
+	uint8 cover, agg_buffer* buffer, const PatternHandler* pattern)
+{
+	if (pattern->IsSolidLow())
+		return;
+
+	uint8* p = buffer->row_ptr(y) + (x << 2);
+	if (cover == 255) {
+		fill_line_sse2(p, len, c);
+		return;
+	}
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i opaque = _mm_set1_epi32(0xff000000);
+	const __m128i alpha = _mm_set1_epi16(cover);
+	const __m128i color = color_channels_sse2(c);
+
+	for (; len >= 4; len -= 4, p += 16) {
+		__m128i dst = _mm_loadu_si128((const __m128i*)p);
+		__m128i blended = _mm_packus_epi16(
+			blend_sse2(_mm_unpacklo_epi8(dst, zero), color, alpha),
+			blend_sse2(_mm_unpackhi_epi8(dst, zero), color, alpha));
+		_mm_storeu_si128((__m128i*)p, _mm_or_si128(blended, opaque));
+	}
+
+	for (; len > 0; len--, p += 4)
+		BLEND(p, c.r, c.g, c.b, cover);
+}
+
+
+SSE2_FUNCTION
+void
+blend_solid_hspan_over_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, const uint8* covers, agg_buffer* buffer,
+	const PatternHandler* pattern)
+{
+	if (pattern->IsSolidLow())
+		return;
+
+	uint8* p = buffer->row_ptr(y) + (x << 2);
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i opaque = _mm_set1_epi32(0xff000000);
+	const __m128i fullAlpha = _mm_set1_epi16(255);
+	const __m128i color = color_channels_sse2(c);
+	const __m128i solid = _mm_packus_epi16(color, color);
+
+	for (; len >= 4; len -= 4, p += 16, covers += 4) {
+		__m128i alphaLow;
+		__m128i alphaHigh;
+		load_covers_sse2(covers, alphaLow, alphaHigh);
+
+		__m128i skip = pack_mask_sse2(_mm_cmpeq_epi16(alphaLow, zero),
+			_mm_cmpeq_epi16(alphaHigh, zero));
+		if (_mm_movemask_epi8(skip) == 0xffff)
+			continue;
+
+		__m128i assign = pack_mask_sse2(_mm_cmpeq_epi16(alphaLow, fullAlpha),
+			_mm_cmpeq_epi16(alphaHigh, fullAlpha));
+		if (_mm_movemask_epi8(assign) == 0xffff) {
+			_mm_storeu_si128((__m128i*)p, solid);
+			continue;
+		}
+
+		__m128i dst = _mm_loadu_si128((const __m128i*)p);
+		__m128i blended = _mm_packus_epi16(
+			blend_sse2(_mm_unpacklo_epi8(dst, zero), color, alphaLow),
+			blend_sse2(_mm_unpackhi_epi8(dst, zero), color, alphaHigh));
+		blended = select_sse2(assign, solid, _mm_or_si128(blended, opaque));
+		_mm_storeu_si128((__m128i*)p, select_sse2(skip, dst, blended));
+	}
+
+	for (; len > 0; len--, p += 4, covers++) {
+		if (*covers == 255)
+			assign_pixel(p, c.r, c.g, c.b);
+		else if (*covers != 0)
+			BLEND(p, c.r, c.g, c.b, *covers);
+	}
+}
+
+
+SSE2_FUNCTION
+void
+blend_hline_alpha_co_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, uint8 cover, agg_buffer* buffer,
+	const PatternHandler* pattern)
+{
+	blend_hline_alpha_sse2(buffer->row_ptr(y) + (x << 2), len, c,
+		pattern->HighColor().alpha * cover);
+}
+
+
+SSE2_FUNCTION
+void
+blend_solid_hspan_alpha_co_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, const uint8* covers, agg_buffer* buffer,
+	const PatternHandler* pattern)
+{
+	blend_solid_hspan_alpha_sse2(buffer->row_ptr(y) + (x << 2), len, c,
+		pattern->HighColor().alpha, covers);
+}
+
+
+SSE2_FUNCTION
+void
+blend_hline_alpha_po_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, uint8 cover, agg_buffer* buffer,
+	const PatternHandler* pattern)
+{
+	blend_hline_alpha_sse2(buffer->row_ptr(y) + (x << 2), len, c,
+		c.a * cover);
+}
+
+
+SSE2_FUNCTION
+void
+blend_solid_hspan_alpha_po_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, const uint8* covers, agg_buffer* buffer,
+	const PatternHandler* pattern)
+{
+	blend_solid_hspan_alpha_sse2(buffer->row_ptr(y) + (x << 2), len, c, c.a,
+		covers);
+}
+
+
+SSE2_FUNCTION
+void
+blend_color_hspan_alpha_po_sse2(int x, int y, unsigned len,
+	const color_type* colors, const uint8* covers, uint8 cover,
+	agg_buffer* buffer, const PatternHandler* pattern)
+{
+	uint8* p = buffer->row_ptr(y) + (x << 2);
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i opaque = _mm_set1_epi32(0xff000000);
+	const __m128i fullAlpha = _mm_set1_epi16((int16)(255 * 255));
+
+	// like the scalar version, use the alpha of the first color for all of
+	// them if there are no covers
+	uint16 alpha = colors->a * cover;
+	if (covers == NULL && alpha == 0)
+		return;
+	const __m128i constantAlpha = _mm_set1_epi16(alpha);
+
+	for (; len >= 4; len -= 4, p += 16, colors += 4) {
+		// RGBA -> BGRA
+		__m128i src = _mm_loadu_si128((const __m128i*)colors);
+		__m128i srcLow = _mm_unpacklo_epi8(src, zero);
+		__m128i srcHigh = _mm_unpackhi_epi8(src, zero);
+		srcLow = _mm_shufflehi_epi16(
+			_mm_shufflelo_epi16(srcLow, _MM_SHUFFLE(3, 0, 1, 2)),
+			_MM_SHUFFLE(3, 0, 1, 2));
+		srcHigh = _mm_shufflehi_epi16(
+			_mm_shufflelo_epi16(srcHigh, _MM_SHUFFLE(3, 0, 1, 2)),
+			_MM_SHUFFLE(3, 0, 1, 2));
+		__m128i solid = _mm_or_si128(_mm_packus_epi16(srcLow, srcHigh),
+			opaque);
+
+		__m128i alphaLow = constantAlpha;
+		__m128i alphaHigh = constantAlpha;
+		if (covers != NULL) {
+			load_covers_sse2(covers, alphaLow, alphaHigh);
+			covers += 4;
+			alphaLow = _mm_mullo_epi16(alphaLow, _mm_shufflehi_epi16(
+				_mm_shufflelo_epi16(srcLow, _MM_SHUFFLE(3, 3, 3, 3)),
+				_MM_SHUFFLE(3, 3, 3, 3)));
+			alphaHigh = _mm_mullo_epi16(alphaHigh, _mm_shufflehi_epi16(
+				_mm_shufflelo_epi16(srcHigh, _MM_SHUFFLE(3, 3, 3, 3)),
+				_MM_SHUFFLE(3, 3, 3, 3)));
+		}
+
+		__m128i skip = pack_mask_sse2(_mm_cmpeq_epi16(alphaLow, zero),
+			_mm_cmpeq_epi16(alphaHigh, zero));
+		if (_mm_movemask_epi8(skip) == 0xffff)
+			continue;
+
+		__m128i assign = pack_mask_sse2(_mm_cmpeq_epi16(alphaLow, fullAlpha),
+			_mm_cmpeq_epi16(alphaHigh, fullAlpha));
+		if (_mm_movemask_epi8(assign) == 0xffff) {
+			_mm_storeu_si128((__m128i*)p, solid);
+			continue;
+		}
+
+		__m128i dst = _mm_loadu_si128((const __m128i*)p);
+		__m128i blended = _mm_packus_epi16(
+			blend16_sse2(_mm_unpacklo_epi8(dst, zero), srcLow, alphaLow),
+			blend16_sse2(_mm_unpackhi_epi8(dst, zero), srcHigh, alphaHigh));
+		blended = select_sse2(assign, solid, _mm_or_si128(blended, opaque));
+		_mm_storeu_si128((__m128i*)p, select_sse2(skip, dst, blended));
+	}
+
+	for (; len > 0; len--, p += 4, colors++) {
+		uint16 pixelAlpha = alpha;
+		if (covers != NULL)
+			pixelAlpha = colors->a * *covers++;
+
+		if (pixelAlpha == 255 * 255)
+			assign_pixel(p, colors->r, colors->g, colors->b);
+		else if (pixelAlpha != 0)
+			BLEND16(p, colors->r, colors->g, colors->b, pixelAlpha);
+	}
+}
+
+
+// #pragma mark - AVX2
+
+
+AVX2_FUNCTION
+static inline __m256i
+blend_avx2(__m256i dst, __m256i src, __m256i alpha)
+{
+	__m256i inverse = _mm256_sub_epi16(_mm256_set1_epi16(256), alpha);
+	return _mm256_srli_epi16(_mm256_add_epi16(
+		_mm256_mullo_epi16(dst, inverse), _mm256_mullo_epi16(src, alpha)), 8);
+}
+
+
+AVX2_FUNCTION
+static inline __m256i
+blend16_avx2(__m256i dst, __m256i src, __m256i alpha)
+{
+	__m256i inverse = _mm256_sub_epi16(_mm256_setzero_si256(), alpha);
+	__m256i dstLow = _mm256_mullo_epi16(dst, inverse);
+	__m256i dstHigh = _mm256_mulhi_epu16(dst, inverse);
+	__m256i srcLow = _mm256_mullo_epi16(src, alpha);
+	__m256i srcHigh = _mm256_mulhi_epu16(src, alpha);
+
+	__m256i sum0 = _mm256_add_epi32(_mm256_unpacklo_epi16(dstLow, dstHigh),
+		_mm256_unpacklo_epi16(srcLow, srcHigh));
+	__m256i sum1 = _mm256_add_epi32(_mm256_unpackhi_epi16(dstLow, dstHigh),
+		_mm256_unpackhi_epi16(srcLow, srcHigh));
+
+	return _mm256_packs_epi32(_mm256_srli_epi32(sum0, 16),
+		_mm256_srli_epi32(sum1, 16));
+}
+
+
+AVX2_FUNCTION
+static inline __m256i
+select_avx2(__m256i mask, __m256i a, __m256i b)
+{
+	return _mm256_blendv_epi8(b, a, mask);
+}
+
+
+AVX2_FUNCTION
+static inline __m256i
+pack_mask_avx2(__m256i low, __m256i high)
+{
+	return _mm256_packs_epi16(low, high);
+}
+
+
+/*!	Loads eight covers, and spreads them over the 16 bit channels in the
+	same order as unpacking eight pixels does, ie. \a low gets pixels
+	0, 1, 4, and 5, and \a high gets pixels 2, 3, 6, and 7.
+*/
+AVX2_FUNCTION
+static inline void
+load_covers_avx2(const uint8* covers, __m256i& low, __m256i& high)
+{
+	__m256i packed = _mm256_broadcastq_epi64(
+		_mm_loadl_epi64((const __m128i*)covers));
+	low = _mm256_shuffle_epi8(packed, _mm256_setr_epi8(
+		0, -1, 0, -1, 0, -1, 0, -1, 1, -1, 1, -1, 1, -1, 1, -1,
+		4, -1, 4, -1, 4, -1, 4, -1, 5, -1, 5, -1, 5, -1, 5, -1));
+	high = _mm256_shuffle_epi8(packed, _mm256_setr_epi8(
+		2, -1, 2, -1, 2, -1, 2, -1, 3, -1, 3, -1, 3, -1, 3, -1,
+		6, -1, 6, -1, 6, -1, 6, -1, 7, -1, 7, -1, 7, -1, 7, -1));
+}
+
+
+AVX2_FUNCTION
+static inline __m256i
+color_channels_avx2(const color_type& c)
+{
+	return _mm256_broadcastsi128_si256(
+		_mm_set_epi16(255, c.r, c.g, c.b, 255, c.r, c.g, c.b));
+}
+
+
+AVX2_FUNCTION
+static void
+fill_line_avx2(uint8* p, unsigned len, const color_type& c)
+{
+	__m256i channels = color_channels_avx2(c);
+	__m256i solid = _mm256_packus_epi16(channels, channels);
+
+	for (; len >= 8; len -= 8, p += 32)
+		_mm256_storeu_si256((__m256i*)p, solid);
+
+	if (len > 0)
+		assign_line(p, len, c);
+}
+
+
+AVX2_FUNCTION
+static void
+blend_solid_hspan_alpha_avx2(uint8* p, unsigned len, const color_type& c,
+	uint8 alpha, const uint8* covers)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i opaque = _mm256_set1_epi32(0xff000000);
+	const __m256i fullAlpha = _mm256_set1_epi16((int16)(255 * 255));
+	const __m256i alphaFactor = _mm256_set1_epi16(alpha);
+	const __m256i color = color_channels_avx2(c);
+	const __m256i solid = _mm256_packus_epi16(color, color);
+
+	for (; len >= 8; len -= 8, p += 32, covers += 8) {
+		__m256i alphaLow;
+		__m256i alphaHigh;
+		load_covers_avx2(covers, alphaLow, alphaHigh);
+		alphaLow = _mm256_mullo_epi16(alphaLow, alphaFactor);
+		alphaHigh = _mm256_mullo_epi16(alphaHigh, alphaFactor);
+
+		__m256i skip = pack_mask_avx2(_mm256_cmpeq_epi16(alphaLow, zero),
+			_mm256_cmpeq_epi16(alphaHigh, zero));
+		if (_mm256_movemask_epi8(skip) == -1)
+			continue;
+
+		__m256i assign = pack_mask_avx2(
+			_mm256_cmpeq_epi16(alphaLow, fullAlpha),
+			_mm256_cmpeq_epi16(alphaHigh, fullAlpha));
+		if (_mm256_movemask_epi8(assign) == -1) {
+			_mm256_storeu_si256((__m256i*)p, solid);
+			continue;
+		}
+
+		__m256i dst = _mm256_loadu_si256((const __m256i*)p);
+		__m256i blended = _mm256_packus_epi16(
+			blend16_avx2(_mm256_unpacklo_epi8(dst, zero), color, alphaLow),
+			blend16_avx2(_mm256_unpackhi_epi8(dst, zero), color, alphaHigh));
+		blended = select_avx2(assign, solid,
+			_mm256_or_si256(blended, opaque));
+		_mm256_storeu_si256((__m256i*)p, select_avx2(skip, dst, blended));
+	}
+
+	for (; len > 0; len--, p += 4, covers++) {
+		uint16 pixelAlpha = alpha * *covers;
+		if (pixelAlpha == 255 * 255)
+			assign_pixel(p, c.r, c.g, c.b);
+		else if (pixelAlpha != 0)
+			BLEND16(p, c.r, c.g, c.b, pixelAlpha);
+	}
+}
+
+
+AVX2_FUNCTION
+static void
+blend_hline_alpha_avx2(uint8* p, unsigned len, const color_type& c,
+	uint16 alpha)
+{
+	if (alpha == 255 * 255) {
+		fill_line_avx2(p, len, c);
+		return;
+	}
+
+	if (len < 4) {
+		do {
+			BLEND16(p, c.r, c.g, c.b, alpha);
+			p += 4;
+		} while (--len);
+		return;
+	}
+
+	// blend_line32()
+	uint8 a = alpha >> 8;
+	uint8 r = (c.r * a) >> 8;
+	uint8 g = (c.g * a) >> 8;
+	uint8 b = (c.b * a) >> 8;
+	a = 255 - a;
+
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i opaque = _mm256_set1_epi32(0xff000000);
+	const __m256i inverse = _mm256_set1_epi16(a);
+	const __m256i premultiplied = _mm256_broadcastsi128_si256(
+		_mm_set_epi16(0, r, g, b, 0, r, g, b));
+
+	for (; len >= 8; len -= 8, p += 32) {
+		__m256i dst = _mm256_loadu_si256((const __m256i*)p);
+		__m256i low = _mm256_add_epi16(_mm256_srli_epi16(
+			_mm256_mullo_epi16(_mm256_unpacklo_epi8(dst, zero), inverse), 8),
+			premultiplied);
+		__m256i high = _mm256_add_epi16(_mm256_srli_epi16(
+			_mm256_mullo_epi16(_mm256_unpackhi_epi8(dst, zero), inverse), 8),
+			premultiplied);
+		_mm256_storeu_si256((__m256i*)p,
+			_mm256_or_si256(_mm256_packus_epi16(low, high), opaque));
+	}
+
+	for (; len > 0; len--, p += 4) {
+		p[0] = ((p[0] * a) >> 8) + b;
+		p[1] = ((p[1] * a) >> 8) + g;
+		p[2] = ((p[2] * a) >> 8) + r;
+		p[3] = 255;
+	}
+}
+
+
+AVX2_FUNCTION
+void
+blend_hline_over_solid_avx2(int x, int y, unsigned len, const color_type& c,
+	uint8 cover, agg_buffer* buffer, const PatternHandler* pattern)
+{
+	if (pattern->IsSolidLow())
+		return;
+
+	uint8* p = buffer->row_ptr(y) + (x << 2);
+	if (cover == 255) {
+		fill_line_avx2(p, len, c);
+		return;
+	}
+
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i opaque = _mm256_set1_epi32(0xff000000);
+	const __m256i alpha = _mm256_set1_epi16(cover);
+	const __m256i color = color_channels_avx2(c);
+
+	for (; len >= 8; len -= 8, p += 32) {
+		__m256i dst = _mm256_loadu_si256((const __m256i*)p);
+		__m256i blended = _mm256_packus_epi16(
+			blend_avx2(_mm256_unpacklo_epi8(dst, zero), color, alpha),
+			blend_avx2(_mm256_unpackhi_epi8(dst, zero), color, alpha));
+		_mm256_storeu_si256((__m256i*)p, _mm256_or_si256(blended, opaque));
+	}
+
+	for (; len > 0; len--, p += 4)
+		BLEND(p, c.r, c.g, c.b, cover);
+}
+
+
+AVX2_FUNCTION
+void
+blend_solid_hspan_over_solid_avx2(int x, int y, unsigned len,
+	const color_type& c, const uint8* covers, agg_buffer* buffer,
+	const PatternHandler* pattern)
+{
+	if (pattern->IsSolidLow())
+		return;
+
+	uint8* p = buffer->row_ptr(y) + (x << 2);
+
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i opaque = _mm256_set1_epi32(0xff000000);
+	const __m256i fullAlpha = _mm256_set1_epi16(255);
+	const __m256i color = color_channels_avx2(c);
+	const __m256i solid = _mm256_packus_epi16(color, color);
+
+	for (; len >= 8; len -= 8, p += 32, covers += 8) {
+		__m256i alphaLow;
+		__m256i alphaHigh;
+		load_covers_avx2(covers, alphaLow, alphaHigh);
+
+		__m256i skip = pack_mask_avx2(_mm256_cmpeq_epi16(alphaLow, zero),
+			_mm256_cmpeq_epi16(alphaHigh, zero));
+		if (_mm256_movemask_epi8(skip) == -1)
+			continue;
+
+		__m256i assign = pack_mask_avx2(
+			_mm256_cmpeq_epi16(alphaLow, fullAlpha),
+			_mm256_cmpeq_epi16(alphaHigh, fullAlpha));
+		if (_mm256_movemask_epi8(assign) == -1) {
+			_mm256_storeu_si256((__m256i*)p, solid);
+			continue;
+		}
+
+		__m256i dst = _mm256_loadu_si256((const __m256i*)p);
+		__m256i blended = _mm256_packus_epi16(
+			blend_avx2(_mm256_unpacklo_epi8(dst, zero), color, alphaLow),
+			blend_avx2(_mm256_unpackhi_epi8(dst, zero), color, alphaHigh));
+		blended = select_avx2(assign, solid,
+			_mm256_or_si256(blended, opaque));
+		_mm256_storeu_si256((__m256i*)p, select_avx2(skip, dst, blended));
+	}
+
+	for (; len > 0; len--, p += 4, covers++) {
+		if (*covers == 255)
+			assign_pixel(p, c.r, c.g, c.b);
+		else if (*covers != 0)
+			BLEND(p, c.r, c.g, c.b, *covers);
+	}
+}
+
+
+AVX2_FUNCTION
+void
+blend_hline_alpha_co_solid_avx2(int x, int y, unsigned len,
+	const color_type& c, uint8 cover, agg_buffer* buffer,
+	const PatternHandler* pattern)
+{
+	blend_hline_alpha_avx2(buffer->row_ptr(y) + (x << 2), len, c,
+		pattern->HighColor().alpha * cover);
+}
+
+
+AVX2_FUNCTION
+void
+blend_solid_hspan_alpha_co_solid_avx2(int x, int y, unsigned len,
+	const color_type& c, const uint8* covers, agg_buffer* buffer,
+	const PatternHandler* pattern)
+{
+	blend_solid_hspan_alpha_avx2(buffer->row_ptr(y) + (x << 2), len, c,
+		pattern->HighColor().alpha, covers);
+}
+
+
+AVX2_FUNCTION
+void
+blend_hline_alpha_po_solid_avx2(int x, int y, unsigned len,
+	const color_type& c, uint8 cover, agg_buffer* buffer,
+	const PatternHandler* pattern)
+{
+	blend_hline_alpha_avx2(buffer->row_ptr(y) + (x << 2), len, c,
+		c.a * cover);
+}
+
+
+AVX2_FUNCTION
+void
+blend_solid_hspan_alpha_po_solid_avx2(int x, int y, unsigned len,
+	const color_type& c, const uint8* covers, agg_buffer* buffer,
+	const PatternHandler* pattern)
+{
+	blend_solid_hspan_alpha_avx2(buffer->row_ptr(y) + (x << 2), len, c, c.a,
+		covers);
+}
+
+
+AVX2_FUNCTION
+void
+blend_color_hspan_alpha_po_avx2(int x, int y, unsigned len,
+	const color_type* colors, const uint8* covers, uint8 cover,
+	agg_buffer* buffer, const PatternHandler* pattern)
+{
+	uint8* p = buffer->row_ptr(y) + (x << 2);
+
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i opaque = _mm256_set1_epi32(0xff000000);
+	const __m256i fullAlpha = _mm256_set1_epi16((int16)(255 * 255));
+	const __m256i swapRedBlue = _mm256_setr_epi8(
+		2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+		2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+	// like the scalar version, use the alpha of the first color for all of
+	// them if there are no covers
+	uint16 alpha = colors->a * cover;
+	if (covers == NULL && alpha == 0)
+		return;
+	const __m256i constantAlpha = _mm256_set1_epi16(alpha);
+
+	for (; len >= 8; len -= 8, p += 32, colors += 8) {
+		// RGBA -> BGRA
+		__m256i src = _mm256_shuffle_epi8(
+			_mm256_loadu_si256((const __m256i*)colors), swapRedBlue);
+		__m256i srcLow = _mm256_unpacklo_epi8(src, zero);
+		__m256i srcHigh = _mm256_unpackhi_epi8(src, zero);
+		__m256i solid = _mm256_or_si256(src, opaque);
+
+		__m256i alphaLow = constantAlpha;
+		__m256i alphaHigh = constantAlpha;
+		if (covers != NULL) {
+			load_covers_avx2(covers, alphaLow, alphaHigh);
+			covers += 8;
+			alphaLow = _mm256_mullo_epi16(alphaLow, _mm256_shufflehi_epi16(
+				_mm256_shufflelo_epi16(srcLow, _MM_SHUFFLE(3, 3, 3, 3)),
+				_MM_SHUFFLE(3, 3, 3, 3)));
+			alphaHigh = _mm256_mullo_epi16(alphaHigh, _mm256_shufflehi_epi16(
+				_mm256_shufflelo_epi16(srcHigh, _MM_SHUFFLE(3, 3, 3, 3)),
+				_MM_SHUFFLE(3, 3, 3, 3)));
+		}
+
+		__m256i skip = pack_mask_avx2(_mm256_cmpeq_epi16(alphaLow, zero),
+			_mm256_cmpeq_epi16(alphaHigh, zero));
+		if (_mm256_movemask_epi8(skip) == -1)
+			continue;
+
+		__m256i assign = pack_mask_avx2(
+			_mm256_cmpeq_epi16(alphaLow, fullAlpha),
+			_mm256_cmpeq_epi16(alphaHigh, fullAlpha));
+		if (_mm256_movemask_epi8(assign) == -1) {
+			_mm256_storeu_si256((__m256i*)p, solid);
+			continue;
+		}
+
+		__m256i dst = _mm256_loadu_si256((const __m256i*)p);
+		__m256i blended = _mm256_packus_epi16(
+			blend16_avx2(_mm256_unpacklo_epi8(dst, zero), srcLow, alphaLow),
+			blend16_avx2(_mm256_unpackhi_epi8(dst, zero), srcHigh,
+				alphaHigh));
+		blended = select_avx2(assign, solid,
+			_mm256_or_si256(blended, opaque));
+		_mm256_storeu_si256((__m256i*)p, select_avx2(skip, dst, blended));
+	}
+
+	for (; len > 0; len--, p += 4, colors++) {
+		uint16 pixelAlpha = alpha;
+		if (covers != NULL)
+			pixelAlpha = colors->a * *covers++;
+
+		if (pixelAlpha == 255 * 255)
+			assign_pixel(p, colors->r, colors->g, colors->b);
+		else if (pixelAlpha != 0)
+			BLEND16(p, colors->r, colors->g, colors->b, pixelAlpha);
+	}
+}
+
+
+#endif	// APPSERVER_SIMD_BLENDERS
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * SSE2 and AVX2 versions of the most frequently used blending functions.
+ * They produce exactly the same results as their scalar counterparts, and
+ * are selected by PixelFormat::SetDrawingMode() depending on gSIMDFlags.
+ *
+ */
+
+#ifndef DRAWING_MODE_SIMD_H
+#define DRAWING_MODE_SIMD_H
+
+#include "DrawingMode.h"
+
+
+#if (defined(__i386__) || defined(__x86_64__)) \
+	&& (__GNUC__ >= 5 || defined(__clang__))
+#	define APPSERVER_SIMD_BLENDERS
+#endif
+
+
+#ifdef APPSERVER_SIMD_BLENDERS
+
+// B_OP_OVER
+void blend_hline_over_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, uint8 cover, agg_buffer* buffer,
+	const PatternHandler* pattern);
+void blend_hline_over_solid_avx2(int x, int y, unsigned len,
+	const color_type& c, uint8 cover, agg_buffer* buffer,
+	const PatternHandler* pattern);
+void blend_solid_hspan_over_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, const uint8* covers, agg_buffer* buffer,
+	const PatternHandler* pattern);
+void blend_solid_hspan_over_solid_avx2(int x, int y, unsigned len,
+	const color_type& c, const uint8* covers, agg_buffer* buffer,
+	const PatternHandler* pattern);
+
+// B_OP_ALPHA, B_CONSTANT_ALPHA, B_ALPHA_OVERLAY
+void blend_hline_alpha_co_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, uint8 cover, agg_buffer* buffer,
+	const PatternHandler* pattern);
+void blend_hline_alpha_co_solid_avx2(int x, int y, unsigned len,
+	const color_type& c, uint8 cover, agg_buffer* buffer,
+	const PatternHandler* pattern);
+void blend_solid_hspan_alpha_co_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, const uint8* covers, agg_buffer* buffer,
+	const PatternHandler* pattern);
+void blend_solid_hspan_alpha_co_solid_avx2(int x, int y, unsigned len,
+	const color_type& c, const uint8* covers, agg_buffer* buffer,
+	const PatternHandler* pattern);
+
+// B_OP_ALPHA, B_PIXEL_ALPHA, B_ALPHA_OVERLAY
+void blend_hline_alpha_po_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, uint8 cover, agg_buffer* buffer,
+	const PatternHandler* pattern);
+void blend_hline_alpha_po_solid_avx2(int x, int y, unsigned len,
+	const color_type& c, uint8 cover, agg_buffer* buffer,
+	const PatternHandler* pattern);
+void blend_solid_hspan_alpha_po_solid_sse2(int x, int y, unsigned len,
+	const color_type& c, const uint8* covers, agg_buffer* buffer,
+	const PatternHandler* pattern);
+void blend_solid_hspan_alpha_po_solid_avx2(int x, int y, unsigned len,
+	const color_type& c, const uint8* covers, agg_buffer* buffer,
+	const PatternHandler* pattern);
+void blend_color_hspan_alpha_po_sse2(int x, int y, unsigned len,
+	const color_type* colors, const uint8* covers, uint8 cover,
+	agg_buffer* buffer, const PatternHandler* pattern);
+void blend_color_hspan_alpha_po_avx2(int x, int y, unsigned len,
+	const color_type* colors, const uint8* covers, uint8 cover,
+	agg_buffer* buffer, const PatternHandler* pattern);
+
+#endif	// APPSERVER_SIMD_BLENDERS
+
+
+#endif // DRAWING_MODE_SIMD_H
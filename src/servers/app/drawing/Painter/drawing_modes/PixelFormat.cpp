@@ -54,7 +54,11 @@
 #include "DrawingModeSelectSUBPIX.h"
 #include "DrawingModeSubtractSUBPIX.h"
 
+#include "DrawingModeSIMD.h"
+
 #include "PatternHandler.h"
+#include "SIMDFlags.h"
+
 
 // blend_pixel_empty
 void
@@ -361,4 +365,49 @@ fprintf(stderr, "PixelFormat::SetDrawingMode() - drawing_mode not implemented\n"
 //			return fDrawingModeBGRA32Copy;
 			break;
 	}
+	_UseSIMDBlenders();
+}
+
+
+// _UseSIMDBlenders
+void
+PixelFormat::_UseSIMDBlenders()
+{
+#ifdef APPSERVER_SIMD_BLENDERS
+	if ((gSIMDFlags & APPSERVER_SIMD_AVX2) != 0) {
+		if (fBlendHLine == blend_hline_over_solid)
+			fBlendHLine = blend_hline_over_solid_avx2;
+		else if (fBlendHLine == blend_hline_alpha_co_solid)
+			fBlendHLine = blend_hline_alpha_co_solid_avx2;
+		else if (fBlendHLine == blend_hline_alpha_po_solid)
+			fBlendHLine = blend_hline_alpha_po_solid_avx2;
+
+		if (fBlendSolidHSpan == blend_solid_hspan_over_solid)
+			fBlendSolidHSpan = blend_solid_hspan_over_solid_avx2;
+		else if (fBlendSolidHSpan == blend_solid_hspan_alpha_co_solid)
+			fBlendSolidHSpan = blend_solid_hspan_alpha_co_solid_avx2;
+		else if (fBlendSolidHSpan == blend_solid_hspan_alpha_po_solid)
+			fBlendSolidHSpan = blend_solid_hspan_alpha_po_solid_avx2;
+
+		if (fBlendColorHSpan == blend_color_hspan_alpha_po)
+			fBlendColorHSpan = blend_color_hspan_alpha_po_avx2;
+	} else if ((gSIMDFlags & APPSERVER_SIMD_SSE2) != 0) {
+		if (fBlendHLine == blend_hline_over_solid)
+			fBlendHLine = blend_hline_over_solid_sse2;
+		else if (fBlendHLine == blend_hline_alpha_co_solid)
+			fBlendHLine = blend_hline_alpha_co_solid_sse2;
+		else if (fBlendHLine == blend_hline_alpha_po_solid)
+			fBlendHLine = blend_hline_alpha_po_solid_sse2;
+
+		if (fBlendSolidHSpan == blend_solid_hspan_over_solid)
+			fBlendSolidHSpan = blend_solid_hspan_over_solid_sse2;
+		else if (fBlendSolidHSpan == blend_solid_hspan_alpha_co_solid)
+			fBlendSolidHSpan = blend_solid_hspan_alpha_co_solid_sse2;
+		else if (fBlendSolidHSpan == blend_solid_hspan_alpha_po_solid)
+			fBlendSolidHSpan = blend_solid_hspan_alpha_po_solid_sse2;
+
+		if (fBlendColorHSpan == blend_color_hspan_alpha_po)
+			fBlendColorHSpan = blend_color_hspan_alpha_po_sse2;
+	}
+#endif
 }
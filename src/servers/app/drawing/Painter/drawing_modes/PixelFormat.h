@@ -177,6 +177,8 @@ class PixelFormat {
 	blend_color_span			fBlendColorHSpan;
 	blend_color_span			fBlendColorVSpan;
 
+	void _UseSIMDBlenders();
+
 	template<typename T>
 	void SetAggCompOpAdapter()
 	{
@@ -440,6 +440,8 @@ AccelerantHWInterface::_UpdateHooksAfterModeChange()
 status_t
 AccelerantHWInterface::Shutdown()
 {
+	_StopDeferredUpdates();
+
 	if (fAccelerantHook != NULL) {
 		uninit_accelerant uninitAccelerant
 			= (uninit_accelerant)fAccelerantHook(B_UNINIT_ACCELERANT, NULL);
@@ -664,6 +666,11 @@ AccelerantHWInterface::SetMode(const display_mode& mode)
 	else if (fDisplayMode.space == B_GRAY8)
 		_SetGrayscalePalette();
 
+	// On a software frame buffer, copying to the front buffer is a good
+	// part of the drawing time, so collect the damage and copy it once
+	// per frame.
+	SetDeferredUpdates(IsDoubleBuffered(), _FrameInterval());
+
 	// notify all listeners about the mode change
 	_NotifyFrameBufferChanged();
 
@@ -671,6 +678,22 @@ AccelerantHWInterface::SetMode(const display_mode& mode)
 }
 
 
+/*!	Returns the time between two frames of the current display mode.
+*/
+bigtime_t
+AccelerantHWInterface::_FrameInterval() const
+{
+	const display_timing& timing = fDisplayMode.timing;
+	if (timing.pixel_clock == 0 || timing.h_total == 0 || timing.v_total == 0)
+		return 1000000 / 60;
+
+	// the pixel clock is in kHz
+	bigtime_t interval = (bigtime_t)timing.h_total * timing.v_total * 1000
+		/ timing.pixel_clock;
+	return max_c(interval, 1000000 / 240);
+}
+
+
 void
 AccelerantHWInterface::GetMode(display_mode* mode)
 {
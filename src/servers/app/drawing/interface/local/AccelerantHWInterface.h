@@ -110,6 +110,7 @@ private:
 									display_mode& modeFound,
 									int32 *_diff = NULL) const;
 			status_t			_SetFallbackMode(display_mode& mode) const;
+			bigtime_t			_FrameInterval() const;
 			void				_SetSystemPalette();
 			void				_SetGrayscalePalette();
 
@@ -0,0 +1,206 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "BitmapTileCache.h"
+
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+
+
+static const uint32 kNoSlot = 0xffffffff;
+
+
+static inline uint64
+mix_hash(uint64 hash, uint64 value)
+{
+	hash ^= value * 0x9e3779b97f4a7c15ULL;
+	hash = (hash << 31) | (hash >> 33);
+	return hash * 0xc2b2ae3d27d4eb4fULL;
+}
+
+
+BitmapTileCache::BitmapTileCache()
+	:
+	fLock("bitmap tile cache"),
+	fSlots(NULL),
+	fUsedSlots(0),
+	fLeastRecent(kNoSlot),
+	fMostRecent(kNoSlot),
+	fSlotData(NULL)
+{
+	fSlots = (tile_slot*)malloc(kTileSlotCount * sizeof(tile_slot));
+	fSlotData = (uint8**)calloc(kTileSlotCount, sizeof(uint8*));
+}
+
+
+BitmapTileCache::~BitmapTileCache()
+{
+	MakeEmpty();
+
+	free(fSlots);
+	free(fSlotData);
+}
+
+
+status_t
+BitmapTileCache::InitCheck() const
+{
+	if (fSlots == NULL || fSlotData == NULL)
+		return B_NO_MEMORY;
+
+	return fSlotMap.InitCheck();
+}
+
+
+/*!	Forgets about all tiles; this must happen on both sides at the same
+	time, ie. whenever a new connection is established.
+*/
+void
+BitmapTileCache::MakeEmpty()
+{
+	fSlotMap.Clear();
+	fUsedSlots = 0;
+	fLeastRecent = fMostRecent = kNoSlot;
+
+	if (fSlotData != NULL) {
+		for (uint32 i = 0; i < kTileSlotCount; i++) {
+			free(fSlotData[i]);
+			fSlotData[i] = NULL;
+		}
+	}
+}
+
+
+/*!	Returns the slot of the tile with the given \a hash. If the tile is
+	already cached, \c true is returned. Otherwise, the least recently used
+	slot is assigned to the tile, and its data needs to be sent along.
+*/
+bool
+BitmapTileCache::GetSlot(uint64 hash, uint32& _slot)
+{
+	uint32* cachedSlot;
+	if (fSlotMap.Get(hash, cachedSlot)) {
+		_slot = *cachedSlot;
+		_Unlink(_slot);
+		_Append(_slot);
+		return true;
+	}
+
+	uint32 slot;
+	if (fUsedSlots < kTileSlotCount)
+		slot = fUsedSlots++;
+	else {
+		slot = fLeastRecent;
+		fSlotMap.Remove(fSlots[slot].hash);
+		_Unlink(slot);
+	}
+
+	fSlots[slot].hash = hash;
+	fSlotMap.Put(hash, slot);
+		// if this fails, the tile is just not found again
+	_Append(slot);
+
+	_slot = slot;
+	return false;
+}
+
+
+/*!	Returns the buffer for the data of the tile in \a slot, which can hold
+	a full tile, stored without any padding between the rows.
+*/
+uint8*
+BitmapTileCache::SlotData(uint32 slot)
+{
+	if (slot >= kTileSlotCount || fSlotData == NULL)
+		return NULL;
+
+	if (fSlotData[slot] == NULL)
+		fSlotData[slot] = (uint8*)malloc(kTileSize * kTileSize * 4);
+
+	return fSlotData[slot];
+}
+
+
+/*!	Only bitmaps with 32 bits per pixel are split into tiles.
+*/
+/*static*/ bool
+BitmapTileCache::IsSupported(color_space colorSpace)
+{
+	switch (colorSpace) {
+		case B_RGB32:
+		case B_RGBA32:
+		case B_RGB32_BIG:
+		case B_RGBA32_BIG:
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+
+/*static*/ uint64
+BitmapTileCache::HashTile(const uint8* bits, int32 bytesPerRow, int32 width,
+	int32 height)
+{
+	uint64 hash = mix_hash(width, height);
+	size_t rowBytes = width * 4;
+
+	for (int32 y = 0; y < height; y++) {
+		const uint8* row = bits + y * bytesPerRow;
+
+		size_t offset = 0;
+		for (; offset + 8 <= rowBytes; offset += 8) {
+			uint64 value;
+			memcpy(&value, row + offset, sizeof(value));
+			hash = mix_hash(hash, value);
+		}
+
+		if (offset < rowBytes) {
+			uint32 value;
+			memcpy(&value, row + offset, sizeof(value));
+			hash = mix_hash(hash, value);
+		}
+	}
+
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+
+void
+BitmapTileCache::_Unlink(uint32 slot)
+{
+	tile_slot& tile = fSlots[slot];
+
+	if (tile.previous != kNoSlot)
+		fSlots[tile.previous].next = tile.next;
+	else
+		fLeastRecent = tile.next;
+
+	if (tile.next != kNoSlot)
+		fSlots[tile.next].previous = tile.previous;
+	else
+		fMostRecent = tile.previous;
+}
+
+
+void
+BitmapTileCache::_Append(uint32 slot)
+{
+	tile_slot& tile = fSlots[slot];
+	tile.previous = fMostRecent;
+	tile.next = kNoSlot;
+
+	if (fMostRecent != kNoSlot)
+		fSlots[fMostRecent].next = slot;
+	else
+		fLeastRecent = slot;
+
+	fMostRecent = slot;
+}
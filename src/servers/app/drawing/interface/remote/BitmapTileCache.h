@@ -0,0 +1,73 @@
+/*
+ * Copyright 2026, Haiku, Inc.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef BITMAP_TILE_CACHE_H
+#define BITMAP_TILE_CACHE_H
+
+#include <GraphicsDefs.h>
+#include <HashMap.h>
+#include <Locker.h>
+#include <SupportDefs.h>
+
+
+// Bitmaps are sent in tiles of this size, and only the tiles the other side
+// does not know yet are actually transferred.
+static const int32 kTileSize = 32;
+static const uint32 kTileSlotCount = 4096;
+static const uint32 kTileDataFlag = 0x80000000;
+
+
+/*!	Both ends of a connection have one of these. The sending side decides
+	which slot a tile is stored in, and the receiving side stores the tile
+	data in that slot, so the two caches always stay in sync, as long as
+	all messages are processed in the order they were created.
+*/
+class BitmapTileCache {
+public:
+								BitmapTileCache();
+								~BitmapTileCache();
+
+		status_t				InitCheck() const;
+
+		bool					Lock() { return fLock.Lock(); }
+		status_t				LockWithTimeout(bigtime_t timeout)
+									{ return fLock.LockWithTimeout(timeout); }
+		void					Unlock() { fLock.Unlock(); }
+
+		void					MakeEmpty();
+
+		// sending side
+		bool					GetSlot(uint64 hash, uint32& _slot);
+
+		// receiving side
+		uint8*					SlotData(uint32 slot);
+
+static	bool					IsSupported(color_space colorSpace);
+static	uint64					HashTile(const uint8* bits, int32 bytesPerRow,
+									int32 width, int32 height);
+
+private:
+		struct tile_slot {
+			uint64				hash;
+			uint32				previous;
+			uint32				next;
+		};
+
+		void					_Unlink(uint32 slot);
+		void					_Append(uint32 slot);
+
+		typedef HashMap<HashKey64<uint64>, uint32> SlotMap;
+
+		BLocker					fLock;
+		SlotMap					fSlotMap;
+		tile_slot*				fSlots;
+		uint32					fUsedSlots;
+		uint32					fLeastRecent;
+		uint32					fMostRecent;
+
+		uint8**					fSlotData;
+};
+
+
+#endif // BITMAP_TILE_CACHE_H
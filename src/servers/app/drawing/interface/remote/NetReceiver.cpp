@@ -7,11 +7,13 @@
  */
 
 #include "NetReceiver.h"
+#include "NetSender.h"
 #include "RemoteMessage.h"
 
 #include "StreamingRingBuffer.h"
 
 #include <NetEndpoint.h>
+#include <ZstdCompressionAlgorithm.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -95,11 +97,70 @@ NetReceiver::_Listen()
 status_t
 NetReceiver::_Transfer()
 {
-	int32 errorCount = 0;
+	const size_t bufferSize = kMaxChunkSize;
+	uint8 *buffer = (uint8 *)malloc(bufferSize);
+	uint8 *compressed = (uint8 *)malloc(bufferSize);
+	MemoryDeleter bufferDeleter(buffer);
+	MemoryDeleter compressedDeleter(compressed);
+	if (buffer == NULL || compressed == NULL)
+		return B_NO_MEMORY;
+
+	BZstdCompressionAlgorithm algorithm;
 
 	while (!fStopThread) {
-		uint8 buffer[4096];
-		int32 readSize = fEndpoint->Receive(buffer, sizeof(buffer));
+		net_chunk_header header;
+		status_t result = _Receive(&header, sizeof(header));
+		if (result != B_OK)
+			return result;
+
+		if (header.uncompressed_size > kMaxChunkSize
+			|| header.size > header.uncompressed_size) {
+			TRACE_ERROR("invalid chunk of %" B_PRIu32 " bytes (%" B_PRIu32
+				" uncompressed), closing connection\n", header.size,
+				header.uncompressed_size);
+			return B_BAD_DATA;
+		}
+
+		bool isCompressed = header.size < header.uncompressed_size;
+		result = _Receive(isCompressed ? compressed : buffer, header.size);
+		if (result != B_OK)
+			return result;
+
+		if (isCompressed) {
+			iovec input = { compressed, header.size };
+			iovec output = { buffer, header.uncompressed_size };
+			result = algorithm.DecompressBuffer(input, output);
+			if (result == B_OK && output.iov_len != header.uncompressed_size)
+				result = B_BAD_DATA;
+			if (result != B_OK) {
+				TRACE_ERROR("failed to decompress chunk: %s\n",
+					strerror(result));
+				return result;
+			}
+		}
+
+		result = fTarget->Write(buffer, header.uncompressed_size);
+		if (result != B_OK) {
+			TRACE_ERROR("writing to ring buffer failed: %s\n",
+				strerror(result));
+			return result;
+		}
+	}
+
+	return B_OK;
+}
+
+
+status_t
+NetReceiver::_Receive(void *buffer, size_t size)
+{
+	int32 errorCount = 0;
+
+	while (size > 0) {
+		if (fStopThread)
+			return B_CANCELED;
+
+		int32 readSize = fEndpoint->Receive(buffer, size);
 		if (readSize < 0) {
 			TRACE_ERROR("read failed, closing connection: %s\n",
 				strerror(readSize));
@@ -119,12 +180,8 @@ NetReceiver::_Transfer()
 		}
 
 		errorCount = 0;
-		status_t result = fTarget->Write(buffer, readSize);
-		if (result != B_OK) {
-			TRACE_ERROR("writing to ring buffer failed: %s\n",
-				strerror(result));
-			return result;
-		}
+		buffer = (uint8 *)buffer + readSize;
+		size -= readSize;
 	}
 
 	return B_OK;
@@ -32,6 +32,7 @@ private:
 static	int32					_NetworkReceiverEntry(void *data);
 		status_t				_Listen();
 		status_t				_Transfer();
+		status_t				_Receive(void *buffer, size_t size);
 
 		BNetEndpoint *			fListener;
 		StreamingRingBuffer *	fTarget;
@@ -10,7 +10,9 @@
 
 #include "StreamingRingBuffer.h"
 
+#include <AutoDeleter.h>
 #include <NetEndpoint.h>
+#include <ZstdCompressionAlgorithm.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -20,13 +22,30 @@
 #define TRACE_ERROR(x...)	debug_printf("NetSender: " x)
 
 
-NetSender::NetSender(BNetEndpoint *endpoint, StreamingRingBuffer *source)
+// Small writes that follow each other closely are collected into a single
+// chunk, so that a frame worth of drawing commands goes out at once.
+static const int32 kBatchSize = 16 * 1024;
+static const bigtime_t kBatchDelay = 4000;
+
+// Compressing tiny chunks is not worth it, and if compression does not save
+// enough, it is paused for an increasing number of chunks.
+static const uint32 kMinCompressSize = 256;
+static const uint32 kMaxBackOff = 64;
+
+
+NetSender::NetSender(BNetEndpoint *endpoint, StreamingRingBuffer *source,
+	bool compress)
 	:
 	fEndpoint(endpoint),
 	fSource(source),
 	fSenderThread(-1),
-	fStopThread(false)
+	fStopThread(false),
+	fCompress(compress),
+	fSkipChunks(0),
+	fBackOff(1)
 {
+	memset(&fStatistics, 0, sizeof(fStatistics));
+
 	fSenderThread = spawn_thread(_NetworkSenderEntry, "network sender",
 		B_NORMAL_PRIORITY, this);
 	resume_thread(fSenderThread);
@@ -49,27 +68,131 @@ NetSender::_NetworkSenderEntry(void *data)
 }
 
 
+void
+NetSender::GetStatistics(net_sender_statistics& statistics)
+{
+	statistics.chunks = atomic_get64(&fStatistics.chunks);
+	statistics.compressed_chunks = atomic_get64(&fStatistics.compressed_chunks);
+	statistics.data_bytes = atomic_get64(&fStatistics.data_bytes);
+	statistics.sent_bytes = atomic_get64(&fStatistics.sent_bytes);
+}
+
+
 status_t
 NetSender::_NetworkSender()
 {
+	// both buffers leave room for the chunk header in front of the data
+	const size_t bufferSize = sizeof(net_chunk_header) + kMaxChunkSize;
+	uint8 *buffer = (uint8 *)malloc(bufferSize);
+	uint8 *compressed = (uint8 *)malloc(bufferSize);
+	MemoryDeleter bufferDeleter(buffer);
+	MemoryDeleter compressedDeleter(compressed);
+	if (buffer == NULL || compressed == NULL)
+		return B_NO_MEMORY;
+
+	uint8 *data = buffer + sizeof(net_chunk_header);
+
 	while (!fStopThread) {
-		uint8 buffer[4096];
-		int32 readSize = fSource->Read(buffer, sizeof(buffer), true);
+		int32 readSize = fSource->Read(data, kMaxChunkSize, true);
 		if (readSize < 0) {
 			TRACE_ERROR("read failed, stopping sender thread: %s\n",
 				strerror(readSize));
 			return readSize;
 		}
 
-		while (readSize > 0) {
-			int32 sendSize = fEndpoint->Send(buffer, readSize);
-			if (sendSize < 0) {
-				TRACE_ERROR("sending data failed: %s\n", strerror(sendSize));
-				return sendSize;
+		bigtime_t deadline = system_time() + kBatchDelay;
+		while (readSize < kBatchSize) {
+			bigtime_t timeout = deadline - system_time();
+			if (timeout <= 0)
+				break;
+
+			int32 moreSize = fSource->Read(data + readSize,
+				kMaxChunkSize - readSize, true, timeout);
+			if (moreSize == B_TIMED_OUT)
+				break;
+			if (moreSize < 0) {
+				TRACE_ERROR("read failed, stopping sender thread: %s\n",
+					strerror(moreSize));
+				return moreSize;
 			}
 
-			readSize -= sendSize;
+			readSize += moreSize;
+		}
+
+		net_chunk_header header;
+		header.uncompressed_size = readSize;
+
+		uint8 *chunk = buffer;
+		int32 compressedSize = _Compress(data, readSize,
+			compressed + sizeof(net_chunk_header));
+		if (compressedSize > 0) {
+			chunk = compressed;
+			header.size = compressedSize;
+			atomic_add64(&fStatistics.compressed_chunks, 1);
+		} else
+			header.size = readSize;
+
+		memcpy(chunk, &header, sizeof(header));
+
+		int32 sendSize = sizeof(header) + header.size;
+		status_t result = _Send(chunk, sendSize);
+		if (result != B_OK) {
+			TRACE_ERROR("sending data failed: %s\n", strerror(result));
+			return result;
 		}
+
+		atomic_add64(&fStatistics.chunks, 1);
+		atomic_add64(&fStatistics.data_bytes, readSize);
+		atomic_add64(&fStatistics.sent_bytes, sendSize);
+	}
+
+	return B_OK;
+}
+
+
+/*!	Compresses \a data into \a output, which must be able to hold \a size
+	bytes. Returns the compressed size, or zero if the chunk is to be sent
+	uncompressed.
+*/
+int32
+NetSender::_Compress(const uint8 *data, uint32 size, uint8 *output)
+{
+	if (!fCompress || size < kMinCompressSize)
+		return 0;
+
+	if (fSkipChunks > 0) {
+		fSkipChunks--;
+		return 0;
+	}
+
+	BZstdCompressionAlgorithm algorithm;
+	BZstdCompressionParameters parameters(B_ZSTD_COMPRESSION_FASTEST);
+
+	iovec input = { (void *)data, size };
+	iovec compressed = { output, size - size / 10 };
+		// anything saving less than 10% is not worth the effort
+	if (algorithm.CompressBuffer(input, compressed, &parameters) != B_OK) {
+		// did not fit, or compression is not available at all
+		fSkipChunks = fBackOff;
+		fBackOff = min_c(fBackOff * 2, kMaxBackOff);
+		return 0;
+	}
+
+	fBackOff = 1;
+	return compressed.iov_len;
+}
+
+
+status_t
+NetSender::_Send(const void *buffer, int32 size)
+{
+	while (size > 0) {
+		int32 sendSize = fEndpoint->Send(buffer, size);
+		if (sendSize < 0)
+			return sendSize;
+
+		buffer = (const uint8 *)buffer + sendSize;
+		size -= sendSize;
 	}
 
 	return B_OK;
@@ -14,21 +14,54 @@
 class BNetEndpoint;
 class StreamingRingBuffer;
 
+
+// The data is sent in chunks, each preceded by this header. A chunk is
+// compressed if its size is smaller than its uncompressed size.
+struct net_chunk_header {
+	uint32				size;
+	uint32				uncompressed_size;
+};
+
+static const uint32 kMaxChunkSize = 64 * 1024;
+
+
+struct net_sender_statistics {
+	int64				chunks;
+	int64				compressed_chunks;
+	int64				data_bytes;
+	int64				sent_bytes;
+};
+
+
 class NetSender {
 public:
 								NetSender(BNetEndpoint *endpoint,
-									StreamingRingBuffer *source);
+									StreamingRingBuffer *source,
+									bool compress = false);
 								~NetSender();
 
+		void					GetStatistics(
+									net_sender_statistics& statistics);
+
 private:
 static	int32					_NetworkSenderEntry(void *data);
 		status_t				_NetworkSender();
 
+		int32					_Compress(const uint8 *data, uint32 size,
+									uint8 *output);
+		status_t				_Send(const void *buffer, int32 size);
+
 		BNetEndpoint *			fEndpoint;
 		StreamingRingBuffer *	fSource;
 
 		thread_id				fSenderThread;
 		bool					fStopThread;
+
+		bool					fCompress;
+		uint32					fSkipChunks;
+		uint32					fBackOff;
+
+		net_sender_statistics	fStatistics;
 };
 
 #endif // NET_SENDER_H
@@ -13,6 +13,7 @@
 #include "DrawState.h"
 #include "ServerTokenSpace.h"
 
+#include <AutoLocker.h>
 #include <Bitmap.h>
 #include <utf8_functions.h>
 
@@ -99,6 +100,13 @@ RemoteDrawingEngine::ConstrainClippingRegion(const BRegion* region)
 }
 
 
+bool
+RemoteDrawingEngine::IntersectsClipping(const BRect& rect) const
+{
+	return fClippingRegion.Intersects(rect);
+}
+
+
 void
 RemoteDrawingEngine::SetDrawState(const DrawState* state, int32 xOffset,
 	int32 yOffset)
@@ -362,6 +370,9 @@ RemoteDrawingEngine::DrawBitmap(ServerBitmap* bitmap, const BRect& _bitmapRect,
 			return;
 		}
 
+		// the cache must stay locked until the message is flushed, so that
+		// the messages arrive in the order the tiles were assigned their slots
+		AutoLocker<BitmapTileCache> tileLocker(fHWInterface->TileCache());
 		RemoteMessage message(NULL, fHWInterface->SendBuffer());
 		message.Start(RP_DRAW_BITMAP_RECTS);
 		message.Add(fToken);
@@ -372,7 +383,7 @@ RemoteDrawingEngine::DrawBitmap(ServerBitmap* bitmap, const BRect& _bitmapRect,
 
 		for (int32 i = 0; i < rectCount; i++) {
 			message.Add(clippedRegion.RectAt(i));
-			message.AddBitmap(*bitmaps[i], true);
+			message.AddBitmap(*bitmaps[i], true, fHWInterface->TileCache());
 			delete bitmaps[i];
 		}
 
@@ -380,14 +391,14 @@ RemoteDrawingEngine::DrawBitmap(ServerBitmap* bitmap, const BRect& _bitmapRect,
 		return;
 	}
 
-	// TODO: we may want to cache/checksum bitmaps
+	AutoLocker<BitmapTileCache> tileLocker(fHWInterface->TileCache());
 	RemoteMessage message(NULL, fHWInterface->SendBuffer());
 	message.Start(RP_DRAW_BITMAP);
 	message.Add(fToken);
 	message.Add(bitmapRect);
 	message.Add(viewRect);
 	message.Add(options);
-	message.AddBitmap(*bitmap);
+	message.AddBitmap(*bitmap, false, fHWInterface->TileCache());
 }
 
 
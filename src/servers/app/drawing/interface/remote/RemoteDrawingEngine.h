@@ -40,6 +40,7 @@ public:
 	// clipping for all drawing functions, passing a NULL region
 	// will remove any clipping (drawing allowed everywhere)
 	virtual	void				ConstrainClippingRegion(const BRegion* region);
+	virtual	bool				IntersectsClipping(const BRect& rect) const;
 
 	virtual	void				SetDrawState(const DrawState* state,
 									int32 xOffset = 0, int32 yOffset = 0);
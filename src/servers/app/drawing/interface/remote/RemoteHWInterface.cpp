@@ -76,7 +76,12 @@ RemoteHWInterface::RemoteHWInterface(const char* target)
 	if (fInitStatus != B_OK)
 		return;
 
-	fSendBuffer.SetTo(new(std::nothrow) StreamingRingBuffer(16 * 1024));
+	fInitStatus = fTileCache.InitCheck();
+	if (fInitStatus != B_OK)
+		return;
+
+	// bitmaps are written in one go, and the sender compresses larger chunks
+	fSendBuffer.SetTo(new(std::nothrow) StreamingRingBuffer(128 * 1024));
 	if (!fSendBuffer.IsSet()) {
 		fInitStatus = B_NO_MEMORY;
 		return;
@@ -342,13 +347,21 @@ RemoteHWInterface::_NewConnection(BNetEndpoint &endpoint)
 {
 	fSender.Unset();
 
+	// the new client starts with an empty tile cache; a bitmap message that
+	// is currently being written might wait for room in the send buffer
+	while (fTileCache.LockWithTimeout(10000) != B_OK)
+		fSendBuffer->MakeEmpty();
+
 	fSendBuffer->MakeEmpty();
+	fTileCache.MakeEmpty();
+	fTileCache.Unlock();
 
 	BNetEndpoint *sendEndpoint = new(std::nothrow) BNetEndpoint(endpoint);
 	if (sendEndpoint == NULL)
 		return B_NO_MEMORY;
 
-	fSender.SetTo(new(std::nothrow) NetSender(sendEndpoint, fSendBuffer.Get()));
+	fSender.SetTo(new(std::nothrow) NetSender(sendEndpoint, fSendBuffer.Get(),
+		true));
 	if (!fSender.IsSet()) {
 		delete sendEndpoint;
 		return B_NO_MEMORY;
@@ -8,6 +8,7 @@
 #ifndef REMOTE_HW_INTERFACE_H
 #define REMOTE_HW_INTERFACE_H
 
+#include "BitmapTileCache.h"
 #include "HWInterface.h"
 
 #include <AutoDeleter.h>
@@ -84,6 +85,7 @@ virtual	status_t					CopyBackToFront(const BRect& frame);
 		StreamingRingBuffer*		ReceiveBuffer()
 										{ return fReceiveBuffer.Get(); }
 		StreamingRingBuffer*		SendBuffer() { return fSendBuffer.Get(); }
+		BitmapTileCache*			TileCache() { return &fTileCache; }
 
 typedef bool (*CallbackFunction)(void* cookie, RemoteMessage& message);
 
@@ -127,6 +129,8 @@ static	status_t					_NewConnectionCallback(void *cookie,
 		ObjectDeleter<NetSender>	fSender;
 		ObjectDeleter<NetReceiver>	fReceiver;
 
+		BitmapTileCache				fTileCache;
+
 		thread_id					fEventThread;
 		ObjectDeleter<RemoteEventStream>
 									fEventStream;
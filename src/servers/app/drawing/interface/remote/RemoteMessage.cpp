@@ -8,6 +8,8 @@
 
 #include "RemoteMessage.h"
 
+#include "BitmapTileCache.h"
+
 #ifndef CLIENT_COMPILE
 #include "DrawState.h"
 #include "ServerBitmap.h"
@@ -87,8 +89,13 @@ RemoteMessage::Cancel()
 
 
 #ifndef CLIENT_COMPILE
+/*!	If a \a tileCache is given, only the tiles of the bitmap that are not
+	yet known to the other side are sent along. The cache must stay locked
+	until the message has been flushed.
+*/
 void
-RemoteMessage::AddBitmap(const ServerBitmap& bitmap, bool minimal)
+RemoteMessage::AddBitmap(const ServerBitmap& bitmap, bool minimal,
+	BitmapTileCache* tileCache)
 {
 	Add(bitmap.Width());
 	Add(bitmap.Height());
@@ -99,15 +106,8 @@ RemoteMessage::AddBitmap(const ServerBitmap& bitmap, bool minimal)
 		Add(bitmap.Flags());
 	}
 
-	uint32 bitsLength = bitmap.BitsLength();
-	Add(bitsLength);
-
-	if (!_MakeSpace(bitsLength))
-		return;
-
-	memcpy(fBuffer + fWriteIndex, bitmap.Bits(), bitsLength);
-	fWriteIndex += bitsLength;
-	fAvailable -= bitsLength;
+	_AddBits(bitmap.Bits(), bitmap.BitsLength(), bitmap.Width(),
+		bitmap.Height(), bitmap.BytesPerRow(), bitmap.ColorSpace(), tileCache);
 }
 
 
@@ -170,7 +170,7 @@ RemoteMessage::AddPattern(const Pattern& pattern)
 #else // !CLIENT_COMPILE
 
 void
-RemoteMessage::AddBitmap(const BBitmap& bitmap)
+RemoteMessage::AddBitmap(const BBitmap& bitmap, BitmapTileCache* tileCache)
 {
 	BRect bounds = bitmap.Bounds();
 	Add(bounds.IntegerWidth() + 1);
@@ -179,17 +179,55 @@ RemoteMessage::AddBitmap(const BBitmap& bitmap)
 	Add((uint32)bitmap.ColorSpace());
 	Add(bitmap.Flags());
 
-	uint32 bitsLength = bitmap.BitsLength();
-	Add(bitsLength);
+	_AddBits((const uint8*)bitmap.Bits(), bitmap.BitsLength(),
+		bounds.IntegerWidth() + 1, bounds.IntegerHeight() + 1,
+		bitmap.BytesPerRow(), bitmap.ColorSpace(), tileCache);
+}
+#endif // !CLIENT_COMPILE
+
+
+void
+RemoteMessage::_AddBits(const uint8* bits, uint32 bitsLength, int32 width,
+	int32 height, int32 bytesPerRow, color_space colorSpace,
+	BitmapTileCache* tileCache)
+{
+	if (tileCache == NULL || !BitmapTileCache::IsSupported(colorSpace)
+		|| bytesPerRow < width * 4) {
+		Add((uint8)RP_BITMAP_RAW);
+		Add(bitsLength);
+		_AddData(bits, bitsLength);
+		return;
+	}
+
+	Add((uint8)RP_BITMAP_TILES);
 
-	if (!_MakeSpace(bitsLength))
+	// make room for the worst case up front, instead of growing the buffer
+	// tile by tile
+	int32 tileCount = ((width + kTileSize - 1) / kTileSize)
+		* ((height + kTileSize - 1) / kTileSize);
+	if (!_MakeSpace(tileCount * sizeof(uint32) + (size_t)width * height * 4))
 		return;
 
-	memcpy(fBuffer + fWriteIndex, bitmap.Bits(), bitsLength);
-	fWriteIndex += bitsLength;
-	fAvailable -= bitsLength;
+	for (int32 y = 0; y < height; y += kTileSize) {
+		int32 tileHeight = min_c(kTileSize, height - y);
+
+		for (int32 x = 0; x < width; x += kTileSize) {
+			int32 tileWidth = min_c(kTileSize, width - x);
+			const uint8* tile = bits + y * bytesPerRow + x * 4;
+
+			uint32 slot;
+			if (tileCache->GetSlot(BitmapTileCache::HashTile(tile, bytesPerRow,
+					tileWidth, tileHeight), slot)) {
+				Add(slot);
+				continue;
+			}
+
+			Add(slot | kTileDataFlag);
+			for (int32 row = 0; row < tileHeight; row++)
+				_AddData(tile + row * bytesPerRow, tileWidth * 4);
+		}
+	}
 }
-#endif // !CLIENT_COMPILE
 
 
 void
@@ -329,11 +367,15 @@ RemoteMessage::ReadString(char** _string, size_t& _length)
 }
 
 
+/*!	Reads a bitmap. If \a _bitmap is \c NULL, the bitmap is only read
+	past, but its tiles still end up in the \a tileCache.
+*/
 status_t
 RemoteMessage::ReadBitmap(BBitmap** _bitmap, bool minimal,
-	color_space colorSpace, uint32 flags)
+	color_space colorSpace, uint32 flags, BitmapTileCache* tileCache)
 {
-	uint32 bitsLength;
+	uint32 bitsLength = 0;
+	uint8 encoding;
 	int32 width, height, bytesPerRow;
 
 	Read(width);
@@ -345,10 +387,26 @@ RemoteMessage::ReadBitmap(BBitmap** _bitmap, bool minimal,
 		Read(flags);
 	}
 
-	Read(bitsLength);
+	status_t result = Read(encoding);
+	if (result != B_OK)
+		return result;
 
-	if (bitsLength > fDataLeft)
+	if (encoding == RP_BITMAP_RAW) {
+		Read(bitsLength);
+		if (bitsLength > fDataLeft)
+			return B_ERROR;
+	} else if (encoding != RP_BITMAP_TILES || tileCache == NULL
+		|| !BitmapTileCache::IsSupported(colorSpace)) {
+		TRACE_ERROR("unsupported bitmap encoding %" B_PRIu8 "\n", encoding);
 		return B_ERROR;
+	}
+
+	if (_bitmap == NULL) {
+		if (encoding == RP_BITMAP_TILES)
+			return _ReadTiles(NULL, 0, width, height, tileCache);
+
+		return _SkipData(bitsLength);
+	}
 
 #ifndef CLIENT_COMPILE
 	flags = B_BITMAP_NO_SERVER_LINK;
@@ -356,28 +414,128 @@ RemoteMessage::ReadBitmap(BBitmap** _bitmap, bool minimal,
 
 	BBitmap *bitmap = new(std::nothrow) BBitmap(
 		BRect(0, 0, width - 1, height - 1), flags, colorSpace, bytesPerRow);
+	if (bitmap != NULL && bitmap->InitCheck() != B_OK) {
+		delete bitmap;
+		bitmap = NULL;
+	}
+
+	if (encoding == RP_BITMAP_TILES) {
+		// the tiles need to be read in any case to keep the cache in sync
+		if (bitmap != NULL && bitmap->BytesPerRow() < width * 4) {
+			delete bitmap;
+			bitmap = NULL;
+		}
+
+		result = _ReadTiles(bitmap != NULL ? (uint8*)bitmap->Bits() : NULL,
+			bitmap != NULL ? bitmap->BytesPerRow() : 0, width, height,
+			tileCache);
+		if (result == B_OK && bitmap == NULL)
+			result = B_NO_MEMORY;
+		if (result != B_OK) {
+			delete bitmap;
+			return result;
+		}
+
+		*_bitmap = bitmap;
+		return B_OK;
+	}
+
 	if (bitmap == NULL)
 		return B_NO_MEMORY;
 
-	status_t result = bitmap->InitCheck();
+	if (bitmap->BitsLength() < (int32)bitsLength) {
+		delete bitmap;
+		return B_ERROR;
+	}
+
+	result = _ReadData(bitmap->Bits(), bitsLength);
 	if (result != B_OK) {
 		delete bitmap;
 		return result;
 	}
 
-	if (bitmap->BitsLength() < (int32)bitsLength) {
-		delete bitmap;
+	*_bitmap = bitmap;
+	return B_OK;
+}
+
+
+status_t
+RemoteMessage::_ReadData(void* buffer, size_t size)
+{
+	if (size > fDataLeft)
 		return B_ERROR;
-	}
 
-	int32 readSize = fSource->Read(bitmap->Bits(), bitsLength);
-	if ((uint32)readSize != bitsLength) {
-		delete bitmap;
+	int32 readSize = fSource->Read(buffer, size);
+	if ((size_t)readSize != size)
 		return readSize < 0 ? readSize : B_ERROR;
-	}
 
 	fDataLeft -= readSize;
-	*_bitmap = bitmap;
+	return B_OK;
+}
+
+
+status_t
+RemoteMessage::_SkipData(size_t size)
+{
+	if (size > fDataLeft)
+		return B_ERROR;
+
+	uint8 buffer[1024];
+	while (size > 0) {
+		size_t chunkSize = min_c(size, sizeof(buffer));
+		status_t result = _ReadData(buffer, chunkSize);
+		if (result != B_OK)
+			return result;
+
+		size -= chunkSize;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Reads the tiles of a bitmap, and copies them to \a bits, if given.
+	Tiles that are sent along are stored in the \a tileCache, the others
+	are taken from there.
+*/
+status_t
+RemoteMessage::_ReadTiles(uint8* bits, int32 bytesPerRow, int32 width,
+	int32 height, BitmapTileCache* tileCache)
+{
+	for (int32 y = 0; y < height; y += kTileSize) {
+		int32 tileHeight = min_c(kTileSize, height - y);
+
+		for (int32 x = 0; x < width; x += kTileSize) {
+			int32 tileWidth = min_c(kTileSize, width - x);
+			size_t tileBytesPerRow = tileWidth * 4;
+
+			uint32 slot;
+			status_t result = Read(slot);
+			if (result != B_OK)
+				return result;
+
+			uint8* tile = tileCache->SlotData(slot & ~kTileDataFlag);
+			if ((slot & kTileDataFlag) != 0) {
+				// without a tile to store it in, the data is discarded
+				size_t tileSize = tileBytesPerRow * tileHeight;
+				result = tile != NULL
+					? _ReadData(tile, tileSize) : _SkipData(tileSize);
+				if (result != B_OK)
+					return result;
+			}
+
+			if (bits == NULL || tile == NULL)
+				continue;
+
+			uint8* target = bits + y * bytesPerRow + x * 4;
+			for (int32 row = 0; row < tileHeight; row++) {
+				memcpy(target, tile, tileBytesPerRow);
+				target += bytesPerRow;
+				tile += tileBytesPerRow;
+			}
+		}
+	}
+
 	return B_OK;
 }
 
@@ -25,6 +25,7 @@
 
 class BBitmap;
 class BFont;
+class BitmapTileCache;
 class BGradient;
 class BView;
 class DrawState;
@@ -139,6 +140,13 @@ enum {
 };
 
 
+// how the bits of a bitmap are encoded
+enum {
+	RP_BITMAP_RAW = 0,
+	RP_BITMAP_TILES
+};
+
+
 class RemoteMessage {
 public:
 								RemoteMessage(StreamingRingBuffer* source,
@@ -163,14 +171,16 @@ public:
 
 #ifndef CLIENT_COMPILE
 		void					AddBitmap(const ServerBitmap& bitmap,
-									bool minimal = false);
+									bool minimal = false,
+									BitmapTileCache* tileCache = NULL);
 		void					AddFont(const ServerFont& font);
 		void					AddPattern(const Pattern& pattern);
 		void					AddDrawState(const DrawState& drawState);
 		void					AddArrayLine(const ViewLineArrayInfo& line);
 		void					AddCursor(const ServerCursor& cursor);
 #else
-		void					AddBitmap(const BBitmap& bitmap);
+		void					AddBitmap(const BBitmap& bitmap,
+									BitmapTileCache* tileCache = NULL);
 #endif
 
 		template<typename T>
@@ -189,7 +199,8 @@ public:
 		status_t				ReadBitmap(BBitmap** _bitmap,
 									bool minimal = false,
 									color_space colorSpace = B_RGB32,
-									uint32 flags = 0);
+									uint32 flags = 0,
+									BitmapTileCache* tileCache = NULL);
 		status_t				ReadGradient(BGradient** _gradient);
 		status_t				ReadTransform(BAffineTransform& transform);
 		status_t				ReadArrayLine(BPoint& startPoint,
@@ -200,6 +211,18 @@ public:
 
 private:
 		bool					_MakeSpace(size_t size);
+		void					_AddData(const void* data, size_t size);
+		void					_AddBits(const uint8* bits,
+									uint32 bitsLength, int32 width,
+									int32 height, int32 bytesPerRow,
+									color_space colorSpace,
+									BitmapTileCache* tileCache);
+
+		status_t				_ReadData(void* buffer, size_t size);
+		status_t				_SkipData(size_t size);
+		status_t				_ReadTiles(uint8* bits, int32 bytesPerRow,
+									int32 width, int32 height,
+									BitmapTileCache* tileCache);
 
 		StreamingRingBuffer*	fSource;
 		StreamingRingBuffer*	fTarget;
@@ -384,4 +407,16 @@ RemoteMessage::_MakeSpace(size_t size)
 	return true;
 }
 
+
+inline void
+RemoteMessage::_AddData(const void* data, size_t size)
+{
+	if (!_MakeSpace(size))
+		return;
+
+	memcpy(fBuffer + fWriteIndex, data, size);
+	fWriteIndex += size;
+	fAvailable -= size;
+}
+
 #endif // REMOTE_MESSAGE_H
@@ -73,8 +73,14 @@ StreamingRingBuffer::InitCheck()
 }
 
 
+/*!	Reads \a length bytes into \a buffer. If \a onlyBlockOnNoData is
+	\c true, whatever data is available is returned instead of waiting for
+	the rest. If no data arrives within \a timeout, the data read so far is
+	returned, or \c B_TIMED_OUT if there was none.
+*/
 int32
-StreamingRingBuffer::Read(void *buffer, size_t length, bool onlyBlockOnNoData)
+StreamingRingBuffer::Read(void *buffer, size_t length, bool onlyBlockOnNoData,
+	bigtime_t timeout)
 {
 	BAutolock readerLock(fReaderLocker);
 	if (!readerLock.IsLocked())
@@ -99,11 +105,24 @@ StreamingRingBuffer::Read(void *buffer, size_t length, bool onlyBlockOnNoData)
 			status_t result;
 			do {
 				TRACE("waiting in reader\n");
-				result = acquire_sem(fReaderNotifier);
+				if (timeout == B_INFINITE_TIMEOUT)
+					result = acquire_sem(fReaderNotifier);
+				else {
+					result = acquire_sem_etc(fReaderNotifier, 1,
+						B_RELATIVE_TIMEOUT, timeout);
+				}
 				TRACE("done waiting in reader with status: %#" B_PRIx32 "\n",
 					result);
 			} while (result == B_INTERRUPTED);
 
+			if (result == B_TIMED_OUT) {
+				// a writer might still release the semaphore, which only
+				// causes a spurious wake up later on
+				if (dataLock.Lock())
+					fReaderWaiting = false;
+				return readSize > 0 ? readSize : B_TIMED_OUT;
+			}
+
 			if (result != B_OK)
 				return result;
 
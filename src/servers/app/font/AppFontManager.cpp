@@ -16,6 +16,7 @@
 #include <new>
 #include <stdint.h>
 
+#include <Autolock.h>
 #include <Debug.h>
 #include <Entry.h>
 
@@ -31,6 +32,7 @@
 
 
 extern FT_Library gFreeTypeLibrary;
+extern BLocker gFreeTypeLibraryLock;
 
 
 //	#pragma mark -
@@ -66,7 +68,12 @@ AppFontManager::AddUserFontFromFile(const char* path, uint16 index, uint16 insta
 		return status;
 
 	FT_Face face;
-	FT_Error error = FT_New_Face(gFreeTypeLibrary, path, index | (instance << 16), &face);
+	FT_Error error;
+	{
+		BAutolock _(gFreeTypeLibraryLock);
+		error = FT_New_Face(gFreeTypeLibrary, path, index | (instance << 16),
+			&face);
+	}
 	if (error != 0)
 		return B_ERROR;
 
@@ -87,8 +94,12 @@ AppFontManager::AddUserFontFromMemory(const FT_Byte* fontAddress, size_t size, u
 	status_t status;
 
 	FT_Face face;
-	FT_Error error = FT_New_Memory_Face(gFreeTypeLibrary, fontAddress, size,
-		index | (instance << 16), &face);
+	FT_Error error;
+	{
+		BAutolock _(gFreeTypeLibraryLock);
+		error = FT_New_Memory_Face(gFreeTypeLibrary, fontAddress, size,
+			index | (instance << 16), &face);
+	}
 	if (error != 0)
 		return B_ERROR;
 
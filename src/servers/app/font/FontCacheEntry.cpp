@@ -133,6 +133,8 @@ FontCacheEntry::FontCacheEntry()
 	:
 	MultiLocker("FontCacheEntry lock"),
 	fGlyphCache(new(std::nothrow) GlyphCachePool()),
+	fGlyphAtlas(new(std::nothrow) GlyphAtlas()),
+	fRunCache(new(std::nothrow) ShapedRunCache()),
 	fEngine(),
 	fLastUsedTime(LONGLONG_MIN),
 	fUseCounter(0)
@@ -178,6 +180,10 @@ FontCacheEntry::Init(const ServerFont& font, bool forceVector)
 		return false;
 	}
 
+	// both the atlas and the run cache are optional
+	if (fRunCache.IsSet() && fRunCache->Init() != B_OK)
+		fRunCache.Unset();
+
 	return true;
 }
 
@@ -334,14 +340,20 @@ FontCacheEntry::CreateGlyph(uint32 glyphCode, FontCacheEntry* fallbackEntry)
 	}
 
 	if (engine->PrepareGlyph(glyphIndex)) {
-		glyph = fGlyphCache->CacheGlyph(glyphCode,
+		GlyphCache* newGlyph = fGlyphCache->CacheGlyph(glyphCode,
 			engine->DataSize(), engine->DataType(), engine->Bounds(),
 			engine->AdvanceX(), engine->AdvanceY(),
 			engine->PreciseAdvanceX(), engine->PreciseAdvanceY(),
 			engine->InsetLeft(), engine->InsetRight());
 
-		if (glyph != NULL)
-			engine->WriteGlyphTo(glyph->data);
+		if (newGlyph != NULL) {
+			engine->WriteGlyphTo(newGlyph->data);
+			if (newGlyph->data_type == glyph_data_gray8
+				&& fGlyphAtlas.IsSet()) {
+				fGlyphAtlas->AddGlyph(newGlyph);
+			}
+		}
+		glyph = newGlyph;
 	}
 
 	return glyph;
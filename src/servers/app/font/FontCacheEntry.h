@@ -36,8 +36,10 @@
 
 #include "ServerFont.h"
 #include "FontEngine.h"
+#include "GlyphAtlas.h"
 #include "MultiLocker.h"
 #include "Referenceable.h"
+#include "ShapedRunCache.h"
 #include "Transformable.h"
 
 
@@ -58,6 +60,8 @@ struct GlyphCache {
 		precise_advance_y(preciseAdvanceY),
 		inset_left(insetLeft),
 		inset_right(insetRight),
+		coverage(NULL),
+		coverage_bytes_per_row(0),
 		hash_link(NULL)
 	{
 	}
@@ -79,6 +83,10 @@ struct GlyphCache {
 	float			inset_left;
 	float			inset_right;
 
+	const uint8*	coverage;
+		// the glyph bitmap in the GlyphAtlas, if it is in there
+	int32			coverage_bytes_per_row;
+
 	GlyphCache*		hash_link;
 };
 
@@ -125,6 +133,9 @@ class FontCacheEntry : public MultiLocker, public BReferenceable {
 			bool				GetKerning(uint32 glyphCode1,
 									uint32 glyphCode2, double* x, double* y);
 
+			ShapedRunCache*		RunCache() const
+									{ return fRunCache.Get(); }
+
 	static	void				GenerateSignature(char* signature,
 									size_t signatureSize,
 									const ServerFont& font, bool forceVector);
@@ -147,6 +158,10 @@ class FontCacheEntry : public MultiLocker, public BReferenceable {
 
 			ObjectDeleter<GlyphCachePool>
 								fGlyphCache;
+			ObjectDeleter<GlyphAtlas>
+								fGlyphAtlas;
+			ObjectDeleter<ShapedRunCache>
+								fRunCache;
 			FontEngine			fEngine;
 
 	static	BLocker				sUsageUpdateLock;
@@ -0,0 +1,473 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "FontIndex.h"
+
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+
+#include <DataIO.h>
+#include <Entry.h>
+#include <File.h>
+#include <Path.h>
+
+
+static const uint32 kIndexMagic = 'FIdx';
+static const uint32 kIndexVersion = 1;
+static const uint32 kFreeTypeVersion
+	= (FREETYPE_MAJOR << 16) | (FREETYPE_MINOR << 8) | FREETYPE_PATCH;
+	// the styles depend on how FreeType parses the files
+
+static const off_t kMaxIndexSize = 16 * 1024 * 1024;
+
+
+struct index_header {
+	uint32		magic;
+	uint32		version;
+	uint32		freetype_version;
+	uint32		entry_count;
+};
+
+
+static inline bigtime_t
+modification_time(const struct stat& stat)
+{
+	return (bigtime_t)stat.st_mtim.tv_sec * 1000000
+		+ stat.st_mtim.tv_nsec / 1000;
+}
+
+
+/*!	Reads the index data from a buffer, making sure not to read beyond
+	its end.
+*/
+class IndexReader {
+public:
+	IndexReader(const uint8* data, size_t size)
+		:
+		fData(data),
+		fSize(size)
+	{
+	}
+
+	bool Read(void* buffer, size_t size)
+	{
+		if (size > fSize)
+			return false;
+
+		memcpy(buffer, fData, size);
+		fData += size;
+		fSize -= size;
+		return true;
+	}
+
+	bool ReadString(BString& string)
+	{
+		uint16 length;
+		if (!Read(&length, sizeof(length)) || length > fSize)
+			return false;
+
+		string.SetTo((const char*)fData, length);
+		fData += length;
+		fSize -= length;
+		return string.Length() == length;
+	}
+
+	bool IsEmpty() const
+	{
+		return fSize == 0;
+	}
+
+private:
+	const uint8*	fData;
+	size_t			fSize;
+};
+
+
+static status_t
+write_data(BDataIO& output, const void* buffer, size_t size)
+{
+	ssize_t written = output.Write(buffer, size);
+	if (written < 0)
+		return written;
+
+	return (size_t)written == size ? B_OK : B_ERROR;
+}
+
+
+static status_t
+write_string(BDataIO& output, const BString& string)
+{
+	uint16 length = string.Length();
+	status_t status = write_data(output, &length, sizeof(length));
+	if (status == B_OK)
+		status = write_data(output, string.String(), length);
+
+	return status;
+}
+
+
+// #pragma mark -
+
+
+font_index_entry::font_index_entry(const char* path, const struct stat& stat)
+	:
+	path(path),
+	size(stat.st_size),
+	modified(modification_time(stat)),
+	used(true),
+	styles(4)
+{
+}
+
+
+bool
+font_index_entry::Matches(const struct stat& stat) const
+{
+	return size == stat.st_size && modified == modification_time(stat);
+}
+
+
+// #pragma mark -
+
+
+FontIndex::FontIndex()
+	:
+	fChanged(false)
+{
+}
+
+
+FontIndex::~FontIndex()
+{
+	MakeEmpty();
+}
+
+
+/*!	Reads the index stored in the file at \a path. The file is read at
+	once, and replaces the current contents of the index.
+*/
+status_t
+FontIndex::Load(const char* path)
+{
+	MakeEmpty();
+
+	BFile file;
+	status_t status = file.SetTo(path, B_READ_ONLY);
+	if (status != B_OK)
+		return status;
+
+	off_t size;
+	status = file.GetSize(&size);
+	if (status != B_OK)
+		return status;
+	if (size < (off_t)sizeof(index_header) || size > kMaxIndexSize)
+		return B_BAD_DATA;
+
+	uint8* data = (uint8*)malloc(size);
+	if (data == NULL)
+		return B_NO_MEMORY;
+
+	ssize_t bytesRead = file.ReadAt(0, data, size);
+	if (bytesRead != size) {
+		free(data);
+		return bytesRead < 0 ? (status_t)bytesRead : B_IO_ERROR;
+	}
+
+	IndexReader reader(data, size);
+	index_header header;
+	reader.Read(&header, sizeof(header));
+	if (header.magic != kIndexMagic || header.version != kIndexVersion
+		|| header.freetype_version != kFreeTypeVersion) {
+		free(data);
+		return B_MISMATCHED_VALUES;
+	}
+
+	status = B_OK;
+	for (uint32 i = 0; i < header.entry_count && status == B_OK; i++) {
+		BString entryPath;
+		int64 entrySize;
+		int64 modified;
+		uint32 styleCount;
+		if (!reader.ReadString(entryPath)
+			|| !reader.Read(&entrySize, sizeof(entrySize))
+			|| !reader.Read(&modified, sizeof(modified))
+			|| !reader.Read(&styleCount, sizeof(styleCount))) {
+			status = B_BAD_DATA;
+			break;
+		}
+
+		struct stat stat;
+		memset(&stat, 0, sizeof(stat));
+		stat.st_size = entrySize;
+		font_index_entry* entry = new (std::nothrow) font_index_entry(
+			entryPath.String(), stat);
+		if (entry == NULL) {
+			status = B_NO_MEMORY;
+			break;
+		}
+		entry->modified = modified;
+		entry->used = false;
+
+		for (uint32 j = 0; j < styleCount; j++) {
+			font_style_info* info = new (std::nothrow) font_style_info;
+			if (info == NULL || !entry->styles.AddItem(info)) {
+				delete info;
+				status = B_NO_MEMORY;
+				break;
+			}
+
+			int64 faceIndex;
+			if (!reader.Read(&faceIndex, sizeof(faceIndex))
+				|| !reader.Read(&info->flags, sizeof(info->flags))
+				|| !reader.Read(&info->glyph_count, sizeof(info->glyph_count))
+				|| !reader.Read(&info->char_map_count,
+					sizeof(info->char_map_count))
+				|| !reader.Read(&info->tuned_count, sizeof(info->tuned_count))
+				|| !reader.Read(&info->height, sizeof(info->height))
+				|| !reader.ReadString(info->family)
+				|| !reader.ReadString(info->style)) {
+				status = B_BAD_DATA;
+				break;
+			}
+			info->face_index = faceIndex;
+		}
+
+		if (status == B_OK && fEntries.ContainsKey(
+				HashString(entry->path.String())))
+			status = B_BAD_DATA;
+		if (status == B_OK)
+			status = fEntries.Put(HashString(entry->path.String()), entry);
+		if (status != B_OK)
+			delete entry;
+	}
+
+	if (status == B_OK && !reader.IsEmpty())
+		status = B_BAD_DATA;
+
+	free(data);
+
+	if (status != B_OK)
+		MakeEmpty();
+
+	fChanged = false;
+	return status;
+}
+
+
+/*!	Writes the index to the file at \a path. The file is replaced
+	atomically, so that a partially written index is never read back.
+*/
+status_t
+FontIndex::Save(const char* path)
+{
+	BMallocIO output;
+	output.SetBlockSize(16 * 1024);
+
+	index_header header;
+	header.magic = kIndexMagic;
+	header.version = kIndexVersion;
+	header.freetype_version = kFreeTypeVersion;
+	header.entry_count = fEntries.Size();
+
+	status_t status = write_data(output, &header, sizeof(header));
+
+	EntryMap::Iterator iterator = fEntries.GetIterator();
+	while (status == B_OK && iterator.HasNext()) {
+		font_index_entry* entry = iterator.Next().value;
+
+		int64 size = entry->size;
+		int64 modified = entry->modified;
+		uint32 styleCount = entry->styles.CountItems();
+
+		status = write_string(output, entry->path);
+		if (status == B_OK)
+			status = write_data(output, &size, sizeof(size));
+		if (status == B_OK)
+			status = write_data(output, &modified, sizeof(modified));
+		if (status == B_OK)
+			status = write_data(output, &styleCount, sizeof(styleCount));
+
+		for (uint32 i = 0; i < styleCount && status == B_OK; i++) {
+			const font_style_info* info = entry->styles.ItemAt(i);
+
+			int64 faceIndex = info->face_index;
+			status = write_data(output, &faceIndex, sizeof(faceIndex));
+			if (status == B_OK)
+				status = write_data(output, &info->flags, sizeof(info->flags));
+			if (status == B_OK) {
+				status = write_data(output, &info->glyph_count,
+					sizeof(info->glyph_count));
+			}
+			if (status == B_OK) {
+				status = write_data(output, &info->char_map_count,
+					sizeof(info->char_map_count));
+			}
+			if (status == B_OK) {
+				status = write_data(output, &info->tuned_count,
+					sizeof(info->tuned_count));
+			}
+			if (status == B_OK)
+				status = write_data(output, &info->height, sizeof(info->height));
+			if (status == B_OK)
+				status = write_string(output, info->family);
+			if (status == B_OK)
+				status = write_string(output, info->style);
+		}
+	}
+	if (status != B_OK)
+		return status;
+
+	BString tempPath(path);
+	tempPath << "~";
+
+	BFile file;
+	status = file.SetTo(tempPath.String(),
+		B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
+	if (status != B_OK)
+		return status;
+
+	status = write_data(file, output.Buffer(), output.BufferLength());
+	file.Unset();
+
+	BEntry entry(tempPath.String());
+	if (status == B_OK)
+		status = entry.Rename(path, true);
+	if (status != B_OK) {
+		entry.Remove();
+		return status;
+	}
+
+	fChanged = false;
+	return B_OK;
+}
+
+
+/*!	Returns the entry of the file at \a path, if it is still up to date,
+	and marks it as used.
+*/
+font_index_entry*
+FontIndex::Lookup(const char* path, const struct stat& stat)
+{
+	font_index_entry* entry = fEntries.Get(HashString(path));
+	if (entry == NULL || !entry->Matches(stat))
+		return NULL;
+
+	entry->used = true;
+	return entry;
+}
+
+
+/*!	Adds \a entry to the index, replacing an existing entry for the same
+	path. The index takes over ownership of the entry, even on failure.
+*/
+status_t
+FontIndex::Put(font_index_entry* entry)
+{
+	HashString key(entry->path.String());
+	font_index_entry* previous = fEntries.Remove(key);
+	if (previous != entry)
+		delete previous;
+
+	status_t status = fEntries.Put(key, entry);
+	if (status != B_OK)
+		delete entry;
+
+	fChanged = true;
+	return status;
+}
+
+
+void
+FontIndex::Remove(const char* path)
+{
+	font_index_entry* entry = fEntries.Remove(HashString(path));
+	if (entry == NULL)
+		return;
+
+	delete entry;
+	fChanged = true;
+}
+
+
+//! Removes all entries that have not been looked up since they were loaded.
+void
+FontIndex::RemoveUnused()
+{
+	EntryMap::Iterator iterator = fEntries.GetIterator();
+	while (iterator.HasNext()) {
+		font_index_entry* entry = iterator.Next().value;
+		if (entry->used)
+			continue;
+
+		fEntries.Remove(iterator);
+		delete entry;
+		fChanged = true;
+	}
+}
+
+
+void
+FontIndex::MakeEmpty()
+{
+	EntryMap::Iterator iterator = fEntries.GetIterator();
+	while (iterator.HasNext())
+		delete iterator.Next().value;
+
+	fEntries.Clear();
+	fChanged = true;
+}
+
+
+/*!	\brief Opens the font file of \a entry, and collects the styles of all
+		of its faces and named instances.
+
+	This only uses the given FreeType \a library, and may therefore run
+	in parallel to other threads using their own library. When passing the
+	shared gFreeTypeLibrary, the caller must hold gFreeTypeLibraryLock.
+	Returns \c B_BAD_DATA if the file is not a font file at all.
+*/
+/*static*/ status_t
+FontIndex::ParseFile(FT_Library library, font_index_entry& entry)
+{
+	const char* path = entry.path.String();
+
+	FT_Face face;
+	FT_Error error = FT_New_Face(library, path, -1, &face);
+	if (error != 0)
+		return error == FT_Err_Unknown_File_Format ? B_BAD_DATA : B_ERROR;
+	FT_Long count = face->num_faces;
+	FT_Done_Face(face);
+
+	for (FT_Long i = 0; i < count; i++) {
+		error = FT_New_Face(library, path, -(i + 1), &face);
+		if (error != 0)
+			return B_ERROR;
+		uint32 variableCount = (face->style_flags & 0x7fff0000) >> 16;
+		FT_Done_Face(face);
+
+		uint32 j = variableCount == 0 ? 0 : 1;
+		do {
+			FT_Long faceIndex = i | (j << 16);
+			error = FT_New_Face(library, path, faceIndex, &face);
+			if (error != 0)
+				return B_ERROR;
+
+			font_style_info* info = new (std::nothrow) font_style_info;
+			if (info == NULL || !entry.styles.AddItem(info)) {
+				delete info;
+				FT_Done_Face(face);
+				return B_NO_MEMORY;
+			}
+
+			FontStyle::GetInfo(face, *info);
+			FT_Done_Face(face);
+			j++;
+		} while (j <= variableCount);
+	}
+
+	return B_OK;
+}
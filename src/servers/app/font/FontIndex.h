@@ -0,0 +1,66 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef FONT_INDEX_H
+#define FONT_INDEX_H
+
+
+#include <sys/stat.h>
+
+#include <HashMap.h>
+#include <HashString.h>
+#include <ObjectList.h>
+#include <String.h>
+
+#include "FontStyle.h"
+
+
+struct font_index_entry {
+								font_index_entry(const char* path,
+									const struct stat& stat);
+
+			bool				Matches(const struct stat& stat) const;
+
+			BString				path;
+			off_t				size;
+			bigtime_t			modified;
+			bool				used;
+			BObjectList<font_style_info, true> styles;
+};
+
+
+/*!	An index of the styles contained in the font files, keyed by the path,
+	size and modification time of each file. It is stored on disk, so that
+	the font files do not need to be opened again on every start.
+*/
+class FontIndex {
+public:
+								FontIndex();
+								~FontIndex();
+
+			status_t			Load(const char* path);
+			status_t			Save(const char* path);
+
+			bool				IsChanged() const
+									{ return fChanged; }
+
+			font_index_entry*	Lookup(const char* path,
+									const struct stat& stat);
+			status_t			Put(font_index_entry* entry);
+			void				Remove(const char* path);
+			void				RemoveUnused();
+			void				MakeEmpty();
+
+	static	status_t			ParseFile(FT_Library library,
+									font_index_entry& entry);
+
+private:
+			typedef HashMap<HashString, font_index_entry*> EntryMap;
+
+			EntryMap			fEntries;
+			bool				fChanged;
+};
+
+
+#endif	// FONT_INDEX_H
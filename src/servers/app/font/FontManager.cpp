@@ -15,6 +15,7 @@
 
 #include <new>
 
+#include <Autolock.h>
 #include <Debug.h>
 
 #include "FontFamily.h"
@@ -29,6 +30,9 @@
 
 
 FT_Library gFreeTypeLibrary;
+BLocker gFreeTypeLibraryLock("FreeType library lock");
+	// FreeType libraries are not thread safe, every use of
+	// gFreeTypeLibrary, including creating and freeing faces, must hold it
 
 
 static int
@@ -308,31 +312,75 @@ FontManager::_AddFont(FT_Face face, node_ref nodeRef, const char* path,
 {
 	ASSERT(IsLocked());
 
-	BReference<FontFamily> family(_FindFamily(face->family_name));
-	bool isNewFontFamily = !family.IsSet();
-
-	if (family.IsSet() && family->HasStyle(face->style_name)) {
+	if (_HasStyle(face->family_name, face->style_name)) {
 		// prevent adding the same style twice
 		// (this indicates a problem with the installed fonts maybe?)
+		BAutolock _(gFreeTypeLibraryLock);
 		FT_Done_Face(face);
 		return B_NAME_IN_USE;
 	}
 
+	// the FontStyle takes over ownership of the FT_Face object
+	FontStyle* style = new (std::nothrow) FontStyle(nodeRef, path, face, this);
+	if (style == NULL) {
+		BAutolock _(gFreeTypeLibraryLock);
+		FT_Done_Face(face);
+		return B_NO_MEMORY;
+	}
+
+	return _AddStyle(style, face->family_name, familyID, styleID);
+}
+
+
+/*!	\brief Adds the style described by \a info, without opening its face.
+*/
+status_t
+FontManager::_AddFont(const font_style_info& info, node_ref nodeRef,
+	const char* path, uint16& familyID, uint16& styleID)
+{
+	ASSERT(IsLocked());
+
+	if (_HasStyle(info.family.String(), info.style.String()))
+		return B_NAME_IN_USE;
+
+	FontStyle* style = new (std::nothrow) FontStyle(nodeRef, path, info, this);
+	if (style == NULL)
+		return B_NO_MEMORY;
+
+	return _AddStyle(style, info.family.String(), familyID, styleID);
+}
+
+
+bool
+FontManager::_HasStyle(const char* familyName, const char* styleName) const
+{
+	FontFamily* family = _FindFamily(familyName);
+	return family != NULL && family->HasStyle(styleName);
+}
+
+
+/*!	\brief Adds \a style to the family of the given name, creating the family
+		if needed. The style is deleted on failure.
+*/
+status_t
+FontManager::_AddStyle(FontStyle* style, const char* familyName,
+	uint16& familyID, uint16& styleID)
+{
+	BReference<FontFamily> family(_FindFamily(familyName));
+	bool isNewFontFamily = !family.IsSet();
+
 	if (!family.IsSet()) {
-		family.SetTo(new (std::nothrow) FontFamily(face->family_name, _NextID()), true);
+		family.SetTo(new (std::nothrow) FontFamily(familyName, _NextID()), true);
 
 		if (!family.IsSet() || !fFamilies.BinaryInsert(family, compare_font_families)) {
-			FT_Done_Face(face);
+			delete style;
 			return B_NO_MEMORY;
 		}
 	}
 
-	FTRACE(("\tadd style: %s, %s\n", face->family_name, face->style_name));
-
-	// the FontStyle takes over ownership of the FT_Face object
-	FontStyle* style = new (std::nothrow) FontStyle(nodeRef, path, face, this);
+	FTRACE(("\tadd style: %s, %s\n", familyName, style->Name()));
 
-	if (style == NULL || !family->AddStyle(style)) {
+	if (!family->AddStyle(style)) {
 		delete style;
 		if (isNewFontFamily)
 			fFamilies.RemoveItem(family);
@@ -21,6 +21,7 @@
 
 class FontFamily;
 class FontStyle;
+struct font_style_info;
 
 
 /*!
@@ -74,11 +75,21 @@ protected:
 			status_t			_AddFont(FT_Face face, node_ref nodeRef,
 									const char* path,
 									uint16& familyID, uint16& styleID);
+			status_t			_AddFont(const font_style_info& info,
+									node_ref nodeRef, const char* path,
+									uint16& familyID, uint16& styleID);
 			FontStyle*			_RemoveFont(uint16 familyID, uint16 styleID);
 			void				_RemoveAllFonts();
 
 	virtual	uint16				_NextID();
 
+private:
+			bool				_HasStyle(const char* familyName,
+									const char* styleName) const;
+			status_t			_AddStyle(FontStyle* style,
+									const char* familyName,
+									uint16& familyID, uint16& styleID);
+
 private:
 			struct FontKey {
 				FontKey()
@@ -16,10 +16,12 @@
 
 #include <FontPrivate.h>
 
+#include <Autolock.h>
 #include <Entry.h>
 
 
-static BLocker sFontLock("font lock");
+extern FT_Library gFreeTypeLibrary;
+extern BLocker gFreeTypeLibraryLock;
 
 
 /*!
@@ -32,64 +34,43 @@ FontStyle::FontStyle(node_ref& nodeRef, const char* path, FT_Face face,
 	FontManager* fontManager)
 	:
 	fFreeTypeFace(face),
-	fName(face->style_name),
+	fFaceIndex(face->face_index),
 	fPath(path),
 	fNodeRef(nodeRef),
 	fFamily(NULL),
 	fID(0),
 	fBounds(0, 0, 0, 0),
-	fFace(_TranslateStyleToFace(face->style_name)),
-	fFullAndHalfFixed(false),
 	fFontData(NULL),
+	fFontDataSize(0),
 	fFontManager(fontManager)
 {
-	fName.Truncate(B_FONT_STYLE_LENGTH);
-		// make sure this style can be found using the Be API
-
-	if (IsScalable()) {
-		fHeight.ascent = (double)face->ascender / face->units_per_EM;
-		fHeight.descent = (double)-face->descender / face->units_per_EM;
-			// FT2's descent numbers are negative. Be's is positive
-
-		// FT2 doesn't provide a linegap, but according to the docs, we can
-		// calculate it because height = ascending + descending + leading
-		fHeight.leading = (double)(face->height - face->ascender
-			+ face->descender) / face->units_per_EM;
-	} else {
-		// We don't have global metrics, get them from a bitmap
-		FT_Pos size = face->available_sizes[0].size;
-		for (int i = 1; i < face->num_fixed_sizes; i++)
-			size = max_c(size, face->available_sizes[i].size);
-		FT_Set_Pixel_Sizes(face, 0, size / 64);
-			// Size is encoded as 26.6 fixed point, while FT_Set_Pixel_Sizes
-			// uses the integer unencoded value
-
-		FT_Size_Metrics metrics = face->size->metrics;
-		fHeight.ascent = (double)metrics.ascender / size;
-		fHeight.descent = (double)-metrics.descender / size;
-		fHeight.leading = (double)(metrics.height - metrics.ascender
-			+ metrics.descender) / size;
-	}
-
-	if (IsFixedWidth())
-		return;
-
-	// manually check if all applicable chars are the same width
-
-	FT_Int32 loadFlags = FT_LOAD_NO_SCALE | FT_LOAD_TARGET_NORMAL;
-	if (FT_Load_Char(face, (uint32)' ', loadFlags) != 0)
-		return;
-
-	int firstWidth = face->glyph->advance.x;
-	for (uint32 c = ' ' + 1; c <= 0x7e; c++) {
-		if (FT_Load_Char(face, c, loadFlags) != 0)
-			return;
+	font_style_info info;
+	GetInfo(face, info);
+	_SetInfo(info);
+}
 
-		if (face->glyph->advance.x != firstWidth)
-			return;
-	}
 
-	fFullAndHalfFixed = true;
+/*!
+	\brief Constructor
+	\param filepath path to a font file
+	\param info the information about the face, as retrieved by GetInfo().
+		   The face itself is only opened once it is needed.
+*/
+FontStyle::FontStyle(node_ref& nodeRef, const char* path,
+	const font_style_info& info, FontManager* fontManager)
+	:
+	fFreeTypeFace(NULL),
+	fFaceIndex(info.face_index),
+	fPath(path),
+	fNodeRef(nodeRef),
+	fFamily(NULL),
+	fID(0),
+	fBounds(0, 0, 0, 0),
+	fFontData(NULL),
+	fFontDataSize(0),
+	fFontManager(fontManager)
+{
+	_SetInfo(info);
 }
 
 
@@ -101,7 +82,10 @@ FontStyle::~FontStyle()
 		fFontManager->Unlock();
 	}
 
-	FT_Done_Face(fFreeTypeFace);
+	if (fFreeTypeFace != NULL) {
+		BAutolock _(gFreeTypeLibraryLock);
+		FT_Done_Face(fFreeTypeFace);
+	}
 
 	if (fFontData != NULL)
 		free(fFontData);
@@ -111,14 +95,33 @@ FontStyle::~FontStyle()
 bool
 FontStyle::Lock()
 {
-	return sFontLock.Lock();
+	return gFreeTypeLibraryLock.Lock();
 }
 
 
 void
 FontStyle::Unlock()
 {
-	sFontLock.Unlock();
+	gFreeTypeLibraryLock.Unlock();
+}
+
+
+/*!
+	\brief Returns the FreeType face of this style, opening it first if the
+		style was created without one.
+	\return The face, or \c NULL if the font file could not be opened
+*/
+FT_Face
+FontStyle::FreeTypeFace() const
+{
+	BAutolock locker(gFreeTypeLibraryLock);
+
+	if (fFreeTypeFace == NULL && FT_New_Face(gFreeTypeLibrary, Path(),
+			fFaceIndex, &fFreeTypeFace) != 0) {
+		fFreeTypeFace = NULL;
+	}
+
+	return fFreeTypeFace;
 }
 
 
@@ -205,7 +208,7 @@ FontStyle::PreservedFace(uint16 face) const
 status_t
 FontStyle::UpdateFace(FT_Face face)
 {
-	if (!sFontLock.IsLocked()) {
+	if (!gFreeTypeLibraryLock.IsLocked()) {
 		debugger("UpdateFace() called without having locked FontStyle!");
 		return B_ERROR;
 	}
@@ -218,12 +221,101 @@ FontStyle::UpdateFace(FT_Face face)
 	if (name != fName)
 		return B_BAD_VALUE;
 
-	FT_Done_Face(fFreeTypeFace);
+	if (fFreeTypeFace != NULL)
+		FT_Done_Face(fFreeTypeFace);
 	fFreeTypeFace = face;
+	fFaceIndex = face->face_index;
 	return B_OK;
 }
 
 
+/*!	\brief Retrieves everything a FontStyle needs to know about \a face.
+
+	This only depends on the face, and therefore may be called with a face
+	from any FreeType library.
+*/
+/*static*/ void
+FontStyle::GetInfo(FT_Face face, font_style_info& info)
+{
+	info.family = face->family_name;
+	info.style = face->style_name;
+	info.face_index = face->face_index;
+	info.flags = 0;
+	info.glyph_count = face->num_glyphs;
+	info.char_map_count = face->num_charmaps;
+	info.tuned_count = face->num_fixed_sizes;
+
+	if (FT_IS_FIXED_WIDTH(face))
+		info.flags |= FONT_STYLE_FIXED_WIDTH;
+	if (FT_HAS_KERNING(face))
+		info.flags |= FONT_STYLE_KERNING;
+
+	font_height& height = info.height;
+	if (FT_IS_SCALABLE(face)) {
+		info.flags |= FONT_STYLE_SCALABLE;
+
+		height.ascent = (double)face->ascender / face->units_per_EM;
+		height.descent = (double)-face->descender / face->units_per_EM;
+			// FT2's descent numbers are negative. Be's is positive
+
+		// FT2 doesn't provide a linegap, but according to the docs, we can
+		// calculate it because height = ascending + descending + leading
+		height.leading = (double)(face->height - face->ascender
+			+ face->descender) / face->units_per_EM;
+	} else {
+		// We don't have global metrics, get them from a bitmap
+		FT_Pos size = face->available_sizes[0].size;
+		for (int i = 1; i < face->num_fixed_sizes; i++)
+			size = max_c(size, face->available_sizes[i].size);
+		FT_Set_Pixel_Sizes(face, 0, size / 64);
+			// Size is encoded as 26.6 fixed point, while FT_Set_Pixel_Sizes
+			// uses the integer unencoded value
+
+		FT_Size_Metrics metrics = face->size->metrics;
+		height.ascent = (double)metrics.ascender / size;
+		height.descent = (double)-metrics.descender / size;
+		height.leading = (double)(metrics.height - metrics.ascender
+			+ metrics.descender) / size;
+	}
+
+	if (FT_IS_FIXED_WIDTH(face))
+		return;
+
+	// manually check if all applicable chars are the same width
+
+	FT_Int32 loadFlags = FT_LOAD_NO_SCALE | FT_LOAD_TARGET_NORMAL;
+	if (FT_Load_Char(face, (uint32)' ', loadFlags) != 0)
+		return;
+
+	int firstWidth = face->glyph->advance.x;
+	for (uint32 c = ' ' + 1; c <= 0x7e; c++) {
+		if (FT_Load_Char(face, c, loadFlags) != 0)
+			return;
+
+		if (face->glyph->advance.x != firstWidth)
+			return;
+	}
+
+	info.flags |= FONT_STYLE_FULL_AND_HALF_FIXED;
+}
+
+
+void
+FontStyle::_SetInfo(const font_style_info& info)
+{
+	fName = info.style;
+	fName.Truncate(B_FONT_STYLE_LENGTH);
+		// make sure this style can be found using the Be API
+
+	fFace = _TranslateStyleToFace(info.style.String());
+	fFlags = info.flags;
+	fGlyphCount = info.glyph_count;
+	fCharMapCount = info.char_map_count;
+	fTunedCount = info.tuned_count;
+	fHeight = info.height;
+}
+
+
 void
 FontStyle::_SetFontFamily(FontFamily* family, uint16 id)
 {
@@ -29,6 +29,29 @@ class FontManager;
 class ServerFont;
 
 
+enum {
+	FONT_STYLE_FIXED_WIDTH			= 0x01,
+	FONT_STYLE_FULL_AND_HALF_FIXED	= 0x02,
+	FONT_STYLE_SCALABLE				= 0x04,
+	FONT_STYLE_KERNING				= 0x08,
+};
+
+
+/*!	Everything a FontStyle needs to know about its face up front, so that
+	the face itself only has to be opened once it is actually used.
+*/
+struct font_style_info {
+	BString			family;
+	BString			style;
+	FT_Long			face_index;
+	uint32			flags;
+	uint16			glyph_count;
+	uint16			char_map_count;
+	int32			tuned_count;
+	font_height		height;
+};
+
+
 /*!
 	\class FontStyle FontStyle.h
 	\brief Object used to represent a font style
@@ -40,6 +63,9 @@ class FontStyle : public BReferenceable {
 	public:
 						FontStyle(node_ref& nodeRef, const char* path,
 							FT_Face face, FontManager* fontManager);
+						FontStyle(node_ref& nodeRef, const char* path,
+							const font_style_info& info,
+							FontManager* fontManager);
 		virtual			~FontStyle();
 
 		const node_ref& NodeRef() const { return fNodeRef; }
@@ -53,7 +79,7 @@ class FontStyle : public BReferenceable {
 	\return true if fixed, false if not
 */
 		bool			IsFixedWidth() const
-							{ return FT_IS_FIXED_WIDTH(fFreeTypeFace); }
+							{ return (fFlags & FONT_STYLE_FIXED_WIDTH) != 0; }
 
 
 /*	\fn bool FontStyle::IsFullAndHalfFixed()
@@ -61,7 +87,8 @@ class FontStyle : public BReferenceable {
 	\return false (for now)
 */
 		bool			IsFullAndHalfFixed() const
-							{ return fFullAndHalfFixed; };
+							{ return (fFlags
+								& FONT_STYLE_FULL_AND_HALF_FIXED) != 0; }
 
 /*!
 	\fn bool FontStyle::IsScalable(void)
@@ -69,42 +96,42 @@ class FontStyle : public BReferenceable {
 	\return true if scalable, false if not
 */
 		bool			IsScalable() const
-							{ return FT_IS_SCALABLE(fFreeTypeFace); }
+							{ return (fFlags & FONT_STYLE_SCALABLE) != 0; }
 /*!
 	\fn bool FontStyle::HasKerning(void)
 	\brief Determines whether the font has kerning information
 	\return true if kerning info is available, false if not
 */
 		bool			HasKerning() const
-							{ return FT_HAS_KERNING(fFreeTypeFace); }
+							{ return (fFlags & FONT_STYLE_KERNING) != 0; }
 /*!
 	\fn bool FontStyle::HasTuned(void)
 	\brief Determines whether the font contains strikes
 	\return true if it has strikes included, false if not
 */
 		bool			HasTuned() const
-							{ return FT_HAS_FIXED_SIZES(fFreeTypeFace); }
+							{ return fTunedCount > 0; }
 /*!
 	\fn bool FontStyle::TunedCount(void)
 	\brief Returns the number of strikes the style contains
 	\return The number of strikes the style contains
 */
 		int32			TunedCount() const
-							{ return fFreeTypeFace->num_fixed_sizes; }
+							{ return fTunedCount; }
 /*!
 	\fn bool FontStyle::GlyphCount(void)
 	\brief Returns the number of glyphs in the style
 	\return The number of glyphs the style contains
 */
 		uint16			GlyphCount() const
-							{ return fFreeTypeFace->num_glyphs; }
+							{ return fGlyphCount; }
 /*!
 	\fn bool FontStyle::CharMapCount(void)
 	\brief Returns the number of character maps the style contains
 	\return The number of character maps the style contains
 */
 		uint16			CharMapCount() const
-							{ return fFreeTypeFace->num_charmaps; }
+							{ return fCharMapCount; }
 
 		const char*		Name() const
 							{ return fName.String(); }
@@ -127,8 +154,9 @@ class FontStyle : public BReferenceable {
 		font_file_format FileFormat() const
 							{ return B_TRUETYPE_WINDOWS; }
 
-		FT_Face			FreeTypeFace() const
-							{ return fFreeTypeFace; }
+		FT_Face			FreeTypeFace() const;
+		FT_Long			FaceIndex() const
+							{ return fFaceIndex; }
 
 		status_t		UpdateFace(FT_Face face);
 
@@ -142,13 +170,17 @@ class FontStyle : public BReferenceable {
 		FT_Byte*  		FontData() const
 							{ return fFontData; }
 
+		static void		GetInfo(FT_Face face, font_style_info& info);
+
 	private:
 		friend class FontFamily;
 		friend class FontManager;
 		uint16			_TranslateStyleToFace(const char *name) const;
 		void			_SetFontFamily(FontFamily* family, uint16 id);
+		void			_SetInfo(const font_style_info& info);
 	private:
-		FT_Face			fFreeTypeFace;
+		mutable FT_Face	fFreeTypeFace;
+		FT_Long			fFaceIndex;
 		BString			fName;
 		BPath			fPath;
 		node_ref		fNodeRef;
@@ -161,7 +193,10 @@ class FontStyle : public BReferenceable {
 
 		font_height		fHeight;
 		uint16			fFace;
-		bool			fFullAndHalfFixed;
+		uint32			fFlags;
+		uint16			fGlyphCount;
+		uint16			fCharMapCount;
+		int32			fTunedCount;
 
 		FT_Byte*		fFontData;
 		uint32			fFontDataSize;
@@ -22,6 +22,7 @@
 #include <File.h>
 #include <FindDirectory.h>
 #include <Message.h>
+#include <MessageRunner.h>
 #include <NodeMonitor.h>
 #include <Path.h>
 #include <String.h>
@@ -46,6 +47,13 @@
 
 GlobalFontManager* gFontManager = NULL;
 extern FT_Library gFreeTypeLibrary;
+extern BLocker gFreeTypeLibraryLock;
+
+static const uint32 kMsgSaveFontIndex = 'svfi';
+static const bigtime_t kFontIndexSaveDelay = 2000000;
+	// changes are collected for a while, as fonts are usually installed
+	// or removed in batches
+static const int32 kMaxParserThreads = 8;
 
 
 struct GlobalFontManager::font_directory {
@@ -66,6 +74,24 @@ struct GlobalFontManager::font_mapping {
 };
 
 
+struct GlobalFontManager::font_file {
+	font_directory*		directory;
+	node_ref			nodeRef;
+	BPath				path;
+	struct stat			stat;
+	font_index_entry*	entry;
+	ObjectDeleter<font_index_entry> parsedEntry;
+		// set when the file was not in the index, until it is added to it
+	status_t			status;
+};
+
+
+struct GlobalFontManager::font_parser {
+	BObjectList<font_file>* files;
+	int32				next;
+};
+
+
 FontStyle*
 GlobalFontManager::font_directory::FindStyle(const node_ref& nodeRef) const
 {
@@ -108,10 +134,12 @@ GlobalFontManager::GlobalFontManager()
 	fDefaultBoldFont(NULL),
 	fDefaultFixedFont(NULL),
 
-	fScanned(false)
+	fScanned(false),
+	fFontIndexSavePending(false)
 {
 	fInitStatus = FT_Init_FreeType(&gFreeTypeLibrary) == 0 ? B_OK : B_ERROR;
 	if (fInitStatus == B_OK) {
+		_LoadFontIndex();
 		_AddSystemPaths();
 		_AddUserPaths();
 		_LoadRecentFontMappings();
@@ -137,6 +165,9 @@ GlobalFontManager::~GlobalFontManager()
 	fDefaultBoldFont.Unset();
 	fDefaultFixedFont.Unset();
 
+	if (fFontIndex.IsChanged())
+		_SaveFontIndex();
+
 	_RemoveAllFonts();
 
 	FT_Done_FreeType(gFreeTypeLibrary);
@@ -241,6 +272,7 @@ GlobalFontManager::MessageReceived(BMessage* message)
 								nodeRef.node = node;
 								FontStyle* style;
 								while ((style = fromDirectory->FindStyle(nodeRef)) != NULL) {
+									fFontIndex.Remove(style->Path());
 									fromDirectory->styles.RemoveItem(style, false);
 									directory->styles.AddItem(style);
 									style->UpdatePath(directory->directory);
@@ -285,9 +317,16 @@ GlobalFontManager::MessageReceived(BMessage* message)
 					break;
 				}
 			}
+
+			_ScheduleFontIndexSave();
 			break;
 		}
 
+		case kMsgSaveFontIndex:
+			fFontIndexSavePending = false;
+			_SaveFontIndex();
+			break;
+
 		default:
 			BLooper::MessageReceived(message);
 			break;
@@ -478,6 +517,7 @@ GlobalFontManager::_RemoveStyle(font_directory& directory, FontStyle* style)
 {
 	FTRACE(("font removed: %s\n", style->Name()));
 
+	fFontIndex.Remove(style->Path());
 	directory.styles.RemoveItem(style);
 
 	_RemoveFont(style->Family()->ID(), style->ID());
@@ -688,19 +728,134 @@ GlobalFontManager::_ScanFonts()
 	if (fScanned)
 		return;
 
+	FontFileList files(256);
+
 	for (int32 i = fDirectories.CountItems(); i-- > 0;) {
 		font_directory* directory = fDirectories.ItemAt(i);
 
 		if (directory->scanned)
 			continue;
 
-		_ScanFontDirectory(*directory);
+		_ScanFontDirectory(*directory, files);
 	}
 
+	// Only the files that are not in the index yet need to be opened
+
+	BObjectList<font_file> unknownFiles(files.CountItems());
+
+	for (int32 i = 0; i < files.CountItems(); i++) {
+		font_file* file = files.ItemAt(i);
+
+		file->entry = fFontIndex.Lookup(file->path.Path(), file->stat);
+		if (file->entry != NULL)
+			continue;
+
+		file->parsedEntry.SetTo(new (std::nothrow) font_index_entry(
+			file->path.Path(), file->stat));
+		file->entry = file->parsedEntry.Get();
+		if (file->entry != NULL)
+			unknownFiles.AddItem(file);
+	}
+
+	_ParseFontFiles(unknownFiles);
+
+	for (int32 i = 0; i < files.CountItems(); i++) {
+		font_file* file = files.ItemAt(i);
+		if (file->entry == NULL)
+			continue;
+
+		_AddStyles(*file->directory, file->nodeRef, file->path.Path(),
+			*file->entry);
+
+		// Files that are no fonts are remembered as well, so that they
+		// won't be opened again
+		if (file->parsedEntry.IsSet()
+			&& (file->status == B_OK || file->status == B_BAD_DATA)) {
+			fFontIndex.Put(file->parsedEntry.Detach());
+		}
+	}
+
+	fFontIndex.RemoveUnused();
+	_ScheduleFontIndexSave();
+
 	fScanned = true;
 }
 
 
+/*!	\brief Parses the given font files into their index entries, using as
+		many threads as there are CPUs.
+*/
+void
+GlobalFontManager::_ParseFontFiles(BObjectList<font_file>& files)
+{
+	int32 count = files.CountItems();
+	if (count == 0)
+		return;
+
+	for (int32 i = 0; i < count; i++)
+		files.ItemAt(i)->status = B_NO_INIT;
+
+	int32 threadCount = 1;
+	system_info info;
+	if (get_system_info(&info) == B_OK)
+		threadCount = info.cpu_count;
+	threadCount = min_c(min_c(threadCount, kMaxParserThreads), count);
+
+	font_parser parser;
+	parser.files = &files;
+	parser.next = 0;
+
+	thread_id threads[kMaxParserThreads];
+	int32 spawned = 0;
+	for (int32 i = 1; i < threadCount; i++) {
+		thread_id thread = spawn_thread(&_ParseFontFilesThread, "font parser",
+			B_NORMAL_PRIORITY, &parser);
+		if (thread < 0 || resume_thread(thread) != B_OK)
+			break;
+
+		threads[spawned++] = thread;
+	}
+
+	// we do our share of the work, too
+	_ParseFontFilesThread(&parser);
+
+	for (int32 i = 0; i < spawned; i++) {
+		status_t result;
+		wait_for_thread(threads[i], &result);
+	}
+
+	// in case no thread could get its own library
+	BAutolock _(gFreeTypeLibraryLock);
+	for (int32 i = 0; i < count; i++) {
+		font_file* file = files.ItemAt(i);
+		if (file->status == B_NO_INIT)
+			file->status = FontIndex::ParseFile(gFreeTypeLibrary, *file->entry);
+	}
+}
+
+
+/*static*/ status_t
+GlobalFontManager::_ParseFontFilesThread(void* _parser)
+{
+	font_parser* parser = (font_parser*)_parser;
+
+	// A FreeType library must not be used by more than one thread at a time
+	FT_Library library;
+	if (FT_Init_FreeType(&library) != 0)
+		return B_ERROR;
+
+	int32 count = parser->files->CountItems();
+	int32 index;
+	while ((index = atomic_add(&parser->next, 1)) < count) {
+		font_file* file = parser->files->ItemAt(index);
+		file->status = FontIndex::ParseFile(library, *file->entry);
+	}
+
+	FT_Done_FreeType(library);
+	return B_OK;
+}
+
+
 /*!	\brief Adds the FontFamily/FontStyle that is represented by this path.
 */
 status_t
@@ -716,39 +871,57 @@ GlobalFontManager::_AddFont(font_directory& directory, BEntry& entry)
 	if (status < B_OK)
 		return status;
 
-	FT_Face face;
-	FT_Error error = FT_New_Face(gFreeTypeLibrary, path.Path(), -1, &face);
-	if (error != 0)
+	struct stat stat;
+	status = entry.GetStat(&stat);
+	if (status < B_OK)
+		return status;
+
+	font_index_entry* indexEntry = fFontIndex.Lookup(path.Path(), stat);
+	if (indexEntry != NULL)
+		return _AddStyles(directory, nodeRef, path.Path(), *indexEntry);
+
+	ObjectDeleter<font_index_entry> parsedEntry(
+		new (std::nothrow) font_index_entry(path.Path(), stat));
+	if (!parsedEntry.IsSet())
+		return B_NO_MEMORY;
+
+	{
+		BAutolock _(gFreeTypeLibraryLock);
+		status = FontIndex::ParseFile(gFreeTypeLibrary, *parsedEntry.Get());
+	}
+	if (status != B_OK && status != B_BAD_DATA) {
+		_AddStyles(directory, nodeRef, path.Path(), *parsedEntry.Get());
+		return status;
+	}
+
+	indexEntry = parsedEntry.Detach();
+	if (fFontIndex.Put(indexEntry) != B_OK)
+		return B_NO_MEMORY;
+
+	if (status != B_OK)
 		return B_ERROR;
-	FT_Long count = face->num_faces;
-	FT_Done_Face(face);
-
-	for (FT_Long i = 0; i < count; i++) {
-		FT_Error error = FT_New_Face(gFreeTypeLibrary, path.Path(), -(i + 1), &face);
-		if (error != 0)
-			return B_ERROR;
-		uint32 variableCount = (face->style_flags & 0x7fff0000) >> 16;
-		FT_Done_Face(face);
-
-		uint32 j = variableCount == 0 ? 0 : 1;
-		do {
-			FT_Long faceIndex = i | (j << 16);
-			error = FT_New_Face(gFreeTypeLibrary, path.Path(), faceIndex, &face);
-			if (error != 0)
-				return B_ERROR;
-
-			uint16 familyID, styleID;
-			status = FontManager::_AddFont(face, nodeRef, path.Path(), familyID, styleID);
-			if (status == B_NAME_IN_USE) {
-				status = B_OK;
-				j++;
-				continue;
-			}
-			if (status < B_OK)
-				return status;
-			directory.styles.AddItem(GetStyle(familyID, styleID));
-			j++;
-		} while (j <= variableCount);
+
+	return _AddStyles(directory, nodeRef, path.Path(), *indexEntry);
+}
+
+
+/*!	\brief Adds the styles of the font file at \a path, as found in its
+		index \a entry.
+*/
+status_t
+GlobalFontManager::_AddStyles(font_directory& directory,
+	const node_ref& nodeRef, const char* path, const font_index_entry& entry)
+{
+	for (int32 i = 0; i < entry.styles.CountItems(); i++) {
+		uint16 familyID, styleID;
+		status_t status = FontManager::_AddFont(*entry.styles.ItemAt(i),
+			nodeRef, path, familyID, styleID);
+		if (status == B_NAME_IN_USE)
+			continue;
+		if (status < B_OK)
+			return status;
+
+		directory.styles.AddItem(GetStyle(familyID, styleID));
 	}
 
 	return B_OK;
@@ -907,12 +1080,14 @@ GlobalFontManager::_CreateDirectories(const char* path)
 
 /*!	\brief Scan a folder for all valid fonts
 	\param directoryPath Path of the folder to scan.
+	\param files The list the files found are added to.
 */
 status_t
-GlobalFontManager::_ScanFontDirectory(font_directory& fontDirectory)
+GlobalFontManager::_ScanFontDirectory(font_directory& fontDirectory,
+	FontFileList& files)
 {
-	// This bad boy does all the real work. It loads each entry in the
-	// directory. If a valid font file, it adds both the family and the style.
+	// This collects all files in the directory, and its subdirectories;
+	// the font files among them are added by _ScanFonts() later on.
 
 	if (fontDirectory.scanned)
 		return B_OK;
@@ -929,7 +1104,7 @@ GlobalFontManager::_ScanFontDirectory(font_directory& fontDirectory)
 			font_directory* newDirectory;
 			if (_AddPath(entry, &newDirectory) == B_OK && newDirectory != NULL
 				&& !newDirectory->scanned) {
-				_ScanFontDirectory(*newDirectory);
+				_ScanFontDirectory(*newDirectory, files);
 			}
 
 			continue;
@@ -951,8 +1126,20 @@ GlobalFontManager::_ScanFontDirectory(font_directory& fontDirectory)
 		face->charmap = charmap;
 #endif
 
-		_AddFont(fontDirectory, entry);
-			// takes over ownership of the FT_Face object
+		font_file* file = new (std::nothrow) font_file;
+		if (file == NULL)
+			return B_NO_MEMORY;
+
+		file->directory = &fontDirectory;
+		file->entry = NULL;
+		file->status = B_NO_INIT;
+
+		if (entry.GetNodeRef(&file->nodeRef) != B_OK
+			|| entry.GetPath(&file->path) != B_OK
+			|| entry.GetStat(&file->stat) != B_OK
+			|| !files.AddItem(file)) {
+			delete file;
+		}
 	}
 
 	fontDirectory.scanned = true;
@@ -960,6 +1147,70 @@ GlobalFontManager::_ScanFontDirectory(font_directory& fontDirectory)
 }
 
 
+status_t
+GlobalFontManager::_GetFontIndexPath(BPath& path)
+{
+#if TEST_MODE
+	directory_which which = B_USER_CACHE_DIRECTORY;
+#else
+	directory_which which = B_SYSTEM_CACHE_DIRECTORY;
+#endif
+	status_t status = find_directory(which, &path, true);
+	if (status == B_OK)
+		status = path.Append("app_server");
+	if (status == B_OK)
+		status = create_directory(path.Path(), 0755);
+	if (status == B_OK)
+		status = path.Append("font_index");
+
+	return status;
+}
+
+
+void
+GlobalFontManager::_LoadFontIndex()
+{
+	BPath path;
+	if (_GetFontIndexPath(path) != B_OK)
+		return;
+
+	status_t status = fFontIndex.Load(path.Path());
+	if (status != B_OK) {
+		FTRACE(("GlobalFontManager: could not load font index: %s\n",
+			strerror(status)));
+	}
+}
+
+
+void
+GlobalFontManager::_SaveFontIndex()
+{
+	BPath path;
+	status_t status = _GetFontIndexPath(path);
+	if (status == B_OK)
+		status = fFontIndex.Save(path.Path());
+	if (status != B_OK) {
+		FTRACE(("GlobalFontManager: could not save font index: %s\n",
+			strerror(status)));
+	}
+}
+
+
+//! Saves the font index a little later, if it has been changed
+void
+GlobalFontManager::_ScheduleFontIndexSave()
+{
+	if (fFontIndexSavePending || !fFontIndex.IsChanged())
+		return;
+
+	BMessage message(kMsgSaveFontIndex);
+	if (BMessageRunner::StartSending(BMessenger(this), &message,
+			kFontIndexSaveDelay, 1) == B_OK) {
+		fFontIndexSavePending = true;
+	}
+}
+
+
 /*!	\brief Locates a FontFamily object by name
 	\param name The family to find
 	\return Pointer to the specified family or NULL if not found.
@@ -10,6 +10,7 @@
 #define GLOBAL_FONT_MANAGER_H
 
 
+#include "FontIndex.h"
 #include "FontManager.h"
 
 #include <AutoDeleter.h>
@@ -70,6 +71,10 @@ public:
 private:
 			struct font_directory;
 			struct font_mapping;
+			struct font_file;
+			struct font_parser;
+
+			typedef BObjectList<font_file, true>	FontFileList;
 
 			void				_AddDefaultMapping(const char* family,
 									const char* style, const char* path);
@@ -88,9 +93,16 @@ private:
 
 			void				_ScanFontsIfNecessary();
 			void				_ScanFonts();
-			status_t			_ScanFontDirectory(font_directory& directory);
+			status_t			_ScanFontDirectory(font_directory& directory,
+									FontFileList& files);
+			void				_ParseFontFiles(
+									BObjectList<font_file>& files);
+	static	status_t			_ParseFontFilesThread(void* _parser);
 			status_t			_AddFont(font_directory& directory,
 									BEntry& entry);
+			status_t			_AddStyles(font_directory& directory,
+									const node_ref& nodeRef, const char* path,
+									const font_index_entry& entry);
 			void 				_RemoveStyle(font_directory& directory,
 									FontStyle* style);
 			void 				_RemoveStyle(dev_t device, uint64 directory,
@@ -102,6 +114,11 @@ private:
 									uint16 fallbackFace);
 			status_t			_SetDefaultFonts();
 
+			status_t			_GetFontIndexPath(BPath& path);
+			void				_LoadFontIndex();
+			void				_SaveFontIndex();
+			void				_ScheduleFontIndexSave();
+
 private:
 			status_t			fInitStatus;
 
@@ -120,6 +137,8 @@ private:
 
 			bool				fScanned;
 
+			FontIndex			fFontIndex;
+			bool				fFontIndexSavePending;
 };
 
 
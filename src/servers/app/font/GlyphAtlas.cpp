@@ -0,0 +1,120 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "GlyphAtlas.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <new>
+
+#include "FontCacheEntry.h"
+
+
+static const int32 kPageWidth = 256;
+static const int32 kPageHeight = 64;
+
+
+struct GlyphAtlas::Page {
+	Page*	next;
+	uint8	coverage[kPageWidth * kPageHeight];
+};
+
+
+GlyphAtlas::GlyphAtlas()
+	:
+	fPages(NULL),
+	fShelfX(0),
+	fShelfY(0),
+	fShelfHeight(0),
+	fSize(0)
+{
+}
+
+
+GlyphAtlas::~GlyphAtlas()
+{
+	while (fPages != NULL) {
+		Page* next = fPages->next;
+		free(fPages);
+		fPages = next;
+	}
+}
+
+
+/*!	Copies the coverage of \a glyph, which must be an anti-aliased glyph
+	bitmap, into the atlas, and points its \c coverage at it. Glyphs are
+	placed next to each other on shelves as high as the tallest glyph on
+	them, and the shelves are stacked onto pages; full pages are never
+	revisited.
+	Returns \c false if the glyph could not be added, in which case it
+	continues to be drawn from its scanlines.
+*/
+bool
+GlyphAtlas::AddGlyph(GlyphCache* glyph)
+{
+	if (glyph->data_type != glyph_data_gray8 || !glyph->bounds.is_valid())
+		return false;
+
+	const agg::rect_i& bounds = glyph->bounds;
+	int32 width = bounds.x2 - bounds.x1 + 1;
+	int32 height = bounds.y2 - bounds.y1 + 1;
+	if (width > kPageWidth || height > kPageHeight)
+		return false;
+
+	if (fShelfX + width > kPageWidth) {
+		// start a new shelf
+		fShelfY += fShelfHeight;
+		fShelfX = 0;
+		fShelfHeight = 0;
+	}
+
+	if (fPages == NULL || fShelfY + height > kPageHeight) {
+		Page* page = (Page*)malloc(sizeof(Page));
+		if (page == NULL)
+			return false;
+
+		memset(page->coverage, 0, sizeof(page->coverage));
+		page->next = fPages;
+		fPages = page;
+		fSize += sizeof(Page);
+
+		fShelfX = 0;
+		fShelfY = 0;
+		fShelfHeight = 0;
+	}
+
+	uint8* coverage = fPages->coverage + fShelfY * kPageWidth + fShelfX;
+
+	// decode the serialized scanlines into the reserved area
+	FontCacheEntry::GlyphGray8Adapter adapter;
+	FontCacheEntry::GlyphGray8Scanline scanline;
+	adapter.init(glyph->data, glyph->data_size, 0, 0);
+	if (adapter.rewind_scanlines()) {
+		while (adapter.sweep_scanline(scanline)) {
+			uint8* row = coverage + (scanline.y() - bounds.y1) * kPageWidth;
+
+			FontCacheEntry::GlyphGray8Scanline::const_iterator span
+				= scanline.begin();
+			for (unsigned i = scanline.num_spans(); i > 0; i--, ++span) {
+				uint8* start = row + span->x - bounds.x1;
+				if (span->len < 0)
+					memset(start, *span->covers, -span->len);
+				else
+					memcpy(start, span->covers, span->len);
+			}
+		}
+	}
+
+	glyph->coverage = coverage;
+	glyph->coverage_bytes_per_row = kPageWidth;
+
+	fShelfX += width;
+	if (height > fShelfHeight)
+		fShelfHeight = height;
+
+	return true;
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef GLYPH_ATLAS_H
+#define GLYPH_ATLAS_H
+
+
+#include <SupportDefs.h>
+
+
+struct GlyphCache;
+
+
+/*!	Keeps the coverage of the anti-aliased glyph bitmaps of a font cache
+	entry packed into a few 8 bit alpha pages. Drawing a glyph from there
+	is a matter of handing its rows to the renderer, instead of decoding
+	its serialized scanlines every time.
+*/
+class GlyphAtlas {
+public:
+								GlyphAtlas();
+								~GlyphAtlas();
+
+			bool				AddGlyph(GlyphCache* glyph);
+
+			size_t				Size() const
+									{ return fSize; }
+
+private:
+			struct Page;
+
+			Page*				fPages;
+			int32				fShelfX;
+			int32				fShelfY;
+			int32				fShelfHeight;
+			size_t				fSize;
+};
+
+
+#endif // GLYPH_ATLAS_H
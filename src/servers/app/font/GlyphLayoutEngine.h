@@ -19,6 +19,7 @@
 #include <Autolock.h>
 #include <Debug.h>
 #include <ObjectList.h>
+#include <StackOrHeapArray.h>
 #include <SupportDefs.h>
 
 #include <ctype.h>
@@ -212,6 +213,11 @@ public:
 									uint32 charCode);
 
 private:
+			template<class GlyphConsumer>
+	static	void				_ReplayRun(GlyphConsumer& consumer,
+									const ShapedRun* run,
+									FontCacheEntry* entry);
+
 	static	const GlyphCache*	_CreateGlyph(
 									FontCacheReference& cacheReference,
 									BObjectList<FontCacheReference, true>& fallbacks,
@@ -289,6 +295,26 @@ GlyphLayoutEngine::LayoutGlyphs(GlyphConsumer& consumer,
 			return false;
 	} // else the entry was already used and is still locked
 
+	// Strings that were laid out before with this entry don't need to be
+	// looked at character by character again.
+	ShapedRunCache* runCache = offsets == NULL ? entry->RunCache() : NULL;
+	shaped_run_key runKey(utf8String, length, maxChars, font.Size(), delta,
+		spacing);
+	if (runCache != NULL && runKey.IsValid()) {
+		BReference<ShapedRun> run(runCache->Lookup(runKey), true);
+		if (run.IsSet()) {
+			_ReplayRun(consumer, run.Get(), entry);
+			return true;
+		}
+	} else
+		runCache = NULL;
+
+	BStackOrHeapArray<shaped_glyph, 64> runGlyphs(
+		runCache != NULL ? runKey.length : 0);
+	if (!runGlyphs.IsValid())
+		runCache = NULL;
+	int32 runGlyphCount = 0;
+
 	consumer.Start();
 
 	double x = 0.0;
@@ -335,6 +361,9 @@ GlyphLayoutEngine::LayoutGlyphs(GlyphConsumer& consumer,
 			consumer.ConsumeEmptyGlyph(index++, charCode, x, y);
 			advanceX = 0;
 			advanceY = 0;
+
+			// it might work out next time
+			runCache = NULL;
 		} else {
 			// get next increment for pen position
 			if (spacing == B_CHAR_SPACING) {
@@ -355,8 +384,19 @@ GlyphLayoutEngine::LayoutGlyphs(GlyphConsumer& consumer,
 					advanceX, advanceY)) {
 				advanceX = 0.0;
 				advanceY = 0.0;
+				runCache = NULL;
 				break;
 			}
+
+			if (runCache != NULL) {
+				shaped_glyph& shaped = runGlyphs[runGlyphCount++];
+				shaped.glyph = glyph;
+				shaped.char_code = charCode;
+				shaped.x = x;
+				shaped.y = y;
+				shaped.advance_x = advanceX;
+				shaped.advance_y = advanceY;
+			}
 		}
 
 		lastCharCode = charCode;
@@ -368,10 +408,36 @@ GlyphLayoutEngine::LayoutGlyphs(GlyphConsumer& consumer,
 	y += advanceY;
 	consumer.Finish(x, y);
 
+	if (runCache != NULL)
+		runCache->Put(runKey, runGlyphs, runGlyphCount, x, y);
+
 	return true;
 }
 
 
+template<class GlyphConsumer>
+inline void
+GlyphLayoutEngine::_ReplayRun(GlyphConsumer& consumer, const ShapedRun* run,
+	FontCacheEntry* entry)
+{
+	consumer.Start();
+
+	const shaped_glyph* glyphs = run->Glyphs();
+	int32 count = run->CountGlyphs();
+	for (int32 index = 0; index < count; index++) {
+		const shaped_glyph& glyph = glyphs[index];
+		if (!consumer.ConsumeGlyph(index, glyph.char_code, glyph.glyph, entry,
+				glyph.x, glyph.y, glyph.advance_x, glyph.advance_y)) {
+			// the layout ends where the glyph was put
+			consumer.Finish(glyph.x, glyph.y);
+			return;
+		}
+	}
+
+	consumer.Finish(run->EndX(), run->EndY());
+}
+
+
 inline const GlyphCache*
 GlyphLayoutEngine::_CreateGlyph(FontCacheReference& cacheReference,
 	BObjectList<FontCacheReference, true>& fallbacks,
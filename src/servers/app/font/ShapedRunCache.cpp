@@ -0,0 +1,219 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "ShapedRunCache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <new>
+
+#include <Autolock.h>
+#include <utf8_functions.h>
+
+
+// Only short strings like labels and menu items are worth remembering,
+// and there are only so many of them visible at once.
+static const int32 kMaxRunLength = 256;
+static const int32 kMaxRunCount = 128;
+
+
+shaped_run_key::shaped_run_key(const char* string, int32 length,
+	int32 maxChars, float size, const escapement_delta* delta, uint8 spacing)
+	:
+	string(string),
+	length(0),
+	max_chars(maxChars),
+	size(size),
+	spacing(spacing),
+	hash(0)
+{
+	if (delta != NULL)
+		this->delta = *delta;
+	else {
+		this->delta.nonspace = 0;
+		this->delta.space = 0;
+	}
+
+	if (string == NULL || length <= 0 || length > kMaxRunLength
+		|| maxChars <= 0) {
+		return;
+	}
+
+	// The layout stops at the first null character, or after the
+	// character reaching the given length - which must not end in
+	// the middle of a character, then.
+	int32 end = strnlen(string, length);
+	if (end == 0)
+		return;
+
+	// Only look at the bytes within the length to find out whether the
+	// last character is complete.
+	int32 last = end - 1;
+	while (last > 0 && IsInsideGlyph(string[last]))
+		last--;
+	if (UTF8NextCharLen(string + last, end - last) != (uint32)(end - last))
+		return;
+
+	// there cannot be more characters than bytes
+	if (max_chars > end)
+		max_chars = INT32_MAX;
+
+	this->length = end;
+
+	size_t hash = end;
+	for (int32 i = 0; i < end; i++)
+		hash = hash * 31 + (uint8)string[i];
+	hash = hash * 31 + max_chars;
+	hash = hash * 31 + spacing;
+	hash ^= (size_t)(int32)(this->delta.nonspace * 64) << 4;
+	hash ^= (size_t)(int32)(this->delta.space * 64) << 12;
+	this->hash = hash;
+}
+
+
+// #pragma mark - ShapedRun
+
+
+ShapedRun::ShapedRun()
+	:
+	fHashLink(NULL),
+	fString(NULL),
+	fGlyphs(NULL)
+{
+}
+
+
+ShapedRun::~ShapedRun()
+{
+	free(fString);
+	free(fGlyphs);
+}
+
+
+/*static*/ ShapedRun*
+ShapedRun::Create(const shaped_run_key& key, const shaped_glyph* glyphs,
+	int32 count, double endX, double endY)
+{
+	ShapedRun* run = new(std::nothrow) ShapedRun;
+	if (run == NULL)
+		return NULL;
+
+	run->fString = (char*)malloc(key.length);
+	run->fGlyphs = (shaped_glyph*)malloc(count * sizeof(shaped_glyph) + 1);
+	if (run->fString == NULL || run->fGlyphs == NULL) {
+		run->ReleaseReference();
+		return NULL;
+	}
+
+	memcpy(run->fString, key.string, key.length);
+	memcpy(run->fGlyphs, glyphs, count * sizeof(shaped_glyph));
+	run->fLength = key.length;
+	run->fMaxChars = key.max_chars;
+	run->fSize = key.size;
+	run->fDelta = key.delta;
+	run->fSpacing = key.spacing;
+	run->fHash = key.hash;
+	run->fCount = count;
+	run->fEndX = endX;
+	run->fEndY = endY;
+
+	return run;
+}
+
+
+bool
+ShapedRun::Matches(const shaped_run_key& key) const
+{
+	return fHash == key.hash && fLength == key.length
+		&& fMaxChars == key.max_chars && fSize == key.size
+		&& fSpacing == key.spacing
+		&& fDelta.nonspace == key.delta.nonspace
+		&& fDelta.space == key.delta.space
+		&& memcmp(fString, key.string, fLength) == 0;
+}
+
+
+// #pragma mark - ShapedRunCache
+
+
+ShapedRunCache::ShapedRunCache()
+	:
+	fLock("shaped run cache"),
+	fCount(0)
+{
+}
+
+
+ShapedRunCache::~ShapedRunCache()
+{
+	fTable.Clear();
+
+	while (ShapedRun* run = fRuns.RemoveHead())
+		run->ReleaseReference();
+}
+
+
+status_t
+ShapedRunCache::Init()
+{
+	return fTable.Init();
+}
+
+
+/*!	Returns the run that was stored for \a key, with a reference acquired
+	for the caller, or \c NULL if there is none.
+*/
+ShapedRun*
+ShapedRunCache::Lookup(const shaped_run_key& key)
+{
+	BAutolock _(fLock);
+
+	ShapedRun* run = fTable.Lookup(key);
+	if (run == NULL)
+		return NULL;
+
+	// move it to the end of the list, it has just been used
+	fRuns.Remove(run);
+	fRuns.Add(run);
+
+	run->AcquireReference();
+	return run;
+}
+
+
+void
+ShapedRunCache::Put(const shaped_run_key& key, const shaped_glyph* glyphs,
+	int32 count, double endX, double endY)
+{
+	ShapedRun* run = ShapedRun::Create(key, glyphs, count, endX, endY);
+	if (run == NULL)
+		return;
+
+	BAutolock _(fLock);
+
+	if (fTable.Lookup(key) != NULL) {
+		// another thread was faster
+		run->ReleaseReference();
+		return;
+	}
+
+	while (fCount >= kMaxRunCount) {
+		ShapedRun* oldest = fRuns.RemoveHead();
+		fTable.Remove(oldest);
+		oldest->ReleaseReference();
+		fCount--;
+	}
+
+	if (fTable.Insert(run) != B_OK) {
+		run->ReleaseReference();
+		return;
+	}
+
+	fRuns.Add(run);
+	fCount++;
+}
+
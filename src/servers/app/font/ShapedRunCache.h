@@ -0,0 +1,147 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef SHAPED_RUN_CACHE_H
+#define SHAPED_RUN_CACHE_H
+
+
+#include <Font.h>
+#include <Locker.h>
+#include <Referenceable.h>
+
+#include <util/DoublyLinkedList.h>
+#include <util/OpenHashTable.h>
+
+
+struct GlyphCache;
+
+
+struct shaped_glyph {
+	const GlyphCache*	glyph;
+	uint32				char_code;
+	double				x;
+	double				y;
+	double				advance_x;
+	double				advance_y;
+};
+
+
+/*!	Identifies a string laid out with a particular font cache entry: the
+	characters that are actually laid out, and everything else that
+	affects the glyph positions.
+*/
+struct shaped_run_key {
+								shaped_run_key(const char* string,
+									int32 length, int32 maxChars,
+									float size, const escapement_delta* delta,
+									uint8 spacing);
+
+			bool				IsValid() const
+									{ return length > 0; }
+
+			const char*			string;
+			int32				length;
+			int32				max_chars;
+			float				size;
+			escapement_delta	delta;
+			uint8				spacing;
+			size_t				hash;
+};
+
+
+class ShapedRun : public BReferenceable,
+	public DoublyLinkedListLinkImpl<ShapedRun> {
+public:
+	static	ShapedRun*			Create(const shaped_run_key& key,
+									const shaped_glyph* glyphs, int32 count,
+									double endX, double endY);
+
+			bool				Matches(const shaped_run_key& key) const;
+			size_t				Hash() const
+									{ return fHash; }
+
+			const shaped_glyph*	Glyphs() const
+									{ return fGlyphs; }
+			int32				CountGlyphs() const
+									{ return fCount; }
+			double				EndX() const
+									{ return fEndX; }
+			double				EndY() const
+									{ return fEndY; }
+
+			ShapedRun*			fHashLink;
+
+private:
+								ShapedRun();
+	virtual						~ShapedRun();
+
+			char*				fString;
+			int32				fLength;
+			int32				fMaxChars;
+			float				fSize;
+			escapement_delta	fDelta;
+			uint8				fSpacing;
+			size_t				fHash;
+
+			shaped_glyph*		fGlyphs;
+			int32				fCount;
+			double				fEndX;
+			double				fEndY;
+};
+
+
+/*!	Remembers where the glyphs of the most recently drawn strings of a
+	font cache entry ended up, so that laying out the same string again
+	does not need to look at its characters and glyphs one by one.
+*/
+class ShapedRunCache {
+public:
+								ShapedRunCache();
+								~ShapedRunCache();
+
+			status_t			Init();
+
+			ShapedRun*			Lookup(const shaped_run_key& key);
+			void				Put(const shaped_run_key& key,
+									const shaped_glyph* glyphs, int32 count,
+									double endX, double endY);
+
+private:
+			struct HashDefinition {
+				typedef shaped_run_key	KeyType;
+				typedef	ShapedRun		ValueType;
+
+				size_t HashKey(const shaped_run_key& key) const
+				{
+					return key.hash;
+				}
+
+				size_t Hash(ShapedRun* value) const
+				{
+					return value->Hash();
+				}
+
+				bool Compare(const shaped_run_key& key, ShapedRun* value) const
+				{
+					return value->Matches(key);
+				}
+
+				ShapedRun*& GetLink(ShapedRun* value) const
+				{
+					return value->fHashLink;
+				}
+			};
+
+			typedef BOpenHashTable<HashDefinition> RunTable;
+			typedef DoublyLinkedList<ShapedRun> RunList;
+
+			BLocker				fLock;
+			RunTable			fTable;
+			RunList				fRuns;
+				// least recently used first
+			int32				fCount;
+};
+
+
+#endif // SHAPED_RUN_CACHE_H
@@ -59,6 +59,33 @@ KeymapMethod InputServer::gKeymapMethod;
 extern "C" _EXPORT BView* instantiate_deskbar_item();
 
 
+static const bigtime_t kEventRingWakeUpTimeout = 10000;
+static const bigtime_t kEventRingFullTimeout = 250000;
+static const bigtime_t kEventRingRetryDelay = 1000;
+
+
+/*!	Returns whether the app_server would get out of sync with the actual
+	state of the keyboard or mouse buttons if it missed \a event.
+*/
+static bool
+is_state_changing_event(const BMessage* event)
+{
+	switch (event->what) {
+		case B_MOUSE_DOWN:
+		case B_MOUSE_UP:
+		case B_KEY_DOWN:
+		case B_KEY_UP:
+		case B_UNMAPPED_KEY_DOWN:
+		case B_UNMAPPED_KEY_UP:
+		case B_MODIFIERS_CHANGED:
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+
 // #pragma mark - InputDeviceListItem
 
 
@@ -155,7 +182,9 @@ InputServer::InputServer()
 	fCursorSem(-1),
 	fAppServerPort(-1),
 	fAppServerTeam(-1),
-	fCursorArea(-1)
+	fCursorArea(-1),
+	fEventRingArea(-1),
+	fEventRing(NULL)
 {
 	CALLED();
 	gInputServer = this;
@@ -394,6 +423,19 @@ InputServer::_AcquireInput(BMessage& message, BMessage& reply)
 		}
 	}
 
+	if (message.FindInt32("event ring area", &area) == B_OK) {
+		fEventRingArea = clone_area("input server event ring",
+			(void**)&fEventRing, B_ANY_ADDRESS, B_READ_AREA | B_WRITE_AREA,
+			area);
+		if (fEventRingArea < B_OK) {
+			fEventRing = NULL;
+		} else if (fEventRing->size != SHARED_EVENT_RING_SIZE) {
+			delete_area(fEventRingArea);
+			fEventRingArea = -1;
+			fEventRing = NULL;
+		}
+	}
+
 	if (message.FindInt32("remote team", &fAppServerTeam) != B_OK)
 		fAppServerTeam = -1;
 
@@ -412,6 +454,11 @@ InputServer::_AcquireInput(BMessage& message, BMessage& reply)
 		reply.AddInt32("cursor semaphore", fCursorSem);
 	}
 
+	if (fEventRing != NULL) {
+		// events are passed through the shared ring
+		reply.AddBool("event ring", true);
+	}
+
 	return B_OK;
 }
 
@@ -428,6 +475,12 @@ InputServer::_ReleaseInput(BMessage* /*message*/)
 		fCursorArea = -1;
 	}
 
+	if (fEventRing != NULL) {
+		fEventRing = NULL;
+		delete_area(fEventRingArea);
+		fEventRingArea = -1;
+	}
+
 	delete_port(fAppServerPort);
 }
 
@@ -1895,6 +1948,28 @@ InputServer::_DispatchEvents(EventList& events)
 	}
 
 	events.MakeEmpty();
+
+	// wake up the app_server only once for the whole batch
+	if (fEventRing != NULL)
+		_WakeUpEventRingReader();
+}
+
+
+/*!	Notifies the app_server about new events in the ring, if it is waiting
+	for them.
+*/
+void
+InputServer::_WakeUpEventRingReader()
+{
+	if (atomic_get_and_set(&fEventRing->reader_waiting, 0) == 0)
+		return;
+
+	if (write_port_etc(fAppServerPort, kEventRingCode, NULL, 0,
+			B_RELATIVE_TIMEOUT, kEventRingWakeUpTimeout) != B_OK) {
+		// Try again with the next events; as long as its port is full, the
+		// app_server won't sleep anyway.
+		atomic_set(&fEventRing->reader_waiting, 1);
+	}
 }
 
 
@@ -1981,6 +2056,30 @@ InputServer::_DispatchEvent(BMessage* event)
 			break;
 	}
 
+	if (fEventRing != NULL) {
+		// Like with the port below, mouse moved and other events that don't
+		// change any state are dropped if the app_server doesn't keep up;
+		// events too large for the ring use the port.
+		status_t status = _WriteToEventRing(event);
+		if (status == B_WOULD_BLOCK && is_state_changing_event(event)) {
+			// Losing a key or mouse button up event would leave it stuck
+			// in the app_server, so give it some time to make room.
+			bigtime_t timeout = system_time() + kEventRingFullTimeout;
+			do {
+				_WakeUpEventRingReader();
+				snooze(kEventRingRetryDelay);
+				status = _WriteToEventRing(event);
+			} while (status == B_WOULD_BLOCK && system_time() < timeout);
+
+			// If it still didn't, we're out of options and use the port,
+			// even though the event might then overtake the ones before it.
+		} else if (status == B_WOULD_BLOCK)
+			return status;
+
+		if (status != B_BUFFER_OVERFLOW && status != B_WOULD_BLOCK)
+			return status;
+	}
+
 	BMessenger reply;
 	BMessage::Private messagePrivate(event);
 	return messagePrivate.SendMessage(fAppServerPort, fAppServerTeam, 0, 0,
@@ -1988,6 +2087,37 @@ InputServer::_DispatchEvent(BMessage* event)
 }
 
 
+/*!	Flattens \a event into the event ring shared with the app_server.
+	Returns \c B_BUFFER_OVERFLOW if the event is too large for the ring, and
+	\c B_WOULD_BLOCK if there currently isn't enough room left in it.
+*/
+status_t
+InputServer::_WriteToEventRing(BMessage* event)
+{
+	ssize_t messageSize = event->FlattenedSize();
+	if (messageSize < 0)
+		return messageSize;
+
+	uint32 entrySize = shared_event_ring_entry_size(messageSize);
+	if (entrySize > SHARED_EVENT_RING_SIZE / 2)
+		return B_BUFFER_OVERFLOW;
+
+	uint32 nextWriteOffset;
+	uint8* buffer = shared_event_ring_begin_write(fEventRing, messageSize,
+		&nextWriteOffset);
+	if (buffer == NULL)
+		return B_WOULD_BLOCK;
+
+	status_t status = event->Flatten((char*)buffer, messageSize);
+	if (status != B_OK)
+		return status;
+
+	// publish the entry
+	shared_event_ring_end_write(fEventRing, nextWriteOffset);
+	return B_OK;
+}
+
+
 //	#pragma mark -
 
 
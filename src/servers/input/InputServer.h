@@ -28,6 +28,7 @@
 #include <SupportDefs.h>
 
 #include <shared_cursor_area.h>
+#include <shared_event_ring.h>
 
 #include "AddOnManager.h"
 #include "KeyboardSettings.h"
@@ -209,6 +210,8 @@ class InputServer : public BApplication {
 		void _FilterEvent(BInputServerFilter* filter, EventList& events,
 					int32& index, int32& count);
 		status_t _DispatchEvent(BMessage* event);
+		status_t _WriteToEventRing(BMessage* event);
+		void _WakeUpEventRingReader();
 
 		status_t _AcquireInput(BMessage& message, BMessage& reply);
 		void _ReleaseInput(BMessage* message);
@@ -252,6 +255,8 @@ class InputServer : public BApplication {
 		team_id			fAppServerTeam;
 		area_id			fCursorArea;
 		shared_cursor*	fCursorBuffer;
+		area_id			fEventRingArea;
+		shared_event_ring* fEventRing;
 };
 
 extern InputServer* gInputServer;
@@ -220,7 +220,20 @@ CommitTransactionHandler::HandleRequest(
 		throw Exception(B_TRANSACTION_BAD_REQUEST);
 	}
 
-	_ApplyChanges();
+	// if requested, drop packages that would just be replaced by identical
+	// ones
+	bool nothingToDo = false;
+	if (!fFirstBootProcessing && transaction.SkipUnchangedPackages()) {
+		_SkipUnchangedPackages();
+		nothingToDo = fPackagesToActivate.IsEmpty()
+			&& fPackagesToDeactivate.empty();
+	}
+
+	if (nothingToDo) {
+		INFORM("CommitTransactionHandler::HandleRequest(): all packages "
+			"unchanged, nothing to do\n");
+	} else
+		_ApplyChanges();
 
 	// Clean up the unused empty transaction directory for first boot
 	// processing, since it's usually an internal to package_daemon
@@ -410,6 +423,63 @@ CommitTransactionHandler::_ReadPackagesToActivate(
 }
 
 
+/*!	Removes the packages from the transaction that would replace an active
+	package with an identical package file, as well as the replaced packages.
+	Re-activating such a package makes packagefs reload it, re-extracts its
+	writable files, and re-runs its scripts. That is what a re-install meant
+	to repair an installation wants, so this is only done when the client
+	asked for it via BActivationTransaction::SetSkipUnchangedPackages().
+*/
+void
+CommitTransactionHandler::_SkipUnchangedPackages()
+{
+	if (fPackagesToActivate.IsEmpty() || fPackagesToDeactivate.empty())
+		return;
+
+	BDirectory packagesDirectory;
+	status_t error
+		= packagesDirectory.SetTo(&fVolume->PackagesDirectoryRef());
+	if (error != B_OK)
+		return;
+
+	for (int32 i = fPackagesToActivate.CountItems() - 1; i >= 0; i--) {
+		Package* package = fPackagesToActivate.ItemAt(i);
+		if (fPackagesAlreadyAdded.find(package)
+				!= fPackagesAlreadyAdded.end()) {
+			continue;
+		}
+
+		Package* oldPackage = fVolumeState->FindPackage(package->FileName());
+		if (oldPackage == NULL || !oldPackage->IsActive()
+			|| fPackagesToDeactivate.find(oldPackage)
+				== fPackagesToDeactivate.end()
+			|| fPackagesAlreadyRemoved.find(oldPackage)
+				!= fPackagesAlreadyRemoved.end()) {
+			continue;
+		}
+
+		BEntry entry;
+		NotOwningEntryRef entryRef(fTransactionDirectoryRef,
+			package->FileName());
+		if (entry.SetTo(&entryRef) != B_OK
+			|| _AssertEntriesAreEqual(entry, &packagesDirectory) != B_OK) {
+			continue;
+		}
+
+		INFORM("CommitTransactionHandler::_SkipUnchangedPackages(): "
+			"package %s is unchanged\n", package->FileName().String());
+
+		// The entry would otherwise prevent the transaction directory from
+		// being removed later. We ignore failure to Remove() here, though.
+		entry.Remove();
+
+		fPackagesToActivate.RemoveItemAt(i);
+		fPackagesToDeactivate.erase(oldPackage);
+		delete package;
+	}
+}
+
+
 void
 CommitTransactionHandler::_ApplyChanges()
 {
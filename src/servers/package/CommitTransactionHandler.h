@@ -71,6 +71,7 @@ private:
 									const BActivationTransaction& transaction);
 			void				_ReadPackagesToActivate(
 									const BActivationTransaction& transaction);
+			void				_SkipUnchangedPackages();
 			void				_ApplyChanges();
 			void				_CreateOldStateDirectory();
 			void				_RemovePackagesToDeactivate();
@@ -309,6 +309,13 @@ Stream::ReadAt(off_t pos, uint8* buffer, size_t* _length)
 	if (pos + (off_t)length > data.Size())
 		length = data.Size() - pos;
 
+	if (Flags() & INODE_INLINE_DATA) {
+		// the data is in the inode
+		memcpy(buffer, inline_data + pos, length);
+		*_length = length;
+		return B_OK;
+	}
+
 	block_run run;
 	off_t offset;
 	if (FindBlockRun(pos, run, offset) < B_OK) {
@@ -459,6 +466,10 @@ bfs_inode::InitCheck(Volume* volume) const
 		|| attributes.Start() > (1L << volume->AllocationGroupShift()))
 		return B_BAD_DATA;
 
+	if ((Flags() & INODE_INLINE_DATA) != 0
+		&& data.Size() > (off_t)INODE_INLINE_DATA_LENGTH)
+		return B_BAD_DATA;
+
 	// TODO: Add some tests to check the integrity of the other stuff here,
 	// especially for the data_stream!
 
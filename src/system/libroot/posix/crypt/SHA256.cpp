@@ -11,6 +11,14 @@
 
 #include <ByteOrder.h>
 
+#if !defined(_KERNEL_MODE) \
+	&& (defined(__x86_64__) || defined(__i386__)) \
+	&& (__GNUC__ >= 5 || defined(__clang__))
+#	define HAVE_SHA_EXTENSIONS
+#	include <cpuid.h>
+#	include <immintrin.h>
+#endif
+
 
 namespace BPrivate {
 
@@ -40,11 +48,107 @@ rotate_right(uint32 value, int bits)
 }
 
 
+#ifdef HAVE_SHA_EXTENSIONS
+
+
+static bool
+has_sha_extensions()
+{
+	static int sHasSHAExtensions = -1;
+	if (sHasSHAExtensions < 0) {
+		unsigned int eax, ebx, ecx, edx;
+		bool hasSHA = false;
+		if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) != 0
+			&& (ecx & bit_SSSE3) != 0 && (ecx & bit_SSE4_1) != 0
+			&& __get_cpuid_max(0, NULL) >= 7) {
+			__cpuid_count(7, 0, eax, ebx, ecx, edx);
+			hasSHA = (ebx & (1 << 29)) != 0;
+		}
+		sHasSHAExtensions = hasSHA ? 1 : 0;
+	}
+
+	return sHasSHAExtensions != 0;
+}
+
+
+/*!	Processes \a count chunks of (big-endian) input data using the x86 SHA
+	extensions. \a hash is the hash state as used by the generic code.
+*/
+__attribute__((target("sha,sse4.1")))
+static void
+process_chunks_sha_extensions(uint32* hash, const uint8* data, size_t count)
+{
+	const __m128i byteSwapMask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+		0x0405060700010203ULL);
+
+	// The instructions want the state as ABEF and CDGH.
+	__m128i temp = _mm_shuffle_epi32(
+		_mm_loadu_si128((const __m128i*)&hash[0]), 0xb1);		// CDAB
+	__m128i state1 = _mm_shuffle_epi32(
+		_mm_loadu_si128((const __m128i*)&hash[4]), 0x1b);		// EFGH
+	__m128i state0 = _mm_alignr_epi8(temp, state1, 8);			// ABEF
+	state1 = _mm_blend_epi16(state1, temp, 0xf0);				// CDGH
+
+	for (; count > 0; count--, data += kChunkSize) {
+		__m128i savedState0 = state0;
+		__m128i savedState1 = state1;
+
+		// message[i % 4] holds the schedule words 4 * i ... 4 * i + 3
+		__m128i message[4];
+		for (int i = 0; i < 4; i++) {
+			message[i] = _mm_shuffle_epi8(
+				_mm_loadu_si128((const __m128i*)(data + 16 * i)),
+				byteSwapMask);
+		}
+
+		for (int i = 0; i < 16; i++) {
+			if (i >= 4) {
+				__m128i words = _mm_sha256msg1_epu32(message[i % 4],
+					message[(i + 1) % 4]);
+				words = _mm_add_epi32(words, _mm_alignr_epi8(
+					message[(i + 3) % 4], message[(i + 2) % 4], 4));
+				message[i % 4] = _mm_sha256msg2_epu32(words,
+					message[(i + 3) % 4]);
+			}
+
+			__m128i words = _mm_add_epi32(message[i % 4],
+				_mm_loadu_si128((const __m128i*)&kRounds[4 * i]));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, words);
+			words = _mm_shuffle_epi32(words, 0x0e);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, words);
+		}
+
+		state0 = _mm_add_epi32(state0, savedState0);
+		state1 = _mm_add_epi32(state1, savedState1);
+	}
+
+	temp = _mm_shuffle_epi32(state0, 0x1b);						// FEBA
+	state1 = _mm_shuffle_epi32(state1, 0xb1);					// DCHG
+	state0 = _mm_blend_epi16(temp, state1, 0xf0);				// DCBA
+	state1 = _mm_alignr_epi8(state1, temp, 8);					// ABEF
+
+	_mm_storeu_si128((__m128i*)&hash[0], state0);
+	_mm_storeu_si128((__m128i*)&hash[4], state1);
+}
+
+
+#endif	// HAVE_SHA_EXTENSIONS
+
+
 //	#pragma mark -
 
 
-SHA256::SHA256()
+/*!	If \a allowAcceleration is \c false, the generic implementation is used
+	even when the CPU supports the SHA extensions, e.g. for comparing the two.
+*/
+SHA256::SHA256(bool allowAcceleration)
 {
+#ifdef HAVE_SHA_EXTENSIONS
+	fAccelerated = allowAcceleration && has_sha_extensions();
+#else
+	fAccelerated = false;
+#endif
+
 	Init();
 }
 
@@ -71,6 +175,16 @@ SHA256::Update(const void* _buffer, size_t size)
 	const uint8* buffer = (const uint8*)_buffer;
 	fMessageSize += size;
 
+#ifdef HAVE_SHA_EXTENSIONS
+	// process whole chunks directly from the caller's buffer
+	if (fBytesInBuffer == 0 && size >= kChunkSize && fAccelerated) {
+		size_t count = size / kChunkSize;
+		process_chunks_sha_extensions(fHash, buffer, count);
+		buffer += count * kChunkSize;
+		size -= count * kChunkSize;
+	}
+#endif
+
 	while (fBytesInBuffer + size >= kChunkSize) {
 		size_t toCopy = kChunkSize - fBytesInBuffer;
 		memcpy((uint8*)fBuffer + fBytesInBuffer, buffer, toCopy);
@@ -136,6 +250,13 @@ SHA256::Digest()
 void
 SHA256::_ProcessChunk()
 {
+#ifdef HAVE_SHA_EXTENSIONS
+	if (fAccelerated) {
+		process_chunks_sha_extensions(fHash, (const uint8*)fBuffer, 1);
+		return;
+	}
+#endif
+
 	// convert endianess -- the data are supposed to be a stream of
 	// 32 bit big-endian integers
 	#if B_HOST_IS_LENDIAN
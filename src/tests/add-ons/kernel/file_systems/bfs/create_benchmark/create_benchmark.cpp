@@ -0,0 +1,193 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * This file may be used under the terms of the MIT License.
+ */
+
+
+/*!	Measures how many small files per second can be created by one, and by
+	several concurrent writer threads. Every thread creates its files in a
+	directory of its own, so that the threads only compete for the journal,
+	not for the same B+tree.
+*/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+
+static const char* kUsage =
+	"Usage: %s [-n <files>] [-s <size>] [-t <threads>] <directory>\n"
+	"\n"
+	"Creates <files> files of <size> bytes with every thread, once with a\n"
+	"single thread, and once with <threads> threads (default: 8). The files\n"
+	"are created in, and removed from, a new subdirectory of <directory>.\n";
+
+static int sFileCount = 1000;
+static size_t sFileSize = 512;
+
+
+struct writer {
+	pthread_t	thread;
+	char		directory[PATH_MAX];
+	int			error;
+};
+
+
+static double
+current_time()
+{
+	struct timeval time;
+	gettimeofday(&time, NULL);
+	return time.tv_sec + time.tv_usec / 1000000.0;
+}
+
+
+static void*
+create_files(void* data)
+{
+	writer* self = (writer*)data;
+	self->error = 0;
+
+	char* buffer = (char*)malloc(sFileSize);
+	if (buffer == NULL) {
+		self->error = ENOMEM;
+		return NULL;
+	}
+	memset(buffer, 'x', sFileSize);
+
+	for (int i = 0; i < sFileCount; i++) {
+		char path[PATH_MAX];
+		snprintf(path, sizeof(path), "%s/file%d", self->directory, i);
+
+		int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0) {
+			self->error = errno;
+			break;
+		}
+
+		if (write(fd, buffer, sFileSize) != (ssize_t)sFileSize)
+			self->error = errno != 0 ? errno : EIO;
+
+		close(fd);
+		if (self->error != 0)
+			break;
+	}
+
+	free(buffer);
+	return NULL;
+}
+
+
+static void
+remove_files(const char* directory)
+{
+	for (int i = 0; i < sFileCount; i++) {
+		char path[PATH_MAX];
+		snprintf(path, sizeof(path), "%s/file%d", directory, i);
+		unlink(path);
+	}
+	rmdir(directory);
+}
+
+
+static bool
+run(const char* baseDirectory, int threadCount)
+{
+	writer* writers = new writer[threadCount];
+
+	for (int i = 0; i < threadCount; i++) {
+		snprintf(writers[i].directory, sizeof(writers[i].directory),
+			"%s/writer%d", baseDirectory, i);
+		if (mkdir(writers[i].directory, 0755) != 0) {
+			fprintf(stderr, "Could not create \"%s\": %s\n",
+				writers[i].directory, strerror(errno));
+			exit(1);
+		}
+	}
+	sync();
+
+	double start = current_time();
+
+	for (int i = 0; i < threadCount; i++)
+		pthread_create(&writers[i].thread, NULL, &create_files, &writers[i]);
+
+	bool success = true;
+	for (int i = 0; i < threadCount; i++) {
+		pthread_join(writers[i].thread, NULL);
+		if (writers[i].error != 0) {
+			fprintf(stderr, "Writer %d failed: %s\n", i,
+				strerror(writers[i].error));
+			success = false;
+		}
+	}
+
+	// the files are only created once they are on disk
+	sync();
+
+	double elapsed = current_time() - start;
+	int files = threadCount * sFileCount;
+	printf("%2d thread(s): %6d files in %7.3f s, %9.1f files/s\n", threadCount,
+		files, elapsed, files / elapsed);
+
+	for (int i = 0; i < threadCount; i++)
+		remove_files(writers[i].directory);
+	sync();
+
+	delete[] writers;
+	return success;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int threadCount = 8;
+
+	int option;
+	while ((option = getopt(argc, argv, "n:s:t:h")) != -1) {
+		switch (option) {
+			case 'n':
+				sFileCount = atoi(optarg);
+				break;
+			case 's':
+				sFileSize = strtoul(optarg, NULL, 0);
+				break;
+			case 't':
+				threadCount = atoi(optarg);
+				break;
+			default:
+				fprintf(stderr, kUsage, argv[0]);
+				return 1;
+		}
+	}
+
+	if (optind + 1 != argc || sFileCount <= 0 || threadCount <= 0) {
+		fprintf(stderr, kUsage, argv[0]);
+		return 1;
+	}
+
+	char baseDirectory[PATH_MAX];
+	snprintf(baseDirectory, sizeof(baseDirectory), "%s/create_benchmark.%d",
+		argv[optind], (int)getpid());
+	if (mkdir(baseDirectory, 0755) != 0) {
+		fprintf(stderr, "Could not create \"%s\": %s\n", baseDirectory,
+			strerror(errno));
+		return 1;
+	}
+
+	bool success = run(baseDirectory, 1);
+	if (success && threadCount > 1)
+		success = run(baseDirectory, threadCount);
+
+	rmdir(baseDirectory);
+	return success ? 0 : 1;
+}
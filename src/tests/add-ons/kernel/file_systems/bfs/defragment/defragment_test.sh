@@ -0,0 +1,88 @@
+#!/bin/sh
+
+# Creates a BFS image with a fragmented file using bfs_shell, defragments it,
+# and verifies that checkfs is happy, the file has been moved into a single
+# block run, and that its contents did not change.
+#
+# Usage: defragment_test.sh [<bfs_shell>]
+#
+# "jam -q bfs_defragment_test" builds bfs_shell for the build platform and
+# runs this script with it.
+
+BFS_SHELL=${1:-bfs_shell}
+
+TEST_DIR=$(mktemp -d /tmp/bfs_defragment_test.XXXXXX) || exit 1
+trap 'rm -rf "$TEST_DIR"' EXIT
+
+IMAGE="$TEST_DIR/image"
+CHUNK_SIZE=131072
+VOLUME_SIZE=8388608
+
+fail()
+{
+	echo "FAILED: $1"
+	[ -f "$TEST_DIR/output" ] && cat "$TEST_DIR/output"
+	exit 1
+}
+
+run_shell() # commands are read from stdin
+{
+	"$BFS_SHELL" "$IMAGE" > "$TEST_DIR/output" 2>&1
+}
+
+# create the image
+dd if=/dev/zero of="$IMAGE" bs=$VOLUME_SIZE count=1 2>/dev/null
+"$BFS_SHELL" --initialize "$IMAGE" "defragment test" > /dev/null \
+	|| fail "could not initialize image"
+
+dd if=/dev/urandom of="$TEST_DIR/chunk" bs=$CHUNK_SIZE count=1 2>/dev/null
+dd if=/dev/urandom of="$TEST_DIR/file" bs=$CHUNK_SIZE count=5 2>/dev/null
+
+# fill the volume with chunk sized files, and remove a few of them that are
+# not next to each other, so that a larger file has to be split over the
+# holes
+chunks=$((VOLUME_SIZE / CHUNK_SIZE))
+(
+	i=0
+	while [ $i -lt $chunks ]; do
+		echo "cp :$TEST_DIR/chunk /myfs/chunk$i"
+		i=$((i + 1))
+	done
+	for i in 4 8 12 16 20 24; do
+		echo "rm /myfs/chunk$i"
+	done
+	echo "sync"
+	echo "cp :$TEST_DIR/file /myfs/file"
+	echo "sync"
+) | run_shell
+
+# remove the other files again, so that there is room to move the file into
+(
+	i=0
+	while [ $i -lt $chunks ]; do
+		echo "rm /myfs/chunk$i"
+		i=$((i + 1))
+	done
+	echo "sync"
+	echo "defragfs"
+	echo "checkfs"
+	echo "defragfs"
+	echo "cp /myfs/file :$TEST_DIR/file.out"
+) | run_shell
+
+# the first defragfs run must have moved the file, the second one must not
+# have found anything to do anymore
+grep -q " 1 fragmented files" "$TEST_DIR/output" \
+	|| fail "the file was not fragmented"
+grep -q " 1 files relocated" "$TEST_DIR/output" \
+	|| fail "the file was not relocated"
+[ $(grep -c "0 fragmented files" "$TEST_DIR/output") -eq 1 ] \
+	|| fail "the file is still fragmented after defragmenting"
+grep -q "0 blocks not allocated" "$TEST_DIR/output" \
+	&& grep -q "0 blocks already set" "$TEST_DIR/output" \
+	&& grep -q "0 blocks could be freed" "$TEST_DIR/output" \
+	|| fail "checkfs found errors"
+cmp -s "$TEST_DIR/file" "$TEST_DIR/file.out" \
+	|| fail "the file contents changed"
+
+echo PASSED
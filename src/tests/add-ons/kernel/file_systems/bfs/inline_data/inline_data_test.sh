@@ -0,0 +1,98 @@
+#!/bin/sh
+
+# Creates a BFS image with inline data using bfs_shell, and copies files to
+# it that fit into their inode, that don't, and that change between the two.
+# Verifies that checkfs is happy, that only the larger files got a data
+# stream, and that the contents survive remounting.
+#
+# Usage: inline_data_test.sh [<bfs_shell>]
+#
+# "jam -q bfs_inline_data_test" builds bfs_shell for the build platform and
+# runs this script with it.
+
+BFS_SHELL=${1:-bfs_shell}
+
+TEST_DIR=$(mktemp -d /tmp/bfs_inline_data_test.XXXXXX) || exit 1
+trap 'rm -rf "$TEST_DIR"' EXIT
+
+IMAGE="$TEST_DIR/image"
+VOLUME_SIZE=8388608
+
+# the size of a data_stream, minus its size field
+INLINE_SIZE=136
+
+fail()
+{
+	echo "FAILED: $1"
+	[ -f "$TEST_DIR/output" ] && cat "$TEST_DIR/output"
+	exit 1
+}
+
+run_shell() # commands are read from stdin
+{
+	"$BFS_SHELL" "$IMAGE" > "$TEST_DIR/output" 2>&1
+}
+
+direct_runs()
+{
+	sed -n 's/^[[:space:]]*direct block runs[[:space:]]*\([0-9]*\).*/\1/p' \
+		"$TEST_DIR/output"
+}
+
+# create the image
+dd if=/dev/zero of="$IMAGE" bs=$VOLUME_SIZE count=1 2>/dev/null
+"$BFS_SHELL" --initialize "$IMAGE" "inline data test" "inline_data" \
+	> /dev/null || fail "could not initialize image"
+
+for size in 1 100 $INLINE_SIZE $((INLINE_SIZE + 1)) 5000; do
+	dd if=/dev/urandom of="$TEST_DIR/file$size" bs=$size count=1 2>/dev/null
+done
+
+echo "checkfs" | run_shell
+runsBefore=$(direct_runs)
+
+(
+	echo "touch /myfs/empty"
+	for size in 1 100 $INLINE_SIZE $((INLINE_SIZE + 1)) 5000; do
+		echo "cp :$TEST_DIR/file$size /myfs/file$size"
+	done
+	# an inline file that needs a stream, and one that no longer does
+	echo "cp :$TEST_DIR/file100 /myfs/grown"
+	echo "cp :$TEST_DIR/file5000 /myfs/grown"
+	echo "cp :$TEST_DIR/file5000 /myfs/shrunk"
+	echo "cp :$TEST_DIR/file100 /myfs/shrunk"
+	echo "sync"
+) | run_shell
+
+(
+	echo "checkfs"
+	for size in 1 100 $INLINE_SIZE $((INLINE_SIZE + 1)) 5000; do
+		echo "cp /myfs/file$size :$TEST_DIR/file$size.out"
+	done
+	echo "cp /myfs/empty :$TEST_DIR/empty.out"
+	echo "cp /myfs/grown :$TEST_DIR/grown.out"
+	echo "cp /myfs/shrunk :$TEST_DIR/shrunk.out"
+) | run_shell
+
+grep -q "0 blocks not allocated" "$TEST_DIR/output" \
+	&& grep -q "0 blocks already set" "$TEST_DIR/output" \
+	&& grep -q "0 blocks could be freed" "$TEST_DIR/output" \
+	|| fail "checkfs found errors"
+
+# only file137, file5000, and grown may have a data stream
+[ "$(direct_runs)" -eq $((runsBefore + 3)) ] \
+	|| fail "expected $((runsBefore + 3)) direct block runs, found \
+$(direct_runs)"
+
+for size in 1 100 $INLINE_SIZE $((INLINE_SIZE + 1)) 5000; do
+	cmp -s "$TEST_DIR/file$size" "$TEST_DIR/file$size.out" \
+		|| fail "the contents of file$size changed"
+done
+[ -f "$TEST_DIR/empty.out" ] && [ ! -s "$TEST_DIR/empty.out" ] \
+	|| fail "the empty file is not empty"
+cmp -s "$TEST_DIR/file5000" "$TEST_DIR/grown.out" \
+	|| fail "the contents of the grown file changed"
+cmp -s "$TEST_DIR/file100" "$TEST_DIR/shrunk.out" \
+	|| fail "the contents of the shrunk file changed"
+
+echo PASSED
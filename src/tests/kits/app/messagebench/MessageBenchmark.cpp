@@ -0,0 +1,258 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures the throughput and the number of allocations of the basic
+	BMessage operations for a set of typical messages.
+*/
+
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <OS.h>
+
+#include <FlattenedMessage.h>
+#include <MessagePrivate.h>
+
+#include "MessageShapes.h"
+
+
+#ifdef __linux__
+// Count allocations by interposing the allocator; glibc exports its own
+// implementation under these names.
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* address, size_t size);
+
+static int64 sAllocationCount = 0;
+
+
+extern "C" void*
+malloc(size_t size)
+{
+	sAllocationCount++;
+	return __libc_malloc(size);
+}
+
+
+extern "C" void*
+calloc(size_t count, size_t size)
+{
+	sAllocationCount++;
+	return __libc_calloc(count, size);
+}
+
+
+extern "C" void*
+realloc(void* address, size_t size)
+{
+	sAllocationCount++;
+	return __libc_realloc(address, size);
+}
+
+#	define HAVE_ALLOCATION_COUNT
+#endif
+
+
+static const int32 kDefaultIterations = 100000;
+
+static int32 sIterations = kDefaultIterations;
+static const MessageShape* sShape;
+static BMessage sMessage;
+static char* sFlatBuffer;
+static ssize_t sFlatSize;
+static volatile int32 sSink;
+
+
+static void
+build_message()
+{
+	BMessage message;
+	sShape->build(message, 0);
+}
+
+
+static void
+rebuild_message()
+{
+	static BMessage message;
+	BMessage::Private(message).Reset();
+	sShape->build(message, 0);
+}
+
+
+static void
+flatten_message()
+{
+	sMessage.Flatten(sFlatBuffer, sFlatSize);
+}
+
+
+static void
+unflatten_message()
+{
+	BMessage message;
+	message.Unflatten(sFlatBuffer);
+}
+
+
+static void
+find_data()
+{
+	const void* data;
+	ssize_t size;
+	if (sMessage.FindData(sShape->lookupName, sShape->lookupType, 0, &data,
+			&size) == B_OK) {
+		sSink += size;
+	}
+}
+
+
+static void
+unflatten_and_find_data()
+{
+	BMessage message;
+	if (message.Unflatten(sFlatBuffer) != B_OK)
+		return;
+
+	const void* data;
+	ssize_t size;
+	if (message.FindData(sShape->lookupName, sShape->lookupType, 0, &data,
+			&size) == B_OK) {
+		sSink += size;
+	}
+}
+
+
+static void
+view_and_find_data()
+{
+	BPrivate::BFlattenedMessage message(sFlatBuffer, sFlatSize);
+	const void* data;
+	ssize_t size;
+	if (message.FindData(sShape->lookupName, sShape->lookupType, 0, &data,
+			&size) == B_OK) {
+		sSink += size;
+	}
+}
+
+
+struct Operation {
+	const char*	name;
+	void		(*function)();
+};
+
+static const Operation kOperations[] = {
+	{ "build", &build_message },
+	{ "build (reset)", &rebuild_message },
+	{ "flatten", &flatten_message },
+	{ "unflatten", &unflatten_message },
+	{ "find", &find_data },
+	{ "unflatten + find", &unflatten_and_find_data },
+	{ "flat view + find", &view_and_find_data },
+};
+
+
+static void
+run_operation(const Operation& operation)
+{
+	// warm up, so that caches and reused buffers are in place
+	for (int32 i = 0; i < 100; i++)
+		operation.function();
+
+#ifdef HAVE_ALLOCATION_COUNT
+	int64 allocations = sAllocationCount;
+#endif
+	bigtime_t startTime = system_time();
+
+	for (int32 i = 0; i < sIterations; i++)
+		operation.function();
+
+	bigtime_t time = system_time() - startTime;
+	if (time <= 0)
+		time = 1;
+
+	printf("  %-20s %12.0f ops/s", operation.name,
+		sIterations * 1000000.0 / time);
+#ifdef HAVE_ALLOCATION_COUNT
+	printf("  %6.2f allocs/op",
+		(double)(sAllocationCount - allocations) / sIterations);
+#endif
+	printf("\n");
+}
+
+
+static void
+print_usage_and_exit(bool error)
+{
+	fprintf(error ? stderr : stdout,
+		"Usage: message_benchmark [ -i <iterations> ] [ <shape> ... ]\n"
+		"Runs the benchmark for the given message shapes, or all of them.\n"
+		"Shapes:\n");
+	for (int32 i = 0; i < kMessageShapeCount; i++)
+		fprintf(error ? stderr : stdout, "  \"%s\"\n", kMessageShapes[i].name);
+
+	exit(error ? 1 : 0);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int option;
+	while ((option = getopt(argc, argv, "hi:")) != -1) {
+		switch (option) {
+			case 'i':
+				sIterations = atol(optarg);
+				if (sIterations <= 0)
+					print_usage_and_exit(true);
+				break;
+			case 'h':
+				print_usage_and_exit(false);
+				break;
+			default:
+				print_usage_and_exit(true);
+				break;
+		}
+	}
+
+	for (int32 i = 0; i < kMessageShapeCount; i++) {
+		sShape = &kMessageShapes[i];
+
+		if (optind < argc) {
+			bool selected = false;
+			for (int32 j = optind; j < argc; j++) {
+				if (strcmp(argv[j], sShape->name) == 0)
+					selected = true;
+			}
+			if (!selected)
+				continue;
+		}
+
+		sMessage.MakeEmpty();
+		sShape->build(sMessage, 0);
+		sFlatSize = sMessage.FlattenedSize();
+		sFlatBuffer = (char*)malloc(sFlatSize);
+		if (sFlatBuffer == NULL) {
+			fprintf(stderr, "message_benchmark: out of memory\n");
+			return 1;
+		}
+		sMessage.Flatten(sFlatBuffer, sFlatSize);
+
+		printf("%s (%" B_PRIdSSIZE " bytes flattened)\n", sShape->name,
+			sFlatSize);
+		for (size_t j = 0; j < sizeof(kOperations) / sizeof(kOperations[0]);
+				j++) {
+			run_operation(kOperations[j]);
+		}
+
+		free(sFlatBuffer);
+	}
+
+	return 0;
+}
@@ -0,0 +1,456 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Checks BMessage flattening against a corpus of flattened messages: the
+	built-in message shapes, and any files given on the command line (for
+	example messages that once broke something). Every corpus entry has to
+	survive a round trip, and BFlattenedMessage has to agree with BMessage on
+	its contents. Then deterministic mutations of each entry are fed to both
+	unflattening paths, which must reject or safely accept them.
+*/
+
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <DataIO.h>
+
+#include <FlattenedMessage.h>
+#include <MessagePrivate.h>
+
+#include "MessageShapes.h"
+
+
+static const int32 kSequencesPerShape = 4;
+static const int32 kDefaultMutations = 2000;
+
+
+struct CorpusEntry {
+	char*		data;
+	ssize_t		size;
+	char		name[64];
+};
+
+
+static int32 sFailures = 0;
+static uint32 sRandomState = 0x2545f491;
+
+
+static uint32
+next_random()
+{
+	// xorshift32, to get the same mutations everywhere
+	sRandomState ^= sRandomState << 13;
+	sRandomState ^= sRandomState >> 17;
+	sRandomState ^= sRandomState << 5;
+	return sRandomState;
+}
+
+
+static void
+fail(const CorpusEntry& entry, const char* what)
+{
+	fprintf(stderr, "FAILED: %s: %s\n", entry.name, what);
+	sFailures++;
+}
+
+
+static bool
+flatten(const BMessage& message, char*& _data, ssize_t& _size)
+{
+	_size = message.FlattenedSize();
+	_data = (char*)malloc(_size);
+	return _data != NULL && message.Flatten(_data, _size) == B_OK;
+}
+
+
+/*!	Looks up every item of \a message in \a view, and compares the results.
+*/
+static bool
+view_matches_message(const BPrivate::BFlattenedMessage& view,
+	const BMessage& message)
+{
+	if (view.What() != message.what
+		|| view.CountFields() != message.CountNames(B_ANY_TYPE)) {
+		return false;
+	}
+
+	char* name;
+	type_code type;
+	int32 count;
+	for (int32 i = 0; message.GetInfo(B_ANY_TYPE, i, &name, &type, &count)
+			== B_OK; i++) {
+		type_code viewType;
+		int32 viewCount;
+		if (view.GetInfo(name, &viewType, &viewCount) != B_OK
+			|| viewType != type || viewCount != count) {
+			return false;
+		}
+
+		for (int32 j = 0; j < count; j++) {
+			const void* data;
+			ssize_t size;
+			const void* viewData;
+			ssize_t viewSize;
+			if (message.FindData(name, type, j, &data, &size) != B_OK
+				|| view.FindData(name, type, j, &viewData, &viewSize) != B_OK
+				|| size != viewSize || memcmp(data, viewData, size) != 0) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+/*!	Accesses everything \a message claims to contain; this must not crash,
+	however broken the message was.
+*/
+static void
+touch_message(const BMessage& message)
+{
+	char* name;
+	type_code type;
+	int32 count;
+	for (int32 i = 0; message.GetInfo(B_ANY_TYPE, i, &name, &type, &count)
+			== B_OK; i++) {
+		for (int32 j = 0; j < count; j++) {
+			const void* data;
+			ssize_t size;
+			if (message.FindData(name, type, j, &data, &size) == B_OK
+				&& size > 0) {
+				volatile char first = ((const char*)data)[0];
+				volatile char last = ((const char*)data)[size - 1];
+				(void)first;
+				(void)last;
+			}
+		}
+	}
+}
+
+
+/*!	Like touch_message(), but also checks that everything found lies within
+	the buffer.
+*/
+static bool
+touch_view(const char* buffer, ssize_t bufferSize, const BMessage& names)
+{
+	BPrivate::BFlattenedMessage view(buffer, bufferSize);
+	if (view.InitCheck() != B_OK)
+		return true;
+
+	char* name;
+	type_code type;
+	int32 count;
+	for (int32 i = 0; names.GetInfo(B_ANY_TYPE, i, &name, &type, &count)
+			== B_OK; i++) {
+		type_code viewType;
+		int32 viewCount;
+		if (view.GetInfo(name, &viewType, &viewCount) != B_OK)
+			continue;
+
+		for (int32 j = 0; j < viewCount; j++) {
+			const void* data;
+			ssize_t size;
+			if (view.FindData(name, viewType, j, &data, &size) != B_OK)
+				continue;
+
+			if ((const char*)data < buffer || size < 0
+				|| (const char*)data + size > buffer + bufferSize) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+static void
+test_entry(const CorpusEntry& entry, int32 mutations)
+{
+	// round trip
+	BMessage message;
+	BMemoryIO input(entry.data, entry.size);
+	if (message.Unflatten(&input) != B_OK) {
+		fail(entry, "unflattening failed");
+		return;
+	}
+
+	char* data;
+	ssize_t size;
+	if (!flatten(message, data, size)) {
+		fail(entry, "flattening failed");
+		free(data);
+		return;
+	}
+
+	if (size != entry.size || memcmp(data, entry.data, size) != 0)
+		fail(entry, "flattening again gives a different result");
+
+	BMessage copy;
+	if (copy.Unflatten(data) != B_OK || !copy.HasSameData(message, false, true))
+		fail(entry, "unflattened copy differs");
+	free(data);
+
+	BPrivate::BFlattenedMessage view(entry.data, entry.size);
+	if (view.InitCheck() != B_OK)
+		fail(entry, "BFlattenedMessage rejects the message");
+	else if (!view_matches_message(view, message))
+		fail(entry, "BFlattenedMessage doesn't match BMessage");
+
+	// mutations
+	char* buffer = (char*)malloc(entry.size);
+	if (buffer == NULL) {
+		fail(entry, "out of memory");
+		return;
+	}
+
+	for (int32 i = 0; i < mutations; i++) {
+		memcpy(buffer, entry.data, entry.size);
+		ssize_t bufferSize = entry.size;
+
+		int32 changes = 1 + next_random() % 4;
+		for (int32 j = 0; j < changes && bufferSize > 0; j++) {
+			uint32 offset = next_random() % bufferSize;
+			switch (next_random() % 4) {
+				case 0:
+					buffer[offset] ^= 1 << (next_random() % 8);
+					break;
+				case 1:
+					buffer[offset] = next_random();
+					break;
+				case 2:
+				{
+					// sizes, counts, offsets, and indices are 32 bit wide
+					static const uint32 kValues[] = { 0, 1, 0x7fffffff,
+						0x80000000, 0xffffffff, (uint32)entry.size };
+					uint32 value = kValues[next_random()
+						% (sizeof(kValues) / sizeof(kValues[0]))];
+					offset &= ~(uint32)3;
+					if (offset + sizeof(uint32) <= (uint32)bufferSize)
+						memcpy(buffer + offset, &value, sizeof(uint32));
+					break;
+				}
+				case 3:
+					bufferSize = offset;
+					break;
+			}
+		}
+
+		// don't let a mutation make us clone some random area
+		if (bufferSize >= (ssize_t)sizeof(BMessage::message_header)) {
+			BMessage::message_header* header
+				= (BMessage::message_header*)buffer;
+			header->flags &= ~MESSAGE_FLAG_PASS_BY_AREA;
+		}
+
+		BMessage mutated;
+		BMemoryIO mutatedInput(buffer, bufferSize);
+		if (mutated.Unflatten(&mutatedInput) == B_OK)
+			touch_message(mutated);
+
+		if (!touch_view(buffer, bufferSize, message)) {
+			fail(entry, "BFlattenedMessage returned data outside the buffer");
+			break;
+		}
+	}
+
+	free(buffer);
+}
+
+
+static bool
+add_entry(CorpusEntry*& entries, int32& count, const char* name, char* data,
+	ssize_t size)
+{
+	CorpusEntry* newEntries = (CorpusEntry*)realloc(entries,
+		(count + 1) * sizeof(CorpusEntry));
+	if (newEntries == NULL)
+		return false;
+
+	entries = newEntries;
+	CorpusEntry& entry = entries[count++];
+	entry.data = data;
+	entry.size = size;
+	strlcpy(entry.name, name, sizeof(entry.name));
+	return true;
+}
+
+
+static bool
+read_file(const char* path, char*& _data, ssize_t& _size)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	_data = NULL;
+	if (fstat(fd, &st) == 0 && st.st_size > 0) {
+		_size = st.st_size;
+		_data = (char*)malloc(_size);
+		if (_data != NULL && read(fd, _data, _size) != _size) {
+			free(_data);
+			_data = NULL;
+		}
+	}
+
+	close(fd);
+	return _data != NULL;
+}
+
+
+static bool
+write_file(const char* path, const char* data, ssize_t size)
+{
+	int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		return false;
+
+	bool success = write(fd, data, size) == size;
+	close(fd);
+	return success;
+}
+
+
+static void
+print_usage_and_exit(bool error)
+{
+	fprintf(error ? stderr : stdout,
+		"Usage: message_corpus_test [ -m <mutations> ] [ -w <directory> ]\n"
+		"           [ <file> ... ]\n"
+		"Tests the built-in messages and the given flattened message files.\n"
+		"  -m  The number of mutations per corpus entry (default %" B_PRId32
+			").\n"
+		"  -w  Writes the built-in messages to the given directory.\n",
+		kDefaultMutations);
+	exit(error ? 1 : 0);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 mutations = kDefaultMutations;
+	const char* writeDirectory = NULL;
+
+	int option;
+	while ((option = getopt(argc, argv, "hm:w:")) != -1) {
+		switch (option) {
+			case 'm':
+				mutations = atol(optarg);
+				break;
+			case 'w':
+				writeDirectory = optarg;
+				break;
+			case 'h':
+				print_usage_and_exit(false);
+				break;
+			default:
+				print_usage_and_exit(true);
+				break;
+		}
+	}
+
+	CorpusEntry* entries = NULL;
+	int32 count = 0;
+
+	// the built-in corpus
+	BMessage empty('empt');
+	char* data;
+	ssize_t size;
+	if (!flatten(empty, data, size)
+		|| !add_entry(entries, count, "empty", data, size)) {
+		fprintf(stderr, "message_corpus_test: out of memory\n");
+		return 1;
+	}
+
+	BMessage reused;
+	for (int32 i = 0; i < kMessageShapeCount; i++) {
+		for (int32 sequence = 0; sequence < kSequencesPerShape; sequence++) {
+			BMessage message;
+			kMessageShapes[i].build(message, sequence);
+
+			char name[64];
+			snprintf(name, sizeof(name), "%s %" B_PRId32,
+				kMessageShapes[i].name, sequence);
+			if (!flatten(message, data, size)
+				|| !add_entry(entries, count, name, data, size)) {
+				fprintf(stderr, "message_corpus_test: out of memory\n");
+				return 1;
+			}
+
+			// a reset message that is refilled must not differ from a new
+			// one; it still contains the previous shape's buffers here
+			BMessage::Private(reused).Reset();
+			kMessageShapes[i].build(reused, sequence);
+
+			char* reusedData;
+			ssize_t reusedSize;
+			if (!flatten(reused, reusedData, reusedSize) || reusedSize != size
+				|| memcmp(reusedData, data, size) != 0) {
+				fail(entries[count - 1], "reset message differs");
+			}
+			free(reusedData);
+		}
+	}
+
+	if (writeDirectory != NULL) {
+		for (int32 i = 0; i < count; i++) {
+			char path[PATH_MAX];
+			snprintf(path, sizeof(path), "%s/%s.msg", writeDirectory,
+				entries[i].name);
+			for (char* c = path + strlen(writeDirectory) + 1; *c; c++) {
+				if (*c == ' ')
+					*c = '_';
+			}
+
+			if (!write_file(path, entries[i].data, entries[i].size)) {
+				fprintf(stderr, "message_corpus_test: failed to write "
+					"\"%s\"\n", path);
+				return 1;
+			}
+		}
+	}
+
+	// corpus files
+	for (int i = optind; i < argc; i++) {
+		if (!read_file(argv[i], data, size)) {
+			fprintf(stderr, "message_corpus_test: failed to read \"%s\"\n",
+				argv[i]);
+			return 1;
+		}
+
+		const char* name = strrchr(argv[i], '/');
+		if (!add_entry(entries, count, name != NULL ? name + 1 : argv[i],
+				data, size)) {
+			fprintf(stderr, "message_corpus_test: out of memory\n");
+			return 1;
+		}
+	}
+
+	for (int32 i = 0; i < count; i++) {
+		test_entry(entries[i], mutations);
+		free(entries[i].data);
+	}
+	free(entries);
+
+	if (sFailures > 0) {
+		fprintf(stderr, "%" B_PRId32 " failures\n", sFailures);
+		return 1;
+	}
+
+	printf("%" B_PRId32 " corpus entries passed\n", count);
+	return 0;
+}
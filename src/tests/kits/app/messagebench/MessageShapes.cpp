@@ -0,0 +1,109 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "MessageShapes.h"
+
+#include <stdio.h>
+
+#include <AppDefs.h>
+#include <Point.h>
+#include <Rect.h>
+
+
+static void
+build_mouse_moved(BMessage& message, int32 sequence)
+{
+	// what input_server sends for every mouse movement
+	message.what = B_MOUSE_MOVED;
+	message.AddInt64("when", 1000000LL + sequence * 8000LL);
+	message.AddPoint("where", BPoint(sequence % 1920, sequence % 1080));
+	message.AddInt32("buttons", 0);
+	message.AddInt32("modifiers", 0);
+	message.AddInt32("be:delta_x", sequence % 3 - 1);
+	message.AddInt32("be:delta_y", sequence % 5 - 2);
+}
+
+
+static void
+build_key_down(BMessage& message, int32 sequence)
+{
+	char bytes[2] = { (char)('a' + sequence % 26), '\0' };
+	uint8 states[16] = {};
+	states[sequence % 16] = 0x80;
+
+	message.what = B_KEY_DOWN;
+	message.AddInt64("when", 1000000LL + sequence * 8000LL);
+	message.AddInt32("modifiers", 0);
+	message.AddInt32("key", 0x3c + sequence % 10);
+	message.AddData("states", B_UINT8_TYPE, states, sizeof(states));
+	message.AddInt8("byte", bytes[0]);
+	message.AddString("bytes", bytes);
+	message.AddInt32("raw_char", bytes[0]);
+	message.AddInt32("be:key_repeat", sequence % 4);
+}
+
+
+static void
+build_registrar_reply(BMessage& message, int32 sequence)
+{
+	// like the reply to a running application info request
+	char path[64];
+	snprintf(path, sizeof(path), "/boot/system/apps/App%" B_PRId32, sequence);
+
+	message.what = B_REPLY;
+	message.AddInt32("result", B_OK);
+	message.AddString("signature", "application/x-vnd.Haiku-Tracker");
+	message.AddInt32("team", 100 + sequence);
+	message.AddInt32("thread", 200 + sequence);
+	message.AddInt32("port", 300 + sequence);
+	message.AddInt32("flags", 0x10);
+	message.AddString("path", path);
+	message.AddInt32("device", 3);
+	message.AddInt64("directory", 1234567);
+	message.AddString("name", path + 18);
+}
+
+
+static void
+build_scripting(BMessage& message, int32 sequence)
+{
+	// "get Frame of View <n> of Window "Main Window""
+	message.what = B_GET_PROPERTY;
+	message.AddSpecifier("Frame");
+	message.AddSpecifier("View", sequence % 8);
+	message.AddSpecifier("Window", "Main Window");
+}
+
+
+static void
+build_bulk(BMessage& message, int32 sequence)
+{
+	// many fields and items, so that the hash chains get long
+	message.what = 'bulk';
+	char name[32];
+	for (int32 i = 0; i < 32; i++) {
+		snprintf(name, sizeof(name), "field %" B_PRId32, i);
+		message.AddInt32(name, sequence + i);
+	}
+
+	for (int32 i = 0; i < 64; i++) {
+		snprintf(name, sizeof(name), "item %" B_PRId32, sequence + i);
+		message.AddString("items", name);
+		message.AddRect("frames", BRect(i, i, i + sequence, i + 10));
+	}
+}
+
+
+const MessageShape kMessageShapes[] = {
+	{ "mouse moved", &build_mouse_moved, "where", B_POINT_TYPE },
+	{ "key down", &build_key_down, "bytes", B_STRING_TYPE },
+	{ "registrar reply", &build_registrar_reply, "path", B_STRING_TYPE },
+	{ "scripting", &build_scripting, "specifiers", B_MESSAGE_TYPE },
+	{ "bulk", &build_bulk, "items", B_STRING_TYPE },
+};
+
+const int32 kMessageShapeCount
+	= sizeof(kMessageShapes) / sizeof(kMessageShapes[0]);
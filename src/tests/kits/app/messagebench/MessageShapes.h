@@ -0,0 +1,29 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef MESSAGE_SHAPES_H
+#define MESSAGE_SHAPES_H
+
+
+#include <Message.h>
+
+
+/*!	A kind of message that is commonly sent around the system, used as input
+	for the benchmark and as seed for the corpus test.
+*/
+struct MessageShape {
+	const char*	name;
+	void		(*build)(BMessage& message, int32 sequence);
+
+	// a field that a receiver would typically look up
+	const char*	lookupName;
+	type_code	lookupType;
+};
+
+
+extern const MessageShape kMessageShapes[];
+extern const int32 kMessageShapeCount;
+
+
+#endif	// MESSAGE_SHAPES_H
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Tests the region operations of BRegion::Support with the destination
+	region being one of the source regions, and compares the results of
+	the BRegion methods, which have shortcuts of their own, to them.
+*/
+
+
+#include "RegionSupportTest.h"
+
+#include <assert.h>
+
+#include <Region.h>
+
+#include <RegionSupport.h>
+
+
+RegionSupportTest::RegionSupportTest(std::string name)
+	:
+	RegionTestcase(name)
+{
+}
+
+
+RegionSupportTest::~RegionSupportTest()
+{
+}
+
+
+void
+RegionSupportTest::testOneRegion(BRegion* region)
+{
+	region_support_ops support = get_region_support_ops();
+
+	// operations of a region with itself, all three being the same
+	BRegion result(*region);
+	support.union_region(&result, &result, &result);
+	assert(_RegionsAreIdentical(result, *region));
+
+	result = *region;
+	support.intersect_region(&result, &result, &result);
+	assert(_RegionsAreIdentical(result, *region));
+
+	result = *region;
+	support.subtract_region(&result, &result, &result);
+	assert(RegionIsEmpty(&result));
+
+	result = *region;
+	result.IntersectWith(region);
+	assert(_RegionsAreIdentical(result, *region));
+}
+
+
+void
+RegionSupportTest::testTwoRegions(BRegion* regionA, BRegion* regionB)
+{
+	region_support_ops support = get_region_support_ops();
+
+	BRegion expected;
+	support.union_region(regionA, regionB, &expected);
+	CheckFrame(&expected);
+	_CheckAliasing(support.union_region, regionA, regionB,
+		expected);
+
+	BRegion result(*regionA);
+	result.Include(regionB);
+	assert(_RegionsAreIdentical(result, expected));
+
+	support.intersect_region(regionA, regionB, &expected);
+	CheckFrame(&expected);
+	_CheckAliasing(support.intersect_region, regionA, regionB,
+		expected);
+
+	result = *regionA;
+	result.IntersectWith(regionB);
+	assert(_RegionsAreIdentical(result, expected));
+
+	support.subtract_region(regionA, regionB, &expected);
+	CheckFrame(&expected);
+	_CheckAliasing(support.subtract_region, regionA, regionB,
+		expected);
+
+	result = *regionA;
+	result.Exclude(regionB);
+	assert(_RegionsAreIdentical(result, expected));
+
+	if (regionB->CountRects() == 1) {
+		result = *regionA;
+		result.Exclude(regionB->RectAtInt(0));
+		assert(_RegionsAreIdentical(result, expected));
+	}
+}
+
+
+/*!	Checks that \a op gives \a expected, when the destination region is
+	the same as either of the source regions.
+*/
+void
+RegionSupportTest::_CheckAliasing(region_op op, BRegion* regionA,
+	BRegion* regionB, const BRegion& expected)
+{
+	BRegion result(*regionA);
+	op(&result, regionB, &result);
+	CheckFrame(&result);
+	assert(_RegionsAreIdentical(result, expected));
+
+	result = *regionB;
+	op(regionA, &result, &result);
+	CheckFrame(&result);
+	assert(_RegionsAreIdentical(result, expected));
+}
+
+
+/*!	Regions are kept in a canonical form, so the same area must always
+	result in the very same rectangles.
+*/
+bool
+RegionSupportTest::_RegionsAreIdentical(const BRegion& regionA,
+	const BRegion& regionB)
+{
+	return regionA == regionB && regionA.Frame() == regionB.Frame();
+}
+
+
+Test*
+RegionSupportTest::suite()
+{
+	typedef CppUnit::TestCaller<RegionSupportTest> RegionSupportTestCaller;
+
+	return new RegionSupportTestCaller("BRegion::Support Test",
+		&RegionSupportTest::PerformTest);
+}
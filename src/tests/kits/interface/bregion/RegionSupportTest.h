@@ -0,0 +1,36 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef REGION_SUPPORT_TEST_H
+#define REGION_SUPPORT_TEST_H
+
+
+#include "RegionTestcase.h"
+
+
+class RegionSupportTest : public RegionTestcase {
+public:
+								RegionSupportTest(std::string name = "");
+	virtual						~RegionSupportTest();
+
+	static	Test*				suite();
+
+protected:
+	virtual	void				testOneRegion(BRegion* region);
+	virtual	void				testTwoRegions(BRegion* regionA,
+									BRegion* regionB);
+
+private:
+			typedef int (*region_op)(const BRegion*, const BRegion*,
+				BRegion*);
+
+			void				_CheckAliasing(region_op op,
+									BRegion* regionA, BRegion* regionB,
+									const BRegion& expected);
+			bool				_RegionsAreIdentical(const BRegion& regionA,
+									const BRegion& regionB);
+};
+
+
+#endif	// REGION_SUPPORT_TEST_H
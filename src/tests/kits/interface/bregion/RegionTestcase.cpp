@@ -97,6 +97,28 @@ RegionTestcase::RegionTestcase(std::string name) :
 		}
 		listOfRegions.AddItem(tempRegion);
 	}
+
+	// Regions of a single rectangle take the shortcuts of BRegion and of
+	// its support code: one that covers all of the above, ones that lie
+	// within some of them, two that overlap each other, one that is
+	// disjoint from all others, and one that shares an edge with another.
+	float theRects[][4] =
+		{
+			{-200.0, -200.0, 400.0, 1000.0},
+			{20.0, 20.0, 40.0, 40.0},
+			{0.0, 0.0, 60.0, 60.0},
+			{40.0, 40.0, 100.0, 100.0},
+			{500.0, 500.0, 510.0, 510.0},
+			{61.0, 0.0, 80.0, 60.0}
+		};
+
+	const int numTestRects = sizeof(theRects) / sizeof(theRects[0]);
+
+	for(int rectNum = 0; rectNum < numTestRects; rectNum++) {
+		listOfRegions.AddItem(new BRegion(BRect(theRects[rectNum][0],
+			theRects[rectNum][1], theRects[rectNum][2],
+			theRects[rectNum][3])));
+	}
 }
 
 
@@ -0,0 +1,539 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Sends typical drawing workloads through the remote drawing protocol to a
+	receiver on the loopback interface, and reports how many bytes went over
+	the wire per frame, and how long each frame took to arrive.
+
+	Every workload is run with plain bitmaps, with the bitmap tile cache, and
+	with the tile cache and compression, so that their effect can be
+	compared. The receiver checks each bitmap it decodes against a checksum
+	computed by the sender.
+*/
+
+
+#include <getopt.h>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Bitmap.h>
+#include <NetEndpoint.h>
+#include <OS.h>
+
+#include "BitmapTileCache.h"
+#include "NetReceiver.h"
+#include "NetSender.h"
+#include "RemoteMessage.h"
+#include "StreamingRingBuffer.h"
+
+
+static const int32 kDefaultFrameCount = 100;
+static const double kDefaultLinkSpeed = 10.0;
+	// in Mbit/s
+
+static const int32 kIconSize = 32;
+static const int32 kIconCount = 4;
+static const int32 kIconsPerFrame = 48;
+static const int32 kCanvasWidth = 640;
+static const int32 kCanvasHeight = 480;
+static const int32 kSpriteSize = 64;
+static const int32 kNoiseSize = 256;
+static const int32 kCommandsPerFrame = 500;
+
+
+extern const char* __progname;
+static const char* kProgramName = __progname;
+
+static const char* kUsage =
+	"Usage: %s [ <options> ] [ <workload> ... ]\n"
+	"Sends each workload (or the given ones) through the remote drawing\n"
+	"protocol over the loopback interface.\n"
+	"\n"
+	"Options:\n"
+	"  -f, --frames <count>   Send <count> frames per run (default %" B_PRId32
+		").\n"
+	"  -h, --help             Print this usage info.\n"
+	"  -l, --list             List the available workloads.\n"
+	"  -s, --speed <mbit>     Estimate the frame time for a link with this\n"
+	"                         speed in Mbit/s (default %g).\n"
+;
+
+
+struct benchmark_bitmaps {
+	BBitmap*	icons[kIconCount];
+	BBitmap*	background;
+	BBitmap*	sprite;
+	BBitmap*	canvas;
+	BBitmap*	noise;
+};
+
+typedef void (*workload_function)(RemoteMessage& message,
+	BitmapTileCache* tileCache, benchmark_bitmaps& bitmaps, int32 frame);
+
+struct workload {
+	const char*			name;
+	const char*			description;
+	workload_function	function;
+};
+
+struct configuration {
+	const char*			name;
+	bool				useTileCache;
+	bool				compress;
+};
+
+struct receiver_context {
+	StreamingRingBuffer*	buffer;
+	BitmapTileCache*		tileCache;
+	sem_id					frameDone;
+	int32					bitmaps;
+	int32					failures;
+};
+
+
+static void
+print_usage_and_exit(bool error)
+{
+	fprintf(error ? stderr : stdout, kUsage, kProgramName, kDefaultFrameCount,
+		kDefaultLinkSpeed);
+	exit(error ? 1 : 0);
+}
+
+
+static uint32
+checksum(const BBitmap* bitmap)
+{
+	const uint8* bits = (const uint8*)bitmap->Bits();
+	int32 width = bitmap->Bounds().IntegerWidth() + 1;
+	int32 height = bitmap->Bounds().IntegerHeight() + 1;
+
+	uint32 hash = 2166136261U;
+	for (int32 y = 0; y < height; y++) {
+		const uint8* row = bits + y * bitmap->BytesPerRow();
+		for (int32 i = 0; i < width * 4; i++)
+			hash = (hash ^ row[i]) * 16777619U;
+	}
+
+	return hash;
+}
+
+
+static BBitmap*
+create_bitmap(int32 width, int32 height)
+{
+	BBitmap* bitmap = new(std::nothrow) BBitmap(
+		BRect(0, 0, width - 1, height - 1), B_BITMAP_NO_SERVER_LINK, B_RGB32);
+	if (bitmap != NULL && bitmap->InitCheck() != B_OK) {
+		delete bitmap;
+		return NULL;
+	}
+
+	return bitmap;
+}
+
+
+//! Fills the bitmap with smooth gradients and some stripes.
+static void
+fill_pattern(BBitmap* bitmap, uint32 seed)
+{
+	uint8* bits = (uint8*)bitmap->Bits();
+	int32 width = bitmap->Bounds().IntegerWidth() + 1;
+	int32 height = bitmap->Bounds().IntegerHeight() + 1;
+
+	for (int32 y = 0; y < height; y++) {
+		uint8* pixel = bits + y * bitmap->BytesPerRow();
+		for (int32 x = 0; x < width; x++) {
+			bool stripe = ((x + y + seed) / 8) % 5 == 0;
+			pixel[0] = stripe ? 255 : (x * 255 / width + seed * 40) & 0xff;
+			pixel[1] = stripe ? 255 : (y * 255 / height) & 0xff;
+			pixel[2] = (seed * 90 + (x ^ y)) & 0xff;
+			pixel[3] = 255;
+			pixel += 4;
+		}
+	}
+}
+
+
+static void
+fill_noise(BBitmap* bitmap, uint32 seed)
+{
+	uint32* bits = (uint32*)bitmap->Bits();
+	int32 count = bitmap->BitsLength() / 4;
+
+	uint32 state = seed * 2654435761U + 1;
+	for (int32 i = 0; i < count; i++) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		bits[i] = state | 0xff000000;
+	}
+}
+
+
+static void
+add_bitmap(RemoteMessage& message, BitmapTileCache* tileCache,
+	const BBitmap* bitmap, BRect viewRect)
+{
+	message.Start(RP_DRAW_BITMAP);
+	message.Add((uint32)0);
+	message.Add(viewRect);
+	message.Add(checksum(bitmap));
+	message.AddBitmap(*bitmap, tileCache);
+}
+
+
+// #pragma mark - workloads
+
+
+static void
+icons_workload(RemoteMessage& message, BitmapTileCache* tileCache,
+	benchmark_bitmaps& bitmaps, int32 frame)
+{
+	for (int32 i = 0; i < kIconsPerFrame; i++) {
+		BRect rect(0, 0, kIconSize - 1, kIconSize - 1);
+		rect.OffsetTo((i % 12) * 48, (i / 12) * 48 + frame % 8);
+		add_bitmap(message, tileCache, bitmaps.icons[(i + frame) % kIconCount],
+			rect);
+	}
+}
+
+
+static void
+sprite_workload(RemoteMessage& message, BitmapTileCache* tileCache,
+	benchmark_bitmaps& bitmaps, int32 frame)
+{
+	BBitmap* canvas = bitmaps.canvas;
+	memcpy(canvas->Bits(), bitmaps.background->Bits(), canvas->BitsLength());
+
+	int32 left = (frame * 7) % (kCanvasWidth - kSpriteSize);
+	int32 top = (frame * 5) % (kCanvasHeight - kSpriteSize);
+	for (int32 y = 0; y < kSpriteSize; y++) {
+		memcpy((uint8*)canvas->Bits() + (top + y) * canvas->BytesPerRow()
+				+ left * 4,
+			(uint8*)bitmaps.sprite->Bits() + y * bitmaps.sprite->BytesPerRow(),
+			kSpriteSize * 4);
+	}
+
+	add_bitmap(message, tileCache, canvas, canvas->Bounds());
+}
+
+
+static void
+commands_workload(RemoteMessage& message, BitmapTileCache* tileCache,
+	benchmark_bitmaps& bitmaps, int32 frame)
+{
+	for (int32 i = 0; i < kCommandsPerFrame; i++) {
+		BRect rect(0, 0, 15 + i % 32, 11);
+		rect.OffsetTo((i * 37) % kCanvasWidth, (i * 13 + frame) % kCanvasHeight);
+		rgb_color color = { (uint8)i, (uint8)(i * 3), (uint8)frame, 255 };
+
+		message.Start(RP_FILL_RECT_COLOR);
+		message.Add((uint32)0);
+		message.Add(rect);
+		message.Add(color);
+	}
+}
+
+
+static void
+noise_workload(RemoteMessage& message, BitmapTileCache* tileCache,
+	benchmark_bitmaps& bitmaps, int32 frame)
+{
+	fill_noise(bitmaps.noise, frame);
+	add_bitmap(message, tileCache, bitmaps.noise,
+		bitmaps.noise->Bounds().OffsetToCopy(100, 100));
+}
+
+
+static const workload kWorkloads[] = {
+	{ "icons", "a grid of small, recurring icons", icons_workload },
+	{ "sprite", "a sprite moving over a full window bitmap", sprite_workload },
+	{ "commands", "many small fill commands", commands_workload },
+	{ "noise", "an image that never repeats", noise_workload },
+	{ NULL, NULL, NULL }
+};
+
+static const configuration kConfigurations[] = {
+	{ "raw", false, false },
+	{ "tiles", true, false },
+	{ "tiles+zstd", true, true },
+	{ NULL, false, false }
+};
+
+
+// #pragma mark -
+
+
+static status_t
+receiver_thread(void* data)
+{
+	receiver_context& context = *(receiver_context*)data;
+	RemoteMessage message(context.buffer, NULL);
+
+	while (true) {
+		uint16 code;
+		status_t status = message.NextMessage(code);
+		if (status != B_OK)
+			return status;
+
+		switch (code) {
+			case RP_DRAW_BITMAP:
+			{
+				uint32 token, expected;
+				BRect viewRect;
+				message.Read(token);
+				message.Read(viewRect);
+				message.Read(expected);
+
+				BBitmap* bitmap;
+				if (message.ReadBitmap(&bitmap, false, B_RGB32,
+						B_BITMAP_NO_SERVER_LINK, context.tileCache) != B_OK) {
+					context.failures++;
+					break;
+				}
+
+				if (checksum(bitmap) != expected)
+					context.failures++;
+
+				context.bitmaps++;
+				delete bitmap;
+				break;
+			}
+
+			case RP_INVALIDATE_RECT:
+				release_sem(context.frameDone);
+				break;
+
+			case RP_CLOSE_CONNECTION:
+				return B_OK;
+		}
+	}
+}
+
+
+static bool
+run_workload(const workload& workload, const configuration& configuration,
+	benchmark_bitmaps& bitmaps, int32 frameCount, double linkSpeed,
+	double& rawBytesPerFrame)
+{
+	// The sender and receiver threads cannot be joined, and would access
+	// the buffers and endpoints after they were gone. The objects of each
+	// run are therefore kept until the benchmark exits.
+	BNetEndpoint* listener = new BNetEndpoint();
+	BNetEndpoint* sendEndpoint = new BNetEndpoint();
+	StreamingRingBuffer* sendBuffer = new StreamingRingBuffer(128 * 1024);
+	StreamingRingBuffer* receiveBuffer = new StreamingRingBuffer(128 * 1024);
+
+	unsigned short port;
+	status_t status = listener->Bind();
+	if (status == B_OK)
+		status = listener->LocalAddr().GetAddr(NULL, &port);
+	if (status == B_OK)
+		status = listener->Listen();
+	if (status == B_OK)
+		status = sendEndpoint->Connect("127.0.0.1", port);
+	if (status != B_OK) {
+		fprintf(stderr, "Could not connect on the loopback interface: %s\n",
+			strerror(status));
+		return false;
+	}
+
+	BNetEndpoint* receiveEndpoint = listener->Accept(1000);
+	if (receiveEndpoint == NULL) {
+		fprintf(stderr, "Could not accept the connection.\n");
+		return false;
+	}
+
+	NetSender* sender = new NetSender(sendEndpoint, sendBuffer,
+		configuration.compress);
+	new NetReceiver(receiveEndpoint, receiveBuffer);
+
+	BitmapTileCache sendTileCache;
+	BitmapTileCache receiveTileCache;
+
+	receiver_context context;
+	context.buffer = receiveBuffer;
+	context.tileCache = &receiveTileCache;
+	context.frameDone = create_sem(0, "frame done");
+	context.bitmaps = 0;
+	context.failures = 0;
+
+	thread_id receiver = spawn_thread(receiver_thread, "benchmark receiver",
+		B_NORMAL_PRIORITY, &context);
+	resume_thread(receiver);
+
+	bigtime_t totalLatency = 0;
+	for (int32 frame = 0; frame < frameCount; frame++) {
+		bigtime_t start = system_time();
+
+		RemoteMessage message(NULL, sendBuffer);
+		workload.function(message, configuration.useTileCache
+			? &sendTileCache : NULL, bitmaps, frame);
+
+		// marks the end of the frame for the receiver
+		message.Start(RP_INVALIDATE_RECT);
+		message.Add((uint32)0);
+		message.Add(BRect(0, 0, kCanvasWidth - 1, kCanvasHeight - 1));
+		message.Flush();
+
+		while (acquire_sem(context.frameDone) == B_INTERRUPTED)
+			;
+
+		totalLatency += system_time() - start;
+	}
+
+	RemoteMessage message(NULL, sendBuffer);
+	message.Start(RP_CLOSE_CONNECTION);
+	message.Flush();
+
+	status_t result;
+	wait_for_thread(receiver, &result);
+	delete_sem(context.frameDone);
+
+	net_sender_statistics statistics;
+	sender->GetStatistics(statistics);
+
+	double bytesPerFrame = (double)statistics.sent_bytes / frameCount;
+	if (rawBytesPerFrame == 0)
+		rawBytesPerFrame = bytesPerFrame;
+
+	printf("%-10s %-12s %10.1f %7.2f %8.1f%% %10.3f %10.3f%s\n",
+		workload.name, configuration.name, bytesPerFrame / 1024,
+		rawBytesPerFrame / bytesPerFrame,
+		statistics.chunks > 0
+			? 100.0 * statistics.compressed_chunks / statistics.chunks : 0.0,
+		totalLatency / 1000.0 / frameCount,
+		bytesPerFrame * 8 / (linkSpeed * 1000000) * 1000,
+		context.failures > 0 ? "  FAILED" : "");
+
+	return context.failures == 0;
+}
+
+
+static bool
+matches(const char* name, int argc, char** argv)
+{
+	if (argc == 0)
+		return true;
+
+	for (int i = 0; i < argc; i++) {
+		if (strcasecmp(name, argv[i]) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 frameCount = kDefaultFrameCount;
+	double linkSpeed = kDefaultLinkSpeed;
+	bool listOnly = false;
+
+	while (true) {
+		static struct option sLongOptions[] = {
+			{ "frames", required_argument, 0, 'f' },
+			{ "help", no_argument, 0, 'h' },
+			{ "list", no_argument, 0, 'l' },
+			{ "speed", required_argument, 0, 's' },
+			{ 0, 0, 0, 0 }
+		};
+
+		opterr = 0; // don't print errors
+		int c = getopt_long(argc, argv, "+f:hls:", sLongOptions, NULL);
+		if (c == -1)
+			break;
+
+		switch (c) {
+			case 'f':
+				frameCount = atoi(optarg);
+				if (frameCount <= 0)
+					print_usage_and_exit(true);
+				break;
+
+			case 'h':
+				print_usage_and_exit(false);
+				break;
+
+			case 'l':
+				listOnly = true;
+				break;
+
+			case 's':
+				linkSpeed = atof(optarg);
+				if (linkSpeed <= 0)
+					print_usage_and_exit(true);
+				break;
+
+			default:
+				print_usage_and_exit(true);
+				break;
+		}
+	}
+
+	argc -= optind;
+	argv += optind;
+
+	if (listOnly) {
+		for (int32 i = 0; kWorkloads[i].name != NULL; i++)
+			printf("%-10s %s\n", kWorkloads[i].name, kWorkloads[i].description);
+		return 0;
+	}
+
+	for (int i = 0; i < argc; i++) {
+		int32 index = 0;
+		while (kWorkloads[index].name != NULL
+			&& strcasecmp(kWorkloads[index].name, argv[i]) != 0) {
+			index++;
+		}
+		if (kWorkloads[index].name == NULL) {
+			fprintf(stderr, "Unknown workload \"%s\", see --list.\n", argv[i]);
+			return 1;
+		}
+	}
+
+	benchmark_bitmaps bitmaps;
+	bool created = true;
+	for (int32 i = 0; i < kIconCount; i++) {
+		bitmaps.icons[i] = create_bitmap(kIconSize, kIconSize);
+		if (bitmaps.icons[i] != NULL)
+			fill_pattern(bitmaps.icons[i], i);
+		else
+			created = false;
+	}
+	bitmaps.background = create_bitmap(kCanvasWidth, kCanvasHeight);
+	bitmaps.sprite = create_bitmap(kSpriteSize, kSpriteSize);
+	bitmaps.canvas = create_bitmap(kCanvasWidth, kCanvasHeight);
+	bitmaps.noise = create_bitmap(kNoiseSize, kNoiseSize);
+	if (!created || bitmaps.background == NULL || bitmaps.sprite == NULL
+		|| bitmaps.canvas == NULL || bitmaps.noise == NULL) {
+		fprintf(stderr, "Could not create the bitmaps.\n");
+		return 1;
+	}
+	fill_pattern(bitmaps.background, 7);
+	fill_pattern(bitmaps.sprite, 3);
+
+	printf("%-10s %-12s %10s %7s %9s %10s %10s\n", "workload", "encoding",
+		"KB/frame", "ratio", "zstd", "ms/frame", "ms@link");
+
+	bool success = true;
+	for (int32 i = 0; kWorkloads[i].name != NULL; i++) {
+		if (!matches(kWorkloads[i].name, argc, argv))
+			continue;
+
+		double rawBytesPerFrame = 0;
+		for (int32 j = 0; kConfigurations[j].name != NULL; j++) {
+			success &= run_workload(kWorkloads[i], kConfigurations[j],
+				bitmaps, frameCount, linkSpeed, rawBytesPerFrame);
+		}
+	}
+
+	return success ? 0 : 1;
+}
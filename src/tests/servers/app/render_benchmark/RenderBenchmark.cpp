@@ -0,0 +1,516 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Runs app_server drawing operations through a BitmapDrawingEngine, without
+	a display or a running app_server, and reports how fast they are.
+
+	Each test draws its first iteration onto a white canvas; that image can
+	be written out as a golden image (-w), or compared against one that was
+	written before (-c), to make sure an optimization did not change what
+	ends up on screen. With -T, the first iteration is also drawn with and
+	without tiled rendering, and both have to match byte for byte.
+*/
+
+
+#include <errno.h>
+#include <getopt.h>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <AutoDeleter.h>
+#include <OS.h>
+
+#include "BitmapDrawingEngine.h"
+#include "DrawState.h"
+#include "GlobalFontManager.h"
+#include "ServerBitmap.h"
+#include "ServerTokenSpace.h"
+
+#include "RenderTest.h"
+
+
+// normally provided by AppServer.cpp
+port_id gAppServerPort = -1;
+BTokenSpace gTokenSpace;
+
+
+typedef CObjectDeleter<FILE, int, fclose> FileCloser;
+
+
+static const int32 kCanvasWidth = 1024;
+static const int32 kCanvasHeight = 768;
+static const bigtime_t kDefaultDuration = 500000;
+
+
+extern const char* __progname;
+static const char* kProgramName = __progname;
+
+static const char* kUsage =
+	"Usage: %s [ <options> ] [ <test> ... ]\n"
+	"Renders each test (or the given ones) into an off-screen %" B_PRId32
+		"x%" B_PRId32 "\n"
+	"canvas, and prints how many pixels per second it drew.\n"
+	"\n"
+	"Options:\n"
+	"  -c, --compare <dir>    Compare the first iteration of each test with\n"
+	"                         the golden image in <dir>.\n"
+	"  -d, --duration <ms>    Run each test for <ms> milliseconds (default "
+		"500).\n"
+	"  -h, --help             Print this usage info.\n"
+	"  -l, --list             List the available tests.\n"
+	"  -t, --tolerance <n>    Allow channels to differ by up to <n> when\n"
+	"                         comparing (default 0).\n"
+	"  -T, --tiled            Check that the first iteration of each test\n"
+	"                         is the same with and without tiled rendering.\n"
+	"  -w, --write <dir>      Write the first iteration of each test to\n"
+	"                         <dir> as golden image.\n"
+;
+
+
+static void
+print_usage_and_exit(bool error)
+{
+	fprintf(error ? stderr : stdout, kUsage, kProgramName, kCanvasWidth,
+		kCanvasHeight);
+	exit(error ? 1 : 0);
+}
+
+
+static bool
+matches(const char* name, int argc, char** argv)
+{
+	if (argc == 0)
+		return true;
+
+	for (int i = 0; i < argc; i++) {
+		if (strcasecmp(name, argv[i]) == 0)
+			return true;
+	}
+	return false;
+}
+
+
+// #pragma mark - golden images
+
+
+/*!	Golden images are stored as PAM files (the portable arbitrary map format
+	of netpbm), since that is trivial to read and write, and can be viewed
+	and diffed with common tools on any platform.
+*/
+static status_t
+write_image(const char* path, UtilityBitmap* bitmap)
+{
+	int32 width = bitmap->Width();
+	int32 height = bitmap->Height();
+	ArrayDeleter<uint8> row(new(std::nothrow) uint8[width * 4]);
+	if (!row.IsSet())
+		return B_NO_MEMORY;
+
+	FILE* file = fopen(path, "wb");
+	if (file == NULL)
+		return errno;
+
+	fprintf(file, "P7\nWIDTH %" B_PRId32 "\nHEIGHT %" B_PRId32 "\nDEPTH 4\n"
+		"MAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n", width, height);
+
+	for (int32 y = 0; y < height; y++) {
+		const uint8* bits = bitmap->Bits() + y * bitmap->BytesPerRow();
+		for (int32 x = 0; x < width; x++) {
+			row[x * 4 + 0] = bits[x * 4 + 2];
+			row[x * 4 + 1] = bits[x * 4 + 1];
+			row[x * 4 + 2] = bits[x * 4 + 0];
+			row[x * 4 + 3] = bits[x * 4 + 3];
+		}
+		if (fwrite(row.Get(), width * 4, 1, file) != 1) {
+			fclose(file);
+			return B_IO_ERROR;
+		}
+	}
+
+	return fclose(file) == 0 ? B_OK : errno;
+}
+
+
+/*!	Compares \a bitmap with the PAM file at \a path. Returns \c B_OK if all
+	channels of all pixels are within \a tolerance, \c B_MISMATCHED_VALUES
+	if they aren't, or an error code if the file could not be read.
+*/
+static status_t
+compare_image(const char* path, UtilityBitmap* bitmap, int32 tolerance,
+	int32& _differentPixels, int32& _maxDelta)
+{
+	int32 width = bitmap->Width();
+	int32 height = bitmap->Height();
+	ArrayDeleter<uint8> row(new(std::nothrow) uint8[width * 4]);
+	if (!row.IsSet())
+		return B_NO_MEMORY;
+
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+		return errno;
+	FileCloser fileCloser(file);
+
+	int fileWidth;
+	int fileHeight;
+	int depth;
+	int maxValue;
+	char type[32];
+	if (fscanf(file, "P7 WIDTH %d HEIGHT %d DEPTH %d MAXVAL %d TUPLTYPE %31s",
+			&fileWidth, &fileHeight, &depth, &maxValue, type) != 5
+		|| fscanf(file, " ENDHDR") != 0 || fgetc(file) != '\n') {
+		return B_BAD_DATA;
+	}
+	if (fileWidth != width || fileHeight != height || depth != 4
+		|| maxValue != 255) {
+		return B_MISMATCHED_VALUES;
+	}
+
+	_differentPixels = 0;
+	_maxDelta = 0;
+
+	for (int32 y = 0; y < height; y++) {
+		if (fread(row.Get(), width * 4, 1, file) != 1)
+			return B_BAD_DATA;
+
+		const uint8* bits = bitmap->Bits() + y * bitmap->BytesPerRow();
+		for (int32 x = 0; x < width; x++) {
+			static const int kChannel[4] = { 2, 1, 0, 3 };
+			int32 delta = 0;
+			for (int i = 0; i < 4; i++) {
+				delta = max_c(delta,
+					abs(row[x * 4 + i] - bits[x * 4 + kChannel[i]]));
+			}
+			if (delta > tolerance)
+				_differentPixels++;
+			_maxDelta = max_c(_maxDelta, delta);
+		}
+	}
+
+	return _differentPixels == 0 ? B_OK : B_MISMATCHED_VALUES;
+}
+
+
+// #pragma mark - tiled rendering
+
+
+/*!	Draws the first iteration of the test onto a white canvas, and returns
+	the result in \a _image.
+*/
+static status_t
+render_first_iteration(const render_test_info& info,
+	BitmapDrawingEngine& engine, const DrawState& defaultState,
+	BReference<UtilityBitmap>& _image)
+{
+	ObjectDeleter<RenderTest> test(info.create());
+	if (!test.IsSet())
+		return B_NO_MEMORY;
+
+	BRect bounds(0, 0, kCanvasWidth - 1, kCanvasHeight - 1);
+	rgb_color white = { 255, 255, 255, 255 };
+
+	engine.SetDrawState(&defaultState);
+	engine.FillRect(bounds, white);
+
+	status_t status = test->Prepare(&engine, bounds);
+	if (status == B_OK) {
+		test->Draw(&engine, 0);
+
+		_image.SetTo(engine.ExportToBitmap(kCanvasWidth, kCanvasHeight,
+			B_RGBA32), true);
+		if (!_image.IsSet())
+			status = B_NO_MEMORY;
+	}
+
+	test->Cleanup(&engine);
+	return status;
+}
+
+
+/*!	Renders the first iteration of the test with and without tiled
+	rendering, and checks that the results are identical.
+*/
+static bool
+compare_tiled(const render_test_info& info, BitmapDrawingEngine& engine,
+	const DrawState& defaultState)
+{
+	bool tiled = engine.TiledRendering();
+
+	BReference<UtilityBitmap> images[2];
+	status_t status = B_OK;
+	for (int32 i = 0; i < 2 && status == B_OK; i++) {
+		engine.SetTiledRendering(i != 0);
+		status = render_first_iteration(info, engine, defaultState,
+			images[i]);
+	}
+
+	engine.SetTiledRendering(tiled);
+
+	if (status != B_OK) {
+		fprintf(stderr, "%s: rendering failed: %s\n", info.name,
+			strerror(status));
+		return false;
+	}
+
+	int32 differentPixels = 0;
+	int32 firstX = -1;
+	int32 firstY = -1;
+	for (int32 y = 0; y < kCanvasHeight; y++) {
+		const uint32* untiled = (const uint32*)(images[0]->Bits()
+			+ y * images[0]->BytesPerRow());
+		const uint32* tiled = (const uint32*)(images[1]->Bits()
+			+ y * images[1]->BytesPerRow());
+		if (memcmp(untiled, tiled, kCanvasWidth * 4) == 0)
+			continue;
+
+		for (int32 x = 0; x < kCanvasWidth; x++) {
+			if (untiled[x] == tiled[x])
+				continue;
+			if (differentPixels++ == 0) {
+				firstX = x;
+				firstY = y;
+			}
+		}
+	}
+
+	if (differentPixels != 0) {
+		fprintf(stderr, "%s: %" B_PRId32 " pixels differ with tiled "
+			"rendering, the first at (%" B_PRId32 ", %" B_PRId32 ")\n",
+			info.name, differentPixels, firstX, firstY);
+		return false;
+	}
+
+	return true;
+}
+
+
+// #pragma mark -
+
+
+static bool
+run_test(const render_test_info& info, BitmapDrawingEngine& engine,
+	const DrawState& defaultState, bigtime_t duration,
+	const char* goldenWriteDirectory, const char* goldenCompareDirectory,
+	int32 tolerance, bool compareTiled)
+{
+	bool success = true;
+	if (compareTiled)
+		success = compare_tiled(info, engine, defaultState);
+
+	ObjectDeleter<RenderTest> test(info.create());
+	if (!test.IsSet()) {
+		fprintf(stderr, "%s: out of memory\n", info.name);
+		return false;
+	}
+
+	BRect bounds(0, 0, kCanvasWidth - 1, kCanvasHeight - 1);
+	rgb_color white = { 255, 255, 255, 255 };
+
+	engine.SetDrawState(&defaultState);
+	engine.FillRect(bounds, white);
+
+	status_t status = test->Prepare(&engine, bounds);
+	if (status != B_OK) {
+		fprintf(stderr, "%s: preparing failed: %s\n", info.name,
+			strerror(status));
+		test->Cleanup(&engine);
+		return false;
+	}
+
+	// the first iteration is the one that has to match the golden image
+	test->Draw(&engine, 0);
+
+	if (goldenWriteDirectory != NULL || goldenCompareDirectory != NULL) {
+		BReference<UtilityBitmap> image(engine.ExportToBitmap(kCanvasWidth,
+			kCanvasHeight, B_RGBA32), true);
+		if (!image.IsSet()) {
+			fprintf(stderr, "%s: could not export the canvas\n", info.name);
+			test->Cleanup(&engine);
+			return false;
+		}
+
+		char path[B_PATH_NAME_LENGTH];
+		if (goldenWriteDirectory != NULL) {
+			snprintf(path, sizeof(path), "%s/%s.pam", goldenWriteDirectory,
+				info.name);
+			status = write_image(path, image);
+			if (status != B_OK) {
+				fprintf(stderr, "%s: could not write \"%s\": %s\n", info.name,
+					path, strerror(status));
+				success = false;
+			}
+		}
+
+		if (goldenCompareDirectory != NULL) {
+			snprintf(path, sizeof(path), "%s/%s.pam", goldenCompareDirectory,
+				info.name);
+			int32 differentPixels = 0;
+			int32 maxDelta = 0;
+			status = compare_image(path, image, tolerance, differentPixels,
+				maxDelta);
+			if (status == B_MISMATCHED_VALUES && differentPixels > 0) {
+				fprintf(stderr, "%s: %" B_PRId32 " pixels differ from the "
+					"golden image, by up to %" B_PRId32 "\n", info.name,
+					differentPixels, maxDelta);
+				success = false;
+			} else if (status != B_OK) {
+				fprintf(stderr, "%s: could not compare with \"%s\": %s\n",
+					info.name, path, strerror(status));
+				success = false;
+			}
+		}
+	}
+
+	// the actual benchmark
+	uint64 pixels = 0;
+	int32 iterations = 0;
+	bigtime_t start = system_time();
+	bigtime_t elapsed;
+	do {
+		pixels += test->Draw(&engine, ++iterations);
+		elapsed = system_time() - start;
+	} while (elapsed < duration);
+
+	test->Cleanup(&engine);
+
+	printf("%-26s %8" B_PRId32 " %10.3f %10.1f%s\n", info.name, iterations,
+		elapsed / 1000.0 / iterations, pixels / (double)elapsed,
+		success ? "" : "  FAILED");
+	return success;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	bigtime_t duration = kDefaultDuration;
+	const char* goldenWriteDirectory = NULL;
+	const char* goldenCompareDirectory = NULL;
+	int32 tolerance = 0;
+	bool compareTiled = false;
+	bool listOnly = false;
+
+	while (true) {
+		static struct option sLongOptions[] = {
+			{ "compare", required_argument, 0, 'c' },
+			{ "duration", required_argument, 0, 'd' },
+			{ "help", no_argument, 0, 'h' },
+			{ "list", no_argument, 0, 'l' },
+			{ "tolerance", required_argument, 0, 't' },
+			{ "tiled", no_argument, 0, 'T' },
+			{ "write", required_argument, 0, 'w' },
+			{ 0, 0, 0, 0 }
+		};
+
+		opterr = 0; // don't print errors
+		int c = getopt_long(argc, argv, "+c:d:hlt:Tw:", sLongOptions, NULL);
+		if (c == -1)
+			break;
+
+		switch (c) {
+			case 'c':
+				goldenCompareDirectory = optarg;
+				break;
+
+			case 'd':
+				duration = (bigtime_t)atoi(optarg) * 1000;
+				if (duration <= 0)
+					print_usage_and_exit(true);
+				break;
+
+			case 'h':
+				print_usage_and_exit(false);
+				break;
+
+			case 'l':
+				listOnly = true;
+				break;
+
+			case 't':
+				tolerance = atoi(optarg);
+				break;
+
+			case 'T':
+				compareTiled = true;
+				break;
+
+			case 'w':
+				goldenWriteDirectory = optarg;
+				break;
+
+			default:
+				print_usage_and_exit(true);
+				break;
+		}
+	}
+
+	argc -= optind;
+	argv += optind;
+
+	if (listOnly) {
+		for (int32 i = 0; kRenderTests[i].name != NULL; i++) {
+			printf("%-26s %s\n", kRenderTests[i].name,
+				kRenderTests[i].description);
+		}
+		return 0;
+	}
+
+	for (int i = 0; i < argc; i++) {
+		int32 index = 0;
+		while (kRenderTests[index].name != NULL
+			&& strcasecmp(kRenderTests[index].name, argv[i]) != 0) {
+			index++;
+		}
+		if (kRenderTests[index].name == NULL) {
+			fprintf(stderr, "Unknown test \"%s\", see --list.\n", argv[i]);
+			return 1;
+		}
+	}
+
+	// the text tests, and every DrawState, need the fonts
+	gFontManager = new GlobalFontManager;
+	if (gFontManager->InitCheck() != B_OK) {
+		fprintf(stderr, "Could not initialize the font manager: %s\n",
+			strerror(gFontManager->InitCheck()));
+		return 1;
+	}
+	gFontManager->Run();
+
+	bool success = true;
+	{
+		BitmapDrawingEngine engine(B_RGBA32);
+		status_t status = engine.SetSize(kCanvasWidth, kCanvasHeight);
+		if (status != B_OK) {
+			fprintf(stderr, "Could not create the canvas: %s\n",
+				strerror(status));
+			return 1;
+		}
+
+		DrawState defaultState;
+
+		if (compareTiled && !engine.TiledRendering()) {
+			fprintf(stderr, "Tiled rendering is not available, there is "
+				"nothing to compare.\n");
+		}
+
+		printf("%-26s %8s %10s %10s\n", "test", "iter", "ms/iter",
+			"Mpixels/s");
+		for (int32 i = 0; kRenderTests[i].name != NULL; i++) {
+			if (!matches(kRenderTests[i].name, argc, argv))
+				continue;
+
+			success &= run_test(kRenderTests[i], engine, defaultState,
+				duration, goldenWriteDirectory, goldenCompareDirectory,
+				tolerance, compareTiled);
+		}
+	}
+
+	gFontManager->Lock();
+	gFontManager->Quit();
+
+	return success ? 0 : 1;
+}
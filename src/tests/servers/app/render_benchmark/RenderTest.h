@@ -0,0 +1,42 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef RENDER_TEST_H
+#define RENDER_TEST_H
+
+
+#include <Rect.h>
+
+
+class DrawingEngine;
+
+
+class RenderTest {
+public:
+								RenderTest();
+	virtual						~RenderTest();
+
+	// Called once before the test is run, with the engine in its default
+	// state and the canvas cleared to white.
+	virtual	status_t			Prepare(DrawingEngine* engine, BRect bounds);
+	virtual	void				Cleanup(DrawingEngine* engine);
+
+	// Renders one iteration and returns the number of pixels it touched.
+	// Iteration 0 is what ends up in the golden image, so every iteration
+	// must be reproducible from its index alone.
+	virtual	uint64				Draw(DrawingEngine* engine,
+									int32 iteration) = 0;
+};
+
+
+struct render_test_info {
+	const char*					name;
+	const char*					description;
+	RenderTest*					(*create)();
+};
+
+extern const render_test_info kRenderTests[];
+
+
+#endif // RENDER_TEST_H
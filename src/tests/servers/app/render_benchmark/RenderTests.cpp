@@ -0,0 +1,676 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "RenderTest.h"
+
+#include <math.h>
+#include <new>
+#include <string.h>
+
+#include <GradientLinear.h>
+#include <GradientRadial.h>
+#include <Region.h>
+#include <Shape.h>
+#include <ShapePrivate.h>
+#include <View.h>
+
+#include "AlphaMask.h"
+#include "DrawState.h"
+#include "DrawingEngine.h"
+#include "IntPoint.h"
+#include "IntRect.h"
+#include "ServerBitmap.h"
+#include "ServerFont.h"
+
+
+static const char* kSampleText
+	= "The quick brown fox jumps over the lazy dog. 0123456789 {}[]()!?";
+
+
+static rgb_color
+iteration_color(int32 iteration, uint8 alpha = 255)
+{
+	rgb_color color = { (uint8)(40 + iteration * 13),
+		(uint8)(90 + iteration * 29), (uint8)(160 + iteration * 47), alpha };
+	return color;
+}
+
+
+static BRect
+moving_rect(BRect bounds, float width, float height, int32 iteration)
+{
+	int32 xRange = max_c(1, bounds.IntegerWidth() + 1 - (int32)width);
+	int32 yRange = max_c(1, bounds.IntegerHeight() + 1 - (int32)height);
+
+	BRect rect(0, 0, width - 1, height - 1);
+	rect.OffsetTo(bounds.left + (iteration * 37) % xRange,
+		bounds.top + (iteration * 23) % yRange);
+	return rect;
+}
+
+
+static uint64
+rect_area(BRect rect)
+{
+	return (uint64)(rect.IntegerWidth() + 1) * (rect.IntegerHeight() + 1);
+}
+
+
+static uint64
+region_area(const BRegion& region)
+{
+	uint64 area = 0;
+	for (int32 i = 0; i < region.CountRects(); i++)
+		area += rect_area(region.RectAt(i));
+	return area;
+}
+
+
+/*!	Creates a B_RGBA32 bitmap with a color ramp, a grid of hard edges (which
+	show scaling artifacts) and a horizontal alpha ramp.
+*/
+static UtilityBitmap*
+create_test_bitmap(int32 width, int32 height)
+{
+	BReference<UtilityBitmap> bitmap(new(std::nothrow) UtilityBitmap(
+		BRect(0, 0, width - 1, height - 1), B_RGBA32, 0), true);
+	if (bitmap == NULL || !bitmap->IsValid())
+		return NULL;
+
+	uint8* bits = bitmap->Bits();
+	for (int32 y = 0; y < height; y++) {
+		uint8* pixel = bits + y * bitmap->BytesPerRow();
+		for (int32 x = 0; x < width; x++) {
+			bool line = (x % 16) == 0 || (y % 16) == 0;
+			pixel[0] = line ? 0 : 255 * y / height;
+			pixel[1] = line ? 0 : 255 * x / width;
+			pixel[2] = line ? 0 : 255 - 255 * x / width;
+			pixel[3] = 64 + 191 * x / width;
+			pixel += 4;
+		}
+	}
+
+	return bitmap.Detach();
+}
+
+
+/*!	Builds a flower like shape out of bezier curves, centered in a box of
+	the given size.
+*/
+static void
+create_flower_shape(BShape& shape, float size, int32 petals)
+{
+	float radius = size / 2;
+	BPoint center(radius, radius);
+
+	for (int32 i = 0; i < petals; i++) {
+		float angle = 2 * M_PI * i / petals;
+		float nextAngle = 2 * M_PI * (i + 1) / petals;
+		BPoint from(center.x + cosf(angle) * radius * 0.3,
+			center.y + sinf(angle) * radius * 0.3);
+		BPoint to(center.x + cosf(nextAngle) * radius * 0.3,
+			center.y + sinf(nextAngle) * radius * 0.3);
+		BPoint control1(center.x + cosf(angle) * radius,
+			center.y + sinf(angle) * radius);
+		BPoint control2(center.x + cosf(nextAngle) * radius,
+			center.y + sinf(nextAngle) * radius);
+
+		if (i == 0)
+			shape.MoveTo(from);
+		shape.BezierTo(control1, control2, to);
+	}
+	shape.Close();
+}
+
+
+// #pragma mark - RenderTest
+
+
+RenderTest::RenderTest()
+{
+}
+
+
+RenderTest::~RenderTest()
+{
+}
+
+
+status_t
+RenderTest::Prepare(DrawingEngine* engine, BRect bounds)
+{
+	return B_OK;
+}
+
+
+void
+RenderTest::Cleanup(DrawingEngine* engine)
+{
+}
+
+
+// #pragma mark - FillRectTest
+
+
+class FillRectTest : public RenderTest {
+public:
+	FillRectTest(drawing_mode mode, uint8 alpha)
+		:
+		fMode(mode),
+		fAlpha(alpha)
+	{
+	}
+
+	virtual status_t Prepare(DrawingEngine* engine, BRect bounds)
+	{
+		fBounds = bounds;
+		engine->SetDrawingMode(fMode);
+		engine->SetBlendingMode(B_CONSTANT_ALPHA, B_ALPHA_OVERLAY);
+		return B_OK;
+	}
+
+	virtual uint64 Draw(DrawingEngine* engine, int32 iteration)
+	{
+		BRect rect = moving_rect(fBounds, 512, 384, iteration);
+		engine->SetHighColor(iteration_color(iteration, fAlpha));
+		engine->FillRect(rect);
+		return rect_area(rect);
+	}
+
+	static RenderTest* CreateCopy()
+	{
+		return new(std::nothrow) FillRectTest(B_OP_COPY, 255);
+	}
+
+	static RenderTest* CreateAlpha()
+	{
+		return new(std::nothrow) FillRectTest(B_OP_ALPHA, 128);
+	}
+
+private:
+	drawing_mode	fMode;
+	uint8			fAlpha;
+	BRect			fBounds;
+};
+
+
+// #pragma mark - FillRegionTest
+
+
+class FillRegionTest : public RenderTest {
+public:
+	virtual status_t Prepare(DrawingEngine* engine, BRect bounds)
+	{
+		// a grid of rects, similar to what redrawing many small views
+		// or list items amounts to
+		for (float y = bounds.top; y + 48 <= bounds.bottom; y += 64) {
+			for (float x = bounds.left; x + 48 <= bounds.right; x += 64)
+				fRegion.Include(BRect(x, y, x + 47, y + 47));
+		}
+		engine->SetDrawingMode(B_OP_COPY);
+		return B_OK;
+	}
+
+	virtual uint64 Draw(DrawingEngine* engine, int32 iteration)
+	{
+		engine->SetHighColor(iteration_color(iteration));
+		engine->FillRegion(fRegion);
+		return region_area(fRegion);
+	}
+
+	static RenderTest* Create()
+	{
+		return new(std::nothrow) FillRegionTest();
+	}
+
+private:
+	BRegion			fRegion;
+};
+
+
+// #pragma mark - GradientTest
+
+
+class GradientTest : public RenderTest {
+public:
+	GradientTest(bool radial)
+		:
+		fRadial(radial)
+	{
+	}
+
+	virtual status_t Prepare(DrawingEngine* engine, BRect bounds)
+	{
+		fBounds = bounds;
+		engine->SetDrawingMode(B_OP_COPY);
+		return B_OK;
+	}
+
+	virtual uint64 Draw(DrawingEngine* engine, int32 iteration)
+	{
+		BRect rect = moving_rect(fBounds, 512, 384, iteration);
+		float shift = iteration % 64;
+
+		rgb_color first = iteration_color(iteration);
+		rgb_color second = iteration_color(iteration + 3);
+		rgb_color third = iteration_color(iteration + 7);
+
+		if (fRadial) {
+			BGradientRadial gradient(BPoint(rect.left + 256 + shift,
+				rect.top + 192), 256);
+			gradient.AddColor(first, 0);
+			gradient.AddColor(second, 128);
+			gradient.AddColor(third, 255);
+			engine->FillRect(rect, gradient);
+		} else {
+			BGradientLinear gradient(BPoint(rect.left + shift, rect.top),
+				BPoint(rect.right, rect.bottom - shift));
+			gradient.AddColor(first, 0);
+			gradient.AddColor(second, 128);
+			gradient.AddColor(third, 255);
+			engine->FillRect(rect, gradient);
+		}
+
+		return rect_area(rect);
+	}
+
+	static RenderTest* CreateLinear()
+	{
+		return new(std::nothrow) GradientTest(false);
+	}
+
+	static RenderTest* CreateRadial()
+	{
+		return new(std::nothrow) GradientTest(true);
+	}
+
+private:
+	bool			fRadial;
+	BRect			fBounds;
+};
+
+
+// #pragma mark - BitmapTest
+
+
+class BitmapTest : public RenderTest {
+public:
+	BitmapTest(drawing_mode mode, float scale, uint32 options)
+		:
+		fMode(mode),
+		fScale(scale),
+		fOptions(options)
+	{
+	}
+
+	virtual status_t Prepare(DrawingEngine* engine, BRect bounds)
+	{
+		fBounds = bounds;
+		fBitmap.SetTo(create_test_bitmap(320, 240), true);
+		if (!fBitmap.IsSet())
+			return B_NO_MEMORY;
+
+		engine->SetDrawingMode(fMode);
+		engine->SetBlendingMode(B_PIXEL_ALPHA, B_ALPHA_OVERLAY);
+		return B_OK;
+	}
+
+	virtual void Cleanup(DrawingEngine* engine)
+	{
+		fBitmap.Unset();
+	}
+
+	virtual uint64 Draw(DrawingEngine* engine, int32 iteration)
+	{
+		BRect bitmapBounds = fBitmap->Bounds();
+		BRect rect = moving_rect(fBounds,
+			floorf((bitmapBounds.Width() + 1) * fScale),
+			floorf((bitmapBounds.Height() + 1) * fScale), iteration);
+
+		engine->DrawBitmap(fBitmap, bitmapBounds, rect, fOptions);
+		return rect_area(rect);
+	}
+
+	static RenderTest* CreateCopy()
+	{
+		return new(std::nothrow) BitmapTest(B_OP_COPY, 1.0f, 0);
+	}
+
+	static RenderTest* CreateAlpha()
+	{
+		return new(std::nothrow) BitmapTest(B_OP_ALPHA, 1.0f, 0);
+	}
+
+	static RenderTest* CreateScaledNearest()
+	{
+		return new(std::nothrow) BitmapTest(B_OP_COPY, 2.5f, 0);
+	}
+
+	static RenderTest* CreateScaledBilinear()
+	{
+		return new(std::nothrow) BitmapTest(B_OP_COPY, 2.5f,
+			B_FILTER_BITMAP_BILINEAR);
+	}
+
+	static RenderTest* CreateScaledDownBilinear()
+	{
+		return new(std::nothrow) BitmapTest(B_OP_COPY, 0.6f,
+			B_FILTER_BITMAP_BILINEAR);
+	}
+
+	static RenderTest* CreateScaledAlphaBilinear()
+	{
+		return new(std::nothrow) BitmapTest(B_OP_ALPHA, 1.8f,
+			B_FILTER_BITMAP_BILINEAR);
+	}
+
+private:
+	drawing_mode	fMode;
+	float			fScale;
+	uint32			fOptions;
+	BRect			fBounds;
+	BReference<UtilityBitmap> fBitmap;
+};
+
+
+// #pragma mark - AlphaMaskTest
+
+
+class AlphaMaskTest : public RenderTest {
+public:
+	AlphaMaskTest(bool uniform)
+		:
+		fUniform(uniform)
+	{
+	}
+
+	virtual status_t Prepare(DrawingEngine* engine, BRect bounds)
+	{
+		fBounds = bounds;
+
+		if (fUniform) {
+			fMask.SetTo(new(std::nothrow) UniformAlphaMask(128), true);
+		} else {
+			BShape shape;
+			create_flower_shape(shape, min_c(bounds.Width(),
+				bounds.Height()), 7);
+			shape_data* data = BShape::Private(shape).PrivateData();
+			fMask.SetTo(ShapeAlphaMask::Create(NULL, *data, BPoint(0, 0),
+				false), true);
+		}
+		if (!fMask.IsSet())
+			return B_NO_MEMORY;
+
+		fMask->SetCanvasGeometry(IntPoint(0, 0), IntRect(bounds));
+		fState.SetAlphaMask(fMask);
+		fState.SetDrawingMode(B_OP_COPY);
+		engine->SetDrawState(&fState);
+		return B_OK;
+	}
+
+	virtual void Cleanup(DrawingEngine* engine)
+	{
+		fState.SetAlphaMask(NULL);
+		engine->SetDrawState(&fState);
+		fMask.Unset();
+	}
+
+	virtual uint64 Draw(DrawingEngine* engine, int32 iteration)
+	{
+		BRect rect = moving_rect(fBounds, 512, 384, iteration);
+		engine->SetHighColor(iteration_color(iteration));
+		engine->FillRect(rect);
+		return rect_area(rect);
+	}
+
+	static RenderTest* CreateShape()
+	{
+		return new(std::nothrow) AlphaMaskTest(false);
+	}
+
+	static RenderTest* CreateUniform()
+	{
+		return new(std::nothrow) AlphaMaskTest(true);
+	}
+
+private:
+	bool			fUniform;
+	BRect			fBounds;
+	DrawState		fState;
+	BReference<AlphaMask> fMask;
+};
+
+
+// #pragma mark - ShapeTest
+
+
+class ShapeTest : public RenderTest {
+public:
+	ShapeTest(bool filled)
+		:
+		fFilled(filled)
+	{
+	}
+
+	virtual status_t Prepare(DrawingEngine* engine, BRect bounds)
+	{
+		fBounds = bounds;
+		create_flower_shape(fShape, 256, 9);
+		BShape::Private(fShape).GetData(&fOpCount, &fPointCount, &fOps,
+			&fPoints);
+
+		engine->SetDrawingMode(B_OP_OVER);
+		engine->SetPenSize(3);
+		return B_OK;
+	}
+
+	virtual uint64 Draw(DrawingEngine* engine, int32 iteration)
+	{
+		BRect rect = moving_rect(fBounds, 256, 256, iteration);
+		engine->SetHighColor(iteration_color(iteration));
+		engine->DrawShape(rect.OffsetToCopy(0, 0), fOpCount, fOps,
+			fPointCount, fPoints, fFilled, rect.LeftTop(), 1.0);
+		return rect_area(rect);
+	}
+
+	static RenderTest* CreateFilled()
+	{
+		return new(std::nothrow) ShapeTest(true);
+	}
+
+	static RenderTest* CreateStroked()
+	{
+		return new(std::nothrow) ShapeTest(false);
+	}
+
+private:
+	bool			fFilled;
+	BRect			fBounds;
+	BShape			fShape;
+	int32			fOpCount;
+	int32			fPointCount;
+	uint32*			fOps;
+	BPoint*			fPoints;
+};
+
+
+// #pragma mark - EllipseTest
+
+
+class EllipseTest : public RenderTest {
+public:
+	virtual status_t Prepare(DrawingEngine* engine, BRect bounds)
+	{
+		fBounds = bounds;
+		engine->SetDrawingMode(B_OP_OVER);
+		return B_OK;
+	}
+
+	virtual uint64 Draw(DrawingEngine* engine, int32 iteration)
+	{
+		uint64 area = 0;
+		for (int32 i = 0; i < 16; i++) {
+			BRect rect = moving_rect(fBounds, 96, 64, iteration * 16 + i);
+			engine->SetHighColor(iteration_color(iteration + i));
+			engine->DrawEllipse(rect, true);
+			area += rect_area(rect);
+		}
+		return area;
+	}
+
+	static RenderTest* Create()
+	{
+		return new(std::nothrow) EllipseTest();
+	}
+
+private:
+	BRect			fBounds;
+};
+
+
+// #pragma mark - TextTest
+
+
+class TextTest : public RenderTest {
+public:
+	TextTest(float size)
+		:
+		fSize(size)
+	{
+	}
+
+	virtual status_t Prepare(DrawingEngine* engine, BRect bounds)
+	{
+		fBounds = bounds;
+
+		ServerFont font;
+		font.SetSize(fSize);
+		engine->SetFont(font);
+		engine->SetDrawingMode(B_OP_OVER);
+
+		font_height height;
+		font.GetHeight(height);
+		fLineHeight = ceilf(height.ascent + height.descent + height.leading);
+		fAscent = ceilf(height.ascent);
+		fLength = strlen(kSampleText);
+		fWidth = ceilf(engine->StringWidth(kSampleText, fLength));
+		return fLineHeight > 0 ? B_OK : B_ERROR;
+	}
+
+	virtual uint64 Draw(DrawingEngine* engine, int32 iteration)
+	{
+		uint64 area = 0;
+		float x = fBounds.left + iteration % 32;
+		for (float y = fBounds.top; y + fLineHeight <= fBounds.bottom;
+				y += fLineHeight) {
+			engine->SetHighColor(iteration_color(iteration + (int32)y));
+			engine->DrawString(kSampleText, fLength, BPoint(x, y + fAscent));
+			area += (uint64)(fWidth * fLineHeight);
+		}
+		return area;
+	}
+
+	static RenderTest* CreateSmall()
+	{
+		return new(std::nothrow) TextTest(12);
+	}
+
+	static RenderTest* CreateLarge()
+	{
+		return new(std::nothrow) TextTest(36);
+	}
+
+private:
+	float			fSize;
+	BRect			fBounds;
+	float			fLineHeight;
+	float			fAscent;
+	float			fWidth;
+	int32			fLength;
+};
+
+
+// #pragma mark - CopyRegionTest
+
+
+class CopyRegionTest : public RenderTest {
+public:
+	virtual status_t Prepare(DrawingEngine* engine, BRect bounds)
+	{
+		// give the copies something to move around
+		BGradientLinear gradient(bounds.LeftTop(), bounds.RightBottom());
+		gradient.AddColor(iteration_color(0), 0);
+		gradient.AddColor(iteration_color(5), 255);
+		engine->FillRect(bounds, gradient);
+
+		// scrolling a view up by 16 pixels, with a second view next to it
+		// that stays in place
+		BRect left(bounds.left, bounds.top + 16,
+			bounds.left + floorf(bounds.Width() * 0.75f), bounds.bottom);
+		BRect bottom(left.right + 1, bounds.top + bounds.Height() / 2,
+			bounds.right, bounds.bottom);
+		fRegion.Set(left);
+		fRegion.Include(bottom);
+		return B_OK;
+	}
+
+	virtual uint64 Draw(DrawingEngine* engine, int32 iteration)
+	{
+		engine->CopyRegion(&fRegion, 0, -16);
+		return region_area(fRegion);
+	}
+
+	static RenderTest* Create()
+	{
+		return new(std::nothrow) CopyRegionTest();
+	}
+
+private:
+	BRegion			fRegion;
+};
+
+
+// #pragma mark -
+
+
+const render_test_info kRenderTests[] = {
+	{ "FillRectCopy", "512x384 rects, B_OP_COPY",
+		FillRectTest::CreateCopy },
+	{ "FillRectAlpha", "512x384 rects, B_OP_ALPHA with constant alpha",
+		FillRectTest::CreateAlpha },
+	{ "FillRegion", "grid of 48x48 rects", FillRegionTest::Create },
+	{ "GradientLinear", "512x384 rects, three stop linear gradient",
+		GradientTest::CreateLinear },
+	{ "GradientRadial", "512x384 rects, three stop radial gradient",
+		GradientTest::CreateRadial },
+	{ "BitmapCopy", "320x240 bitmap, unscaled, B_OP_COPY",
+		BitmapTest::CreateCopy },
+	{ "BitmapAlpha", "320x240 bitmap, unscaled, B_OP_ALPHA",
+		BitmapTest::CreateAlpha },
+	{ "BitmapScaledNearest", "320x240 bitmap scaled by 2.5",
+		BitmapTest::CreateScaledNearest },
+	{ "BitmapScaledBilinear", "320x240 bitmap scaled by 2.5, bilinear",
+		BitmapTest::CreateScaledBilinear },
+	{ "BitmapScaledDownBilinear", "320x240 bitmap scaled by 0.6, bilinear",
+		BitmapTest::CreateScaledDownBilinear },
+	{ "BitmapScaledAlphaBilinear",
+		"320x240 bitmap scaled by 1.8, bilinear, B_OP_ALPHA",
+		BitmapTest::CreateScaledAlphaBilinear },
+	{ "AlphaMaskShape", "512x384 rects clipped to a shape",
+		AlphaMaskTest::CreateShape },
+	{ "AlphaMaskUniform", "512x384 rects with a uniform alpha mask",
+		AlphaMaskTest::CreateUniform },
+	{ "ShapeFilled", "256x256 bezier shapes, filled",
+		ShapeTest::CreateFilled },
+	{ "ShapeStroked", "256x256 bezier shapes, 3 pixel pen",
+		ShapeTest::CreateStroked },
+	{ "Ellipses", "96x64 filled ellipses", EllipseTest::Create },
+	{ "TextSmall", "lines of 12 point text", TextTest::CreateSmall },
+	{ "TextLarge", "lines of 36 point text", TextTest::CreateLarge },
+	{ "CopyRegion", "scrolling a two rect region by 16 pixels",
+		CopyRegionTest::Create },
+	{ NULL, NULL, NULL }
+};
@@ -0,0 +1,327 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Runs the app_server drawing modes through the same AGG pipeline the
+	Painter uses, and reports how many pixels per second they blend.
+
+	Unlike RenderBenchmark, this is built for the build platform, and only
+	needs the drawing modes, the PatternHandler, and AGG; it does not cover
+	what the Painter does on top of them (text, shapes, bitmaps, clipping).
+
+	Every test is also drawn once with the scalar blending functions, and
+	the SIMD version has to produce exactly the same pixels.
+*/
+
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <agg_ellipse.h>
+#include <agg_rasterizer_scanline_aa.h>
+#include <agg_renderer_base.h>
+#include <agg_renderer_scanline.h>
+#include <agg_rendering_buffer.h>
+#include <agg_scanline_u.h>
+#include <agg_span_allocator.h>
+#include <agg_span_gradient.h>
+#include <agg_span_interpolator_linear.h>
+#include <agg_trans_affine.h>
+
+#include "PatternHandler.h"
+#include "PixelFormat.h"
+#include "SIMDFlags.h"
+
+
+// normally provided by Painter.cpp
+uint32 gSIMDFlags = 0;
+
+
+typedef agg::renderer_base<PixelFormat>					renderer_base;
+typedef agg::rasterizer_scanline_aa<>					rasterizer_type;
+typedef agg::scanline_u8								scanline_type;
+typedef agg::span_interpolator_linear<>					interpolator_type;
+typedef agg::gradient_linear_color<PixelFormat::color_type>
+	gradient_colors_type;
+typedef agg::span_gradient<PixelFormat::color_type, interpolator_type,
+	agg::gradient_x, gradient_colors_type>				gradient_type;
+
+
+static const int32 kCanvasWidth = 1024;
+static const int32 kCanvasHeight = 768;
+static const int32 kDefaultDuration = 500;
+
+
+enum primitive {
+	PRIMITIVE_RECT,
+	PRIMITIVE_ELLIPSE,
+	PRIMITIVE_GRADIENT
+};
+
+
+struct drawing_mode_test {
+	const char*		name;
+	drawing_mode	mode;
+	source_alpha	alphaSource;
+	alpha_function	alphaFunction;
+	uint8			alpha;
+};
+
+static const drawing_mode_test kModes[] = {
+	{ "copy", B_OP_COPY, B_PIXEL_ALPHA, B_ALPHA_OVERLAY, 255 },
+	{ "over", B_OP_OVER, B_PIXEL_ALPHA, B_ALPHA_OVERLAY, 255 },
+	{ "alpha-constant", B_OP_ALPHA, B_CONSTANT_ALPHA, B_ALPHA_OVERLAY, 128 },
+	{ "alpha-pixel", B_OP_ALPHA, B_PIXEL_ALPHA, B_ALPHA_OVERLAY, 128 },
+	{ "blend", B_OP_BLEND, B_PIXEL_ALPHA, B_ALPHA_OVERLAY, 255 },
+	{ "invert", B_OP_INVERT, B_PIXEL_ALPHA, B_ALPHA_OVERLAY, 255 },
+};
+
+static const char* kPrimitiveNames[] = { "rect", "ellipse", "gradient" };
+
+
+extern const char* __progname;
+static const char* kProgramName = __progname;
+
+static const char* kUsage =
+	"Usage: %s [ <options> ]\n"
+	"Blends rectangles, anti-aliased ellipses, and gradients into an\n"
+	"off-screen %" B_PRId32 "x%" B_PRId32 " canvas with each drawing mode,\n"
+	"and prints how many pixels per second were drawn.\n"
+	"\n"
+	"Options:\n"
+	"  -d, --duration <ms>    Run each test for <ms> milliseconds (default "
+		"%" B_PRId32 ").\n"
+	"  -h, --help             Print this usage info.\n"
+	"  -s, --simd <set>       Use the \"scalar\", \"sse2\", or \"avx2\"\n"
+	"                         blending functions (default: the best one\n"
+	"                         the CPU supports).\n"
+;
+
+
+static void
+print_usage_and_exit(bool error)
+{
+	fprintf(error ? stderr : stdout, kUsage, kProgramName, kCanvasWidth,
+		kCanvasHeight, kDefaultDuration);
+	exit(error ? 1 : 0);
+}
+
+
+static uint32
+detect_simd()
+{
+	uint32 flags = 0;
+#if defined(__i386__) || defined(__x86_64__)
+	if (__builtin_cpu_supports("sse2"))
+		flags |= APPSERVER_SIMD_SSE2;
+	if (__builtin_cpu_supports("avx2"))
+		flags |= APPSERVER_SIMD_AVX2;
+#endif
+	return flags;
+}
+
+
+static int64
+current_time()
+{
+	struct timeval time;
+	gettimeofday(&time, NULL);
+	return (int64)time.tv_sec * 1000000 + time.tv_usec;
+}
+
+
+static PixelFormat::color_type
+iteration_color(int32 iteration, uint8 alpha)
+{
+	return PixelFormat::color_type((iteration * 37) & 0xff,
+		(iteration * 91 + 64) & 0xff, (iteration * 13 + 128) & 0xff, alpha);
+}
+
+
+/*!	Draws one iteration of \a primitive, and returns the number of pixels
+	it covered.
+*/
+static uint64
+draw(renderer_base& renderer, primitive primitive, int32 iteration,
+	uint8 alpha)
+{
+	// move the shape around a bit, so that it doesn't always start on the
+	// same alignment
+	int32 offset = iteration % 16;
+	PixelFormat::color_type color = iteration_color(iteration, alpha);
+
+	switch (primitive) {
+		case PRIMITIVE_RECT:
+		{
+			int32 width = kCanvasWidth - 16;
+			int32 height = kCanvasHeight - 16;
+			renderer.blend_bar(offset, offset, offset + width - 1,
+				offset + height - 1, color, 255);
+			return (uint64)width * height;
+		}
+
+		case PRIMITIVE_ELLIPSE:
+		{
+			rasterizer_type rasterizer;
+			scanline_type scanline;
+			agg::ellipse ellipse(kCanvasWidth / 2.0 + offset,
+				kCanvasHeight / 2.0 + offset, kCanvasWidth / 2.0 - 16,
+				kCanvasHeight / 2.0 - 16, 256);
+			rasterizer.add_path(ellipse);
+			agg::render_scanlines_aa_solid(rasterizer, scanline, renderer,
+				color);
+			return (uint64)(3.14159265 * (kCanvasWidth / 2 - 16)
+				* (kCanvasHeight / 2 - 16));
+		}
+
+		case PRIMITIVE_GRADIENT:
+		{
+			rasterizer_type rasterizer;
+			scanline_type scanline;
+			rasterizer.move_to_d(offset, offset);
+			rasterizer.line_to_d(kCanvasWidth - 16 + offset, offset);
+			rasterizer.line_to_d(kCanvasWidth - 16 + offset,
+				kCanvasHeight - 16 + offset);
+			rasterizer.line_to_d(offset, kCanvasHeight - 16 + offset);
+
+			agg::trans_affine transform;
+			interpolator_type interpolator(transform);
+			agg::gradient_x gradientFunction;
+			gradient_colors_type colors(color,
+				iteration_color(iteration + 1, alpha));
+			gradient_type gradient(interpolator, gradientFunction, colors,
+				0, kCanvasWidth);
+			agg::span_allocator<PixelFormat::color_type> allocator;
+
+			agg::render_scanlines_aa(rasterizer, scanline, renderer,
+				allocator, gradient);
+			return (uint64)(kCanvasWidth - 16) * (kCanvasHeight - 16);
+		}
+	}
+
+	return 0;
+}
+
+
+static void
+prepare(agg::rendering_buffer& buffer, PixelFormat& pixelFormat,
+	const drawing_mode_test& test)
+{
+	// white
+	memset(buffer.buf(), 0xff, buffer.height() * buffer.stride());
+	pixelFormat.SetDrawingMode(test.mode, test.alphaSource,
+		test.alphaFunction);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int64 duration = kDefaultDuration * 1000LL;
+	uint32 simdFlags = detect_simd();
+
+	while (true) {
+		static struct option sLongOptions[] = {
+			{ "duration", required_argument, 0, 'd' },
+			{ "help", no_argument, 0, 'h' },
+			{ "simd", required_argument, 0, 's' },
+			{ 0, 0, 0, 0 }
+		};
+
+		opterr = 0; // don't print errors
+		int c = getopt_long(argc, (char**)argv, "d:hs:", sLongOptions, NULL);
+		if (c == -1)
+			break;
+
+		switch (c) {
+			case 'd':
+				duration = atoll(optarg) * 1000;
+				break;
+			case 'h':
+				print_usage_and_exit(false);
+				break;
+			case 's':
+				if (strcmp(optarg, "scalar") == 0)
+					simdFlags = 0;
+				else if (strcmp(optarg, "sse2") == 0)
+					simdFlags &= APPSERVER_SIMD_SSE2;
+				else if (strcmp(optarg, "avx2") == 0)
+					simdFlags &= APPSERVER_SIMD_SSE2 | APPSERVER_SIMD_AVX2;
+				else
+					print_usage_and_exit(true);
+				break;
+			default:
+				print_usage_and_exit(true);
+				break;
+		}
+	}
+
+	if (optind != argc || duration <= 0)
+		print_usage_and_exit(true);
+
+	size_t size = (size_t)kCanvasWidth * kCanvasHeight * 4;
+	uint8* bits = (uint8*)malloc(size);
+	uint8* referenceBits = (uint8*)malloc(size);
+	if (bits == NULL || referenceBits == NULL) {
+		fprintf(stderr, "%s: Out of memory\n", kProgramName);
+		return 1;
+	}
+
+	agg::rendering_buffer buffer(bits, kCanvasWidth, kCanvasHeight,
+		kCanvasWidth * 4);
+	PatternHandler patternHandler;
+	bool success = true;
+
+	printf("Using the %s blending functions.\n",
+		(simdFlags & APPSERVER_SIMD_AVX2) != 0 ? "AVX2"
+			: (simdFlags & APPSERVER_SIMD_SSE2) != 0 ? "SSE2" : "scalar");
+
+	for (size_t i = 0; i < sizeof(kModes) / sizeof(kModes[0]); i++) {
+		const drawing_mode_test& test = kModes[i];
+
+		for (int32 j = PRIMITIVE_RECT; j <= PRIMITIVE_GRADIENT; j++) {
+			primitive primitive = (enum primitive)j;
+
+			// the scalar functions draw the reference image
+			gSIMDFlags = 0;
+			PixelFormat referenceFormat(buffer, &patternHandler);
+			renderer_base referenceRenderer(referenceFormat);
+			prepare(buffer, referenceFormat, test);
+			draw(referenceRenderer, primitive, 0, test.alpha);
+			memcpy(referenceBits, bits, size);
+
+			gSIMDFlags = simdFlags;
+			PixelFormat pixelFormat(buffer, &patternHandler);
+			renderer_base renderer(pixelFormat);
+			prepare(buffer, pixelFormat, test);
+			draw(renderer, primitive, 0, test.alpha);
+
+			const char* result = "";
+			if (memcmp(bits, referenceBits, size) != 0) {
+				result = "  DIFFERS FROM SCALAR";
+				success = false;
+			}
+
+			uint64 pixels = 0;
+			int32 iteration = 1;
+			int64 start = current_time();
+			int64 elapsed;
+			do {
+				pixels += draw(renderer, primitive, iteration++, test.alpha);
+				elapsed = current_time() - start;
+			} while (elapsed < duration);
+
+			printf("%-15s %-9s %9.1f Mpixels/s%s\n", test.name,
+				kPrimitiveNames[primitive], pixels / (double)elapsed, result);
+		}
+	}
+
+	free(bits);
+	free(referenceBits);
+	return success ? 0 : 1;
+}
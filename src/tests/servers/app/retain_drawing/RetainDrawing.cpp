@@ -0,0 +1,240 @@
+/*
+ * Copyright 2026, Haiku Inc.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Checks that a view with B_RETAIN_DRAWING is not restored from what it
+	retained in an earlier update, after it has been partly invalidated and
+	drew nothing in the update that followed.
+*/
+
+
+#include <stdio.h>
+
+#include <Application.h>
+#include <Bitmap.h>
+#include <OS.h>
+#include <Region.h>
+#include <Screen.h>
+#include <View.h>
+#include <Window.h>
+
+
+static const rgb_color kBackgroundColor = {255, 255, 255, 255};
+static const rgb_color kContentColor = {255, 0, 0, 255};
+
+
+class RetainingView : public BView {
+public:
+							RetainingView(BRect frame);
+
+	virtual void			Draw(BRect updateRect);
+
+			void			SetDrawContent(bool drawContent);
+			int32			DrawCount() const { return fDrawCount; }
+
+private:
+			bool			fDrawContent;
+			int32			fDrawCount;
+};
+
+
+class Application : public BApplication {
+public:
+							Application();
+
+	virtual void			ReadyToRun();
+
+			bool			Passed() const { return fPassed; }
+
+private:
+	static	status_t		_TestThread(void* data);
+			bool			_Test();
+			bool			_WaitForDraw(int32 drawCount);
+			bool			_CheckColor(const char* step,
+								const rgb_color& expected);
+
+			BWindow*		fWindow;
+			RetainingView*	fView;
+			bool			fPassed;
+};
+
+
+RetainingView::RetainingView(BRect frame)
+	:
+	BView(frame, "retaining", B_FOLLOW_ALL, B_WILL_DRAW | B_RETAIN_DRAWING),
+	fDrawContent(true),
+	fDrawCount(0)
+{
+	SetViewColor(kBackgroundColor);
+}
+
+
+void
+RetainingView::Draw(BRect updateRect)
+{
+	if (fDrawContent) {
+		SetHighColor(kContentColor);
+		FillRect(Bounds());
+	} else {
+		// talks to the server, but doesn't draw anything
+		BRegion clipping;
+		GetClippingRegion(&clipping);
+	}
+
+	atomic_add(&fDrawCount, 1);
+}
+
+
+void
+RetainingView::SetDrawContent(bool drawContent)
+{
+	fDrawContent = drawContent;
+}
+
+
+//	#pragma mark -
+
+
+Application::Application()
+	:
+	BApplication("application/x-vnd.haiku-retain_drawing"),
+	fWindow(NULL),
+	fView(NULL),
+	fPassed(false)
+{
+}
+
+
+void
+Application::ReadyToRun()
+{
+	fWindow = new BWindow(BRect(100, 100, 299, 299), "RetainDrawing-Test",
+		B_TITLED_WINDOW, B_ASYNCHRONOUS_CONTROLS | B_NOT_RESIZABLE);
+	fView = new RetainingView(fWindow->Bounds());
+	fWindow->AddChild(fView);
+	fWindow->Show();
+
+	resume_thread(spawn_thread(&_TestThread, "test", B_NORMAL_PRIORITY,
+		this));
+}
+
+
+/*static*/ status_t
+Application::_TestThread(void* data)
+{
+	Application* app = (Application*)data;
+	app->fPassed = app->_Test();
+	printf("%s\n", app->fPassed ? "PASSED" : "FAILED");
+
+	app->PostMessage(B_QUIT_REQUESTED);
+	return B_OK;
+}
+
+
+bool
+Application::_Test()
+{
+	// the first update retains the content
+	if (!_WaitForDraw(1) || !_CheckColor("initial update", kContentColor))
+		return false;
+
+	// invalidate a part of the view that is not checked, and draw nothing
+	// in the update
+	if (!fWindow->Lock())
+		return false;
+	int32 drawCount = fView->DrawCount();
+	fView->SetDrawContent(false);
+	fView->Invalidate(BRect(0, 0, 49, 49));
+	fWindow->Unlock();
+
+	if (!_WaitForDraw(drawCount + 1)
+		|| !_CheckColor("empty update", kContentColor)) {
+		return false;
+	}
+
+	// cover the view, and expose it again
+	BWindow* cover = new BWindow(fWindow->Frame(), "Cover", B_BORDERED_WINDOW,
+		B_AVOID_FOCUS);
+	cover->Show();
+	cover->Lock();
+	cover->Sync();
+	cover->Quit();
+
+	snooze(100000);
+	if (fWindow->Lock()) {
+		fWindow->Sync();
+		fWindow->Unlock();
+	}
+
+	return _CheckColor("expose", kBackgroundColor);
+}
+
+
+bool
+Application::_WaitForDraw(int32 drawCount)
+{
+	for (int32 i = 0; i < 50; i++) {
+		if (fWindow->Lock()) {
+			fWindow->Sync();
+			fWindow->Unlock();
+		}
+
+		if (fView->DrawCount() >= drawCount) {
+			snooze(50000);
+			return true;
+		}
+
+		snooze(100000);
+	}
+
+	printf("The view was not drawn.\n");
+	return false;
+}
+
+
+bool
+Application::_CheckColor(const char* step, const rgb_color& expected)
+{
+	if (!fWindow->Lock())
+		return false;
+	BPoint where = fView->ConvertToScreen(fView->Bounds().LeftTop()
+		+ BPoint(100, 100));
+	fWindow->Unlock();
+
+	BBitmap* screenShot = NULL;
+	BRect frame(where, where);
+	if (BScreen().GetBitmap(&screenShot, false, &frame) != B_OK
+		|| screenShot == NULL) {
+		printf("%s: could not read the screen.\n", step);
+		return false;
+	}
+
+	const uint8* bits = (const uint8*)screenShot->Bits();
+	rgb_color color = {bits[2], bits[1], bits[0], 255};
+	delete screenShot;
+
+	if (color.red != expected.red || color.green != expected.green
+		|| color.blue != expected.blue) {
+		printf("%s: expected color (%d, %d, %d), found (%d, %d, %d).\n", step,
+			expected.red, expected.green, expected.blue, color.red,
+			color.green, color.blue);
+		return false;
+	}
+
+	return true;
+}
+
+
+//	#pragma mark -
+
+
+int
+main(int argc, char** argv)
+{
+	Application app;
+	app.Run();
+
+	return app.Passed() ? 0 : 1;
+}
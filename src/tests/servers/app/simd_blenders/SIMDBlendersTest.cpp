@@ -0,0 +1,352 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Compares the SSE2 and AVX2 drawing mode blenders against the scalar
+	versions, which they need to match bit by bit, and prints how long each
+	of them takes for a typical amount of spans.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <OS.h>
+
+#include "DrawingModeAlphaCOSolid.h"
+#include "DrawingModeAlphaPOSolid.h"
+#include "DrawingModeOverSolid.h"
+#include "DrawingModeSIMD.h"
+#include "PatternHandler.h"
+
+
+#ifdef APPSERVER_SIMD_BLENDERS
+
+
+static const int kWidth = 256;
+static const int kHeight = 4;
+static const unsigned kMaxLength = 75;
+static const int kRounds = 20000;
+static const int kBenchmarkSpans = 200000;
+
+
+typedef PixelFormat::blend_line blend_line;
+typedef PixelFormat::blend_solid_span blend_solid_span;
+typedef PixelFormat::blend_color_span blend_color_span;
+
+
+struct line_blender {
+	const char*			name;
+	blend_line			scalar;
+	blend_line			sse2;
+	blend_line			avx2;
+};
+
+struct solid_span_blender {
+	const char*			name;
+	blend_solid_span	scalar;
+	blend_solid_span	sse2;
+	blend_solid_span	avx2;
+};
+
+struct color_span_blender {
+	const char*			name;
+	blend_color_span	scalar;
+	blend_color_span	sse2;
+	blend_color_span	avx2;
+};
+
+
+static const line_blender kLineBlenders[] = {
+	{ "hline over solid", blend_hline_over_solid,
+		blend_hline_over_solid_sse2, blend_hline_over_solid_avx2 },
+	{ "hline alpha co solid", blend_hline_alpha_co_solid,
+		blend_hline_alpha_co_solid_sse2, blend_hline_alpha_co_solid_avx2 },
+	{ "hline alpha po solid", blend_hline_alpha_po_solid,
+		blend_hline_alpha_po_solid_sse2, blend_hline_alpha_po_solid_avx2 },
+};
+
+static const solid_span_blender kSolidSpanBlenders[] = {
+	{ "solid hspan over solid", blend_solid_hspan_over_solid,
+		blend_solid_hspan_over_solid_sse2,
+		blend_solid_hspan_over_solid_avx2 },
+	{ "solid hspan alpha co solid", blend_solid_hspan_alpha_co_solid,
+		blend_solid_hspan_alpha_co_solid_sse2,
+		blend_solid_hspan_alpha_co_solid_avx2 },
+	{ "solid hspan alpha po solid", blend_solid_hspan_alpha_po_solid,
+		blend_solid_hspan_alpha_po_solid_sse2,
+		blend_solid_hspan_alpha_po_solid_avx2 },
+};
+
+static const color_span_blender kColorSpanBlenders[] = {
+	{ "color hspan alpha po", blend_color_hspan_alpha_po,
+		blend_color_hspan_alpha_po_sse2, blend_color_hspan_alpha_po_avx2 },
+};
+
+
+static uint8 sReference[kWidth * kHeight * 4];
+static uint8 sResult[kWidth * kHeight * 4];
+static uint8 sInitial[kWidth * kHeight * 4];
+static uint8 sCovers[kWidth];
+static color_type sColors[kWidth];
+
+
+/*!	Returns a random alpha or cover value, with a bias towards the values
+	the blenders treat differently.
+*/
+static uint8
+random_alpha()
+{
+	switch (rand() % 4) {
+		case 0:
+			return 0;
+		case 1:
+			return 255;
+		default:
+			return rand();
+	}
+}
+
+
+static color_type
+random_color()
+{
+	return color_type(rand(), rand(), rand(), random_alpha());
+}
+
+
+static void
+set_pattern_color(PatternHandler& pattern, const color_type& color)
+{
+	rgb_color high = { color.r, color.g, color.b, color.a };
+	pattern.SetColors(high, high);
+}
+
+
+static void
+randomize()
+{
+	for (size_t i = 0; i < sizeof(sInitial); i++)
+		sInitial[i] = rand();
+
+	// covers tend to come in runs
+	uint8 cover = random_alpha();
+	for (int i = 0; i < kWidth; i++) {
+		if (rand() % 8 == 0)
+			cover = random_alpha();
+		sCovers[i] = cover;
+		sColors[i] = random_color();
+	}
+}
+
+
+static bool
+check(const char* name, const char* version, int x, unsigned len)
+{
+	if (memcmp(sReference, sResult, sizeof(sResult)) == 0)
+		return true;
+
+	for (size_t i = 0; i < sizeof(sResult); i++) {
+		if (sReference[i] != sResult[i]) {
+			fprintf(stderr, "%s (%s), x %d, length %u: pixel %d differs, "
+				"expected %02x, got %02x\n", name, version, x, len,
+				(int)(i / 4 % kWidth), sReference[i], sResult[i]);
+			break;
+		}
+	}
+
+	return false;
+}
+
+
+static bool
+test_line(const line_blender& blender, blend_line function,
+	const char* version, PatternHandler& pattern)
+{
+	agg::rendering_buffer reference(sReference, kWidth, kHeight, kWidth * 4);
+	agg::rendering_buffer result(sResult, kWidth, kHeight, kWidth * 4);
+
+	for (int round = 0; round < kRounds; round++) {
+		randomize();
+		unsigned len = 1 + rand() % kMaxLength;
+		int x = rand() % (kWidth - len);
+		int y = rand() % kHeight;
+		color_type color = random_color();
+		uint8 cover = random_alpha();
+		set_pattern_color(pattern, color);
+
+		memcpy(sReference, sInitial, sizeof(sInitial));
+		memcpy(sResult, sInitial, sizeof(sInitial));
+		blender.scalar(x, y, len, color, cover, &reference, &pattern);
+		function(x, y, len, color, cover, &result, &pattern);
+
+		if (!check(blender.name, version, x, len))
+			return false;
+	}
+
+	return true;
+}
+
+
+static bool
+test_solid_span(const solid_span_blender& blender, blend_solid_span function,
+	const char* version, PatternHandler& pattern)
+{
+	agg::rendering_buffer reference(sReference, kWidth, kHeight, kWidth * 4);
+	agg::rendering_buffer result(sResult, kWidth, kHeight, kWidth * 4);
+
+	for (int round = 0; round < kRounds; round++) {
+		randomize();
+		unsigned len = 1 + rand() % kMaxLength;
+		int x = rand() % (kWidth - len);
+		int y = rand() % kHeight;
+		color_type color = random_color();
+		const uint8* covers = sCovers + rand() % (kWidth - len);
+		set_pattern_color(pattern, color);
+
+		memcpy(sReference, sInitial, sizeof(sInitial));
+		memcpy(sResult, sInitial, sizeof(sInitial));
+		blender.scalar(x, y, len, color, covers, &reference, &pattern);
+		function(x, y, len, color, covers, &result, &pattern);
+
+		if (!check(blender.name, version, x, len))
+			return false;
+	}
+
+	return true;
+}
+
+
+static bool
+test_color_span(const color_span_blender& blender, blend_color_span function,
+	const char* version, PatternHandler& pattern)
+{
+	agg::rendering_buffer reference(sReference, kWidth, kHeight, kWidth * 4);
+	agg::rendering_buffer result(sResult, kWidth, kHeight, kWidth * 4);
+
+	for (int round = 0; round < kRounds; round++) {
+		randomize();
+		unsigned len = 1 + rand() % kMaxLength;
+		int x = rand() % (kWidth - len);
+		int y = rand() % kHeight;
+		const color_type* colors = sColors + rand() % (kWidth - len);
+		const uint8* covers = NULL;
+		if (rand() % 4 != 0)
+			covers = sCovers + rand() % (kWidth - len);
+		uint8 cover = random_alpha();
+
+		memcpy(sReference, sInitial, sizeof(sInitial));
+		memcpy(sResult, sInitial, sizeof(sInitial));
+		blender.scalar(x, y, len, colors, covers, cover, &reference, &pattern);
+		function(x, y, len, colors, covers, cover, &result, &pattern);
+
+		if (!check(blender.name, version, x, len))
+			return false;
+	}
+
+	return true;
+}
+
+
+static bigtime_t
+time_solid_span(blend_solid_span function, PatternHandler& pattern)
+{
+	agg::rendering_buffer buffer(sResult, kWidth, kHeight, kWidth * 4);
+	color_type color(30, 60, 90, 200);
+	set_pattern_color(pattern, color);
+
+	// antialiased text and shapes mostly consist of short spans
+	bigtime_t start = system_time();
+	for (int i = 0; i < kBenchmarkSpans; i++)
+		function(i % 16, i % kHeight, 48, color, sCovers, &buffer, &pattern);
+	return system_time() - start;
+}
+
+
+static bigtime_t
+time_color_span(blend_color_span function, PatternHandler& pattern)
+{
+	agg::rendering_buffer buffer(sResult, kWidth, kHeight, kWidth * 4);
+
+	bigtime_t start = system_time();
+	for (int i = 0; i < kBenchmarkSpans; i++) {
+		function(i % 16, i % kHeight, 48, sColors, sCovers, 255, &buffer,
+			&pattern);
+	}
+	return system_time() - start;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	bool hasAVX2 = __builtin_cpu_supports("avx2");
+	if (!__builtin_cpu_supports("sse2")) {
+		printf("SSE2 is not supported, nothing to test.\n");
+		return 0;
+	}
+	if (!hasAVX2)
+		printf("AVX2 is not supported, only testing SSE2.\n");
+
+	srand(42);
+	PatternHandler pattern;
+
+	bool success = true;
+	for (size_t i = 0; i < B_COUNT_OF(kLineBlenders); i++) {
+		const line_blender& blender = kLineBlenders[i];
+		success &= test_line(blender, blender.sse2, "SSE2", pattern);
+		if (hasAVX2)
+			success &= test_line(blender, blender.avx2, "AVX2", pattern);
+	}
+
+	for (size_t i = 0; i < B_COUNT_OF(kSolidSpanBlenders); i++) {
+		const solid_span_blender& blender = kSolidSpanBlenders[i];
+		success &= test_solid_span(blender, blender.sse2, "SSE2", pattern);
+		if (hasAVX2)
+			success &= test_solid_span(blender, blender.avx2, "AVX2", pattern);
+
+		bigtime_t scalar = time_solid_span(blender.scalar, pattern);
+		bigtime_t sse2 = time_solid_span(blender.sse2, pattern);
+		bigtime_t avx2 = hasAVX2 ? time_solid_span(blender.avx2, pattern) : 0;
+		printf("%-28s scalar %7" B_PRId64 " us, SSE2 %7" B_PRId64 " us, "
+			"AVX2 %7" B_PRId64 " us\n", blender.name, scalar, sse2, avx2);
+	}
+
+	for (size_t i = 0; i < B_COUNT_OF(kColorSpanBlenders); i++) {
+		const color_span_blender& blender = kColorSpanBlenders[i];
+		success &= test_color_span(blender, blender.sse2, "SSE2", pattern);
+		if (hasAVX2)
+			success &= test_color_span(blender, blender.avx2, "AVX2", pattern);
+
+		bigtime_t scalar = time_color_span(blender.scalar, pattern);
+		bigtime_t sse2 = time_color_span(blender.sse2, pattern);
+		bigtime_t avx2 = hasAVX2 ? time_color_span(blender.avx2, pattern) : 0;
+		printf("%-28s scalar %7" B_PRId64 " us, SSE2 %7" B_PRId64 " us, "
+			"AVX2 %7" B_PRId64 " us\n", blender.name, scalar, sse2, avx2);
+	}
+
+	if (!success) {
+		fprintf(stderr, "The SIMD blenders don't match the scalar ones!\n");
+		return 1;
+	}
+
+	printf("All SIMD blenders match the scalar ones.\n");
+	return 0;
+}
+
+
+#else	// !APPSERVER_SIMD_BLENDERS
+
+
+int
+main(int argc, char** argv)
+{
+	printf("No SIMD blenders on this architecture.\n");
+	return 0;
+}
+
+
+#endif	// !APPSERVER_SIMD_BLENDERS
@@ -6,6 +6,9 @@
 #include <TestSuite.h>
 #include <TestSuiteAddon.h>
 
+#include "CompiledPictureTest.h"
+#include "DamageTrackerTest.h"
+#include "FontIndexTest.h"
 #include "SimpleTransformTest.h"
 
 
@@ -14,6 +17,9 @@ getTestSuite()
 {
 	BTestSuite* suite = new BTestSuite("AppServerUnitTests");
 
+	CompiledPictureTest::AddTests(*suite);
+	DamageTrackerTest::AddTests(*suite);
+	FontIndexTest::AddTests(*suite);
 	SimpleTransformTest::AddTests(*suite);
 
 	return suite;
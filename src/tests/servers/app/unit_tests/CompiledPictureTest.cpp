@@ -0,0 +1,509 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "CompiledPictureTest.h"
+
+#include <math.h>
+#include <vector>
+
+#include <AffineTransform.h>
+#include <DataIO.h>
+#include <PictureDataWriter.h>
+#include <PicturePlayer.h>
+#include <PictureProtocol.h>
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+
+
+using BPrivate::PicturePlayer;
+using BPrivate::PicturePlayerCallbacks;
+
+
+static const rgb_color kRed = { 255, 0, 0, 255 };
+static const rgb_color kGreen = { 0, 255, 0, 255 };
+static const rgb_color kBlue = { 0, 0, 255, 255 };
+static const rgb_color kWhite = { 255, 255, 255, 255 };
+
+
+/*!	Writes the ops that PictureDataWriter has no method for, the same way
+	BPicture records them.
+*/
+class PictureBuilder : public PictureDataWriter {
+public:
+	PictureBuilder(BPositionIO* data)
+		:
+		PictureDataWriter(data)
+	{
+	}
+
+	void EnterStateChange()
+	{
+		BeginOp(B_PIC_ENTER_STATE_CHANGE);
+	}
+
+	void ExitStateChange()
+	{
+		EndOp();
+	}
+
+	void MovePenBy(const BPoint& delta)
+	{
+		BeginOp(B_PIC_MOVE_PEN_BY);
+		Write<BPoint>(delta);
+		EndOp();
+	}
+};
+
+
+struct drawing_state {
+	BPoint				pen_location;
+	BPoint				origin;
+	float				pen_size;
+	float				scale;
+	cap_mode			cap;
+	join_mode			join;
+	float				miter_limit;
+	drawing_mode		mode;
+	rgb_color			fore_color;
+	rgb_color			back_color;
+	source_alpha		alpha_source_mode;
+	alpha_function		alpha_function_mode;
+	int32				fill_rule;
+	BAffineTransform	transform;
+};
+
+struct drawing_op {
+	BPoint				where;
+	drawing_state		state;
+};
+
+
+/*!	Keeps track of the state that is in effect, and remembers it for every
+	drawing op.
+*/
+class StateRecorder : public PicturePlayerCallbacks {
+public:
+	StateRecorder()
+		:
+		fCalls(0)
+	{
+		fState.pen_location = B_ORIGIN;
+		fState.origin = B_ORIGIN;
+		fState.pen_size = 1.0f;
+		fState.scale = 1.0f;
+		fState.cap = B_BUTT_CAP;
+		fState.join = B_MITER_JOIN;
+		fState.miter_limit = B_DEFAULT_MITER_LIMIT;
+		fState.mode = B_OP_COPY;
+		fState.fore_color = make_color(0, 0, 0);
+		fState.back_color = make_color(255, 255, 255);
+		fState.alpha_source_mode = B_PIXEL_ALPHA;
+		fState.alpha_function_mode = B_ALPHA_OVERLAY;
+		fState.fill_rule = B_NONZERO;
+	}
+
+	int32 CountCalls() const
+	{
+		return fCalls;
+	}
+
+	const std::vector<drawing_op>& Ops() const
+	{
+		return fOps;
+	}
+
+	virtual void MovePenBy(const BPoint& delta)
+	{
+		fCalls++;
+		fState.pen_location += delta;
+	}
+
+	virtual void StrokeLine(const BPoint& start, const BPoint& end)
+	{
+		_Record(start);
+	}
+
+	virtual void DrawRect(const BRect& rect, bool fill)
+	{
+		_Record(rect.LeftTop());
+	}
+
+	virtual void PushState()
+	{
+		fCalls++;
+		fStack.push_back(fState);
+	}
+
+	virtual void PopState()
+	{
+		fCalls++;
+		if (fStack.empty())
+			return;
+
+		fState = fStack.back();
+		fStack.pop_back();
+	}
+
+	virtual void EnterStateChange()
+	{
+		fCalls++;
+	}
+
+	virtual void ExitStateChange()
+	{
+		fCalls++;
+	}
+
+	virtual void SetOrigin(const BPoint& origin)
+	{
+		fCalls++;
+		fState.origin = origin;
+	}
+
+	virtual void SetPenLocation(const BPoint& location)
+	{
+		fCalls++;
+		fState.pen_location = location;
+	}
+
+	virtual void SetDrawingMode(drawing_mode mode)
+	{
+		fCalls++;
+		fState.mode = mode;
+	}
+
+	virtual void SetLineMode(cap_mode capMode, join_mode joinMode,
+		float miterLimit)
+	{
+		fCalls++;
+		fState.cap = capMode;
+		fState.join = joinMode;
+		fState.miter_limit = miterLimit;
+	}
+
+	virtual void SetPenSize(float size)
+	{
+		fCalls++;
+		fState.pen_size = size;
+	}
+
+	virtual void SetForeColor(const rgb_color& color)
+	{
+		fCalls++;
+		fState.fore_color = color;
+	}
+
+	virtual void SetBackColor(const rgb_color& color)
+	{
+		fCalls++;
+		fState.back_color = color;
+	}
+
+	virtual void SetScale(float scale)
+	{
+		fCalls++;
+		fState.scale = scale;
+	}
+
+	virtual void SetBlendingMode(source_alpha alphaSourceMode,
+		alpha_function alphaFunctionMode)
+	{
+		fCalls++;
+		fState.alpha_source_mode = alphaSourceMode;
+		fState.alpha_function_mode = alphaFunctionMode;
+	}
+
+	virtual void SetFillRule(int32 fillRule)
+	{
+		fCalls++;
+		fState.fill_rule = fillRule;
+	}
+
+	virtual void SetTransform(const BAffineTransform& transform)
+	{
+		fCalls++;
+		fState.transform = transform;
+	}
+
+	// the same as the app_server does with the current state
+	virtual void TranslateBy(double x, double y)
+	{
+		fCalls++;
+		fState.transform.PreTranslateBy(x, y);
+	}
+
+	virtual void ScaleBy(double x, double y)
+	{
+		fCalls++;
+		fState.transform.PreScaleBy(x, y);
+	}
+
+	virtual void RotateBy(double angleRadians)
+	{
+		fCalls++;
+		fState.transform.PreRotateBy(angleRadians);
+	}
+
+private:
+	void _Record(const BPoint& where)
+	{
+		fCalls++;
+
+		drawing_op op;
+		op.where = where;
+		op.state = fState;
+		fOps.push_back(op);
+	}
+
+private:
+	int32						fCalls;
+	drawing_state				fState;
+	std::vector<drawing_state>	fStack;
+	std::vector<drawing_op>		fOps;
+};
+
+
+static bool
+equal_transforms(const BAffineTransform& a, const BAffineTransform& b)
+{
+	// folded transformations are computed in a different order
+	const double kEpsilon = 1e-9;
+	return fabs(a.sx - b.sx) < kEpsilon && fabs(a.shy - b.shy) < kEpsilon
+		&& fabs(a.shx - b.shx) < kEpsilon && fabs(a.sy - b.sy) < kEpsilon
+		&& fabs(a.tx - b.tx) < kEpsilon && fabs(a.ty - b.ty) < kEpsilon;
+}
+
+
+static void
+check_equal_states(const drawing_state& expected, const drawing_state& state)
+{
+	CPPUNIT_ASSERT(expected.pen_location == state.pen_location);
+	CPPUNIT_ASSERT(expected.origin == state.origin);
+	CPPUNIT_ASSERT_EQUAL(expected.pen_size, state.pen_size);
+	CPPUNIT_ASSERT_EQUAL(expected.scale, state.scale);
+	CPPUNIT_ASSERT_EQUAL(expected.cap, state.cap);
+	CPPUNIT_ASSERT_EQUAL(expected.join, state.join);
+	CPPUNIT_ASSERT_EQUAL(expected.miter_limit, state.miter_limit);
+	CPPUNIT_ASSERT_EQUAL(expected.mode, state.mode);
+	CPPUNIT_ASSERT(expected.fore_color == state.fore_color);
+	CPPUNIT_ASSERT(expected.back_color == state.back_color);
+	CPPUNIT_ASSERT_EQUAL(expected.alpha_source_mode,
+		state.alpha_source_mode);
+	CPPUNIT_ASSERT_EQUAL(expected.alpha_function_mode,
+		state.alpha_function_mode);
+	CPPUNIT_ASSERT_EQUAL(expected.fill_rule, state.fill_rule);
+	CPPUNIT_ASSERT(equal_transforms(expected.transform, state.transform));
+}
+
+
+/*!	Plays \a data with the PicturePlayer, and compiled, and makes sure that
+	both draw the same with the same state in effect.
+*/
+void
+CompiledPictureTest::_CheckEquivalent(const BMallocIO& data)
+{
+	StateRecorder expected;
+	PicturePlayer player(data.Buffer(), data.BufferLength(), NULL);
+	CPPUNIT_ASSERT_EQUAL(B_OK, player.Play(expected));
+
+	CompiledPicture compiled;
+	CPPUNIT_ASSERT_EQUAL(B_OK,
+		compiled.Compile(data.Buffer(), data.BufferLength(), NULL));
+
+	StateRecorder played;
+	compiled.Play(played);
+
+	// otherwise, there was nothing to fold, and nothing to test
+	CPPUNIT_ASSERT(played.CountCalls() < expected.CountCalls());
+
+	const std::vector<drawing_op>& expectedOps = expected.Ops();
+	const std::vector<drawing_op>& playedOps = played.Ops();
+	CPPUNIT_ASSERT(!expectedOps.empty());
+	CPPUNIT_ASSERT_EQUAL(expectedOps.size(), playedOps.size());
+
+	for (size_t i = 0; i < expectedOps.size(); i++) {
+		CPPUNIT_ASSERT(expectedOps[i].where == playedOps[i].where);
+		check_equal_states(expectedOps[i].state, playedOps[i].state);
+	}
+}
+
+
+void
+CompiledPictureTest::FoldStateChanges()
+{
+	BMallocIO data;
+	PictureBuilder builder(&data);
+
+	builder.EnterStateChange();
+	builder.WriteSetHighColor(kRed);
+	builder.WriteSetDrawingMode(B_OP_ALPHA);
+	builder.WriteSetLineMode(B_ROUND_CAP, B_ROUND_JOIN, 5.0f);
+	builder.ExitStateChange();
+	builder.EnterStateChange();
+	builder.WriteSetHighColor(kBlue);
+	builder.WriteSetLineMode(B_SQUARE_CAP, B_BEVEL_JOIN, 3.0f);
+	builder.WriteSetFillRule(B_EVEN_ODD);
+	builder.ExitStateChange();
+	builder.WriteStrokeLine(BPoint(0, 0), BPoint(10, 10));
+
+	// the pen size and scale cannot be folded, and nothing before them
+	builder.EnterStateChange();
+	builder.WriteSetLowColor(kGreen);
+	builder.WriteSetPenSize(3.0f);
+	builder.WriteSetHighColor(kRed);
+	builder.WriteSetScale(2.0f);
+	builder.WriteSetLowColor(kWhite);
+	builder.ExitStateChange();
+	builder.WriteDrawRect(BRect(10, 10, 20, 20), true);
+
+	builder.EnterStateChange();
+	builder.WriteSetBlendingMode(B_CONSTANT_ALPHA, B_ALPHA_COMPOSITE);
+	builder.WriteSetHighColor(kGreen);
+	builder.ExitStateChange();
+	builder.EnterStateChange();
+	builder.WriteSetBlendingMode(B_PIXEL_ALPHA, B_ALPHA_COMPOSITE);
+	builder.WriteSetOrigin(BPoint(5, 5));
+	builder.WriteSetHighColor(kBlue);
+	builder.ExitStateChange();
+	builder.WriteStrokeLine(BPoint(20, 20), BPoint(30, 30));
+
+	_CheckEquivalent(data);
+}
+
+
+void
+CompiledPictureTest::MergePenMovements()
+{
+	BMallocIO data;
+	PictureBuilder builder(&data);
+
+	builder.WriteSetPenLocation(BPoint(10, 10));
+	builder.MovePenBy(BPoint(5, 5));
+	builder.MovePenBy(BPoint(1, -2));
+	builder.WriteStrokeLine(BPoint(0, 0), BPoint(10, 10));
+
+	// the movement is overridden by the absolute location
+	builder.MovePenBy(BPoint(3, 3));
+	builder.MovePenBy(BPoint(4, 4));
+	builder.WriteSetPenLocation(BPoint(50, 50));
+	builder.MovePenBy(BPoint(-1, -1));
+	builder.WriteDrawRect(BRect(10, 10, 20, 20), false);
+
+	builder.EnterStateChange();
+	builder.WriteSetPenLocation(BPoint(20, 20));
+	builder.WriteSetHighColor(kRed);
+	builder.ExitStateChange();
+	builder.MovePenBy(BPoint(2, 2));
+	builder.EnterStateChange();
+	builder.WriteSetPenLocation(BPoint(30, 30));
+	builder.ExitStateChange();
+	builder.MovePenBy(BPoint(7, 7));
+	builder.WriteStrokeLine(BPoint(20, 20), BPoint(30, 30));
+
+	_CheckEquivalent(data);
+}
+
+
+void
+CompiledPictureTest::FoldTransforms()
+{
+	BMallocIO data;
+	PictureBuilder builder(&data);
+
+	builder.WriteTranslateBy(5, 5);
+	builder.WriteSetTransform(BAffineTransform().RotateBy(0.3));
+	builder.WriteTranslateBy(10, 0);
+	builder.WriteScaleBy(2, 3);
+	builder.WriteRotateBy(0.5);
+	builder.WriteTranslateBy(-4, 2);
+	builder.WriteStrokeLine(BPoint(0, 0), BPoint(10, 10));
+
+	builder.WriteTranslateBy(1, 2);
+	builder.WriteTranslateBy(3, 4);
+	builder.WriteScaleBy(2, 2);
+	builder.WriteScaleBy(0.5, 3);
+	builder.WriteRotateBy(0.1);
+	builder.WriteRotateBy(0.2);
+	builder.WriteDrawRect(BRect(10, 10, 20, 20), true);
+
+	builder.WriteSetTransform(BAffineTransform().ScaleBy(4, 4));
+	builder.WriteScaleBy(0.5, 0.25);
+	builder.WriteSetTransform(BAffineTransform().TranslateBy(7, 8));
+	builder.WriteDrawRect(BRect(10, 10, 20, 20), false);
+
+	_CheckEquivalent(data);
+}
+
+
+void
+CompiledPictureTest::PushStateIsBarrier()
+{
+	BMallocIO data;
+	PictureBuilder builder(&data);
+
+	builder.EnterStateChange();
+	builder.WriteSetHighColor(kRed);
+	builder.ExitStateChange();
+	builder.WritePushState();
+	builder.EnterStateChange();
+	builder.WriteSetHighColor(kBlue);
+	builder.ExitStateChange();
+	builder.WriteStrokeLine(BPoint(0, 0), BPoint(10, 10));
+	builder.WritePopState();
+	builder.WriteStrokeLine(BPoint(10, 10), BPoint(20, 20));
+
+	// state changes are not folded into the ones of the outer state
+	builder.EnterStateChange();
+	builder.WriteSetHighColor(kGreen);
+	builder.WriteSetPenLocation(BPoint(5, 5));
+	builder.ExitStateChange();
+	builder.WritePushState();
+	builder.EnterStateChange();
+	builder.WriteSetHighColor(kWhite);
+	builder.ExitStateChange();
+	builder.EnterStateChange();
+	builder.WriteSetHighColor(kBlue);
+	builder.WriteSetPenLocation(BPoint(6, 6));
+	builder.ExitStateChange();
+	builder.WritePopState();
+	builder.WriteDrawRect(BRect(10, 10, 20, 20), true);
+
+	// neither are transformations, nor pen movements
+	builder.WriteSetTransform(BAffineTransform().TranslateBy(3, 3));
+	builder.WriteSetPenLocation(BPoint(8, 8));
+	builder.WritePushState();
+	builder.WriteTranslateBy(5, 5);
+	builder.MovePenBy(BPoint(1, 1));
+	builder.WriteDrawRect(BRect(10, 10, 20, 20), false);
+	builder.WritePopState();
+	builder.MovePenBy(BPoint(2, 2));
+	builder.WriteStrokeLine(BPoint(20, 20), BPoint(30, 30));
+
+	_CheckEquivalent(data);
+}
+
+
+/* static */ void
+CompiledPictureTest::AddTests(BTestSuite& parent)
+{
+	CppUnit::TestSuite* const suite = new CppUnit::TestSuite(
+		"CompiledPictureTest");
+
+	suite->addTest(new CppUnit::TestCaller<CompiledPictureTest>(
+		"CompiledPictureTest::FoldStateChanges",
+		&CompiledPictureTest::FoldStateChanges));
+	suite->addTest(new CppUnit::TestCaller<CompiledPictureTest>(
+		"CompiledPictureTest::MergePenMovements",
+		&CompiledPictureTest::MergePenMovements));
+	suite->addTest(new CppUnit::TestCaller<CompiledPictureTest>(
+		"CompiledPictureTest::FoldTransforms",
+		&CompiledPictureTest::FoldTransforms));
+	suite->addTest(new CppUnit::TestCaller<CompiledPictureTest>(
+		"CompiledPictureTest::PushStateIsBarrier",
+		&CompiledPictureTest::PushStateIsBarrier));
+
+	parent.addTest("CompiledPictureTest", suite);
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef COMPILED_PICTURE_TEST_H
+#define COMPILED_PICTURE_TEST_H
+
+#include <TestCase.h>
+#include <TestSuite.h>
+
+#include "CompiledPicture.h"
+
+
+class BMallocIO;
+
+
+class CompiledPictureTest : public BTestCase {
+public:
+	static	void			AddTests(BTestSuite& parent);
+
+			void			FoldStateChanges();
+			void			MergePenMovements();
+			void			FoldTransforms();
+			void			PushStateIsBarrier();
+
+private:
+			void			_CheckEquivalent(const BMallocIO& data);
+};
+
+
+#endif // COMPILED_PICTURE_TEST_H
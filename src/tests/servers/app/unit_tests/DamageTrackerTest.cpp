@@ -0,0 +1,231 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "DamageTrackerTest.h"
+
+#include <StackOrHeapArray.h>
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+
+
+static BRegion
+merged_region(const BRegion& region, int32* _count,
+	const BRegion& keepOut = BRegion())
+{
+	BStackOrHeapArray<clipping_rect, 64> rects(region.CountRects());
+	int32 count = DamageTracker::MergeRects(region, keepOut, rects);
+
+	BRegion merged;
+	for (int32 i = 0; i < count; i++)
+		merged.Include(rects[i]);
+
+	*_count = count;
+	return merged;
+}
+
+
+void
+DamageTrackerTest::MergeCoversRegion()
+{
+	// a grid of small rects with one pixel gaps in between, like the
+	// damage of a list view redrawing its items
+	BRegion region;
+	for (int32 y = 0; y < 20; y++) {
+		for (int32 x = 0; x < 20; x++)
+			region.Include(BRect(x * 9, y * 9, x * 9 + 7, y * 9 + 7));
+	}
+
+	int32 count;
+	BRegion merged = merged_region(region, &count);
+	CPPUNIT_ASSERT(count > 0);
+	CPPUNIT_ASSERT(count < region.CountRects());
+
+	BRegion missing = region;
+	missing.Exclude(&merged);
+	CPPUNIT_ASSERT(missing.CountRects() == 0);
+}
+
+
+void
+DamageTrackerTest::MergeStaircase()
+{
+	// the region of a round shape consists of a band per row
+	BRegion region;
+	for (int32 y = 0; y < 100; y++)
+		region.Include(BRect(100 - y, y, 100 + y, y));
+	CPPUNIT_ASSERT(region.CountRects() == 100);
+
+	int32 count;
+	BRegion merged = merged_region(region, &count);
+	CPPUNIT_ASSERT(count < 10);
+
+	BRegion missing = region;
+	missing.Exclude(&merged);
+	CPPUNIT_ASSERT(missing.CountRects() == 0);
+}
+
+
+void
+DamageTrackerTest::MergeKeepsDistantRects()
+{
+	BRegion region;
+	region.Include(BRect(0, 0, 9, 9));
+	region.Include(BRect(500, 500, 509, 509));
+
+	clipping_rect rects[2];
+	int32 count = DamageTracker::MergeRects(region, BRegion(), rects);
+	CPPUNIT_ASSERT(count == 2);
+	CPPUNIT_ASSERT(rects[0].left == 0 && rects[0].bottom == 9);
+	CPPUNIT_ASSERT(rects[1].left == 500 && rects[1].bottom == 509);
+}
+
+
+void
+DamageTrackerTest::MergeKeepsOutOfDirectAccess()
+{
+	// the same grid as above, with a direct window in the gaps between
+	// some of the rects
+	BRegion region;
+	for (int32 y = 0; y < 20; y++) {
+		for (int32 x = 0; x < 20; x++)
+			region.Include(BRect(x * 9, y * 9, x * 9 + 7, y * 9 + 7));
+	}
+	BRegion keepOut;
+	keepOut.Include(BRect(44, 0, 44, 179));
+	keepOut.Include(BRect(0, 98, 179, 98));
+
+	int32 count;
+	BRegion merged = merged_region(region, &count, keepOut);
+	CPPUNIT_ASSERT(count < region.CountRects());
+	BRegion overlap = merged;
+	overlap.IntersectWith(&keepOut);
+	CPPUNIT_ASSERT(overlap.CountRects() == 0);
+
+	BRegion missing = region;
+	missing.Exclude(&merged);
+	CPPUNIT_ASSERT(missing.CountRects() == 0);
+
+	// a tracker doesn't merge into its direct access region either
+	DamageTracker tracker;
+	tracker.AddDirectAccess(keepOut);
+	BStackOrHeapArray<clipping_rect, 64> rects(region.CountRects());
+	count = tracker.MergeRects(region, rects);
+	for (int32 i = 0; i < count; i++)
+		CPPUNIT_ASSERT(!keepOut.Intersects(rects[i]));
+
+	tracker.RemoveDirectAccess(keepOut);
+	CPPUNIT_ASSERT(tracker.MergeRects(region, rects) < count);
+}
+
+
+void
+DamageTrackerTest::MergeNeedsSaving()
+{
+	// two rows close to each other are copied in one go
+	BRegion region;
+	region.Include(BRect(0, 0, 99, 0));
+	region.Include(BRect(0, 2, 99, 2));
+
+	clipping_rect rects[2];
+	CPPUNIT_ASSERT(DamageTracker::MergeRects(region, BRegion(), rects) == 1);
+
+	// but copying the rows in between costs more than it saves here
+	region.MakeEmpty();
+	region.Include(BRect(0, 0, 999, 0));
+	region.Include(BRect(0, 200, 999, 200));
+	CPPUNIT_ASSERT(DamageTracker::MergeRects(region, BRegion(), rects) == 2);
+}
+
+
+void
+DamageTrackerTest::DirectAccessDropsDamage()
+{
+	DamageTracker tracker;
+	tracker.Include(BRect(0, 0, 99, 99));
+	tracker.AddDirectAccess(BRegion(BRect(50, 0, 99, 99)));
+
+	BRegion damage;
+	tracker.TakeDamage(damage);
+	CPPUNIT_ASSERT(damage == BRegion(BRect(0, 0, 49, 99)));
+}
+
+
+void
+DamageTrackerTest::IncludeAndTake()
+{
+	DamageTracker tracker;
+	CPPUNIT_ASSERT(tracker.Include(BRect(0, 0, 9, 9)));
+	CPPUNIT_ASSERT(!tracker.Include(BRect(5, 5, 19, 19)));
+
+	BRegion damage;
+	tracker.TakeDamage(damage);
+	BRegion reference;
+	reference.Include(BRect(0, 0, 9, 9));
+	reference.Include(BRect(5, 5, 19, 19));
+	CPPUNIT_ASSERT(damage == reference);
+
+	tracker.TakeDamage(damage);
+	CPPUNIT_ASSERT(damage.CountRects() == 0);
+	CPPUNIT_ASSERT(tracker.Include(reference));
+}
+
+
+void
+DamageTrackerTest::Statistics()
+{
+	DamageTracker tracker;
+	BRegion region;
+	region.Include(BRect(0, 0, 9, 9));
+	region.Include(BRect(20, 20, 29, 29));
+	tracker.Include(region);
+	tracker.Include(BRect(40, 40, 49, 49));
+	tracker.AddFlush();
+	tracker.AddCopied(100, 400);
+	tracker.AddCopied(50, 200);
+
+	damage_statistics statistics;
+	tracker.GetStatistics(statistics);
+	CPPUNIT_ASSERT(statistics.flushes == 1);
+	CPPUNIT_ASSERT(statistics.rects_damaged == 3);
+	CPPUNIT_ASSERT(statistics.rects_copied == 2);
+	CPPUNIT_ASSERT(statistics.pixels_copied == 150);
+	CPPUNIT_ASSERT(statistics.bytes_copied == 600);
+}
+
+
+/* static */ void
+DamageTrackerTest::AddTests(BTestSuite& parent)
+{
+	CppUnit::TestSuite* const suite = new CppUnit::TestSuite(
+		"DamageTrackerTest");
+
+	suite->addTest(new CppUnit::TestCaller<DamageTrackerTest>(
+		"DamageTrackerTest::MergeCoversRegion",
+		&DamageTrackerTest::MergeCoversRegion));
+	suite->addTest(new CppUnit::TestCaller<DamageTrackerTest>(
+		"DamageTrackerTest::MergeStaircase",
+		&DamageTrackerTest::MergeStaircase));
+	suite->addTest(new CppUnit::TestCaller<DamageTrackerTest>(
+		"DamageTrackerTest::MergeKeepsDistantRects",
+		&DamageTrackerTest::MergeKeepsDistantRects));
+	suite->addTest(new CppUnit::TestCaller<DamageTrackerTest>(
+		"DamageTrackerTest::MergeKeepsOutOfDirectAccess",
+		&DamageTrackerTest::MergeKeepsOutOfDirectAccess));
+	suite->addTest(new CppUnit::TestCaller<DamageTrackerTest>(
+		"DamageTrackerTest::MergeNeedsSaving",
+		&DamageTrackerTest::MergeNeedsSaving));
+	suite->addTest(new CppUnit::TestCaller<DamageTrackerTest>(
+		"DamageTrackerTest::DirectAccessDropsDamage",
+		&DamageTrackerTest::DirectAccessDropsDamage));
+	suite->addTest(new CppUnit::TestCaller<DamageTrackerTest>(
+		"DamageTrackerTest::IncludeAndTake",
+		&DamageTrackerTest::IncludeAndTake));
+	suite->addTest(new CppUnit::TestCaller<DamageTrackerTest>(
+		"DamageTrackerTest::Statistics",
+		&DamageTrackerTest::Statistics));
+
+	parent.addTest("DamageTrackerTest", suite);
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef DAMAGE_TRACKER_TEST_H
+#define DAMAGE_TRACKER_TEST_H
+
+#include <TestCase.h>
+#include <TestSuite.h>
+
+#include "DamageTracker.h"
+
+
+class DamageTrackerTest : public BTestCase {
+public:
+	static	void			AddTests(BTestSuite& parent);
+
+			void			MergeCoversRegion();
+			void			MergeStaircase();
+			void			MergeKeepsDistantRects();
+			void			MergeKeepsOutOfDirectAccess();
+			void			MergeNeedsSaving();
+			void			DirectAccessDropsDamage();
+			void			IncludeAndTake();
+			void			Statistics();
+};
+
+
+#endif // DAMAGE_TRACKER_TEST_H
@@ -0,0 +1,289 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "FontIndexTest.h"
+
+#include <string.h>
+#include <unistd.h>
+
+#include <File.h>
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+
+
+static const off_t kHeaderSize = 16;
+	// magic, version, FreeType version, and entry count
+static const char* kFirstPath = "/fonts/a.ttf";
+static const char* kSecondPath = "/fonts/b.ttf";
+	// both paths have the same length, so that one can be patched into
+	// the other
+
+
+static struct stat
+make_stat(off_t size, time_t modified)
+{
+	struct stat stat;
+	memset(&stat, 0, sizeof(stat));
+	stat.st_size = size;
+	stat.st_mtim.tv_sec = modified;
+	stat.st_mtim.tv_nsec = 500000;
+	return stat;
+}
+
+
+static font_index_entry*
+make_entry(const char* path, const struct stat& stat, int32 styleCount)
+{
+	font_index_entry* entry = new font_index_entry(path, stat);
+	for (int32 i = 0; i < styleCount; i++) {
+		font_style_info* info = new font_style_info;
+		info->family = "Family";
+		info->style.SetToFormat("Style %" B_PRId32, i);
+		info->face_index = i | (i << 16);
+		info->flags = 0x10 + i;
+		info->glyph_count = 300 + i;
+		info->char_map_count = 2;
+		info->tuned_count = i;
+		info->height.ascent = 0.75f;
+		info->height.descent = 0.25f;
+		info->height.leading = 0.125f;
+		entry->styles.AddItem(info);
+	}
+	return entry;
+}
+
+
+static off_t
+find_data(const BMallocIO& data, const char* string)
+{
+	const char* buffer = (const char*)data.Buffer();
+	size_t length = strlen(string);
+	for (size_t i = 0; i + length <= data.BufferLength(); i++) {
+		if (memcmp(buffer + i, string, length) == 0)
+			return i;
+	}
+	return -1;
+}
+
+
+void
+FontIndexTest::setUp()
+{
+	BTestCase::setUp();
+
+	fPath = "/tmp/FontIndexTest-";
+	fPath << (int32)getpid();
+
+	FontIndex index;
+	index.Put(make_entry(kFirstPath, make_stat(1000, 2000), 2));
+	index.Put(make_entry(kSecondPath, make_stat(3000, 4000), 1));
+	CPPUNIT_ASSERT_EQUAL(B_OK, index.Save(fPath.String()));
+}
+
+
+void
+FontIndexTest::tearDown()
+{
+	unlink(fPath.String());
+
+	BTestCase::tearDown();
+}
+
+
+void
+FontIndexTest::SaveAndLoad()
+{
+	FontIndex index;
+	CPPUNIT_ASSERT_EQUAL(B_OK, index.Load(fPath.String()));
+	CPPUNIT_ASSERT(!index.IsChanged());
+
+	font_index_entry* entry = index.Lookup(kFirstPath, make_stat(1000, 2000));
+	CPPUNIT_ASSERT(entry != NULL);
+	CPPUNIT_ASSERT(entry->path == kFirstPath);
+	CPPUNIT_ASSERT_EQUAL(2, entry->styles.CountItems());
+
+	for (int32 i = 0; i < 2; i++) {
+		const font_style_info* info = entry->styles.ItemAt(i);
+		BString style;
+		style.SetToFormat("Style %" B_PRId32, i);
+
+		CPPUNIT_ASSERT(info->family == "Family");
+		CPPUNIT_ASSERT(info->style == style);
+		CPPUNIT_ASSERT_EQUAL((FT_Long)(i | (i << 16)), info->face_index);
+		CPPUNIT_ASSERT_EQUAL((uint32)(0x10 + i), info->flags);
+		CPPUNIT_ASSERT_EQUAL((uint16)(300 + i), info->glyph_count);
+		CPPUNIT_ASSERT_EQUAL((uint16)2, info->char_map_count);
+		CPPUNIT_ASSERT_EQUAL(i, info->tuned_count);
+		CPPUNIT_ASSERT_EQUAL(0.75f, info->height.ascent);
+		CPPUNIT_ASSERT_EQUAL(0.25f, info->height.descent);
+		CPPUNIT_ASSERT_EQUAL(0.125f, info->height.leading);
+	}
+
+	entry = index.Lookup(kSecondPath, make_stat(3000, 4000));
+	CPPUNIT_ASSERT(entry != NULL);
+	CPPUNIT_ASSERT_EQUAL(1, entry->styles.CountItems());
+
+	// changed files are not found
+	CPPUNIT_ASSERT(index.Lookup(kFirstPath, make_stat(1001, 2000)) == NULL);
+	CPPUNIT_ASSERT(index.Lookup(kFirstPath, make_stat(1000, 2001)) == NULL);
+
+	// and only the entries that were looked up survive
+	index.Lookup(kSecondPath, make_stat(3000, 4000));
+	FontIndex other;
+	CPPUNIT_ASSERT_EQUAL(B_OK, other.Load(fPath.String()));
+	other.Lookup(kSecondPath, make_stat(3000, 4000));
+	other.RemoveUnused();
+	CPPUNIT_ASSERT(other.IsChanged());
+	CPPUNIT_ASSERT_EQUAL(B_OK, other.Save(fPath.String()));
+
+	CPPUNIT_ASSERT_EQUAL(B_OK, index.Load(fPath.String()));
+	CPPUNIT_ASSERT(index.Lookup(kFirstPath, make_stat(1000, 2000)) == NULL);
+	CPPUNIT_ASSERT(index.Lookup(kSecondPath, make_stat(3000, 4000)) != NULL);
+}
+
+
+void
+FontIndexTest::LoadTruncated()
+{
+	BMallocIO data;
+	_ReadIndex(data);
+
+	for (size_t size = 0; size < data.BufferLength(); size++) {
+		_WriteIndex(data.Buffer(), size);
+
+		FontIndex index;
+		CPPUNIT_ASSERT(index.Load(fPath.String()) != B_OK);
+		CPPUNIT_ASSERT(index.Lookup(kFirstPath, make_stat(1000, 2000))
+			== NULL);
+		CPPUNIT_ASSERT(index.Lookup(kSecondPath, make_stat(3000, 4000))
+			== NULL);
+	}
+}
+
+
+void
+FontIndexTest::LoadCorrupt()
+{
+	BMallocIO data;
+	_ReadIndex(data);
+
+	// the header must match
+	uint32 magic = 'xxxx';
+	CPPUNIT_ASSERT_EQUAL(B_MISMATCHED_VALUES,
+		_LoadPatched(data, 0, &magic, sizeof(magic)));
+	uint32 version = 0;
+	CPPUNIT_ASSERT_EQUAL(B_MISMATCHED_VALUES,
+		_LoadPatched(data, 4, &version, sizeof(version)));
+
+	// more entries than there are
+	uint32 entryCount = 3;
+	CPPUNIT_ASSERT_EQUAL(B_BAD_DATA,
+		_LoadPatched(data, 12, &entryCount, sizeof(entryCount)));
+	entryCount = 0xffffffff;
+	CPPUNIT_ASSERT_EQUAL(B_BAD_DATA,
+		_LoadPatched(data, 12, &entryCount, sizeof(entryCount)));
+
+	// fewer entries than there are leaves data behind
+	entryCount = 1;
+	CPPUNIT_ASSERT_EQUAL(B_BAD_DATA,
+		_LoadPatched(data, 12, &entryCount, sizeof(entryCount)));
+
+	// a path that reaches beyond the end
+	uint16 length = 0xffff;
+	CPPUNIT_ASSERT_EQUAL(B_BAD_DATA,
+		_LoadPatched(data, kHeaderSize, &length, sizeof(length)));
+
+	// more styles than there are
+	uint32 styleCount = 0x7fffffff;
+	off_t styleCountOffset = kHeaderSize + sizeof(uint16) + strlen(kFirstPath)
+		+ 2 * sizeof(int64);
+	CPPUNIT_ASSERT_EQUAL(B_BAD_DATA,
+		_LoadPatched(data, styleCountOffset, &styleCount, sizeof(styleCount)));
+
+	// the same file twice
+	off_t secondOffset = find_data(data, kSecondPath);
+	CPPUNIT_ASSERT(secondOffset > 0);
+	CPPUNIT_ASSERT_EQUAL(B_BAD_DATA,
+		_LoadPatched(data, secondOffset, kFirstPath, strlen(kFirstPath)));
+
+	// trailing garbage
+	CPPUNIT_ASSERT_EQUAL(B_BAD_DATA,
+		_LoadPatched(data, data.BufferLength(), "x", 1));
+
+	// a failed load leaves the index empty, even if it had entries before
+	_WriteIndex(data.Buffer(), data.BufferLength());
+	FontIndex index;
+	CPPUNIT_ASSERT_EQUAL(B_OK, index.Load(fPath.String()));
+	CPPUNIT_ASSERT(index.Lookup(kFirstPath, make_stat(1000, 2000)) != NULL);
+
+	_WriteIndex(data.Buffer(), data.BufferLength() - 1);
+	CPPUNIT_ASSERT_EQUAL(B_BAD_DATA, index.Load(fPath.String()));
+	CPPUNIT_ASSERT(index.Lookup(kFirstPath, make_stat(1000, 2000)) == NULL);
+}
+
+
+void
+FontIndexTest::_ReadIndex(BMallocIO& data)
+{
+	BFile file(fPath.String(), B_READ_ONLY);
+	CPPUNIT_ASSERT_EQUAL(B_OK, file.InitCheck());
+
+	off_t size;
+	CPPUNIT_ASSERT_EQUAL(B_OK, file.GetSize(&size));
+	CPPUNIT_ASSERT(size > kHeaderSize);
+
+	CPPUNIT_ASSERT_EQUAL(B_OK, data.SetSize(size));
+	CPPUNIT_ASSERT_EQUAL((ssize_t)size,
+		file.ReadAt(0, (void*)data.Buffer(), size));
+}
+
+
+void
+FontIndexTest::_WriteIndex(const void* data, size_t size)
+{
+	BFile file(fPath.String(), B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
+	CPPUNIT_ASSERT_EQUAL(B_OK, file.InitCheck());
+	CPPUNIT_ASSERT_EQUAL((ssize_t)size, file.Write(data, size));
+}
+
+
+/*!	Writes \a data with \a size bytes at \a offset replaced by \a patch,
+	and loads it.
+*/
+status_t
+FontIndexTest::_LoadPatched(const BMallocIO& data, off_t offset,
+	const void* patch, size_t size)
+{
+	BMallocIO patched;
+	patched.Write(data.Buffer(), data.BufferLength());
+	patched.WriteAt(offset, patch, size);
+	_WriteIndex(patched.Buffer(), patched.BufferLength());
+
+	FontIndex index;
+	status_t status = index.Load(fPath.String());
+	if (status != B_OK) {
+		CPPUNIT_ASSERT(index.Lookup(kFirstPath, make_stat(1000, 2000))
+			== NULL);
+	}
+	return status;
+}
+
+
+/* static */ void
+FontIndexTest::AddTests(BTestSuite& parent)
+{
+	CppUnit::TestSuite* const suite = new CppUnit::TestSuite(
+		"FontIndexTest");
+
+	suite->addTest(new CppUnit::TestCaller<FontIndexTest>(
+		"FontIndexTest::SaveAndLoad", &FontIndexTest::SaveAndLoad));
+	suite->addTest(new CppUnit::TestCaller<FontIndexTest>(
+		"FontIndexTest::LoadTruncated", &FontIndexTest::LoadTruncated));
+	suite->addTest(new CppUnit::TestCaller<FontIndexTest>(
+		"FontIndexTest::LoadCorrupt", &FontIndexTest::LoadCorrupt));
+
+	parent.addTest("FontIndexTest", suite);
+}
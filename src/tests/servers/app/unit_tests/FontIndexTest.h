@@ -0,0 +1,38 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef FONT_INDEX_TEST_H
+#define FONT_INDEX_TEST_H
+
+#include <DataIO.h>
+#include <String.h>
+#include <TestCase.h>
+#include <TestSuite.h>
+
+#include "FontIndex.h"
+
+
+class FontIndexTest : public BTestCase {
+public:
+	virtual	void			setUp();
+	virtual	void			tearDown();
+
+	static	void			AddTests(BTestSuite& parent);
+
+			void			SaveAndLoad();
+			void			LoadTruncated();
+			void			LoadCorrupt();
+
+private:
+			void			_ReadIndex(BMallocIO& data);
+			void			_WriteIndex(const void* data, size_t size);
+			status_t		_LoadPatched(const BMallocIO& data,
+								off_t offset, const void* patch,
+								size_t size);
+
+			BString			fPath;
+};
+
+
+#endif // FONT_INDEX_TEST_H
@@ -0,0 +1,285 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Tests the ring buffer through which the input_server passes events to
+	the app_server: entries have to come out in order and unchanged when they
+	wrap around the end of the buffer and the offsets overflow, and a full
+	ring must neither accept nor corrupt any more entries.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <shared_event_ring.h>
+
+
+static shared_event_ring*
+create_ring(uint32 offset)
+{
+	shared_event_ring* ring = (shared_event_ring*)calloc(1,
+		sizeof(shared_event_ring) + SHARED_EVENT_RING_SIZE);
+	if (ring == NULL)
+		return NULL;
+
+	ring->size = SHARED_EVENT_RING_SIZE;
+	ring->write_offset = offset;
+	ring->read_offset = offset;
+	return ring;
+}
+
+
+static void
+fill_message(uint8* buffer, uint32 size, uint32 sequence)
+{
+	for (uint32 i = 0; i < size; i++)
+		buffer[i] = (uint8)(sequence * 31 + i);
+}
+
+
+static bool
+check_message(const uint8* buffer, uint32 size, uint32 sequence)
+{
+	for (uint32 i = 0; i < size; i++) {
+		if (buffer[i] != (uint8)(sequence * 31 + i))
+			return false;
+	}
+	return true;
+}
+
+
+static uint32
+message_size(uint32 sequence)
+{
+	// between 1 and ~3 KB, so that entries end at all kinds of positions
+	return 1 + (sequence * 2654435761U) % 3000;
+}
+
+
+static bool
+write_message(shared_event_ring* ring, uint32 sequence)
+{
+	uint32 size = message_size(sequence);
+	uint32 nextWriteOffset;
+	uint8* buffer = shared_event_ring_begin_write(ring, size,
+		&nextWriteOffset);
+	if (buffer == NULL)
+		return false;
+
+	fill_message(buffer, size, sequence);
+	shared_event_ring_end_write(ring, nextWriteOffset);
+	return true;
+}
+
+
+/*!	Reads up to \a maxCount messages from the ring, and checks that they are
+	the ones starting with \a sequence. Returns the number of messages read,
+	or -1 on failure.
+*/
+static int32
+read_messages(shared_event_ring* ring, uint32 sequence,
+	int32 maxCount = INT32_MAX)
+{
+	uint32 readOffset = ring->read_offset;
+	uint32 writeOffset = ring->write_offset;
+	int32 count = 0;
+
+	while (count < maxCount) {
+		const uint8* data;
+		uint32 size;
+		status_t status = shared_event_ring_next_message(ring, &readOffset,
+			writeOffset, &data, &size);
+		if (status == B_ENTRY_NOT_FOUND)
+			break;
+		if (status != B_OK) {
+			fprintf(stderr, "Reading message %" B_PRIu32 " failed: %s\n",
+				sequence, strerror(status));
+			return -1;
+		}
+		if (size != message_size(sequence)
+			|| !check_message(data, size, sequence)) {
+			fprintf(stderr, "Message %" B_PRIu32 " is wrong\n", sequence);
+			return -1;
+		}
+
+		sequence++;
+		count++;
+	}
+
+	ring->read_offset = readOffset;
+	return count;
+}
+
+
+static bool
+test_wrap_around(uint32 startOffset)
+{
+	shared_event_ring* ring = create_ring(startOffset);
+	if (ring == NULL)
+		return false;
+
+	// write and read in batches of varying size, so that the reader and
+	// writer pass the end of the buffer in all kinds of states
+	uint32 written = 0;
+	uint32 read = 0;
+	bool success = true;
+	for (int32 round = 0; round < 2000 && success; round++) {
+		int32 batch = 1 + round % 23;
+		for (int32 i = 0; i < batch; i++) {
+			if (!write_message(ring, written))
+				break;
+			written++;
+		}
+
+		int32 count = read_messages(ring, read);
+		if (count < 0 || read + count != written)
+			success = false;
+		else
+			read += count;
+	}
+
+	if (success && ring->write_offset - startOffset
+			< 4 * (uint32)SHARED_EVENT_RING_SIZE) {
+		fprintf(stderr, "The ring didn't wrap around\n");
+		success = false;
+	}
+
+	free(ring);
+	return success;
+}
+
+
+static bool
+test_full_ring(uint32 startOffset)
+{
+	shared_event_ring* ring = create_ring(startOffset);
+	if (ring == NULL)
+		return false;
+
+	bool success = true;
+	uint32 written = 0;
+	while (write_message(ring, written))
+		written++;
+
+	uint32 used = ring->write_offset - ring->read_offset;
+	if (written == 0 || used > SHARED_EVENT_RING_SIZE) {
+		fprintf(stderr, "Full ring has %" B_PRIu32 " messages in %" B_PRIu32
+			" bytes\n", written, used);
+		success = false;
+	}
+
+	// once full, nothing must be written anymore, not even a tiny message
+	uint32 nextWriteOffset;
+	uint32 writeOffset = ring->write_offset;
+	if (success && used + shared_event_ring_entry_size(1)
+			> SHARED_EVENT_RING_SIZE
+		&& shared_event_ring_begin_write(ring, 1, &nextWriteOffset) != NULL) {
+		fprintf(stderr, "Full ring accepted another message\n");
+		success = false;
+	}
+	if (ring->write_offset != writeOffset) {
+		fprintf(stderr, "Full ring changed its write offset\n");
+		success = false;
+	}
+
+	// reading everything must give back all messages unchanged, and the
+	// space has to be available again afterwards
+	if (success && read_messages(ring, 0) != (int32)written)
+		success = false;
+	if (success && !write_message(ring, written)) {
+		fprintf(stderr, "Emptied ring doesn't accept messages\n");
+		success = false;
+	}
+	if (success && read_messages(ring, written) != 1)
+		success = false;
+	written++;
+
+	// keep the ring full while the reader only takes a few messages at a
+	// time, so that the writer has to wrap around while the reader is
+	// anywhere in the buffer
+	uint32 read = written;
+	for (int32 round = 0; round < 1000 && success; round++) {
+		while (write_message(ring, written))
+			written++;
+
+		if (ring->write_offset - ring->read_offset
+				> (uint32)SHARED_EVENT_RING_SIZE) {
+			fprintf(stderr, "Ring overflowed\n");
+			success = false;
+			break;
+		}
+
+		int32 count = read_messages(ring, read, 1 + round % 5);
+		if (count <= 0)
+			success = false;
+		else
+			read += count;
+	}
+	if (success && read_messages(ring, read) != (int32)(written - read))
+		success = false;
+
+	free(ring);
+	return success;
+}
+
+
+static bool
+test_invalid_entry()
+{
+	shared_event_ring* ring = create_ring(0);
+	if (ring == NULL)
+		return false;
+
+	write_message(ring, 0);
+	// claim a message size that reaches beyond the written data
+	*(uint32*)ring->data = SHARED_EVENT_RING_SIZE;
+
+	uint32 readOffset = ring->read_offset;
+	const uint8* data;
+	uint32 size;
+	bool success = shared_event_ring_next_message(ring, &readOffset,
+		ring->write_offset, &data, &size) == B_BAD_DATA;
+	if (!success)
+		fprintf(stderr, "Invalid entry wasn't detected\n");
+
+	free(ring);
+	return success;
+}
+
+
+int
+main()
+{
+	// start at some offsets that overflow while testing
+	static const uint32 kStartOffsets[] = {
+		0, 100 * 8, SHARED_EVENT_RING_SIZE - 8, 0xffffffff - 20000 + 1
+	};
+
+	bool success = true;
+	for (size_t i = 0; i < sizeof(kStartOffsets) / sizeof(kStartOffsets[0]);
+			i++) {
+		if (!test_wrap_around(kStartOffsets[i])) {
+			fprintf(stderr, "Wrap around test failed at offset %#" B_PRIx32
+				"\n", kStartOffsets[i]);
+			success = false;
+		}
+		if (!test_full_ring(kStartOffsets[i])) {
+			fprintf(stderr, "Full ring test failed at offset %#" B_PRIx32
+				"\n", kStartOffsets[i]);
+			success = false;
+		}
+	}
+
+	if (!test_invalid_entry())
+		success = false;
+
+	if (!success)
+		return 1;
+
+	printf("All event ring tests passed.\n");
+	return 0;
+}
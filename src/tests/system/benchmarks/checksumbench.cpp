@@ -0,0 +1,128 @@
+/*
+ * Copyright 2026, Haiku, Inc. All Rights Reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <OS.h>
+
+#include <SHA256.h>
+
+
+extern uint32 calculate_crc32c(uint32 crc32c, const unsigned char* buffer,
+	unsigned int length);
+extern uint32 calculate_crc32c_generic(uint32 crc32c,
+	const unsigned char* buffer, unsigned int length);
+
+
+static const size_t kBufferSize = 16 * 1024 * 1024;
+static const size_t kBlockSize = 4096;
+static const int kIterations = 8;
+
+
+static void
+print_rate(const char* name, bigtime_t time)
+{
+	double megaBytes = (double)kBufferSize * kIterations / (1024 * 1024);
+	printf("%-24s %8.1f MiB/s\n", name,
+		megaBytes / ((double)(time > 0 ? time : 1) / 1000000));
+}
+
+
+static void
+sha256_digest(bool allowAcceleration, const uint8* data, size_t size,
+	uint8* digest)
+{
+	SHA256 sha(allowAcceleration);
+	sha.Update(data, size);
+	memcpy(digest, sha.Digest(), SHA_DIGEST_LENGTH);
+}
+
+
+static bigtime_t
+time_sha256(bool allowAcceleration, const uint8* buffer, uint8* digest)
+{
+	bigtime_t start = system_time();
+	for (int i = 0; i < kIterations; i++)
+		sha256_digest(allowAcceleration, buffer, kBufferSize, digest);
+	return system_time() - start;
+}
+
+
+static bigtime_t
+time_crc32c(uint32 (*function)(uint32, const unsigned char*, unsigned int),
+	const uint8* buffer, uint32& _crc)
+{
+	// checksum file system sized blocks, like ext2 and xfs do
+	uint32 crc = 0;
+	bigtime_t start = system_time();
+	for (int i = 0; i < kIterations; i++) {
+		for (size_t offset = 0; offset < kBufferSize; offset += kBlockSize)
+			crc ^= function(0xffffffff, buffer + offset, kBlockSize);
+	}
+	_crc = crc;
+	return system_time() - start;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	uint8* buffer = (uint8*)malloc(kBufferSize);
+	if (buffer == NULL) {
+		fprintf(stderr, "checksumbench: out of memory\n");
+		return 1;
+	}
+
+	srand(42);
+	for (size_t i = 0; i < kBufferSize; i++)
+		buffer[i] = rand();
+
+	uint8 digest[SHA_DIGEST_LENGTH];
+	uint8 genericDigest[SHA_DIGEST_LENGTH];
+	print_rate("SHA-256", time_sha256(true, buffer, digest));
+	print_rate("SHA-256 (generic)", time_sha256(false, buffer, genericDigest));
+
+	uint32 crc;
+	uint32 genericCRC;
+	print_rate("CRC32C", time_crc32c(&calculate_crc32c, buffer, crc));
+	print_rate("CRC32C (generic)",
+		time_crc32c(&calculate_crc32c_generic, buffer, genericCRC));
+
+	// make sure the accelerated implementations compute the same thing,
+	// including for unaligned and odd sized input
+	int result = 0;
+	if (memcmp(digest, genericDigest, SHA_DIGEST_LENGTH) != 0) {
+		fprintf(stderr, "SHA-256 mismatch!\n");
+		result = 1;
+	}
+	if (crc != genericCRC) {
+		fprintf(stderr, "CRC32C mismatch!\n");
+		result = 1;
+	}
+
+	for (size_t size = 0; size < 300; size++) {
+		const uint8* data = buffer + size % 13;
+		SHA256 sha;
+		sha.Update(data, size / 2);
+		sha.Update(data + size / 2, size - size / 2);
+		sha256_digest(false, data, size, genericDigest);
+		if (memcmp(sha.Digest(), genericDigest, SHA_DIGEST_LENGTH) != 0) {
+			fprintf(stderr, "SHA-256 mismatch for size %zu!\n", size);
+			result = 1;
+		}
+
+		if (calculate_crc32c(0xffffffff, data, size)
+				!= calculate_crc32c_generic(0xffffffff, data, size)) {
+			fprintf(stderr, "CRC32C mismatch for size %zu!\n", size);
+			result = 1;
+		}
+	}
+
+	free(buffer);
+	return result;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "fssh_stdio.h"
+#include "syscalls.h"
+
+#include "bfs.h"
+#include "bfs_control.h"
+
+
+namespace FSShell {
+
+
+fssh_status_t
+command_defragfs(int argc, const char* const* argv)
+{
+	if (argc > 2 || (argc == 2 && !strcmp(argv[1], "--help"))) {
+		fssh_dprintf("Usage: %s [delay]\n"
+			"  delay  Microseconds to wait after each relocated file\n",
+			argv[0]);
+		return B_OK;
+	}
+
+	struct defragment_control control;
+	memset(&control, 0, sizeof(control));
+	control.magic = BFS_IOCTL_DEFRAGMENT_MAGIC;
+
+	if (argc == 2 && fssh_sscanf(argv[1], "%" FSSH_B_SCNd64,
+			&control.delay) < 1) {
+		fssh_dprintf("Invalid delay\n");
+		return B_ERROR;
+	}
+
+	int rootDir = _kern_open_dir(-1, "/myfs");
+	if (rootDir < 0) {
+		fssh_dprintf("Error: Couldn't open root directory\n");
+		return rootDir;
+	}
+
+	fssh_status_t status = _kern_ioctl(rootDir, BFS_IOCTL_DEFRAGMENT,
+		&control, sizeof(control));
+
+	_kern_close(rootDir);
+
+	if (status != B_OK) {
+		fssh_dprintf("Defragmenting failed, status: %s\n",
+			fssh_strerror(status));
+		return status;
+	}
+
+	fssh_dprintf("        %" FSSH_B_PRIu64 " nodes visited\n"
+		"        %" FSSH_B_PRIu64 " fragmented files\n"
+		"        %" FSSH_B_PRIu64 " files relocated\n"
+		"        %" FSSH_B_PRIu64 " blocks moved\n",
+		control.stats.inodes, control.stats.fragmented,
+		control.stats.relocated, control.stats.blocks_moved);
+
+	return B_OK;
+}
+
+
+}	// namespace FSShell